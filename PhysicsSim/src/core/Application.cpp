@@ -6,42 +6,31 @@
 */
 
 #include "Application.hpp"
+#include "FrameScheduler.hpp"
 #include "ImGuiManager.hpp"
+#include "SimulationConfig.hpp"
 
 #include "utils/GlfwIncludes.hpp"
+#include "graphics/FrameCapture.hpp"
 #include "graphics/Scene.hpp"
+#include "graphics/SimulationRenderItems.hpp"
+#include "io/Checkpoint.hpp"
+#include "io/OutputStage.hpp"
+#include "io/TrajectoryReader.hpp"
 #include "objects/Object.hpp"
+#include "profiling/GpuProfiler.hpp"
+#include "profiling/Profiler.hpp"
 #include "simulation/Simulation.hpp"
 
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
 
 /// @brief Application namespace.
 namespace App
 {
-	//Structures to hold the simulators' data.
-
-	/**
-	* @brief Structure to hold the thermodynamic simulation variables.
-	* @param num_particles The number of particles to simulate.
-	* @param box_width_perc The width of the simulation box as a percentage of the window.
-	* @param box_height_perc The height of the simulation box as a percentage of the window.
-	* @param energy_value The energy value for the simulation.
-	* @param temperature The temperature for the simulation.
-	* @param chem_potential The chemical potential for the simulation.
-	* @param radius The radius of the particles in the simulation.
-	*/
-	struct ThermodynamicSimulationVariables
-	{
-		int num_particles = 0;
-		int box_width_perc = 0;
-		int box_height_perc = 0;
-		float energy_value = 0.0f;
-		float temperature = 0.0f;
-		float chem_potential = 0.0f;
-		float radius = 0.0f;
-	};
-
 	/// @brief Application PIMPL implementation structure.
 	struct Application::ApplicationImpl
 	{
@@ -82,6 +71,55 @@ namespace App
 		*/
 		void Run(bool demo);
 
+		/**
+		* @brief
+		* Start or stop recording to match the user's choice and publish the
+		* newest step to the output stage while recording. Called once per
+		* rendered frame.
+		*/
+		void UpdateRecording();
+
+		/// @brief Stop recording and report what was written.
+		void StopRecording();
+
+		/// @brief Run one simulation substep.
+		void StepSimulation();
+
+		/**
+		* @brief
+		* Start or stop capturing the render window to match the user's choice
+		* and queue a readback of this frame while capturing.
+		* @param rendered True if the render window was drawn this frame.
+		*/
+		void UpdateCapture(bool rendered);
+
+		/**
+		* @brief
+		* Open the trajectory selected in the ImGuiManager for replay. Removes the
+		* simulator and sets up the render items from the first frame.
+		*/
+		void OpenReplay();
+
+		/// @brief Close the open replay.
+		void CloseReplay();
+
+		/// @brief Decode the replay frame selected in the ImGuiManager if it changed.
+		void UpdateReplay();
+
+		/**
+		* @brief
+		* Snapshot the simulation and write it to the checkpoint selected in the
+		* ImGuiManager on a background thread.
+		*/
+		void SaveCheckpoint();
+
+		/**
+		* @brief
+		* Replace the simulation with the one in the checkpoint selected in the
+		* ImGuiManager.
+		*/
+		void LoadCheckpoint();
+
 		//Member variables
 
 		/// @brief Unique pointer to the ImGuiManager.
@@ -94,6 +132,28 @@ namespace App
 		int box_width_perc = 0;
 		/// @brief The height of the simulation box as a percentage of the window.
 		int box_height_perc = 0;
+		/// @brief Number of frames the current simulation has run.
+		uint64_t simulation_step = 0;
+		/// @brief Asynchronous output stage, set while the simulation is recorded.
+		std::unique_ptr<IO::OutputStage> output;
+		/// @brief Step last published to the output stage.
+		uint64_t published_step = 0;
+		/// @brief Reused buffer for the positions handed to the output stage.
+		std::vector<float> output_positions;
+		/// @brief Flag set when recording failed to start, cleared when the user stops it.
+		bool output_failed = false;
+		/// @brief Flag set when a capture failed to start, cleared when the user stops it.
+		bool capture_failed = false;
+		/// @brief Reader of the trajectory being replayed, set while replaying.
+		std::unique_ptr<IO::TrajectoryReader> replay;
+		/// @brief Index of the replay frame shown, -1 if none.
+		int replay_frame = -1;
+		/// @brief Reused buffer for the decoded replay positions.
+		std::vector<float> replay_positions;
+		/// @brief Writes checkpoints from a spare snapshot buffer on a background thread.
+		IO::Checkpointer checkpointer;
+		/// @brief Paces the frames and schedules the simulation substeps in them.
+		FrameScheduler scheduler;
 	};
 
 	/**
@@ -125,22 +185,43 @@ namespace App
 	/**
 	* @details
 	* Run the application loop using the following steps:
-	* 1. Poll GLFW events for input processing.
+	* 1. Poll GLFW events for input processing, or wait for them while idle.
 	* 2. Check if the window is minimized and prevent rendering if it is.
 	* 3. Create a new ImGui frame.
 	* 4. Render either the demo or the actual application window.
-	* 5. Check for ImGui state changes.
-	* 6. Render the texture for the ImGui render window.
+	* 5. Check for ImGui state changes, decode the selected replay frame and run
+	*    the simulation substeps the scheduler fits into the frame, and hand the
+	*    newest step to the output stage when recording.
+	* 6. Render the texture for the ImGui render window and queue its readback
+	*    when capturing.
 	* 7. Get ImGui background color and render the scene.
 	* 8. Draw ImGui to OpenGL window and swap buffers to present frame to screen.
+	* 9. Pace the frame and end the GPU and CPU profiler frames.
+	* The application is idle while there is no running simulation or playing
+	* replay, and then only draws a frame when an event arrives or a timeout
+	* passes.
+	* Each step is timed by the profiler and shown in the debug window. The render
+	* passes are timed on the GPU as well.
 	*/
 	void Application::ApplicationImpl::Run(bool demo)
 	{
+		PROFILE_THREAD("Render");
+
+		// Target frame rates below the display's are paced by the scheduler instead of vertical sync
+		if (GLFWmonitor* monitor = glfwGetPrimaryMonitor())
+		{
+			if (const GLFWvidmode* mode = glfwGetVideoMode(monitor))
+				scheduler.SetRefreshRate(double(mode->refreshRate));
+		}
+
 		// Check each frame if the window should close
 		while (!scene->WindowShouldClose())
 		{
-			// Poll GLFW events for input processing
-			glfwPollEvents();
+			// Poll GLFW events for input processing, or wait for them while idle
+			scheduler.SetIdle(
+				(simulation == nullptr || imgui->GetPaused()) && !imgui->GetReplayPlaying());
+			scheduler.BeginFrame();
+			imgui->SetPacingStats(scheduler.GetRealTimeFactor(), scheduler.GetStepsPerSecond());
 
 			// If the window is minimized, prevent rendering
 			if (glfwGetWindowAttrib(scene->GetWindow(), GLFW_ICONIFIED) != 0)
@@ -149,25 +230,35 @@ namespace App
 				continue;
 			}
 
-			// Create new ImGui frame
-			imgui->NewFrame();
-
-			// Render either the demo or the actual application window
-			if (demo) imgui->SetupDemoWindow();
-			else
 			{
-				// Build the ImGui UI dockspace and framework for rendering
-				imgui->SetupWindow(scene->GetTexture(), scene->GetTextureAspectRatio());
+				PROFILE_SCOPE("ImGui Build");
+
+				// Create new ImGui frame
+				imgui->NewFrame();
+
+				// Render either the demo or the actual application window
+				if (demo) imgui->SetupDemoWindow();
+				else
+				{
+					// Build the ImGui UI dockspace and framework for rendering
+					imgui->SetupWindow(scene->GetTexture(), scene->GetTextureAspectRatio());
+				}
 			}
 
 			// Check for ImGui state changes
 			std::string& current_state = imgui->CheckForStateChanged();
 			if (current_state == "InitThermoSim")
 			{
+				PROFILE_SCOPE("Simulation Init");
+
 				// Get the simulation variables from the ImGuiManager
 				ThermodynamicSimulationVariables vars =
 					imgui->GetSimulationVariables();
 
+				// The particle count may change, so finish the current recording
+				StopRecording();
+				CloseReplay();
+
 				// Clear the simulation if it exists
 				if (simulation != nullptr) simulation.release();
 
@@ -179,7 +270,8 @@ namespace App
 						vars.energy_value,
 						vars.temperature,
 						vars.chem_potential,
-						vars.radius);
+						vars.radius,
+						vars.seed);
 
 				// Pass the simulation instance data to the RenderManager
 				scene->SetThermodynamicParticlesInstanceData(
@@ -188,6 +280,7 @@ namespace App
 
 				box_width_perc = vars.box_width_perc;
 				box_height_perc = vars.box_height_perc;
+				simulation_step = 0;
 
 				current_state = "";
 			}
@@ -195,11 +288,54 @@ namespace App
 			{
 				current_state = "";
 			}
+			else if (current_state == "OpenReplay")
+			{
+				OpenReplay();
+				current_state = "";
+			}
+			else if (current_state == "CloseReplay")
+			{
+				CloseReplay();
+				current_state = "";
+			}
+			else if (current_state == "SaveCheckpoint")
+			{
+				SaveCheckpoint();
+				current_state = "";
+			}
+			else if (current_state == "LoadCheckpoint")
+			{
+				LoadCheckpoint();
+				current_state = "";
+			}
+
+			UpdateReplay();
+
+			// Fill the frame with simulation substeps, the scheduler keeps time for the render
+			scheduler.SetTargetFrameRate(imgui->GetTargetFrameRate());
+			scheduler.SetFastForward(imgui->GetFastForward());
+			if (simulation != nullptr && !imgui->GetPaused())
+				scheduler.RunSubsteps([this]() { StepSimulation(); });
+
+			// Record at most one frame per rendered frame, however many substeps ran
+			UpdateRecording();
 			
-			ImGui::Render();
+			{
+				PROFILE_SCOPE("ImGui Render");
+				ImGui::Render();
+			}
+
+			scene->SetCamera(imgui->GetCamera());
+			scene->SetColorMode(
+				Graphics::SimulationRenderStructs::ColorBy(imgui->GetColorBy()),
+				Graphics::SimulationRenderStructs::ColorMap(imgui->GetColorMap()));
+			scene->SetCompactInstances(imgui->GetCompactInstances());
+			scene->SetTrails(imgui->GetTrails(), imgui->GetTrailPersistence());
 
 			if (simulation != nullptr)
 			{
+				PROFILE_GPU_SCOPE("Simulation Render");
+
 				ThermodynamicSimulationVariables vars =
 					imgui->GetSimulationVariables();
 
@@ -210,14 +346,314 @@ namespace App
 					box_height_perc);
 			}
 
+			if (replay != nullptr)
+			{
+				PROFILE_GPU_SCOPE("Replay Render");
+
+				scene->RenderTexture();
+				scene->RenderSimulationItems();
+			}
+
+			UpdateCapture(simulation != nullptr || replay != nullptr);
+
 			// Get ImGui background color and render scene
-			ImVec4& cc = imgui->GetClearColor();
-			scene->Render(cc.x * cc.w, cc.y * cc.w, cc.z * cc.w, cc.w);
+			{
+				PROFILE_GPU_SCOPE("Scene Render");
+				ImVec4& cc = imgui->GetClearColor();
+				scene->Render(cc.x * cc.w, cc.y * cc.w, cc.z * cc.w, cc.w);
+			}
 
 			// Draw ImGui to OpenGL window and swap buffers to present frame to screen
-			imgui->RenderDrawData();
-			scene->SwapBuffers();
+			{
+				PROFILE_GPU_SCOPE("ImGui Draw");
+				imgui->RenderDrawData();
+			}
+			{
+				PROFILE_SCOPE("Swap Buffers");
+				scene->SetSwapInterval(scheduler.GetSwapInterval());
+				scene->SwapBuffers();
+			}
+
+			scheduler.EndFrame();
+
+			PROFILE_GPU_END_FRAME();
+			PROFILE_END_FRAME();
+		}
+	}
+
+	/**
+	* @details
+	* Start a recording when the user asked for one and a simulation exists, and
+	* stop it when the user unchecks it or the simulation goes away. A recording
+	* that failed to start isn't retried until the user unchecks it. While
+	* recording, the particle positions of the newest step are published to the
+	* output stage when the step changed since the last frame, so a paused
+	* simulation adds no frames and fast forward adds one per rendered frame
+	* instead of one per substep. The stage copies them into a pooled buffer
+	* and returns, the encoding and disk writes happen on its writer thread.
+	*/
+	void Application::ApplicationImpl::UpdateRecording()
+	{
+		const bool requested = imgui->GetRecordingRequested() && simulation != nullptr;
+
+		if (!requested)
+		{
+			StopRecording();
+			output_failed = false;
+			return;
+		}
+
+		if (output_failed) return;
+
+		if (output == nullptr)
+		{
+			simulation->GetParticlePositions(output_positions);
+			if (output_positions.empty()) return;
+
+			IO::OutputSettings settings;
+			settings.trajectory_path = imgui->GetOutputPath();
+			settings.policy = imgui->GetDropFramesWhenBehind() ?
+				IO::BackpressurePolicy::Drop :
+				IO::BackpressurePolicy::Block;
+			settings.header.num_particles = uint32_t(output_positions.size() / 3);
+			settings.header.dimensions = 2;
+			settings.header.box_min[0] = -float(box_width_perc) / 100.0f;
+			settings.header.box_max[0] = float(box_width_perc) / 100.0f;
+			settings.header.box_min[1] = -float(box_height_perc) / 100.0f;
+			settings.header.box_max[1] = float(box_height_perc) / 100.0f;
+			settings.header.species.assign(settings.header.num_particles, 0);
+
+			output = std::make_unique<IO::OutputStage>(settings);
+			if (output->GetErrorStatus())
+			{
+				StopRecording();
+				output_failed = true;
+				return;
+			}
+		}
+		else
+		{
+			if (simulation_step == published_step) return;
+			simulation->GetParticlePositions(output_positions);
+		}
+
+		published_step = simulation_step;
+		if (!output->Publish(simulation_step, output_positions) && output->GetErrorStatus())
+		{
+			StopRecording();
+			output_failed = true;
+		}
+	}
+
+	/**
+	* @details
+	* The simulator has no integrator to advance yet, so a substep only counts
+	* the step. The recording picks up the newest step once per rendered frame.
+	*/
+	void Application::ApplicationImpl::StepSimulation()
+	{
+		simulation_step++;
+	}
+
+	/**
+	* @details
+	* Close the output stage, which writes the queued frames, and log how many
+	* frames were written and dropped.
+	*/
+	void Application::ApplicationImpl::StopRecording()
+	{
+		if (output == nullptr) return;
+
+		output->Close();
+		spdlog::info(
+			"Recording stopped: {} frames written, {} dropped",
+			output->GetWrittenFrames(),
+			output->GetDroppedFrames());
+		output.reset();
+	}
+
+	/**
+	* @details
+	* Start a capture when the user asked for one and the render window is
+	* drawn, and stop it when the user unchecks it or nothing is drawn. A
+	* capture that failed to start isn't retried until the user unchecks it.
+	* The readback only queues a copy on the GPU, the pixels are collected a
+	* few frames later and encoded on the capture's worker threads.
+	*/
+	void Application::ApplicationImpl::UpdateCapture(bool rendered)
+	{
+		if (!imgui->GetCaptureRequested() || !rendered)
+		{
+			scene->StopCapture();
+			capture_failed = false;
+			return;
+		}
+
+		if (capture_failed) return;
+
+		if (!scene->IsCapturing())
+		{
+			Graphics::CaptureSettings settings;
+			settings.path = imgui->GetCapturePath();
+			settings.format = Graphics::CaptureFormat(imgui->GetCaptureFormat());
+			if (!scene->StartCapture(settings))
+			{
+				capture_failed = true;
+				return;
+			}
+		}
+
+		PROFILE_GPU_SCOPE("Frame Capture");
+		scene->CaptureTexture();
+	}
+
+	/**
+	* @details
+	* Close any recording, simulation and earlier replay, then open the file.
+	* The first frame is decoded to create the render items with the same
+	* instance layout the simulator produces, red particles at unit scale:
+	* x, y, z, padding, red, green, blue, padding, x_scale, y_scale, z_scale, padding
+	* The particle radius isn't stored in the trajectory, the radius from the
+	* simulation variables is used instead.
+	*/
+	void Application::ApplicationImpl::OpenReplay()
+	{
+		StopRecording();
+		CloseReplay();
+		simulation.reset();
+
+		auto reader = std::make_unique<IO::TrajectoryReader>(imgui->GetReplayPath());
+		if (reader->GetErrorStatus() ||
+			reader->GetFrameCount() == 0 ||
+			!reader->ReadFrame(0, replay_positions))
+			return;
+
+		const size_t count = replay_positions.size() / 3;
+		std::vector<float> instance_data(12 * count, 1.0f);
+		for (size_t i = 0; i < count; i++)
+		{
+			float* instance = instance_data.data() + 12 * i;
+			instance[0] = replay_positions[3 * i + 0];
+			instance[1] = replay_positions[3 * i + 1];
+			instance[2] = replay_positions[3 * i + 2];
+			instance[5] = 0.0f;
+			instance[6] = 0.0f;
+		}
+
+		const float radius = std::max(imgui->GetSimulationVariables().radius, 0.005f);
+		scene->InitializeSimulationRenderItems(
+			Graphics::SimulationTypes::THERMODYNAMICS,
+			instance_data,
+			radius);
+
+		replay = std::move(reader);
+		replay_frame = 0;
+		imgui->SetReplayFrameCount(replay->GetFrameCount());
+	}
+
+	/**
+	* @details
+	* Release the reader, which unmaps the file, and reset the replay controls.
+	*/
+	void Application::ApplicationImpl::CloseReplay()
+	{
+		if (replay == nullptr) return;
+
+		replay.reset();
+		replay_frame = -1;
+		imgui->SetReplayFrameCount(0);
+	}
+
+	/**
+	* @details
+	* Decode the selected frame straight from the mapped file and upload its
+	* positions to the render items. Nothing is decoded while the selection
+	* stays on the same frame.
+	*/
+	void Application::ApplicationImpl::UpdateReplay()
+	{
+		if (replay == nullptr) return;
+
+		const int frame = imgui->GetReplayFrame();
+		if (frame == replay_frame) return;
+
+		if (replay->ReadFrame(uint64_t(frame), replay_positions))
+			scene->UpdateSimulationPositions(replay_positions);
+		replay_frame = frame;
+	}
+
+	/**
+	* @details
+	* Copy the simulation state into the checkpointer's spare buffer and hand
+	* it to the writer thread, so the simulation only pauses for the copy and
+	* not for the disk. Incremental checkpoints only write the blocks that
+	* changed since the last one. A request while the previous checkpoint is
+	* still being written is skipped.
+	*/
+	void Application::ApplicationImpl::SaveCheckpoint()
+	{
+		if (simulation == nullptr)
+		{
+			spdlog::warn("No simulation to checkpoint");
+			return;
+		}
+
+		Simulation::SimulationState* state = checkpointer.BeginSnapshot();
+		if (state == nullptr)
+		{
+			spdlog::warn("Previous checkpoint is still being written");
+			return;
 		}
+
+		simulation->SaveState(*state);
+		state->step = simulation_step;
+		checkpointer.CommitSnapshot(
+			imgui->GetCheckpointPath(),
+			imgui->GetIncrementalCheckpoints());
+	}
+
+	/**
+	* @details
+	* Read the checkpoint, then close any recording and replay and restore the
+	* simulator, the box and the step count from it. The simulation continues
+	* exactly where the saved one stopped, and the selection window shows its
+	* parameters. Nothing changes if the checkpoint can't be read or restored.
+	*/
+	void Application::ApplicationImpl::LoadCheckpoint()
+	{
+		Simulation::SimulationState state;
+		if (!IO::ReadCheckpoint(imgui->GetCheckpointPath(), state)) return;
+
+		auto restored = std::make_unique<Simulation::ThermodynamicParticleSimulator>(state);
+		if (restored->GetErrorStatus())
+		{
+			spdlog::error("Failed to restore the simulation from {}", imgui->GetCheckpointPath());
+			return;
+		}
+
+		ThermodynamicSimulationVariables vars = imgui->GetSimulationVariables();
+		vars.num_particles = state.num_particles;
+		vars.box_width_perc = state.box_width_perc;
+		vars.box_height_perc = state.box_height_perc;
+		vars.energy_value = state.energy_value;
+		vars.temperature = state.temperature;
+		vars.chem_potential = state.chem_potential;
+		vars.radius = state.radius;
+		imgui->SetSimulationVariables(vars);
+
+		StopRecording();
+		CloseReplay();
+
+		simulation = std::move(restored);
+		box_width_perc = state.box_width_perc;
+		box_height_perc = state.box_height_perc;
+		simulation_step = state.step;
+
+		std::vector<float> instance_data = simulation->GetParticleInstanceData();
+		scene->InitializeSimulationRenderItems(
+			Graphics::SimulationTypes::THERMODYNAMICS,
+			instance_data,
+			state.radius);
 	}
 
 	/**
@@ -255,4 +691,15 @@ namespace App
 	{
 		_impl->Run(demo);
 	}
+
+	/**
+	* @details
+	* Fill the selection window from the scenario, including the trajectory
+	* path recordings are written to. The simulation is set up when the user
+	* presses Setup Simulation, like one entered by hand.
+	*/
+	void Application::ApplyConfig(const SimulationConfig& config)
+	{
+		_impl->imgui->ApplyConfig(config);
+	}
 }
\ No newline at end of file
@@ -35,6 +35,8 @@ namespace App
 
 	/// @brief Forward declaration of ThermodynamicSimulationVariables struct.
 	struct ThermodynamicSimulationVariables;
+	/// @brief Forward declaration of SimulationConfig struct.
+	struct SimulationConfig;
 
 	//Internal declarations
 
@@ -79,6 +81,12 @@ namespace App
 		*/
 		void Run(bool demo);
 
+		/**
+		* @brief Load a scenario into the application. Must be called after Init.
+		* @param config The scenario loaded from a configuration file.
+		*/
+		void ApplyConfig(const SimulationConfig& config);
+
 		//PIMPL idiom
 	private:
 		/// @brief Forward declaration of ApplicationImpl struct.
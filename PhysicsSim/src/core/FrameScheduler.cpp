@@ -0,0 +1,358 @@
+/**
+* @file FrameScheduler.cpp
+* @brief
+* Function definitions for the FrameScheduler class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "FrameScheduler.hpp"
+#include "utils/GlfwIncludes.hpp"
+
+#include "profiling/Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/// @brief Application namespace
+namespace App
+{
+	/// @brief FrameScheduler PIMPL implementation structure.
+	struct FrameScheduler::FrameSchedulerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		FrameSchedulerImpl(const FrameSchedulerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		FrameSchedulerImpl& operator=(const FrameSchedulerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		FrameSchedulerImpl(const FrameSchedulerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		FrameSchedulerImpl& operator=(const FrameSchedulerImpl&& other) = delete;
+
+		/// @brief Clock the frames are paced with.
+		using Clock = std::chrono::steady_clock;
+		/// @brief Duration in seconds.
+		using Seconds = std::chrono::duration<double>;
+
+		/// @brief Share of a real time frame the substeps may use, the rest is left to the render.
+		static constexpr double SIMULATION_SHARE = 0.75;
+		/// @brief Most simulated time a real time simulation may fall behind before it is dropped.
+		static constexpr double MAX_LAG = 0.25;
+		/// @brief Longest an idle frame waits for an event, in seconds.
+		static constexpr double IDLE_TIMEOUT = 0.5;
+		/// @brief Frames polled after an idle wait, so ImGui settles its response to the event.
+		static constexpr int SETTLE_FRAMES = 2;
+		/// @brief Interval the real time factor is averaged over, in seconds.
+		static constexpr double RATE_INTERVAL = 0.5;
+		/// @brief Weight of the newest measurement in the cost averages.
+		static constexpr double COST_SMOOTHING = 0.1;
+		/// @brief Share a target frame time may exceed the refresh period by and still use vertical sync.
+		static constexpr double REFRESH_TOLERANCE = 0.02;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		FrameSchedulerImpl() = default;
+		/// @brief Default destructor.
+		~FrameSchedulerImpl() = default;
+
+		//Member methods
+
+		/**
+		* @brief Get the time a frame should take in the current mode.
+		* @return The frame time in seconds.
+		*/
+		double FrameTime() const;
+
+		/**
+		* @brief Check if the frames are paced by vertical sync.
+		* @return True if the buffer swaps wait for the display, false otherwise.
+		*/
+		bool VerticalSync() const;
+
+		//Member variables
+
+		/// @brief Time a frame should take outside of fast forward, in seconds.
+		double frame_time = 1.0 / 60.0;
+		/// @brief Time between display refreshes, in seconds.
+		double refresh_period = 1.0 / 60.0;
+		/// @brief Flag set while fast forwarding.
+		bool fast_forward = false;
+		/// @brief Flag set while the application is idle.
+		bool idle = false;
+		/// @brief Simulated seconds per substep.
+		double step_time = 1.0 / 60.0;
+		/// @brief Frames to poll before waiting for events again.
+		int settle_frames = 0;
+		/// @brief Number of the current frame.
+		uint64_t frame = 0;
+		/// @brief Frame substeps last ran in.
+		uint64_t last_step_frame = 0;
+		/// @brief Start of the current frame.
+		Clock::time_point frame_start = Clock::now();
+		/// @brief Time substeps last ran up to.
+		Clock::time_point last_step = Clock::now();
+		/// @brief End of the substeps of the current frame.
+		Clock::time_point steps_end = Clock::now();
+		/// @brief Simulated seconds a real time simulation is behind the wall clock.
+		double lag = 0.0;
+		/// @brief Average wall time of a substep, in seconds.
+		double step_cost = 0.0;
+		/// @brief Average wall time from the end of the substeps to the end of the frame, in seconds.
+		double render_cost = 0.0;
+		/// @brief Start of the current real time factor interval.
+		Clock::time_point rate_start = Clock::now();
+		/// @brief Substeps run in the current real time factor interval.
+		uint64_t rate_steps = 0;
+		/// @brief Real time factor of the last interval.
+		double real_time_factor = 0.0;
+		/// @brief Substeps per second of the last interval.
+		double steps_per_second = 0.0;
+	};
+
+	/**
+	* @details
+	* Fast forward renders at its own fixed rate. With vertical sync a frame
+	* lasts at least a refresh period, however high the target frame rate.
+	*/
+	double FrameScheduler::FrameSchedulerImpl::FrameTime() const
+	{
+		if (fast_forward) return 1.0 / FAST_FORWARD_FRAME_RATE;
+		return std::max(frame_time, refresh_period);
+	}
+
+	/**
+	* @details
+	* Target frame times a little past the refresh period, like 60 FPS on a
+	* 59.94 Hz display, still use vertical sync.
+	*/
+	bool FrameScheduler::FrameSchedulerImpl::VerticalSync() const
+	{
+		return !fast_forward && frame_time <= refresh_period * (1.0 + REFRESH_TOLERANCE);
+	}
+
+	/**
+	* @details
+	* Constructor for the FrameScheduler class. Initializes the PIMPL pointer.
+	*/
+	FrameScheduler::FrameScheduler() :
+		_impl(std::make_unique<FrameSchedulerImpl>())
+	{}
+
+	/**
+	* @details
+	* Destructor for the FrameScheduler class.
+	*/
+	FrameScheduler::~FrameScheduler() = default;
+
+	/**
+	* @details
+	* Rates below one frame per second are raised to one.
+	*/
+	void FrameScheduler::SetTargetFrameRate(double frame_rate)
+	{
+		_impl->frame_time = 1.0 / std::max(frame_rate, 1.0);
+	}
+
+	/**
+	* @details
+	* Rates that aren't positive, like an unknown refresh rate, are ignored.
+	*/
+	void FrameScheduler::SetRefreshRate(double refresh_rate)
+	{
+		if (refresh_rate > 0.0) _impl->refresh_period = 1.0 / refresh_rate;
+	}
+
+	/**
+	* @details
+	* Set the fast forward flag.
+	*/
+	void FrameScheduler::SetFastForward(bool fast_forward)
+	{
+		_impl->fast_forward = fast_forward;
+	}
+
+	/**
+	* @details
+	* Set the idle flag.
+	*/
+	void FrameScheduler::SetIdle(bool idle)
+	{
+		_impl->idle = idle;
+	}
+
+	/**
+	* @details
+	* Times that aren't positive are ignored.
+	*/
+	void FrameScheduler::SetStepTime(double seconds)
+	{
+		if (seconds > 0.0) _impl->step_time = seconds;
+	}
+
+	/**
+	* @details
+	* Vertical sync would hold every swap up to the display, time the fast
+	* forward mode gives to the simulation instead. A target frame rate below
+	* the refresh rate is paced by EndFrame, since vertical sync would let the
+	* substeps sized for the longer target frame miss refreshes.
+	*/
+	int FrameScheduler::GetSwapInterval() const
+	{
+		return _impl->VerticalSync() ? 1 : 0;
+	}
+
+	/**
+	* @details
+	* An idle application blocks in glfwWaitEventsTimeout, so it costs next to
+	* no CPU until the user does something, and still draws a frame every
+	* IDLE_TIMEOUT. After a wait a few frames are polled, as ImGui can take
+	* more than one frame to show the response to an event.
+	*/
+	void FrameScheduler::BeginFrame()
+	{
+		PROFILE_SCOPE("Poll Events");
+
+		_impl->frame++;
+
+		if (_impl->idle && _impl->settle_frames == 0)
+		{
+			glfwWaitEventsTimeout(FrameSchedulerImpl::IDLE_TIMEOUT);
+			_impl->settle_frames = FrameSchedulerImpl::SETTLE_FRAMES;
+		}
+		else
+		{
+			glfwPollEvents();
+			if (_impl->settle_frames > 0) _impl->settle_frames--;
+		}
+
+		_impl->frame_start = FrameSchedulerImpl::Clock::now();
+		_impl->steps_end = _impl->frame_start;
+	}
+
+	/**
+	* @details
+	* Real time runs a fixed substep for every step_time of wall clock that
+	* passed, within SIMULATION_SHARE of the frame. A simulation that can't keep
+	* up drops the time it is more than MAX_LAG behind, so it slows down
+	* instead of spending ever longer frames catching up. Fast forward runs
+	* substeps until the measured render time is all that is left of the
+	* frame, and at least one so it always advances. After frames without
+	* substeps, like a pause, the simulation picks up from now.
+	*/
+	int FrameScheduler::RunSubsteps(const std::function<void()>& step)
+	{
+		PROFILE_SCOPE("Simulation Substeps");
+
+		using Clock = FrameSchedulerImpl::Clock;
+		using Seconds = FrameSchedulerImpl::Seconds;
+
+		Clock::time_point now = Clock::now();
+		if (_impl->last_step_frame + 1 != _impl->frame)
+		{
+			_impl->last_step = now;
+			_impl->lag = _impl->step_time;
+		}
+		_impl->last_step_frame = _impl->frame;
+
+		const double frame_time = _impl->FrameTime();
+		const double budget = _impl->fast_forward ?
+			frame_time - _impl->render_cost :
+			frame_time * FrameSchedulerImpl::SIMULATION_SHARE;
+		const Clock::time_point deadline =
+			_impl->frame_start + std::chrono::duration_cast<Clock::duration>(Seconds(budget));
+
+		_impl->lag = std::min(
+			_impl->lag + Seconds(now - _impl->last_step).count(),
+			FrameSchedulerImpl::MAX_LAG);
+		_impl->last_step = now;
+
+		int steps = 0;
+		while (true)
+		{
+			if (_impl->fast_forward)
+			{
+				if (steps > 0 && now + Seconds(_impl->step_cost) > deadline) break;
+			}
+			else
+			{
+				if (_impl->lag < _impl->step_time) break;
+				if (now + Seconds(_impl->step_cost) > deadline) break;
+				_impl->lag -= _impl->step_time;
+			}
+
+			const Clock::time_point start = now;
+			step();
+			now = Clock::now();
+			steps++;
+
+			_impl->step_cost += FrameSchedulerImpl::COST_SMOOTHING *
+				(Seconds(now - start).count() - _impl->step_cost);
+		}
+
+		//Fast forward doesn't owe the wall clock anything
+		if (_impl->fast_forward) _impl->lag = 0.0;
+
+		_impl->rate_steps += uint64_t(steps);
+		_impl->steps_end = now;
+		return steps;
+	}
+
+	/**
+	* @details
+	* The render time is measured before sleeping, so it holds the CPU side of
+	* the render and, with vertical sync, the wait for the display. Only
+	* frames without vertical sync sleep to the deadline, which caps the frame
+	* rate when nothing else does, like fast forward without a simulation. With
+	* vertical sync the swap already paces the frames. The real time factor is
+	* averaged over RATE_INTERVAL so the readout stays steady.
+	*/
+	void FrameScheduler::EndFrame()
+	{
+		using Clock = FrameSchedulerImpl::Clock;
+		using Seconds = FrameSchedulerImpl::Seconds;
+
+		const Clock::time_point now = Clock::now();
+		_impl->render_cost += FrameSchedulerImpl::COST_SMOOTHING *
+			(Seconds(now - _impl->steps_end).count() - _impl->render_cost);
+
+		const double elapsed = Seconds(now - _impl->rate_start).count();
+		if (elapsed >= FrameSchedulerImpl::RATE_INTERVAL)
+		{
+			_impl->steps_per_second = double(_impl->rate_steps) / elapsed;
+			_impl->real_time_factor = _impl->steps_per_second * _impl->step_time;
+			_impl->rate_steps = 0;
+			_impl->rate_start = now;
+		}
+
+		if (_impl->idle || GetSwapInterval() != 0) return;
+
+		PROFILE_SCOPE("Frame Pacing");
+		std::this_thread::sleep_until(
+			_impl->frame_start +
+			std::chrono::duration_cast<Clock::duration>(Seconds(_impl->FrameTime())));
+	}
+
+	/**
+	* @details
+	* Get the real time factor of the last interval.
+	*/
+	double FrameScheduler::GetRealTimeFactor() const
+	{
+		return _impl->real_time_factor;
+	}
+
+	/**
+	* @details
+	* Get the substeps per second of the last interval.
+	*/
+	double FrameScheduler::GetStepsPerSecond() const
+	{
+		return _impl->steps_per_second;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+/**
+* @file FrameScheduler.hpp
+* @brief
+* Class declaration for the frame scheduler of the application loop. Paces the
+* rendered frames to a target frame time and fills the time the render doesn't
+* need with simulation substeps. A fast forward mode runs the simulation
+* uncapped and renders at a fixed low rate, and an idle application waits for
+* events instead of spinning. Uses the PIMPL idiom to hide implementation
+* details.
+*/
+
+#pragma once
+
+#ifndef _FRAMESCHEDULER_
+#define _FRAMESCHEDULER_
+
+#include <functional>
+#include <memory>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Application namespace
+namespace App
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief FrameScheduler class
+	class FrameScheduler
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		FrameScheduler(const FrameScheduler& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		FrameScheduler& operator=(const FrameScheduler& other) = delete;
+		/// @brief Deleted move constructor.
+		FrameScheduler(const FrameScheduler&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		FrameScheduler& operator=(const FrameScheduler&& other) = delete;
+
+		/// @brief Render rate of the fast forward mode.
+		static constexpr double FAST_FORWARD_FRAME_RATE = 30.0;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		FrameScheduler();
+		/// @brief Destructor
+		~FrameScheduler();
+
+		//Member methods
+
+		/**
+		* @brief Set the rate frames are rendered at outside of fast forward.
+		* @param frame_rate The frames per second, at least 1.
+		*/
+		void SetTargetFrameRate(double frame_rate);
+
+		/**
+		* @brief
+		* Set the refresh rate of the display, which vertical sync paces the
+		* frames to. Target frame rates below it are paced by sleeping instead.
+		* @param refresh_rate The refreshes per second, ignored unless positive.
+		*/
+		void SetRefreshRate(double refresh_rate);
+
+		/**
+		* @brief
+		* Choose fast forward, which renders at FAST_FORWARD_FRAME_RATE without
+		* vertical sync and runs the simulation for the rest of every frame.
+		* @param fast_forward True for fast forward, false for real time.
+		*/
+		void SetFastForward(bool fast_forward);
+
+		/**
+		* @brief
+		* Mark the application idle, with nothing changing unless the user does
+		* something. Idle frames wait for events instead of polling them.
+		* @param idle True while idle, false otherwise.
+		*/
+		void SetIdle(bool idle);
+
+		/**
+		* @brief Set the simulated time a substep advances, for the real time factor.
+		* @param seconds The simulated seconds per substep, positive.
+		*/
+		void SetStepTime(double seconds);
+
+		/**
+		* @brief
+		* Get the swap interval the window should use, 1 for vertical sync and 0
+		* while fast forwarding so swaps don't block the simulation, or while the
+		* target frame rate is below the refresh rate so the frames are paced to
+		* the target instead.
+		* @return The swap interval.
+		*/
+		int GetSwapInterval() const;
+
+		/**
+		* @brief
+		* Start a frame: poll the events, or wait for one while idle, and note
+		* the frame start.
+		*/
+		void BeginFrame();
+
+		/**
+		* @brief
+		* Run simulation substeps for this frame. In real time the simulation
+		* keeps pace with the wall clock, in fast forward it runs until the
+		* frame's render must start. Either way no substep starts once it would
+		* push the render past the frame deadline.
+		* @param step Runs one simulation substep.
+		* @return The number of substeps run.
+		*/
+		int RunSubsteps(const std::function<void()>& step);
+
+		/**
+		* @brief
+		* End a frame after the buffers were swapped: measure the render and,
+		* when the swap interval is 0, sleep until the frame deadline.
+		*/
+		void EndFrame();
+
+		/**
+		* @brief Get the simulated time advanced per wall clock second, 1 is real time.
+		* @return The real time factor, averaged over the last update interval.
+		*/
+		double GetRealTimeFactor() const;
+
+		/**
+		* @brief Get the number of substeps run per wall clock second.
+		* @return The substeps per second, averaged over the last update interval.
+		*/
+		double GetStepsPerSecond() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of FrameSchedulerImpl struct.
+		struct FrameSchedulerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<FrameSchedulerImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
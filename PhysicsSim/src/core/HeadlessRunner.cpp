@@ -0,0 +1,413 @@
+/**
+* @file HeadlessRunner.cpp
+* @brief
+* Function definitions for the HeadlessRunner class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "HeadlessRunner.hpp"
+#include "SimulationConfig.hpp"
+
+#include "graphics/Scene.hpp"
+#include "graphics/SoftwareRasterizer.hpp"
+#include "io/Checkpoint.hpp"
+#include "io/OutputStage.hpp"
+#include "profiling/Profiler.hpp"
+#include "simulation/Simulation.hpp"
+#include "simulation/SimulationState.hpp"
+#include "utils/ImageWrite.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <tuple>
+
+/// @brief Application namespace
+namespace App
+{
+	/// @brief HeadlessRunner PIMPL implementation structure.
+	struct HeadlessRunner::HeadlessRunnerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		HeadlessRunnerImpl() = delete;
+		/// @brief Deleted copy constructor.
+		HeadlessRunnerImpl(const HeadlessRunnerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		HeadlessRunnerImpl& operator=(const HeadlessRunnerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		HeadlessRunnerImpl(const HeadlessRunnerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		HeadlessRunnerImpl& operator=(const HeadlessRunnerImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the HeadlessRunnerImpl class.
+		* @param config The scenario to run.
+		*/
+		explicit HeadlessRunnerImpl(const SimulationConfig& config);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Waits for the image being written.
+		~HeadlessRunnerImpl();
+
+		//Member methods
+
+		/// @brief Log the scenario and warn about settings the simulator doesn't support yet.
+		void LogScenario() const;
+
+		/**
+		* @brief Open the output stage if the scenario records a trajectory.
+		* @return True if the output stage opened or isn't needed, false otherwise.
+		*/
+		bool OpenOutput();
+
+		/**
+		* @brief Write a checkpoint of the current step, waiting for the previous one.
+		* @param step The current step.
+		*/
+		void Checkpoint(uint64_t step);
+
+		/**
+		* @brief Create the renderer of the images the scenario asks for.
+		* @return True if the renderer was created, false otherwise.
+		*/
+		bool OpenRenderer();
+
+		/**
+		* @brief
+		* Draw the current step and write it as a PNG on a background thread,
+		* waiting for the previous image.
+		* @param step The current step.
+		*/
+		void WriteImage(uint64_t step);
+
+		//Member variables
+
+		/// @brief The scenario to run.
+		SimulationConfig config;
+		/// @brief The simulator.
+		std::unique_ptr<Simulation::ThermodynamicParticleSimulator> simulation;
+		/// @brief Output stage, set if the scenario records a trajectory.
+		std::unique_ptr<IO::OutputStage> output;
+		/// @brief Reused buffer for the positions handed to the output stage.
+		std::vector<float> positions;
+		/// @brief Writes checkpoints on a background thread.
+		IO::Checkpointer checkpointer;
+		/// @brief Software rasterizer, set if the scenario writes images with it.
+		std::unique_ptr<Graphics::SoftwareRasterizer> rasterizer;
+		/// @brief Offscreen scene, set if the scenario writes images with OpenGL.
+		std::unique_ptr<Graphics::Scene> scene;
+		/// @brief Reused snapshot of the particles drawn into the images.
+		Simulation::SimulationState image_state;
+		/// @brief Copy of the image being written.
+		std::vector<unsigned char> image_pixels;
+		/// @brief Thread writing the last image.
+		std::thread image_writer;
+		/// @brief Number of images written.
+		std::atomic<uint64_t> images_written = 0;
+		/// @brief Flag set when an image failed to write.
+		std::atomic<bool> image_failed = false;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the HeadlessRunnerImpl class. Copies the scenario
+	* and clamps its variables like the GUI would.
+	*/
+	HeadlessRunner::HeadlessRunnerImpl::HeadlessRunnerImpl(const SimulationConfig& config) :
+		config(config)
+	{
+		ClampSimulationVariables(this->config.variables);
+	}
+
+	/**
+	* @details
+	* Destructor for the HeadlessRunnerImpl class. Joins the image writer so a
+	* run that stopped early doesn't leave it running.
+	*/
+	HeadlessRunner::HeadlessRunnerImpl::~HeadlessRunnerImpl()
+	{
+		if (image_writer.joinable()) image_writer.join();
+	}
+
+	/**
+	* @details
+	* Log the scenario so the run's log records what it ran. The potential,
+	* integrator and thermostat are carried in the configuration for when the
+	* simulator supports them; until then they only warn.
+	*/
+	void HeadlessRunner::HeadlessRunnerImpl::LogScenario() const
+	{
+		static const char* ensembles[] = {
+			"microcanonical",
+			"canonical",
+			"grand canonical" };
+
+		const ThermodynamicSimulationVariables& vars = config.variables;
+		spdlog::info(
+			"Headless run: {} ensemble, {} particles, {}% x {}% box, radius {}, {} steps",
+			ensembles[vars.ensemble],
+			vars.num_particles,
+			vars.box_width_perc,
+			vars.box_height_perc,
+			vars.radius,
+			config.steps);
+
+		if (config.potential != "none")
+			spdlog::warn("Potential '{}' isn't supported yet and is ignored", config.potential);
+		if (config.integrator != "none")
+			spdlog::warn("Integrator '{}' isn't supported yet and is ignored", config.integrator);
+		if (config.thermostat != "none")
+			spdlog::warn("Thermostat '{}' isn't supported yet and is ignored", config.thermostat);
+		if (config.species.size() > 1)
+			spdlog::warn("{} species configured, all particles use the first", config.species.size());
+
+		const unsigned int hardware_threads = std::thread::hardware_concurrency();
+		spdlog::info(
+			"Threads: {} requested, {} available, the simulator steps on one",
+			config.threads,
+			hardware_threads);
+	}
+
+	/**
+	* @details
+	* Open the output stage with the same header the GUI records with. A batch
+	* run must not lose frames, so the stage blocks instead of dropping when
+	* the disk falls behind.
+	*/
+	bool HeadlessRunner::HeadlessRunnerImpl::OpenOutput()
+	{
+		if (config.output_interval == 0 || config.trajectory_path.empty()) return true;
+
+		const ThermodynamicSimulationVariables& vars = config.variables;
+		IO::OutputSettings settings;
+		settings.trajectory_path = config.trajectory_path;
+		settings.policy = IO::BackpressurePolicy::Block;
+		settings.header.num_particles = uint32_t(positions.size() / 3);
+		settings.header.dimensions = 2;
+		settings.header.box_min[0] = -float(vars.box_width_perc) / 100.0f;
+		settings.header.box_max[0] = float(vars.box_width_perc) / 100.0f;
+		settings.header.box_min[1] = -float(vars.box_height_perc) / 100.0f;
+		settings.header.box_max[1] = float(vars.box_height_perc) / 100.0f;
+		settings.header.species.assign(settings.header.num_particles, 0);
+
+		output = std::make_unique<IO::OutputStage>(settings);
+		return !output->GetErrorStatus();
+	}
+
+	/**
+	* @details
+	* Snapshot the simulation into the checkpointer's spare buffer and hand it
+	* to the writer thread. If the previous checkpoint is still being written,
+	* wait for it rather than skip a checkpoint of a batch run.
+	*/
+	void HeadlessRunner::HeadlessRunnerImpl::Checkpoint(uint64_t step)
+	{
+		checkpointer.Wait();
+
+		Simulation::SimulationState* state = checkpointer.BeginSnapshot();
+		simulation->SaveState(*state);
+		state->step = step;
+		checkpointer.CommitSnapshot(config.checkpoint_path, config.incremental_checkpoints);
+	}
+
+	/**
+	* @details
+	* The software renderer draws on the CPU with config.threads threads. The
+	* OpenGL renderer creates an offscreen scene and sets up the same render
+	* items and shaders the interactive app draws with, so batch images match
+	* the window.
+	*/
+	bool HeadlessRunner::HeadlessRunnerImpl::OpenRenderer()
+	{
+		if (config.image_renderer != "opengl")
+		{
+			rasterizer = std::make_unique<Graphics::SoftwareRasterizer>(
+				config.image_width,
+				config.image_height,
+				unsigned(config.threads));
+			return true;
+		}
+
+		static const float bg_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		scene = std::make_unique<Graphics::Scene>(
+			"PhysicsSim",
+			config.image_width,
+			config.image_height,
+			bg_color,
+			true);
+		if (scene->GetErrorStatus())
+		{
+			spdlog::error("Failed to create the offscreen OpenGL scene");
+			return false;
+		}
+
+		std::vector<float> instance_data = simulation->GetParticleInstanceData();
+		scene->InitializeSimulationRenderItems(
+			Graphics::SimulationTypes::THERMODYNAMICS,
+			instance_data,
+			config.variables.radius);
+		return true;
+	}
+
+	/**
+	* @details
+	* Draw the particles with the scenario's renderer and hand a copy of the
+	* image to a writer thread, so PNG compression overlaps the next steps.
+	* OpenGL reads rows bottom up, the software rasterizer writes them top
+	* down. Only one image is written at a time; the next one waits for it,
+	* which keeps a slow disk from piling up images in memory.
+	*/
+	void HeadlessRunner::HeadlessRunnerImpl::WriteImage(uint64_t step)
+	{
+		PROFILE_SCOPE("Headless Image");
+
+		if (image_writer.joinable()) image_writer.join();
+
+		int width = config.image_width;
+		int height = config.image_height;
+		bool bottom_up = false;
+		if (scene != nullptr)
+		{
+			simulation->GetParticlePositions(positions);
+			scene->UpdateSimulationPositions(positions);
+			scene->RenderTexture();
+			scene->RenderSimulationItems();
+			scene->ReadTexturePixels(image_pixels);
+			std::tie(width, height) = scene->GetTextureSize();
+			bottom_up = true;
+		}
+		else
+		{
+			simulation->SaveState(image_state);
+			rasterizer->Render(
+				image_state.positions.data(),
+				image_state.colors.data(),
+				image_state.scales.data(),
+				size_t(image_state.num_particles),
+				image_state.radius);
+			image_pixels = rasterizer->GetPixels();
+			width = rasterizer->GetWidth();
+			height = rasterizer->GetHeight();
+		}
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "_%06llu.png", (unsigned long long)step);
+		image_writer = std::thread([this, path = config.image_path + name, width, height, bottom_up] {
+			PROFILE_THREAD("Image Writer");
+			if (Utils::WritePng(path, width, height, image_pixels.data(), bottom_up))
+				images_written++;
+			else image_failed = true;
+		});
+	}
+
+	/**
+	* @details
+	* Custom constructor for the HeadlessRunner class. Passes the scenario to the
+	* PIMPL implementation.
+	*/
+	HeadlessRunner::HeadlessRunner(const SimulationConfig& config) :
+		_impl(std::make_unique<HeadlessRunnerImpl>(config))
+	{}
+
+	/**
+	* @details
+	* Default destructor for the HeadlessRunner class.
+	*/
+	HeadlessRunner::~HeadlessRunner() = default;
+
+	/**
+	* @details
+	* Set up the simulator from the scenario, then run its steps. Each step
+	* publishes a trajectory frame and writes a checkpoint at the scenario's
+	* cadence, the same way the GUI does once per frame, and a final checkpoint
+	* is written after the last step. Images are drawn on the CPU or in an
+	* offscreen OpenGL context, so a run needs no display. The simulator has no integrator yet, so a
+	* step doesn't move the particles; the loop is where stepping will go.
+	*/
+	bool HeadlessRunner::Run()
+	{
+		HeadlessRunnerImpl& impl = *_impl;
+		const ThermodynamicSimulationVariables& vars = impl.config.variables;
+
+		impl.LogScenario();
+
+		{
+			PROFILE_SCOPE("Simulation Init");
+			impl.simulation = std::make_unique<Simulation::ThermodynamicParticleSimulator>(
+				vars.num_particles,
+				vars.box_width_perc,
+				vars.box_height_perc,
+				vars.energy_value,
+				vars.temperature,
+				vars.chem_potential,
+				vars.radius,
+				vars.seed);
+		}
+
+		impl.simulation->GetParticlePositions(impl.positions);
+		if (!impl.OpenOutput()) return false;
+
+		if (impl.config.image_interval != 0 && !impl.OpenRenderer()) return false;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint64_t step = 0; step < impl.config.steps; step++)
+		{
+			PROFILE_SCOPE("Headless Step");
+
+			if (impl.output != nullptr && step % impl.config.output_interval == 0)
+			{
+				impl.simulation->GetParticlePositions(impl.positions);
+				impl.output->Publish(step, impl.positions);
+			}
+
+			if (impl.config.checkpoint_interval != 0 &&
+				step != 0 &&
+				step % impl.config.checkpoint_interval == 0)
+				impl.Checkpoint(step);
+
+			if (impl.config.image_interval != 0 && step % impl.config.image_interval == 0)
+				impl.WriteImage(step);
+
+			PROFILE_END_FRAME();
+		}
+
+		if (impl.config.checkpoint_interval != 0) impl.Checkpoint(impl.config.steps);
+		impl.checkpointer.Wait();
+		if (impl.image_writer.joinable()) impl.image_writer.join();
+
+		bool success = !impl.checkpointer.GetErrorStatus() && !impl.image_failed;
+		if (impl.output != nullptr)
+		{
+			impl.output->Close();
+			success = success && !impl.output->GetErrorStatus();
+			spdlog::info(
+				"Trajectory: {} frames written to {}",
+				impl.output->GetWrittenFrames(),
+				impl.config.trajectory_path);
+		}
+		if (impl.config.image_interval != 0)
+		{
+			spdlog::info(
+				"Images: {} written to {}_*.png",
+				impl.images_written.load(),
+				impl.config.image_path);
+		}
+
+		const double seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+		spdlog::info(
+			"Headless run finished: {} steps in {:.3f} s ({:.1f} steps/s)",
+			impl.config.steps,
+			seconds,
+			seconds > 0.0 ? double(impl.config.steps) / seconds : 0.0);
+		return success;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+/**
+* @file HeadlessRunner.hpp
+* @brief
+* Class declaration for the headless runner. Runs a scenario for a fixed
+* number of steps without a window, writing the trajectory and checkpoints at
+* the scenario's cadence, for reproducible batch and performance runs. Uses
+* the PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _HEADLESSRUNNER_
+#define _HEADLESSRUNNER_
+
+#include <memory>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Application namespace
+namespace App
+{
+	//External forward declarations
+
+	/// @brief Forward declaration of SimulationConfig struct.
+	struct SimulationConfig;
+
+	//Internal declarations
+
+	/// @brief HeadlessRunner class
+	class HeadlessRunner
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		HeadlessRunner() = delete;
+		/// @brief Deleted copy constructor.
+		HeadlessRunner(const HeadlessRunner& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		HeadlessRunner& operator=(const HeadlessRunner& other) = delete;
+		/// @brief Deleted move constructor.
+		HeadlessRunner(const HeadlessRunner&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		HeadlessRunner& operator=(const HeadlessRunner&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the HeadlessRunner class.
+		* @param config The scenario to run.
+		*/
+		explicit HeadlessRunner(const SimulationConfig& config);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~HeadlessRunner();
+
+		//Member methods
+
+		/**
+		* @brief Run the scenario to completion.
+		* @return True if the run and all of its output succeeded, false otherwise.
+		*/
+		bool Run();
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of HeadlessRunnerImpl struct.
+		struct HeadlessRunnerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<HeadlessRunnerImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,38 +1,26 @@
 #include "ImGuiManager.hpp"
+#include "SimulationConfig.hpp"
 
 #include "utils/GlfwIncludes.hpp"
+#include "graphics/Scene.hpp"
 #include "graphics/Texture.hpp"
+#include "profiling/GpuProfiler.hpp"
+#include "profiling/PerfCounters.hpp"
+#include "profiling/Profiler.hpp"
+#include "utils/Logging.hpp"
 
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
 namespace App
 {
-	//Structures to hold the simulators' data.
-
-	/**
-	* @brief Structure to hold the thermodynamic simulation variables.
-	* @param num_particles The number of particles to simulate.
-	* @param box_width_perc The width of the simulation box as a percentage of the window.
-	* @param box_height_perc The height of the simulation box as a percentage of the window.
-	* @param energy_value The energy value for the simulation.
-	* @param temperature The temperature for the simulation.
-	* @param chem_potential The chemical potential for the simulation.
-	* @param radius The radius of the particles in the simulation.
-	*/
-	struct ThermodynamicSimulationVariables
-	{
-		int num_particles = 0;
-		int box_width_perc = 0;
-		int box_height_perc = 0;
-		float energy_value = 0.0f;
-		float temperature = 0.0f;
-		float chem_potential = 0.0f;
-		float radius = 0.0f;
-	};
-
 	/// @brief ImGuiManager PIMPL implementation structure.
 	struct ImGuiManager::ImGuiManagerImpl
 	{
@@ -80,6 +68,13 @@ namespace App
 		void CreateSelectionWindow();
 		/**
 		* @brief
+		* Pan and zoom the camera with the mouse over the render window image.
+		* @param image_min The upper left corner of the image on screen.
+		* @param size The size of the image on screen.
+		*/
+		void UpdateCamera(const ImVec2& image_min, const ImVec2& size);
+		/**
+		* @brief
 		* Create the render window for the simulation.
 		* @param texture The texture to render in the window.
 		* @param aspect_ratio The aspect ratio of the window.
@@ -95,6 +90,17 @@ namespace App
 		void CreateDebugWindow();
 		/// @brief Create the dockspace for the ImGui windows.
 		void CreateDockspace();
+		/**
+		* @brief
+		* Draw a node of the profiler timing tree and its children as table rows.
+		* @param nodes The nodes of the timing tree.
+		* @param index The index of the node to draw.
+		* @param root_ms The time of the node's root, used for the percentage.
+		*/
+		void DrawProfileNode(
+			const std::vector<Profiling::ProfileNode>& nodes,
+			int index,
+			float root_ms);
 
 		//Member variables
 
@@ -108,6 +114,12 @@ namespace App
 		ImVec2 render_size;
 		/// @brief Application wide ImGui window flags.
 		ImGuiWindowFlags window_flags;
+		/// @brief Log messages shown in the debug window, oldest first.
+		std::vector<Utils::LogMessage> log_messages;
+		/// @brief Position of the debug window in the log ring buffer.
+		uint64_t log_cursor = 0;
+		/// @brief Maximum number of log messages kept for the debug window.
+		static constexpr size_t MAX_LOG_MESSAGES = 512;
 
 		//Simulation variables
 
@@ -115,6 +127,60 @@ namespace App
 		ThermodynamicSimulationVariables simulation_variables;
 		/// @brief The current state of the simulation.
 		std::string current_state;
+		/// @brief Flag set while the user wants the simulation recorded.
+		bool record_output = false;
+		/// @brief Flag to drop recorded frames when the disk falls behind.
+		bool drop_frames_when_behind = true;
+		/// @brief Path of the trajectory recordings are written to.
+		char output_path[256] = "trajectory.pstraj";
+		/// @brief Path of the trajectory to replay.
+		char replay_path[256] = "trajectory.pstraj";
+		/// @brief Number of frames of the open replay, 0 if none is open.
+		uint64_t replay_frame_count = 0;
+		/// @brief Replay frame selected by the user.
+		int replay_frame = 0;
+		/// @brief Flag to advance the replay by one frame every frame.
+		bool replay_playing = false;
+		/// @brief Index of the simulation type selected in the combo box.
+		int simulation_type = 0;
+		/// @brief Path of the checkpoint to save or load.
+		char checkpoint_path[256] = "checkpoint.pschk";
+		/// @brief Flag to write only the blocks changed since the last checkpoint.
+		bool incremental_checkpoints = false;
+		/// @brief Flag set while the user wants the render window captured.
+		bool capture_frames = false;
+		/// @brief Path of the capture output without its extension.
+		char capture_path[256] = "capture";
+		/// @brief Index of the capture format, 0 for PNG and 1 for Y4M.
+		int capture_format = 0;
+		/// @brief Index of the property the particles are colored by.
+		int color_by = 0;
+		/// @brief Index of the colormap of the scalar properties.
+		int color_map = 0;
+		/// @brief Flag set when the user wants the compact quantized instances.
+		bool compact_instances = false;
+		/// @brief Flag set when the user wants the particles to leave trails.
+		bool trails = false;
+		/// @brief Fraction of the trails kept every frame.
+		float trail_persistence = 0.9f;
+		/// @brief Flag set while the user paused the simulation.
+		bool paused = false;
+		/// @brief Flag set when the user wants the simulation uncapped and the render at a low rate.
+		bool fast_forward = false;
+		/// @brief Frame rate the user wants outside of fast forward.
+		int target_frame_rate = 60;
+		/// @brief Simulated time advanced per wall clock second, shown in the stats window.
+		double real_time_factor = 0.0;
+		/// @brief Simulation substeps per wall clock second, shown in the stats window.
+		double steps_per_second = 0.0;
+		/// @brief Camera of the render window.
+		Graphics::Camera camera;
+		/// @brief Smallest camera zoom, half the simulation box across the window.
+		static constexpr float MIN_ZOOM = 0.5f;
+		/// @brief Largest camera zoom.
+		static constexpr float MAX_ZOOM = 1000.0f;
+		/// @brief Zoom factor of one mouse wheel step.
+		static constexpr float ZOOM_STEP = 1.1f;
 
 		//Simulation methods
 
@@ -229,7 +295,7 @@ namespace App
 			"Thermodynamics",
 			"Simulation 2",
 			"Simulation 3" };
-		static int item_current = 0;
+		int& item_current = simulation_type;
 		if (ImGui::BeginCombo("##Simulation Type", items[item_current]))
 		{
 			for (int i = 0; i < IM_ARRAYSIZE(items); i++)
@@ -262,7 +328,7 @@ namespace App
 				"Microcanonical Ensemble",
 				"Canonical Ensemble",
 				"Grand Canonical Ensemble" };
-				static int thermo_item_current = 0;
+				int& thermo_item_current = simulation_variables.ensemble;
 				std::string description = "";
 				if (ImGui::BeginCombo("##Subsimulation Type",
 					thermodynamics[thermo_item_current]))
@@ -319,31 +385,26 @@ namespace App
 				* Text input for the temperature. Real numbers >= 0
 				*/
 				int flags = ImGuiComboFlags_WidthFitPreview;
-				const int min_particles = 1;
-				const int min_box_size = 10;
-				const int max_box_size = 100;
-				const float min_radius = 0.005f;
-				const float max_radius = 0.10f;
-				const float min_energy = 0.0f;
-				const float min_temp = 0.0f;
-				const float min_chem_pot = 0.0f;
 
 				ImGui::InputInt("# Particles", &simulation_variables.num_particles);
 				ImGui::SliderInt(
 					"% Box Height",
 					&simulation_variables.box_height_perc,
-					min_box_size,
-					max_box_size);
+					MIN_BOX_SIZE,
+					MAX_BOX_SIZE);
 				ImGui::SliderInt(
 					"% Box Width",
 					&simulation_variables.box_width_perc,
-					min_box_size,
-					max_box_size);
+					MIN_BOX_SIZE,
+					MAX_BOX_SIZE);
 				ImGui::SliderFloat(
 					"Radius",
 					&simulation_variables.radius,
-					min_radius,
-					max_radius);
+					MIN_RADIUS,
+					MAX_RADIUS);
+				ImGui::InputScalar("Seed", ImGuiDataType_U64, &simulation_variables.seed);
+				ImGui::SameLine();
+				HelpMarker("0 draws a new seed for every setup.");
 
 				switch (thermo_item_current)
 				{
@@ -384,20 +445,7 @@ namespace App
 				}
 
 				//Ensure that the values are within the correct range
-				if (simulation_variables.num_particles < min_particles)
-					simulation_variables.num_particles = min_particles;
-				if (simulation_variables.box_height_perc < min_box_size)
-					simulation_variables.box_height_perc = min_box_size;
-				if (simulation_variables.box_width_perc < min_box_size)
-					simulation_variables.box_width_perc = min_box_size;
-				if (simulation_variables.radius < min_radius)
-					simulation_variables.radius = min_radius;
-				if (simulation_variables.radius > max_radius)
-					simulation_variables.radius = max_radius;
-				if (simulation_variables.energy_value < min_energy)
-					simulation_variables.energy_value = min_energy;
-				if (simulation_variables.temperature < min_chem_pot)
-					simulation_variables.temperature = min_chem_pot;
+				ClampSimulationVariables(simulation_variables);
 
 				break;
 			};
@@ -417,19 +465,91 @@ namespace App
 			{
 				current_state = "StartThermoSim";
 			}
+
+			//Recording runs on a writer thread, see IO::OutputStage
+			ImGui::Separator();
+			ImGui::InputText("Output", output_path, sizeof(output_path));
+			ImGui::Checkbox("Record Trajectory", &record_output);
+			ImGui::Checkbox("Drop Frames When Behind", &drop_frames_when_behind);
 		}
 		else
 		{
 			ImGui::Text("Select a simulation type to begin.");
 		}
 
+		//Replay a recorded trajectory without a simulator, see IO::TrajectoryReader
+		ImGui::Separator();
+		ImGui::InputText("Trajectory", replay_path, sizeof(replay_path));
+		if (ImGui::Button("Open Replay"))
+		{
+			current_state = "OpenReplay";
+		}
+		if (replay_frame_count > 0)
+		{
+			ImGui::SameLine();
+			if (ImGui::Button("Close Replay"))
+			{
+				current_state = "CloseReplay";
+			}
+
+			ImGui::Checkbox("Play", &replay_playing);
+			if (replay_playing)
+				replay_frame = int((uint64_t(replay_frame) + 1) % replay_frame_count);
+			ImGui::SliderInt("Frame", &replay_frame, 0, int(replay_frame_count) - 1);
+		}
+
+		//Checkpoints are written on a background thread, see IO::Checkpointer
+		ImGui::Separator();
+		ImGui::InputText("Checkpoint", checkpoint_path, sizeof(checkpoint_path));
+		if (ImGui::Button("Save Checkpoint"))
+		{
+			current_state = "SaveCheckpoint";
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Load Checkpoint"))
+		{
+			current_state = "LoadCheckpoint";
+		}
+		ImGui::Checkbox("Incremental Checkpoints", &incremental_checkpoints);
+
+		//Frames are read back asynchronously and encoded on worker threads, see Graphics::FrameCapture
+		ImGui::Separator();
+		ImGui::InputText("Capture", capture_path, sizeof(capture_path));
+		ImGui::Combo("Capture Format", &capture_format, "PNG Sequence\0Y4M Video\0");
+		ImGui::Checkbox("Capture Frames", &capture_frames);
+		ImGui::SameLine();
+		HelpMarker("Frames the encoders can't keep up with are dropped from the capture, not from the window.");
+
+		//Colors are mapped on the GPU, changing them doesn't touch the simulation
+		ImGui::Separator();
+		ImGui::Combo("Color By", &color_by, "Particle Color\0Index\0Position X\0Position Y\0Distance\0");
+		ImGui::Combo("Colormap", &color_map, "Viridis\0Magma\0Cool Warm\0Grayscale\0");
+		ImGui::Checkbox("Compact Instances", &compact_instances);
+		ImGui::SameLine();
+		HelpMarker("Uploads 8 instead of 48 bytes per particle, positions are quantized to 16 bits and scalars to 8 bits.");
+		ImGui::Checkbox("Trails", &trails);
+		ImGui::SliderFloat("Trail Persistence", &trail_persistence, 0.5f, 0.99f);
+		ImGui::SameLine();
+		HelpMarker("Fraction of the trails kept every frame. Longer trails cost the same, one extra pass per frame.");
+
+		//The frames are paced by App::FrameScheduler
+		ImGui::Separator();
+		ImGui::Checkbox("Pause", &paused);
+		ImGui::SameLine();
+		ImGui::Checkbox("Fast Forward", &fast_forward);
+		ImGui::SameLine();
+		HelpMarker("Runs the simulation as fast as it goes and renders at 30 FPS.");
+		ImGui::SliderInt("Target FPS", &target_frame_rate, 10, 240);
+
 		ImGui::End();
 	}
 
 	/**
 	* Creates the render window for the simulation. Takes the provided texture and
 	* aspect ratio and scales the texture to fit in the render window. Then
-	* converts the image to an ImGui image and displays it in the window.
+	* converts the image to an ImGui image and displays it in the window. The
+	* texture is asked for the window's size every frame and decides itself
+	* when to reallocate, only the part of it rendered into is shown.
 	*/
 	void ImGuiManager::ImGuiManagerImpl::CreateRenderWindow(
 		std::shared_ptr<Graphics::Texture> texture,
@@ -437,19 +557,28 @@ namespace App
 	{
 		ImGui::Begin(render.c_str(), nullptr, window_flags);
 
-		//Check if the size of the render window has changed
 		ImVec2 size = ImGui::GetContentRegionAvail();
-		if (size.x != render_size.x || size.y != render_size.y)
-		{
-			//If it has, update the texture framebuffer size
-			render_size = size;
-			texture->SetupFramebufferAndTexture(
-				static_cast<int>(size.x),
-				static_cast<int>(size.y));
-		}
+		render_size = size;
+		texture->Resize(static_cast<int>(size.x), static_cast<int>(size.y));
 
 		if (glIsTexture(texture->GetTextureId()))
-			ImGui::Image((void*)(intptr_t)texture->GetTextureId(), size);
+		{
+			auto [u, v] = texture->GetUvExtent();
+			ImGui::Image(
+				(void*)(intptr_t)texture->GetTextureId(),
+				size,
+				ImVec2(0.0f, 0.0f),
+				ImVec2(u, v));
+
+			//Catch the mouse over the image so dragging pans instead of moving the window
+			if (size.x > 0.0f && size.y > 0.0f)
+			{
+				ImVec2 image_min = ImGui::GetItemRectMin();
+				ImGui::SetCursorScreenPos(image_min);
+				ImGui::InvisibleButton("##RenderCamera", size);
+				UpdateCamera(image_min, size);
+			}
+		}
 		//else DebugMessage("Invalid Texture ID.", __func__);
 
 		ImGui::End();
@@ -457,11 +586,95 @@ namespace App
 
 	/**
 	* @details
-	* Creates the statistics window. WORK IN PROGRESS
+	* Called after the invisible button over the image, which is the current
+	* item. Dragging with the left mouse button moves the view with the cursor, the
+	* mouse wheel zooms about the point under the cursor and a double click
+	* shows the whole simulation box again. The image is shown upside down
+	* from OpenGL's convention, so the simulation y axis points down the
+	* screen, and it stretches the view over the window in both directions.
+	*/
+	void ImGuiManager::ImGuiManagerImpl::UpdateCamera(
+		const ImVec2& image_min,
+		const ImVec2& size)
+	{
+		ImGuiIO& io = ImGui::GetIO();
+
+		if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+		{
+			camera.center_x -= 2.0f * io.MouseDelta.x / (size.x * camera.zoom);
+			camera.center_y -= 2.0f * io.MouseDelta.y / (size.y * camera.zoom);
+		}
+
+		if (!ImGui::IsItemHovered()) return;
+
+		if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+		{
+			camera = Graphics::Camera();
+			return;
+		}
+
+		if (io.MouseWheel != 0.0f)
+		{
+			//Offset of the cursor from the center in view units, it stays on the same point
+			const float dx = 2.0f * (io.MousePos.x - image_min.x) / size.x - 1.0f;
+			const float dy = 2.0f * (io.MousePos.y - image_min.y) / size.y - 1.0f;
+			const float x = camera.center_x + dx / camera.zoom;
+			const float y = camera.center_y + dy / camera.zoom;
+
+			camera.zoom = std::clamp(
+				camera.zoom * std::pow(ZOOM_STEP, io.MouseWheel),
+				MIN_ZOOM,
+				MAX_ZOOM);
+			camera.center_x = x - dx / camera.zoom;
+			camera.center_y = y - dy / camera.zoom;
+		}
+	}
+
+	/**
+	* @details
+	* Creates the statistics window. Shows the frame rate along with the average,
+	* minimum, and maximum frame times over the profiler's frame history, and
+	* the simulation's real time factor.
 	*/
 	void ImGuiManager::ImGuiManagerImpl::CreateStatsWindow()
 	{
 		ImGui::Begin(stats.c_str(), nullptr, window_flags);
+
+		ImGuiIO& io = ImGui::GetIO();
+		ImGui::Text(
+			"Application average %.3f ms/frame (%.1f FPS)",
+			1000.0f / io.Framerate,
+			io.Framerate);
+
+		std::vector<float> frame_times = Profiling::Profiler::Get().GetFrameTimes();
+		float sum = 0.0f;
+		float min_ms = 0.0f;
+		float max_ms = 0.0f;
+		int count = 0;
+		for (float ms : frame_times)
+		{
+			//Skip the empty history slots after startup
+			if (ms <= 0.0f) continue;
+			min_ms = count == 0 ? ms : std::min(min_ms, ms);
+			max_ms = std::max(max_ms, ms);
+			sum += ms;
+			count++;
+		}
+
+		if (count > 0)
+		{
+			ImGui::Text(
+				"Frame time avg %.3f ms, min %.3f ms, max %.3f ms",
+				sum / count,
+				min_ms,
+				max_ms);
+		}
+
+		ImGui::Text(
+			"Real time factor %.2fx (%.0f steps/s)",
+			real_time_factor,
+			steps_per_second);
+
 		ImGui::End();
 	}
 
@@ -477,21 +690,243 @@ namespace App
 
 	/**
 	* @details
-	* Creates the debug window. WORK IN PROGRESS
+	* Creates the debug window. Shows the profiler's trace capture controls and
+	* frame time graph followed by the hierarchical timing tree of the last
+	* frame. The tree lists the moving average, the last frame's time, the number
+	* of calls, and the share of the thread's frame time for every instrumented
+	* scope. The hardware counter section lists IPC and per particle rates for
+	* the counted scopes. The log section shows the most recent log messages
+	* read from the logging ring buffer, colored by level.
 	*/
 	void ImGuiManager::ImGuiManagerImpl::CreateDebugWindow()
 	{
 		ImGui::Begin(debug.c_str(), nullptr, window_flags);
 
-		/*auto size = DEBUG_MSG.size();
-		for (auto s : DEBUG_MSG)
+		Profiling::Profiler& profiler = Profiling::Profiler::Get();
+
+		if (ImGui::CollapsingHeader("Profiler", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			bool paused = profiler.IsPaused();
+			if (ImGui::Checkbox("Pause", &paused)) profiler.SetPaused(paused);
+
+			/*
+			* Capture the events of every thread for a number of frames and write
+			* them as Chrome trace JSON. Load the file in chrome://tracing or
+			* https://ui.perfetto.dev to see the per-thread timelines.
+			*/
+			static int capture_frames = 120;
+			static char capture_path[256] = "profile_trace.json";
+			if (profiler.IsCapturing())
+			{
+				ImGui::Text(
+					"Capturing frame %d / %d",
+					profiler.GetCapturedFrames(),
+					capture_frames);
+			}
+			else
+			{
+				ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6.0f);
+				ImGui::InputInt("Frames", &capture_frames);
+				if (capture_frames < 1) capture_frames = 1;
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(ImGui::GetFontSize() * 12.0f);
+				ImGui::InputText("##Trace Path", capture_path, sizeof(capture_path));
+				ImGui::SameLine();
+				if (ImGui::Button("Capture Trace"))
+					profiler.StartCapture(capture_frames, capture_path);
+			}
+
+			//Scale the graph to at least a 60 Hz frame so it doesn't jump around
+			std::vector<float> frame_times = profiler.GetFrameTimes();
+			const float max_ms =
+				*std::max_element(frame_times.begin(), frame_times.end());
+			char overlay[32];
+			snprintf(overlay, sizeof(overlay), "%.2f ms", profiler.GetLastFrameTime());
+			ImGui::PlotLines(
+				"##Frame Times",
+				frame_times.data(),
+				int(frame_times.size()),
+				0,
+				overlay,
+				0.0f,
+				std::max(max_ms * 1.1f, 1000.0f / 60.0f),
+				ImVec2(-1.0f, 80.0f));
+
+			const std::vector<Profiling::ProfileNode>& nodes = profiler.GetFrameTree();
+			ImGuiTableFlags table_flags =
+				ImGuiTableFlags_BordersV |
+				ImGuiTableFlags_RowBg |
+				ImGuiTableFlags_Resizable;
+			if (!nodes.empty() && ImGui::BeginTable("##Profile Tree", 6, table_flags))
+			{
+				ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Avg (ms)", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableSetupColumn("Last (ms)", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableSetupColumn("GPU (ms)", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableHeadersRow();
+
+				//The roots are the threads, linked through their siblings
+				for (int root = 0; root >= 0; root = nodes[root].next_sibling)
+					DrawProfileNode(nodes, root, nodes[root].average_ms);
+
+				ImGui::EndTable();
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Hardware Counters"))
+		{
+			if (!Profiling::CountersAvailable())
+			{
+				ImGui::TextDisabled("Hardware performance counters are not available.");
+			}
+			else
+			{
+				bool enabled = Profiling::CountersEnabled();
+				if (ImGui::Checkbox("Enable", &enabled))
+					Profiling::SetCountersEnabled(enabled);
+				ImGui::SameLine();
+				if (ImGui::Button("Reset")) Profiling::ResetCounterReports();
+				ImGui::SameLine();
+				if (ImGui::Button("Save JSON"))
+					Profiling::WriteCounterReport("counter_report.json");
+
+				//Rates per item (particle) make runs with different N comparable
+				std::vector<Profiling::CounterReport> reports =
+					Profiling::GetCounterReports();
+				ImGuiTableFlags table_flags =
+					ImGuiTableFlags_BordersV |
+					ImGuiTableFlags_RowBg |
+					ImGuiTableFlags_Resizable;
+				if (!reports.empty() &&
+					ImGui::BeginTable("##Counter Table", 7, table_flags))
+				{
+					ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+					ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableSetupColumn("IPC", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableSetupColumn("Cyc/item", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableSetupColumn("L1/item", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableSetupColumn("LLC/item", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableSetupColumn("Br/item", ImGuiTableColumnFlags_WidthFixed);
+					ImGui::TableHeadersRow();
+
+					for (const Profiling::CounterReport& r : reports)
+					{
+						const double items = r.items ? double(r.items) : 1.0;
+						const double ipc = r.counters.cycles ?
+							double(r.counters.instructions) / double(r.counters.cycles) :
+							0.0;
+
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextUnformatted(r.name);
+						ImGui::TableNextColumn();
+						ImGui::Text("%llu", (unsigned long long)r.calls);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", ipc);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f", double(r.counters.cycles) / items);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", double(r.counters.l1_misses) / items);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", double(r.counters.llc_misses) / items);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.3f", double(r.counters.branch_misses) / items);
+					}
+
+					ImGui::EndTable();
+				}
+			}
+		}
+
+		//Pull new messages every frame so the ring buffer can't lap the reader
+		//while the section is collapsed
+		Utils::ReadLogMessages(log_cursor, log_messages);
+		if (log_messages.size() > MAX_LOG_MESSAGES)
+			log_messages.erase(
+				log_messages.begin(),
+				log_messages.end() - MAX_LOG_MESSAGES);
+
+		if (ImGui::CollapsingHeader("Log", ImGuiTreeNodeFlags_DefaultOpen))
 		{
-			ImGui::TextWrapped(s.c_str());
-		}*/
+			if (ImGui::Button("Clear")) log_messages.clear();
+
+			ImGui::BeginChild("##Log Messages", ImVec2(0, 0), ImGuiChildFlags_Borders);
+
+			ImGuiListClipper clipper;
+			clipper.Begin(int(log_messages.size()));
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+				{
+					const Utils::LogMessage& message = log_messages[i];
+
+					//Levels follow spdlog: 3 is warn, 4 is error, 5 is critical
+					ImVec4 color = ImGui::GetStyleColorVec4(ImGuiCol_Text);
+					if (message.level == 3) color = ImVec4(1.0f, 0.8f, 0.2f, 1.0f);
+					else if (message.level >= 4) color = ImVec4(1.0f, 0.35f, 0.35f, 1.0f);
+
+					ImGui::PushStyleColor(ImGuiCol_Text, color);
+					ImGui::TextUnformatted(message.text.c_str());
+					ImGui::PopStyleColor();
+				}
+			}
+
+			//Follow new messages unless the user scrolled up
+			if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+				ImGui::SetScrollHereY(1.0f);
+
+			ImGui::EndChild();
+		}
 
 		ImGui::End();
 	}
 
+	/**
+	* @details
+	* Draw the node as a table row with a tree node in the first column. Scopes
+	* that are also timed on the GPU show the GPU average next to the CPU times.
+	* Leaves don't push onto the tree stack. Open nodes recurse into their children.
+	*/
+	void ImGuiManager::ImGuiManagerImpl::DrawProfileNode(
+		const std::vector<Profiling::ProfileNode>& nodes,
+		int index,
+		float root_ms)
+	{
+		const Profiling::ProfileNode& node = nodes[index];
+		const bool leaf = node.first_child < 0;
+
+		ImGuiTreeNodeFlags flags =
+			ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_DefaultOpen;
+		if (leaf)
+			flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		const bool open = ImGui::TreeNodeEx(node.name, flags, "%s", node.name);
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", node.average_ms);
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", node.total_ms);
+		ImGui::TableNextColumn();
+		if (const Profiling::GpuPassTime* gpu = Profiling::GpuProfiler::Get().FindPass(node.name))
+			ImGui::Text("%.3f", gpu->average_ms);
+		else
+			ImGui::TextDisabled("-");
+		ImGui::TableNextColumn();
+		ImGui::Text("%d", node.calls);
+		ImGui::TableNextColumn();
+		ImGui::Text("%.1f", root_ms > 0.0f ? 100.0f * node.average_ms / root_ms : 0.0f);
+
+		if (open && !leaf)
+		{
+			for (int child = node.first_child; child >= 0; child = nodes[child].next_sibling)
+				DrawProfileNode(nodes, child, root_ms);
+			ImGui::TreePop();
+		}
+	}
+
 	/**
 	* @details
 	* The dockspace will need to be redesigned for each application.
@@ -736,7 +1171,7 @@ namespace App
 		_impl->CreateSelectionWindow();
 		_impl->CreateRenderWindow(texture, aspect_ratio);
 		_impl->CreateGraphWindow();
-		//_impl->CreateDebugWindow();
+		_impl->CreateDebugWindow();
 		_impl->CreateStatsWindow();
 	}
 
@@ -757,4 +1192,237 @@ namespace App
 	{
 		return _impl->GetSimulationVariables();
 	}
+
+	/**
+	* @details
+	* Replace the simulation variables shown in the selection window.
+	*/
+	void ImGuiManager::SetSimulationVariables(const ThermodynamicSimulationVariables& variables)
+	{
+		_impl->simulation_variables = variables;
+	}
+
+	/**
+	* @details
+	* Get whether the user asked to record the simulation.
+	*/
+	bool ImGuiManager::GetRecordingRequested() const
+	{
+		return _impl->record_output;
+	}
+
+	/**
+	* @details
+	* Get the backpressure choice for recording.
+	*/
+	bool ImGuiManager::GetDropFramesWhenBehind() const
+	{
+		return _impl->drop_frames_when_behind;
+	}
+
+	/**
+	* @details
+	* Get the path of the trajectory to record to.
+	*/
+	std::string ImGuiManager::GetOutputPath() const
+	{
+		return _impl->output_path;
+	}
+
+	/**
+	* @details
+	* Get the path of the trajectory to replay.
+	*/
+	std::string ImGuiManager::GetReplayPath() const
+	{
+		return _impl->replay_path;
+	}
+
+	/**
+	* @details
+	* Get the replay frame selected by the user.
+	*/
+	int ImGuiManager::GetReplayFrame() const
+	{
+		return _impl->replay_frame;
+	}
+
+	/**
+	* @details
+	* Set the number of frames of the open replay and rewind the slider. The
+	* slider is an int, so longer replays are limited to its range.
+	*/
+	void ImGuiManager::SetReplayFrameCount(uint64_t frame_count)
+	{
+		_impl->replay_frame_count = std::min<uint64_t>(frame_count, INT_MAX);
+		_impl->replay_frame = 0;
+		_impl->replay_playing = false;
+	}
+
+	/**
+	* @details
+	* Get the path of the checkpoint to save or load.
+	*/
+	std::string ImGuiManager::GetCheckpointPath() const
+	{
+		return _impl->checkpoint_path;
+	}
+
+	/**
+	* @details
+	* Get whether checkpoints should be incremental.
+	*/
+	bool ImGuiManager::GetIncrementalCheckpoints() const
+	{
+		return _impl->incremental_checkpoints;
+	}
+
+	/**
+	* @details
+	* Get whether the user asked to capture the render window.
+	*/
+	bool ImGuiManager::GetCaptureRequested() const
+	{
+		return _impl->capture_frames;
+	}
+
+	/**
+	* @details
+	* Get the path of the capture output.
+	*/
+	std::string ImGuiManager::GetCapturePath() const
+	{
+		return _impl->capture_path;
+	}
+
+	/**
+	* @details
+	* Get the index of the capture format.
+	*/
+	int ImGuiManager::GetCaptureFormat() const
+	{
+		return _impl->capture_format;
+	}
+
+	/**
+	* @details
+	* Get the index of the property the particles are colored by.
+	*/
+	int ImGuiManager::GetColorBy() const
+	{
+		return _impl->color_by;
+	}
+
+	/**
+	* @details
+	* Get the index of the colormap.
+	*/
+	int ImGuiManager::GetColorMap() const
+	{
+		return _impl->color_map;
+	}
+
+	/**
+	* @details
+	* Get the compact instances flag.
+	*/
+	bool ImGuiManager::GetCompactInstances() const
+	{
+		return _impl->compact_instances;
+	}
+
+	/**
+	* @details
+	* Get the trails flag.
+	*/
+	bool ImGuiManager::GetTrails() const
+	{
+		return _impl->trails;
+	}
+
+	/**
+	* @details
+	* Get the fraction of the trails kept every frame.
+	*/
+	float ImGuiManager::GetTrailPersistence() const
+	{
+		return _impl->trail_persistence;
+	}
+
+	/**
+	* @details
+	* Get the pause flag.
+	*/
+	bool ImGuiManager::GetPaused() const
+	{
+		return _impl->paused;
+	}
+
+	/**
+	* @details
+	* Get the fast forward flag.
+	*/
+	bool ImGuiManager::GetFastForward() const
+	{
+		return _impl->fast_forward;
+	}
+
+	/**
+	* @details
+	* Get the target frame rate.
+	*/
+	int ImGuiManager::GetTargetFrameRate() const
+	{
+		return _impl->target_frame_rate;
+	}
+
+	/**
+	* @details
+	* Get the replay play flag.
+	*/
+	bool ImGuiManager::GetReplayPlaying() const
+	{
+		return _impl->replay_playing;
+	}
+
+	/**
+	* @details
+	* Keep the rates for the next stats window.
+	*/
+	void ImGuiManager::SetPacingStats(double real_time_factor, double steps_per_second)
+	{
+		_impl->real_time_factor = real_time_factor;
+		_impl->steps_per_second = steps_per_second;
+	}
+
+	/**
+	* @details
+	* Get the camera of the render window.
+	*/
+	const Graphics::Camera& ImGuiManager::GetCamera() const
+	{
+		return _impl->camera;
+	}
+
+	/**
+	* @details
+	* Select the thermodynamics simulation and fill the controls from the
+	* scenario, as if the user had entered it. The strings are truncated to the
+	* size of their text fields.
+	*/
+	void ImGuiManager::ApplyConfig(const SimulationConfig& config)
+	{
+		_impl->simulation_type = 1;
+		_impl->simulation_variables = config.variables;
+		ClampSimulationVariables(_impl->simulation_variables);
+
+		const size_t length = std::min(config.checkpoint_path.size(), sizeof(_impl->checkpoint_path) - 1);
+		config.checkpoint_path.copy(_impl->checkpoint_path, length);
+		_impl->checkpoint_path[length] = '\0';
+
+		const size_t output_length = std::min(config.trajectory_path.size(), sizeof(_impl->output_path) - 1);
+		config.trajectory_path.copy(_impl->output_path, output_length);
+		_impl->output_path[output_length] = '\0';
+		_impl->incremental_checkpoints = config.incremental_checkpoints;
+	}
 }
\ No newline at end of file
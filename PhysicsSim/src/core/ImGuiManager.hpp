@@ -26,6 +26,8 @@ namespace Graphics
 {
 	/// @brief Forward declaration of Texture class in Scene namespace.
 	class Texture;
+	/// @brief Forward declaration of Camera struct in Scene namespace.
+	struct Camera;
 }
 
 //Internal declarations
@@ -37,6 +39,8 @@ namespace App
 
 	/// @brief Forward declaration of ThermodynamicSimulationVariables struct.
 	struct ThermodynamicSimulationVariables;
+	/// @brief Forward declaration of SimulationConfig struct.
+	struct SimulationConfig;
 
 	//Internal declarations
 
@@ -128,6 +132,201 @@ namespace App
 		*/
 		ThermodynamicSimulationVariables GetSimulationVariables();
 
+		/**
+		* @brief
+		* Show the variables of a simulation that wasn't set up from the
+		* selection window, like one loaded from a checkpoint.
+		* @param variables
+		* Structure containing the simulation variables.
+		*/
+		void SetSimulationVariables(const ThermodynamicSimulationVariables& variables);
+
+		/**
+		* @brief
+		* Get whether the user asked to record the simulation to disk.
+		* @return
+		* True if recording is requested, false otherwise.
+		*/
+		bool GetRecordingRequested() const;
+
+		/**
+		* @brief
+		* Get the backpressure choice for recording.
+		* @return
+		* True to drop frames when the disk falls behind, false to wait for it.
+		*/
+		bool GetDropFramesWhenBehind() const;
+
+		/**
+		* @brief
+		* Get the path of the trajectory to record to.
+		* @return
+		* The path entered in the selection window.
+		*/
+		std::string GetOutputPath() const;
+
+		/**
+		* @brief
+		* Get the path of the trajectory to replay.
+		* @return
+		* The path entered in the selection window.
+		*/
+		std::string GetReplayPath() const;
+
+		/**
+		* @brief
+		* Get the replay frame selected by the user.
+		* @return
+		* The index of the frame to show.
+		*/
+		int GetReplayFrame() const;
+
+		/**
+		* @brief
+		* Set the number of frames of the open replay. Resets the frame slider.
+		* @param frame_count
+		* The number of frames, 0 if no replay is open.
+		*/
+		void SetReplayFrameCount(uint64_t frame_count);
+
+		/**
+		* @brief
+		* Get the path of the checkpoint to save or load.
+		* @return
+		* The path entered in the selection window.
+		*/
+		std::string GetCheckpointPath() const;
+
+		/**
+		* @brief
+		* Get whether checkpoints should only write what changed since the last one.
+		* @return
+		* True for incremental checkpoints, false for full ones.
+		*/
+		bool GetIncrementalCheckpoints() const;
+
+		/**
+		* @brief
+		* Get whether the user asked to capture the render window to disk.
+		* @return
+		* True if capturing is requested, false otherwise.
+		*/
+		bool GetCaptureRequested() const;
+
+		/**
+		* @brief
+		* Get the path of the capture output without its extension.
+		* @return
+		* The path entered in the selection window.
+		*/
+		std::string GetCapturePath() const;
+
+		/**
+		* @brief
+		* Get the capture format chosen by the user.
+		* @return
+		* 0 for a PNG sequence, 1 for a Y4M video.
+		*/
+		int GetCaptureFormat() const;
+
+		/**
+		* @brief
+		* Get the property the user chose to color the particles by.
+		* @return
+		* The index of a Graphics::SimulationRenderStructs::ColorBy value.
+		*/
+		int GetColorBy() const;
+
+		/**
+		* @brief
+		* Get the colormap the user chose for the scalar properties.
+		* @return
+		* The index of a Graphics::SimulationRenderStructs::ColorMap value.
+		*/
+		int GetColorMap() const;
+
+		/**
+		* @brief
+		* Check if the user chose the compact quantized particle instances.
+		* @return
+		* True for the compact instances, false otherwise.
+		*/
+		bool GetCompactInstances() const;
+
+		/**
+		* @brief
+		* Check if the user wants the particles to leave trails.
+		* @return
+		* True for trails, false otherwise.
+		*/
+		bool GetTrails() const;
+
+		/**
+		* @brief
+		* Get the fraction of the trails kept every frame.
+		* @return
+		* The trail persistence, in [0, 1).
+		*/
+		float GetTrailPersistence() const;
+
+		/**
+		* @brief
+		* Check if the user paused the simulation.
+		* @return
+		* True while paused, false otherwise.
+		*/
+		bool GetPaused() const;
+
+		/**
+		* @brief
+		* Check if the user wants the simulation uncapped and the render at a low rate.
+		* @return
+		* True for fast forward, false for real time.
+		*/
+		bool GetFastForward() const;
+
+		/**
+		* @brief
+		* Get the frame rate the user wants outside of fast forward.
+		* @return
+		* The frames per second.
+		*/
+		int GetTargetFrameRate() const;
+
+		/**
+		* @brief
+		* Check if the open replay is playing.
+		* @return
+		* True while playing, false otherwise.
+		*/
+		bool GetReplayPlaying() const;
+
+		/**
+		* @brief
+		* Set the simulation rates shown in the stats window.
+		* @param real_time_factor
+		* The simulated time advanced per wall clock second.
+		* @param steps_per_second
+		* The simulation substeps per wall clock second.
+		*/
+		void SetPacingStats(double real_time_factor, double steps_per_second);
+
+		/**
+		* @brief
+		* Get the camera the user set up by panning and zooming the render window.
+		* @return
+		* The camera of the render window.
+		*/
+		const Graphics::Camera& GetCamera() const;
+
+		/**
+		* @brief
+		* Fill the selection window's controls from a scenario.
+		* @param config
+		* The scenario loaded from a configuration file.
+		*/
+		void ApplyConfig(const SimulationConfig& config);
+
 		//PIMPL idiom
 	private:
 		/// @brief Forward declaration of ImGuiManagerImpl struct.
@@ -0,0 +1,318 @@
+/**
+* @file SimulationConfig.cpp
+* @brief
+* Function definitions for the simulation variable limits and the scenario
+* configuration file.
+*/
+
+#include "SimulationConfig.hpp"
+
+#include "utils/Json.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <sstream>
+
+/// @brief Application namespace
+namespace App
+{
+	/**
+	* @details
+	* Warn about members of an object that aren't in the list of known names, so
+	* a misspelled key doesn't silently fall back to its default.
+	*/
+	static void WarnUnknownMembers(
+		const Utils::JsonValue& object,
+		const std::string& scope,
+		std::initializer_list<const char*> known)
+	{
+		for (const auto& member : object.members)
+		{
+			if (std::find_if(known.begin(), known.end(), [&](const char* name) {
+				return member.first == name; }) == known.end())
+				spdlog::warn("Unknown configuration member: {}{}", scope, member.first);
+		}
+	}
+
+	/**
+	* @details
+	* Read a number member into the output if it exists. Fails if the member
+	* isn't a number or lies outside the given range.
+	*/
+	template <typename T>
+	static bool ReadNumber(
+		const Utils::JsonValue& object,
+		const char* key,
+		T& out,
+		double min_value = std::numeric_limits<T>::lowest(),
+		double max_value = double(std::numeric_limits<T>::max()))
+	{
+		const Utils::JsonValue* value = object.Find(key);
+		if (value == nullptr) return true;
+
+		if (value->type != Utils::JsonType::Number ||
+			value->number < min_value ||
+			value->number > max_value ||
+			(std::numeric_limits<T>::is_integer && std::floor(value->number) != value->number))
+		{
+			spdlog::error("Configuration member '{}' must be a {} in [{:g}, {:g}]",
+				key,
+				std::numeric_limits<T>::is_integer ? "whole number" : "number",
+				min_value,
+				max_value);
+			return false;
+		}
+
+		out = T(value->number);
+		return true;
+	}
+
+	/**
+	* @details
+	* Read a string member into the output if it exists. Fails if the member
+	* isn't a string.
+	*/
+	static bool ReadString(const Utils::JsonValue& object, const char* key, std::string& out)
+	{
+		const Utils::JsonValue* value = object.Find(key);
+		if (value == nullptr) return true;
+
+		if (value->type != Utils::JsonType::String)
+		{
+			spdlog::error("Configuration member '{}' must be a string", key);
+			return false;
+		}
+
+		out = value->string;
+		return true;
+	}
+
+	/**
+	* @details
+	* Read a bool member into the output if it exists. Fails if the member isn't
+	* a bool.
+	*/
+	static bool ReadBool(const Utils::JsonValue& object, const char* key, bool& out)
+	{
+		const Utils::JsonValue* value = object.Find(key);
+		if (value == nullptr) return true;
+
+		if (value->type != Utils::JsonType::Bool)
+		{
+			spdlog::error("Configuration member '{}' must be true or false", key);
+			return false;
+		}
+
+		out = value->boolean;
+		return true;
+	}
+
+	/**
+	* @details
+	* Read the ensemble by name.
+	*/
+	static bool ReadEnsemble(const Utils::JsonValue& object, int& ensemble)
+	{
+		std::string name;
+		if (!ReadString(object, "ensemble", name)) return false;
+		if (name.empty()) return true;
+
+		if (name == "microcanonical") ensemble = MICROCANONICAL;
+		else if (name == "canonical") ensemble = CANONICAL;
+		else if (name == "grand_canonical") ensemble = GRAND_CANONICAL;
+		else
+		{
+			spdlog::error(
+				"Unknown ensemble '{}', expected microcanonical, canonical or grand_canonical",
+				name);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	* @details
+	* Read the image renderer by name.
+	*/
+	static bool ReadImageRenderer(const Utils::JsonValue& object, std::string& renderer)
+	{
+		std::string name;
+		if (!ReadString(object, "image_renderer", name)) return false;
+		if (name.empty()) return true;
+
+		if (name != "software" && name != "opengl")
+		{
+			spdlog::error("Unknown image renderer '{}', expected software or opengl", name);
+			return false;
+		}
+		renderer = name;
+		return true;
+	}
+
+	/**
+	* @details
+	* Read the species names, either a list of strings or a single string.
+	*/
+	static bool ReadSpecies(const Utils::JsonValue& object, std::vector<std::string>& species)
+	{
+		const Utils::JsonValue* value = object.Find("species");
+		if (value == nullptr) return true;
+
+		if (value->type == Utils::JsonType::String)
+		{
+			species.assign(1, value->string);
+			return true;
+		}
+
+		if (value->type == Utils::JsonType::Array)
+		{
+			species.clear();
+			for (const Utils::JsonValue& element : value->elements)
+			{
+				if (element.type != Utils::JsonType::String) break;
+				species.push_back(element.string);
+			}
+			if (species.size() == value->elements.size()) return true;
+		}
+
+		spdlog::error("Configuration member 'species' must be a string or a list of strings");
+		return false;
+	}
+
+	/**
+	* @details
+	* Clamp every variable to its limit. These are the same limits the
+	* selection window enforces on its widgets.
+	*/
+	void ClampSimulationVariables(ThermodynamicSimulationVariables& variables)
+	{
+		variables.ensemble = std::clamp(variables.ensemble, int(MICROCANONICAL), int(GRAND_CANONICAL));
+		variables.num_particles = std::max(variables.num_particles, MIN_PARTICLES);
+		variables.box_width_perc = std::clamp(variables.box_width_perc, MIN_BOX_SIZE, MAX_BOX_SIZE);
+		variables.box_height_perc = std::clamp(variables.box_height_perc, MIN_BOX_SIZE, MAX_BOX_SIZE);
+		variables.radius = std::clamp(variables.radius, MIN_RADIUS, MAX_RADIUS);
+		variables.energy_value = std::max(variables.energy_value, MIN_ENERGY);
+		variables.temperature = std::max(variables.temperature, MIN_TEMPERATURE);
+		variables.chem_potential = std::max(variables.chem_potential, MIN_CHEM_POTENTIAL);
+	}
+
+	/**
+	* @details
+	* Parse the file and read each known member over the defaults already in
+	* the config. Values of the wrong type fail the load, since a run with a
+	* silently different scenario isn't reproducible. Unknown members only
+	* warn, and the simulation variables are clamped to their limits last.
+	*/
+	bool LoadSimulationConfig(const std::string& path, SimulationConfig& config)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			spdlog::error("Failed to open configuration file: {}", path);
+			return false;
+		}
+
+		std::stringstream text;
+		text << file.rdbuf();
+
+		Utils::JsonValue root;
+		std::string error;
+		if (!Utils::ParseJson(text.str(), root, error))
+		{
+			spdlog::error("Failed to parse configuration file {}: {}", path, error);
+			return false;
+		}
+		if (root.type != Utils::JsonType::Object)
+		{
+			spdlog::error("Configuration file {} must hold an object", path);
+			return false;
+		}
+
+		WarnUnknownMembers(root, "", {
+			"ensemble", "particles", "box", "radius", "energy", "temperature",
+			"chemical_potential", "species", "potential", "integrator", "dt",
+			"thermostat", "steps", "threads", "seed", "output" });
+
+		ThermodynamicSimulationVariables& variables = config.variables;
+		bool valid =
+			ReadEnsemble(root, variables.ensemble) &&
+			ReadNumber(root, "particles", variables.num_particles, 0.0) &&
+			ReadNumber(root, "radius", variables.radius, 0.0) &&
+			ReadNumber(root, "energy", variables.energy_value) &&
+			ReadNumber(root, "temperature", variables.temperature) &&
+			ReadNumber(root, "chemical_potential", variables.chem_potential) &&
+			ReadNumber(root, "seed", variables.seed, 0.0, 9007199254740992.0) &&
+			ReadSpecies(root, config.species) &&
+			ReadString(root, "potential", config.potential) &&
+			ReadString(root, "integrator", config.integrator) &&
+			ReadNumber(root, "dt", config.dt, 0.0) &&
+			ReadString(root, "thermostat", config.thermostat) &&
+			ReadNumber(root, "steps", config.steps, 0.0, 9007199254740992.0) &&
+			ReadNumber(root, "threads", config.threads, 0.0);
+
+		const Utils::JsonValue* box = root.Find("box");
+		if (valid && box != nullptr)
+		{
+			if (box->type != Utils::JsonType::Object)
+			{
+				spdlog::error("Configuration member 'box' must be an object");
+				valid = false;
+			}
+			else
+			{
+				WarnUnknownMembers(*box, "box.", { "width", "height" });
+				valid =
+					ReadNumber(*box, "width", variables.box_width_perc) &&
+					ReadNumber(*box, "height", variables.box_height_perc);
+			}
+		}
+
+		const Utils::JsonValue* output = root.Find("output");
+		if (valid && output != nullptr)
+		{
+			if (output->type != Utils::JsonType::Object)
+			{
+				spdlog::error("Configuration member 'output' must be an object");
+				valid = false;
+			}
+			else
+			{
+				WarnUnknownMembers(*output, "output.", {
+					"trajectory", "interval", "checkpoint", "checkpoint_interval", "incremental",
+					"images", "image_interval", "image_width", "image_height", "image_renderer" });
+				valid =
+					ReadString(*output, "trajectory", config.trajectory_path) &&
+					ReadNumber(*output, "interval", config.output_interval, 0.0, 9007199254740992.0) &&
+					ReadString(*output, "checkpoint", config.checkpoint_path) &&
+					ReadNumber(*output, "checkpoint_interval", config.checkpoint_interval, 0.0, 9007199254740992.0) &&
+					ReadBool(*output, "incremental", config.incremental_checkpoints) &&
+					ReadString(*output, "images", config.image_path) &&
+					ReadNumber(*output, "image_interval", config.image_interval, 0.0, 9007199254740992.0) &&
+					ReadNumber(*output, "image_width", config.image_width, 1.0, 16384.0) &&
+					ReadNumber(*output, "image_height", config.image_height, 1.0, 16384.0) &&
+					ReadImageRenderer(*output, config.image_renderer);
+			}
+		}
+
+		if (!valid)
+		{
+			spdlog::error("Invalid configuration file: {}", path);
+			return false;
+		}
+
+		ClampSimulationVariables(variables);
+		spdlog::info(
+			"Loaded configuration {}: {} particles, {}% x {}% box, seed {}",
+			path,
+			variables.num_particles,
+			variables.box_width_perc,
+			variables.box_height_perc,
+			variables.seed);
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+/**
+* @file SimulationConfig.hpp
+* @brief
+* Declarations for the simulation variables shared by the GUI and the headless
+* runner, their limits, and the scenario configuration file that sets them. A
+* scenario is a JSON document. Every member is optional, missing members keep
+* the defaults of SimulationConfig and the simulation variables are clamped to
+* their limits. For example:
+*
+* {
+*   "ensemble": "canonical",     // microcanonical, canonical or grand_canonical
+*   "particles": 1000,
+*   "box": { "width": 80, "height": 80 },
+*   "radius": 0.01,
+*   "energy": 0.0,
+*   "temperature": 300.0,
+*   "chemical_potential": 0.0,
+*   "species": [ "A" ],
+*   "potential": "none",
+*   "integrator": "none",
+*   "dt": 0.001,
+*   "thermostat": "none",
+*   "steps": 1000,
+*   "threads": 0,                // 0 uses every hardware thread
+*   "seed": 0,                   // 0 draws a seed from the system
+*   "output": {
+*     "trajectory": "trajectory.pstraj",
+*     "interval": 0,             // steps between trajectory frames, 0 disables
+*     "checkpoint": "checkpoint.pschk",
+*     "checkpoint_interval": 0,  // steps between checkpoints, 0 disables
+*     "incremental": false,
+*     "images": "frame",         // written as frame_000000.png, named by step
+*     "image_interval": 0,       // steps between images, 0 disables
+*     "image_width": 1024,
+*     "image_height": 1024,
+*     "image_renderer": "software" // software, or opengl for an offscreen context
+*   }
+* }
+*/
+
+#pragma once
+
+#ifndef _SIMULATIONCONFIG_
+#define _SIMULATIONCONFIG_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Application namespace
+namespace App
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	//Structures to hold the simulators' data.
+
+	/// @brief Thermodynamic ensemble of a simulation.
+	enum ThermodynamicEnsemble
+	{
+		MICROCANONICAL = 0,
+		CANONICAL = 1,
+		GRAND_CANONICAL = 2
+	};
+
+	/**
+	* @brief Structure to hold the thermodynamic simulation variables.
+	* @param ensemble The thermodynamic ensemble of the simulation.
+	* @param num_particles The number of particles to simulate.
+	* @param box_width_perc The width of the simulation box as a percentage of the window.
+	* @param box_height_perc The height of the simulation box as a percentage of the window.
+	* @param energy_value The energy value for the simulation.
+	* @param temperature The temperature for the simulation.
+	* @param chem_potential The chemical potential for the simulation.
+	* @param radius The radius of the particles in the simulation.
+	* @param seed The seed of the particle setup, 0 to draw one from the system.
+	*/
+	struct ThermodynamicSimulationVariables
+	{
+		int ensemble = MICROCANONICAL;
+		int num_particles = 0;
+		int box_width_perc = 0;
+		int box_height_perc = 0;
+		float energy_value = 0.0f;
+		float temperature = 0.0f;
+		float chem_potential = 0.0f;
+		float radius = 0.0f;
+		uint64_t seed = 0;
+	};
+
+	/// @brief Minimum number of particles.
+	inline constexpr int MIN_PARTICLES = 1;
+	/// @brief Minimum box size as a percentage of the window.
+	inline constexpr int MIN_BOX_SIZE = 10;
+	/// @brief Maximum box size as a percentage of the window.
+	inline constexpr int MAX_BOX_SIZE = 100;
+	/// @brief Minimum particle radius.
+	inline constexpr float MIN_RADIUS = 0.005f;
+	/// @brief Maximum particle radius.
+	inline constexpr float MAX_RADIUS = 0.10f;
+	/// @brief Minimum energy value.
+	inline constexpr float MIN_ENERGY = 0.0f;
+	/// @brief Minimum temperature.
+	inline constexpr float MIN_TEMPERATURE = 0.0f;
+	/// @brief Minimum chemical potential.
+	inline constexpr float MIN_CHEM_POTENTIAL = 0.0f;
+
+	/**
+	* @brief Structure to hold a scenario loaded from a configuration file.
+	* @param variables The simulation variables.
+	* @param species The names of the particle species.
+	* @param potential The name of the interaction potential.
+	* @param integrator The name of the integrator.
+	* @param dt The time step.
+	* @param thermostat The name of the thermostat.
+	* @param steps The number of steps a headless run takes.
+	* @param threads The number of worker threads, 0 for every hardware thread.
+	* @param trajectory_path The path of the trajectory file.
+	* @param output_interval The number of steps between trajectory frames, 0 to disable.
+	* @param checkpoint_path The path of the checkpoint file.
+	* @param checkpoint_interval The number of steps between checkpoints, 0 to disable.
+	* @param incremental_checkpoints True to write only what changed since the last checkpoint.
+	* @param image_path The path of the images without the step and extension.
+	* @param image_interval The number of steps between images, 0 to disable.
+	* @param image_width The width of the images.
+	* @param image_height The height of the images.
+	* @param image_renderer The renderer of the images, software or opengl.
+	*/
+	struct SimulationConfig
+	{
+		ThermodynamicSimulationVariables variables;
+		std::vector<std::string> species;
+		std::string potential = "none";
+		std::string integrator = "none";
+		float dt = 0.001f;
+		std::string thermostat = "none";
+		uint64_t steps = 1000;
+		int threads = 0;
+		std::string trajectory_path = "trajectory.pstraj";
+		uint64_t output_interval = 0;
+		std::string checkpoint_path = "checkpoint.pschk";
+		uint64_t checkpoint_interval = 0;
+		bool incremental_checkpoints = false;
+		std::string image_path = "frame";
+		uint64_t image_interval = 0;
+		int image_width = 1024;
+		int image_height = 1024;
+		std::string image_renderer = "software";
+	};
+
+	/**
+	* @brief Clamp the simulation variables to their limits.
+	* @param variables The variables to clamp.
+	*/
+	void ClampSimulationVariables(ThermodynamicSimulationVariables& variables);
+
+	/**
+	* @brief Load a scenario from a configuration file.
+	* @param path The path of the configuration file.
+	* @param config Set to the scenario. Members missing from the file keep their defaults.
+	* @return True if the file was loaded, false otherwise.
+	*/
+	bool LoadSimulationConfig(const std::string& path, SimulationConfig& config);
+}
+
+#endif
\ No newline at end of file
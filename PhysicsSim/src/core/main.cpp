@@ -5,6 +5,13 @@
 */
 
 #include "Application.hpp"
+#include "HeadlessRunner.hpp"
+#include "SimulationConfig.hpp"
+#include "utils/Logging.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <cstring>
 
 //Uncomment to enable memory leak detection
 //#define _CRTDBG_MAP_ALLOC
@@ -14,24 +21,72 @@
 * @brief
 * Main entry point for the application.
 * 
+* @param argc
+* The number of command line arguments.
+* @param argv
+* The command line arguments:
+* --config <path>  Load a scenario configuration file.
+* --headless       Run the scenario without a window and exit.
+* 
 * @return
 * 0 if successful, 1 if failed.
 * 
 * @details
-* Create an instance of the application and run it. Sets the starting width and 
+* Start the asynchronous logger and load the scenario if one was given. In
+* headless mode the scenario is run to completion without a window. Otherwise
+* create an instance of the application, fill it from the scenario and run it.
+* The application is destroyed before the logger is shut down so its
+* messages are still flushed. Sets the starting width and 
 * height to 1280x720 and the name of the window to "Physics Sim". The demo flag 
 * is set to false by default to run in normal mode. Set to true to run the ImGui 
 * demo.
 */
-int main()
+int main(int argc, char** argv)
 {
 	int width = 1280;
 	int height = 720;
 	std::string name = "Physics Sim";
 	bool demo = false;
+	bool headless = false;
+	std::string config_path;
+
+	Utils::InitLogging();
+
+	bool valid = true;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0) headless = true;
+		else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) config_path = argv[++i];
+		else
+		{
+			spdlog::error("Unknown argument: {}", argv[i]);
+			spdlog::error("Usage: PhysicsSim [--config <path>] [--headless]");
+			valid = false;
+		}
+	}
+
+	App::SimulationConfig config;
+	if (valid && !config_path.empty()) valid = App::LoadSimulationConfig(config_path, config);
+
+	int result = valid ? 0 : 1;
+	if (valid && headless)
+	{
+		App::HeadlessRunner runner(config);
+		if (!runner.Run()) result = 1;
+	}
+	else if (valid)
+	{
+		std::unique_ptr<App::Application> app = std::make_unique<App::Application>();
+		if (app->Init(name, width, height))
+		{
+			if (!config_path.empty()) app->ApplyConfig(config);
+			app->Run(demo);
+		}
+		else result = 1;
+		app.reset();
+	}
 
-	std::unique_ptr<App::Application> app = std::make_unique<App::Application>();
-	if(app->Init(name, width, height)) app->Run(demo);
+	Utils::ShutdownLogging();
 
-	return 0;
+	return result;
 }
\ No newline at end of file
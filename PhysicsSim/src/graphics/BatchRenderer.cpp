@@ -0,0 +1,366 @@
+/**
+* @file BatchRenderer.cpp
+* @brief
+* Function definitions for the BatchRenderer class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "BatchRenderer.hpp"
+#include "utils/GlfwIncludes.hpp"
+
+#include "graphics/objects/Object.hpp"
+#include "graphics/Shader.hpp"
+#include "graphics/ShaderRegistry.hpp"
+#include "profiling/Profiler.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	/// @brief BatchRenderer PIMPL implementation structure.
+	struct BatchRenderer::BatchRendererImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		BatchRendererImpl(const BatchRendererImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		BatchRendererImpl& operator=(const BatchRendererImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		BatchRendererImpl(const BatchRendererImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		BatchRendererImpl& operator=(const BatchRendererImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		BatchRendererImpl();
+		/// @brief Destructor
+		~BatchRendererImpl();
+
+		/**
+		* @brief Per instance attributes, matching the instanced object shader.
+		* @param model The model matrix, locations 1 to 4.
+		* @param color The color, location 5.
+		*/
+		struct Instance
+		{
+			glm::mat4 model;
+			glm::vec4 color;
+		};
+
+		/**
+		* @brief Draws of one mesh with one shader.
+		* @param vbo The vertex buffer of the mesh.
+		* @param first_vertex The first vertex of the mesh in the buffer.
+		* @param vertex_count The number of vertices of the mesh.
+		* @param shader The shader.
+		* @param instances The queued instances.
+		*/
+		struct Batch
+		{
+			GLuint vbo = 0;
+			GLint first_vertex = 0;
+			GLsizei vertex_count = 0;
+			std::shared_ptr<Shader> shader;
+			std::vector<Instance> instances;
+		};
+
+		/// @brief Key of a batch: vertex buffer, first vertex, vertex count and shader program.
+		using BatchKey = std::tuple<GLuint, GLint, GLsizei, GLuint>;
+
+		//Member methods
+
+		/**
+		* @brief Get the vertex array of the batch renderer for a vertex buffer.
+		* @param vbo The vertex buffer.
+		* @return The vertex array, created on first use.
+		*/
+		GLuint GetVertexArray(GLuint vbo);
+
+		/**
+		* @brief
+		* Point a vertex array at a vertex buffer for the positions and at the
+		* instance buffer for the instance attributes.
+		* @param vao The vertex array of the batch renderer.
+		* @param vbo The vertex buffer of the mesh.
+		* @param first_instance The instance the attributes start at.
+		*/
+		void SetupAttributes(GLuint vao, GLuint vbo, size_t first_instance);
+
+		//Member variables
+
+		/// @brief Batches by mesh and shader program, kept across frames for their capacity.
+		std::vector<Batch> batches;
+		/// @brief Index into batches by mesh and shader program.
+		std::map<BatchKey, size_t> batch_index;
+		/// @brief Vertex arrays of the batch renderer by vertex buffer.
+		std::unordered_map<GLuint, GLuint> vertex_arrays;
+		/// @brief Buffer holding the instances of every batch after each other.
+		GLuint instance_buffer = 0;
+		/// @brief Instanced object shader from the shader registry.
+		std::shared_ptr<Shader> default_shader;
+		/// @brief Draw calls of the last flush.
+		size_t draw_calls = 0;
+		/// @brief Instances of the last flush.
+		size_t instances = 0;
+	};
+
+	/**
+	* @details
+	* Constructor for the BatchRendererImpl class. Creates the instance buffer
+	* and takes the instanced object shader from the registry.
+	*/
+	BatchRenderer::BatchRendererImpl::BatchRendererImpl() :
+		default_shader(ShaderRegistry::Get().GetShader(OBJECT_INSTANCED_SHADER))
+	{
+		glGenBuffers(1, &instance_buffer);
+	}
+
+	/**
+	* @details
+	* Destructor for the BatchRendererImpl class. Deletes the instance buffer
+	* and the vertex arrays.
+	*/
+	BatchRenderer::BatchRendererImpl::~BatchRendererImpl()
+	{
+		for (auto& [vbo, vao] : vertex_arrays) glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(1, &instance_buffer);
+	}
+
+	/**
+	* @details
+	* One vertex array serves every mesh of a vertex buffer, as the meshes
+	* are drawn from their first vertex.
+	*/
+	GLuint BatchRenderer::BatchRendererImpl::GetVertexArray(GLuint vbo)
+	{
+		auto it = vertex_arrays.find(vbo);
+		if (it != vertex_arrays.end()) return it->second;
+
+		GLuint vao = 0;
+		glGenVertexArrays(1, &vao);
+		vertex_arrays.emplace(vbo, vao);
+		return vao;
+	}
+
+	/**
+	* @details
+	* The position is re-pointed every flush, as buffer names are reused once
+	* the object owning one deletes it. The model matrix takes four vec4
+	* locations. Starting the pointers past the first instance draws a batch
+	* from its range of the shared buffer without a base instance.
+	*/
+	void BatchRenderer::BatchRendererImpl::SetupAttributes(GLuint vao, GLuint vbo, size_t first_instance)
+	{
+		const size_t base = first_instance * sizeof(Instance);
+
+		glBindVertexArray(vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+
+		for (GLuint column = 0; column < 4; column++)
+		{
+			glEnableVertexAttribArray(1 + column);
+			glVertexAttribPointer(
+				1 + column,
+				4,
+				GL_FLOAT,
+				GL_FALSE,
+				sizeof(Instance),
+				(void*)(base + offsetof(Instance, model) + column * sizeof(glm::vec4)));
+			glVertexAttribDivisor(1 + column, 1);
+		}
+
+		glEnableVertexAttribArray(5);
+		glVertexAttribPointer(
+			5,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(Instance),
+			(void*)(base + offsetof(Instance, color)));
+		glVertexAttribDivisor(5, 1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	/**
+	* @details
+	* Constructor for the BatchRenderer class. Initializes the PIMPL pointer.
+	*/
+	BatchRenderer::BatchRenderer() :
+		_impl(std::make_unique<BatchRendererImpl>())
+	{}
+
+	/**
+	* @details
+	* Destructor for the BatchRenderer class.
+	*/
+	BatchRenderer::~BatchRenderer() = default;
+
+	/**
+	* @details
+	* Use the object's model matrix, like Object::Draw does.
+	*/
+	void BatchRenderer::Submit(const Object::Object& object)
+	{
+		if (!object.HasGeometry()) return;
+
+		Submit(
+			object,
+			object.GetModelMatrix(),
+			object.GetColor());
+	}
+
+	/**
+	* @details
+	* Objects without vertices, like a Box that has no geometry yet, are
+	* skipped. Circles of one tessellation level share a range of the circle
+	* geometry buffer, so they land in the same batch. The batch of the mesh
+	* and shader is created on first use and reused every frame after.
+	*/
+	void BatchRenderer::Submit(
+		const Object::Object& object,
+		const glm::mat4& model,
+		const glm::vec3& color,
+		const std::shared_ptr<Shader>& shader)
+	{
+		if (!object.HasGeometry()) return;
+
+		const std::shared_ptr<Shader>& program = shader ? shader : _impl->default_shader;
+		if (!program || program->GetErrorStatus()) return;
+
+		const BatchRendererImpl::BatchKey key = {
+			object.GetVBO(),
+			GLint(object.GetFirstVertex()),
+			GLsizei(object.GetNumVertices()),
+			program->GetGLFWShader() };
+
+		auto it = _impl->batch_index.find(key);
+		if (it == _impl->batch_index.end())
+		{
+			BatchRendererImpl::Batch batch;
+			batch.vbo = std::get<0>(key);
+			batch.first_vertex = std::get<1>(key);
+			batch.vertex_count = std::get<2>(key);
+			batch.shader = program;
+			_impl->batches.push_back(std::move(batch));
+			it = _impl->batch_index.emplace(key, _impl->batches.size() - 1).first;
+		}
+
+		_impl->batches[it->second].instances.push_back({ model, glm::vec4(color, 1.0f) });
+	}
+
+	/**
+	* @details
+	* All instances go into one orphaned buffer, so the frame costs one
+	* allocation and an upload per batch. Batches are drawn sorted by program
+	* so every shader is bound once. The queues keep their capacity for the
+	* next frame.
+	*/
+	void BatchRenderer::Flush()
+	{
+		_impl->draw_calls = 0;
+		_impl->instances = 0;
+
+		std::vector<size_t> order;
+		for (size_t b = 0; b < _impl->batches.size(); b++)
+		{
+			if (_impl->batches[b].instances.empty()) continue;
+			order.push_back(b);
+			_impl->instances += _impl->batches[b].instances.size();
+		}
+		if (order.empty()) return;
+
+		PROFILE_SCOPE("Object Batches");
+
+		std::sort(order.begin(), order.end(), [this](size_t a, size_t b)
+			{
+				return _impl->batches[a].shader->GetGLFWShader() <
+					_impl->batches[b].shader->GetGLFWShader();
+			});
+
+		using Instance = BatchRendererImpl::Instance;
+
+		//Orphan the buffer so the driver doesn't wait for the last frame's draws
+		glBindBuffer(GL_ARRAY_BUFFER, _impl->instance_buffer);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			_impl->instances * sizeof(Instance),
+			nullptr,
+			GL_STREAM_DRAW);
+
+		size_t first = 0;
+		std::vector<size_t> firsts(_impl->batches.size(), 0);
+		for (size_t b : order)
+		{
+			const std::vector<Instance>& instances = _impl->batches[b].instances;
+			glBufferSubData(
+				GL_ARRAY_BUFFER,
+				first * sizeof(Instance),
+				instances.size() * sizeof(Instance),
+				instances.data());
+			firsts[b] = first;
+			first += instances.size();
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		GLuint bound_program = 0;
+		for (size_t b : order)
+		{
+			BatchRendererImpl::Batch& batch = _impl->batches[b];
+			const GLuint program = batch.shader->GetGLFWShader();
+			if (program != bound_program)
+			{
+				glUseProgram(program);
+				bound_program = program;
+			}
+
+			_impl->SetupAttributes(_impl->GetVertexArray(batch.vbo), batch.vbo, firsts[b]);
+			glDrawArraysInstanced(
+				GL_TRIANGLE_FAN,
+				batch.first_vertex,
+				batch.vertex_count,
+				GLsizei(batch.instances.size()));
+			_impl->draw_calls++;
+
+			batch.instances.clear();
+		}
+
+		glBindVertexArray(0);
+	}
+
+	/**
+	* @details
+	* Get the number of draw calls of the last flush.
+	*/
+	size_t BatchRenderer::GetDrawCalls() const
+	{
+		return _impl->draw_calls;
+	}
+
+	/**
+	* @details
+	* Get the number of objects drawn by the last flush.
+	*/
+	size_t BatchRenderer::GetInstances() const
+	{
+		return _impl->instances;
+	}
+}
\ No newline at end of file
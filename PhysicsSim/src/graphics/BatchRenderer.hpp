@@ -0,0 +1,120 @@
+/**
+* @file BatchRenderer.hpp
+* @brief
+* Class declaration for the batch renderer. Collects the object draws of a
+* frame, groups them by mesh, the vertex range of a vertex buffer, and shader
+* and submits every group as a single instanced draw, with the model matrix
+* and color of each object as instance attributes, instead of one draw with
+* its own uniforms per object. The instance attributes live in vertex arrays
+* of the batch renderer, the objects' own vertex arrays are left alone. Uses
+* the PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _BATCHRENDERER_
+#define _BATCHRENDERER_
+
+#include <glm/glm.hpp>
+#include <memory>
+
+//External forward declarations
+
+/// @brief Object namespace
+namespace Object
+{
+	/// @brief Forward declaration of Object class.
+	class Object;
+}
+
+//Internal declarations
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Forward declaration of Shader class.
+	class Shader;
+
+	/// @brief BatchRenderer class
+	class BatchRenderer
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		BatchRenderer(const BatchRenderer& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		BatchRenderer& operator=(const BatchRenderer& other) = delete;
+		/// @brief Deleted move constructor.
+		BatchRenderer(const BatchRenderer&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		BatchRenderer& operator=(const BatchRenderer&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor. The OpenGL context must be current.
+		BatchRenderer();
+		/// @brief Destructor. The OpenGL context must be current.
+		~BatchRenderer();
+
+		//Member methods
+
+		/**
+		* @brief
+		* Queue an object for the next flush, with its model matrix and in its
+		* color, drawn with the instanced object shader.
+		* @param object The object.
+		*/
+		void Submit(const Object::Object& object);
+
+		/**
+		* @brief
+		* Queue an object for the next flush with its own transform and color.
+		* The shader must read the model matrix from locations 1 to 4 and the
+		* color from location 5, like the instanced object shader.
+		* @param object The object, for its vertex buffer and vertex range.
+		* @param model The model matrix of this draw.
+		* @param color The color of this draw.
+		* @param shader The shader, nullptr for the instanced object shader.
+		*/
+		void Submit(
+			const Object::Object& object,
+			const glm::mat4& model,
+			const glm::vec3& color,
+			const std::shared_ptr<Shader>& shader = nullptr);
+
+		/**
+		* @brief
+		* Draw the queued objects, one instanced draw per mesh and shader, into
+		* the bound frame buffer and empty the queue.
+		*/
+		void Flush();
+
+		/**
+		* @brief Get the number of draw calls of the last flush.
+		* @return The number of draw calls.
+		*/
+		size_t GetDrawCalls() const;
+
+		/**
+		* @brief Get the number of objects drawn by the last flush.
+		* @return The number of objects.
+		*/
+		size_t GetInstances() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of BatchRendererImpl struct.
+		struct BatchRendererImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<BatchRendererImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,608 @@
+/**
+* @file FrameCapture.cpp
+* @brief
+* Function definitions for the FrameCapture class. Uses the PIMPL idiom to hide
+* implementation details.
+*/
+
+#include "FrameCapture.hpp"
+#include "utils/GlfwIncludes.hpp"
+
+#include "profiling/Profiler.hpp"
+#include "utils/ImageWrite.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	/// @brief FrameCapture PIMPL implementation structure.
+	struct FrameCapture::FrameCaptureImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		FrameCaptureImpl() = delete;
+		/// @brief Deleted copy constructor.
+		FrameCaptureImpl(const FrameCaptureImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		FrameCaptureImpl& operator=(const FrameCaptureImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		FrameCaptureImpl(const FrameCaptureImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		FrameCaptureImpl& operator=(const FrameCaptureImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the FrameCaptureImpl class.
+		* @param settings The settings of the capture.
+		*/
+		explicit FrameCaptureImpl(const CaptureSettings& settings);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~FrameCaptureImpl();
+
+		//Member structures
+
+		/// @brief Structure to hold a pixel pack buffer and the readback in it.
+		struct Readback
+		{
+			GLuint buffer = 0;
+			GLsync fence = nullptr;
+			int width = 0;
+			int height = 0;
+			size_t capacity = 0;
+		};
+
+		/// @brief Structure to hold a frame waiting for the encoders.
+		struct Frame
+		{
+			uint64_t index = 0;
+			int width = 0;
+			int height = 0;
+			std::vector<unsigned char> pixels;
+		};
+
+		//Member methods
+
+		/**
+		* @brief
+		* Copy a finished readback into a free frame buffer and queue it, then
+		* release the readback's fence.
+		* @param readback The readback whose fence has signalled.
+		* @param wait True to wait for a free frame buffer, false to drop the frame.
+		*/
+		void Collect(Readback& readback, bool wait);
+
+		/// @brief Encoder thread loop. Encodes queued frames until stopped.
+		void EncoderLoop();
+
+		/**
+		* @brief Write a frame as a PNG file.
+		* @param frame The frame to write.
+		* @return True if the file was written, false otherwise.
+		*/
+		bool WritePng(const Frame& frame) const;
+
+		/**
+		* @brief Convert a frame to YUV 4:2:0 and append it to the Y4M file.
+		* @param frame The frame to write.
+		* @return True if the frame was written, false otherwise.
+		*/
+		bool WriteY4m(const Frame& frame);
+
+		/// @brief Stop the encoder threads after they encoded the queued frames.
+		void Stop();
+
+		//Member variables
+
+		/// @brief Settings of the capture.
+		CaptureSettings settings;
+		/// @brief Ring of pixel pack buffers.
+		std::vector<Readback> ring;
+		/// @brief Index of the oldest readback in flight.
+		size_t ring_head = 0;
+		/// @brief Number of readbacks in flight.
+		size_t ring_count = 0;
+		/// @brief Index of the next frame captured.
+		uint64_t frame_index = 0;
+		/// @brief Every frame buffer.
+		std::vector<std::unique_ptr<Frame>> pool;
+		/// @brief Frame buffers that are free to collect into.
+		std::vector<Frame*> free_frames;
+		/// @brief Collected frames waiting for the encoders, oldest first.
+		std::deque<Frame*> ready_frames;
+		/// @brief Mutex guarding the free and ready lists.
+		std::mutex mutex;
+		/// @brief Signalled when a frame is ready or the capture stops.
+		std::condition_variable ready_signal;
+		/// @brief Signalled when a frame buffer is freed.
+		std::condition_variable free_signal;
+		/// @brief Flag set to stop the encoder threads.
+		bool stopping = false;
+		/// @brief The encoder threads.
+		std::vector<std::thread> encoders;
+		/// @brief Y4M file, only used by the single Y4M encoder thread.
+		std::FILE* video = nullptr;
+		/// @brief Width of the Y4M video, set by its first frame.
+		int video_width = 0;
+		/// @brief Height of the Y4M video, set by its first frame.
+		int video_height = 0;
+		/// @brief Reused YUV planes of the Y4M encoder.
+		std::vector<unsigned char> video_planes;
+		/// @brief Flag set once the capture was closed.
+		bool closed = false;
+		/// @brief Number of frames captured.
+		std::atomic<uint64_t> captured = 0;
+		/// @brief Number of frames written.
+		std::atomic<uint64_t> written = 0;
+		/// @brief Number of frames dropped.
+		std::atomic<uint64_t> dropped = 0;
+		/// @brief Error status of the capture.
+		std::atomic<bool> error_status = false;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the FrameCaptureImpl class. Creates the pixel pack
+	* buffers, allocates the frame pool and starts the encoders. The buffers get
+	* their storage on the first capture, when the size is known. PNG frames
+	* are independent files and are spread over several threads, since one
+	* thread can't deflate 1080p frames at 60 per second. A Y4M video is
+	* written in order by a single thread, its conversion is cheap.
+	*/
+	FrameCapture::FrameCaptureImpl::FrameCaptureImpl(const CaptureSettings& settings) :
+		settings(settings)
+	{
+		ring.resize(std::max<size_t>(settings.ring_size, 2));
+		for (Readback& readback : ring) glGenBuffers(1, &readback.buffer);
+
+		const size_t pool_size = std::max<size_t>(settings.pool_size, 1);
+		for (size_t i = 0; i < pool_size; i++)
+		{
+			pool.push_back(std::make_unique<Frame>());
+			free_frames.push_back(pool.back().get());
+		}
+
+		unsigned int thread_count = 1;
+		if (settings.format == CaptureFormat::Png)
+		{
+			thread_count = settings.encoder_threads;
+			if (thread_count == 0) thread_count = std::thread::hardware_concurrency() / 2;
+			thread_count = std::max(thread_count, 1u);
+		}
+		else
+		{
+			const std::string path = settings.path + ".y4m";
+			video = std::fopen(path.c_str(), "wb");
+			if (video == nullptr)
+			{
+				spdlog::error("Failed to open capture file: {}", path);
+				error_status = true;
+			}
+		}
+
+		for (unsigned int i = 0; i < thread_count; i++)
+			encoders.emplace_back(&FrameCaptureImpl::EncoderLoop, this);
+
+		spdlog::info(
+			"Capturing frames to {}{} with {} encoder thread(s)",
+			settings.path,
+			settings.format == CaptureFormat::Png ? "_*.png" : ".y4m",
+			thread_count);
+	}
+
+	/**
+	* @details
+	* Destructor for the FrameCaptureImpl class. Stops the encoders and deletes
+	* the fences and pixel pack buffers.
+	*/
+	FrameCapture::FrameCaptureImpl::~FrameCaptureImpl()
+	{
+		Stop();
+
+		for (Readback& readback : ring)
+		{
+			if (readback.fence != nullptr) glDeleteSync(readback.fence);
+			glDeleteBuffers(1, &readback.buffer);
+		}
+	}
+
+	/**
+	* @details
+	* Take a free frame buffer, map the pixel pack buffer and copy the pixels
+	* out. The fence has signalled, so the map doesn't wait for the GPU. If no
+	* frame buffer is free the encoders fell behind, and the frame is dropped
+	* unless the caller asked to wait.
+	*/
+	void FrameCapture::FrameCaptureImpl::Collect(Readback& readback, bool wait)
+	{
+		glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+
+		Frame* frame = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (free_frames.empty())
+			{
+				if (!wait)
+				{
+					dropped++;
+					return;
+				}
+				free_signal.wait(lock, [this] { return !free_frames.empty(); });
+			}
+
+			frame = free_frames.back();
+			free_frames.pop_back();
+		}
+
+		const size_t size = size_t(readback.width) * size_t(readback.height) * 4;
+		frame->index = frame_index++;
+		frame->width = readback.width;
+		frame->height = readback.height;
+		frame->pixels.resize(size);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(size), GL_MAP_READ_BIT);
+		const bool mapped = pixels != nullptr;
+		if (mapped)
+		{
+			std::memcpy(frame->pixels.data(), pixels, size);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (mapped) ready_frames.push_back(frame);
+			else free_frames.push_back(frame);
+		}
+
+		if (!mapped)
+		{
+			dropped++;
+			return;
+		}
+
+		ready_signal.notify_one();
+		captured++;
+	}
+
+	/**
+	* @details
+	* Wait for a ready frame, encode it outside the lock and hand the buffer
+	* back. When stopped, the remaining frames are encoded first, so no
+	* captured frame is lost.
+	*/
+	void FrameCapture::FrameCaptureImpl::EncoderLoop()
+	{
+		PROFILE_THREAD("Capture Encoder");
+
+		while (true)
+		{
+			Frame* frame = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready_signal.wait(lock, [this] { return stopping || !ready_frames.empty(); });
+				if (ready_frames.empty()) break;
+
+				frame = ready_frames.front();
+				ready_frames.pop_front();
+			}
+
+			bool success = false;
+			{
+				PROFILE_SCOPE("Encode Frame");
+
+				if (settings.format == CaptureFormat::Png) success = WritePng(*frame);
+				else success = WriteY4m(*frame);
+			}
+
+			if (success) written++;
+			else error_status = true;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				free_frames.push_back(frame);
+			}
+			free_signal.notify_one();
+		}
+	}
+
+	/**
+	* @details
+	* Write the frame as a PNG named after its index. OpenGL rows run bottom to
+	* top, so the image is written bottom up.
+	*/
+	bool FrameCapture::FrameCaptureImpl::WritePng(const Frame& frame) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "_%06llu.png", (unsigned long long)frame.index);
+		return Utils::WritePng(
+			settings.path + name,
+			frame.width,
+			frame.height,
+			frame.pixels.data(),
+			true);
+	}
+
+	/**
+	* @details
+	* Write the header on the first frame, then convert each frame to full
+	* range BT.601 YUV with the chroma averaged over 2 x 2 pixels, flipping the
+	* rows on the way, and append it. A Y4M video has a single size, so frames
+	* of another size are skipped.
+	*/
+	bool FrameCapture::FrameCaptureImpl::WriteY4m(const Frame& frame)
+	{
+		if (video == nullptr) return false;
+
+		if (video_width == 0)
+		{
+			video_width = frame.width;
+			video_height = frame.height;
+			std::fprintf(
+				video,
+				"YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+				video_width,
+				video_height,
+				settings.frame_rate);
+		}
+
+		if (frame.width != video_width || frame.height != video_height)
+		{
+			spdlog::warn(
+				"Capture frame {} is {} x {}, the video is {} x {}, skipping it",
+				frame.index,
+				frame.width,
+				frame.height,
+				video_width,
+				video_height);
+			return true;
+		}
+
+		const int width = frame.width;
+		const int height = frame.height;
+		const int chroma_width = (width + 1) / 2;
+		const int chroma_height = (height + 1) / 2;
+		const size_t luma_size = size_t(width) * size_t(height);
+		const size_t chroma_size = size_t(chroma_width) * size_t(chroma_height);
+		video_planes.resize(luma_size + 2 * chroma_size);
+
+		unsigned char* y_plane = video_planes.data();
+		unsigned char* u_plane = y_plane + luma_size;
+		unsigned char* v_plane = u_plane + chroma_size;
+
+		auto source_row = [&](int y) {
+			return frame.pixels.data() + size_t(height - 1 - y) * size_t(width) * 4; };
+
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* rgba = source_row(y);
+			unsigned char* luma = y_plane + size_t(y) * size_t(width);
+			for (int x = 0; x < width; x++, rgba += 4)
+				luma[x] = (unsigned char)((77 * rgba[0] + 150 * rgba[1] + 29 * rgba[2] + 128) >> 8);
+		}
+
+		for (int cy = 0; cy < chroma_height; cy++)
+		{
+			const int y0 = 2 * cy;
+			const int y1 = std::min(y0 + 1, height - 1);
+			const unsigned char* row0 = source_row(y0);
+			const unsigned char* row1 = source_row(y1);
+			for (int cx = 0; cx < chroma_width; cx++)
+			{
+				const int x0 = 2 * cx * 4;
+				const int x1 = std::min(2 * cx + 1, width - 1) * 4;
+				const int r = row0[x0] + row0[x1] + row1[x0] + row1[x1];
+				const int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+				const int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+
+				//Sums of four pixels, so the rounding and offset are scaled by four too
+				const int u = (-43 * r - 85 * g + 128 * b + 4 * 32896) >> 10;
+				const int v = (128 * r - 107 * g - 21 * b + 4 * 32896) >> 10;
+				const size_t index = size_t(cy) * size_t(chroma_width) + size_t(cx);
+				u_plane[index] = (unsigned char)std::min(u, 255);
+				v_plane[index] = (unsigned char)std::min(v, 255);
+			}
+		}
+
+		std::fputs("FRAME\n", video);
+		if (std::fwrite(video_planes.data(), 1, video_planes.size(), video) != video_planes.size())
+		{
+			spdlog::error("Failed to write capture file: {}.y4m", settings.path);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	* @details
+	* Set the stop flag, wake the encoders, join them and close the Y4M file.
+	*/
+	void FrameCapture::FrameCaptureImpl::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		ready_signal.notify_all();
+
+		for (std::thread& encoder : encoders)
+			if (encoder.joinable()) encoder.join();
+		encoders.clear();
+
+		if (video != nullptr)
+		{
+			if (std::ferror(video) != 0 || std::fclose(video) != 0)
+			{
+				spdlog::error("Failed to write capture file: {}.y4m", settings.path);
+				error_status = true;
+			}
+			video = nullptr;
+		}
+	}
+
+	/**
+	* @details
+	* Custom constructor for the FrameCapture class. Passes the settings to the
+	* PIMPL implementation.
+	*/
+	FrameCapture::FrameCapture(const CaptureSettings& settings) :
+		_impl(std::make_unique<FrameCaptureImpl>(settings))
+	{}
+
+	/**
+	* @details
+	* Destructor for the FrameCapture class. Closes the capture so the frames in
+	* flight are still written.
+	*/
+	FrameCapture::~FrameCapture()
+	{
+		Close();
+	}
+
+	/**
+	* @details
+	* Get the error status of the capture.
+	*/
+	bool FrameCapture::GetErrorStatus() const
+	{
+		return _impl->error_status;
+	}
+
+	/**
+	* @details
+	* First collect the oldest readbacks whose fences have signalled, polling
+	* with a zero timeout so the render thread never waits for the GPU. Then
+	* queue a readback of this frame into the next free pixel pack buffer,
+	* followed by a fence. If every buffer is still in flight the GPU is a
+	* full ring behind, and the frame is dropped from the capture. The buffer
+	* storage is only reallocated when the framebuffer size changes.
+	*/
+	void FrameCapture::Capture(unsigned int frame_buffer, int width, int height)
+	{
+		PROFILE_SCOPE("Frame Capture");
+
+		FrameCaptureImpl& impl = *_impl;
+		if (impl.closed || width <= 0 || height <= 0) return;
+
+		while (impl.ring_count > 0)
+		{
+			FrameCaptureImpl::Readback& oldest = impl.ring[impl.ring_head];
+			const GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED) break;
+
+			impl.Collect(oldest, false);
+			impl.ring_head = (impl.ring_head + 1) % impl.ring.size();
+			impl.ring_count--;
+		}
+
+		if (impl.ring_count == impl.ring.size())
+		{
+			impl.dropped++;
+			return;
+		}
+
+		FrameCaptureImpl::Readback& readback =
+			impl.ring[(impl.ring_head + impl.ring_count) % impl.ring.size()];
+		const size_t size = size_t(width) * size_t(height) * 4;
+
+		GLint read_frame_buffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_frame_buffer);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		if (readback.capacity != size)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(size), nullptr, GL_STREAM_READ);
+			readback.capacity = size;
+		}
+		readback.width = width;
+		readback.height = height;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, frame_buffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, GLuint(read_frame_buffer));
+
+		impl.ring_count++;
+	}
+
+	/**
+	* @details
+	* Wait for each readback in flight in order and collect it, waiting for
+	* free frame buffers too, then stop the encoders, which write the queued
+	* frames. Closing is the one place the capture waits.
+	*/
+	void FrameCapture::Close()
+	{
+		FrameCaptureImpl& impl = *_impl;
+		if (impl.closed) return;
+		impl.closed = true;
+
+		while (impl.ring_count > 0)
+		{
+			FrameCaptureImpl::Readback& oldest = impl.ring[impl.ring_head];
+			GLenum status = GL_TIMEOUT_EXPIRED;
+			while (status == GL_TIMEOUT_EXPIRED)
+				status = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+
+			if (status == GL_WAIT_FAILED)
+			{
+				glDeleteSync(oldest.fence);
+				oldest.fence = nullptr;
+				impl.dropped++;
+			}
+			else impl.Collect(oldest, true);
+
+			impl.ring_head = (impl.ring_head + 1) % impl.ring.size();
+			impl.ring_count--;
+		}
+
+		impl.Stop();
+	}
+
+	/**
+	* @details
+	* Get the number of frames captured.
+	*/
+	uint64_t FrameCapture::GetCapturedFrames() const
+	{
+		return _impl->captured;
+	}
+
+	/**
+	* @details
+	* Get the number of frames written.
+	*/
+	uint64_t FrameCapture::GetWrittenFrames() const
+	{
+		return _impl->written;
+	}
+
+	/**
+	* @details
+	* Get the number of frames dropped.
+	*/
+	uint64_t FrameCapture::GetDroppedFrames() const
+	{
+		return _impl->dropped;
+	}
+}
\ No newline at end of file
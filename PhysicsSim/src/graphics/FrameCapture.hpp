@@ -0,0 +1,146 @@
+/**
+* @file FrameCapture.hpp
+* @brief
+* Class declaration for the frame capture. Reads a framebuffer back every frame
+* through a ring of pixel pack buffers, so glReadPixels only queues a copy on
+* the GPU instead of stalling the render thread, and collects each readback
+* once its fence has signalled. Collected frames are copied into a pooled
+* buffer and encoded to a PNG sequence or a Y4M video on worker threads. When
+* the GPU or the encoders fall behind, frames are dropped from the capture and
+* never from the interactive frame rate. Uses the PIMPL idiom to hide
+* implementation details.
+*/
+
+#pragma once
+
+#ifndef _FRAMECAPTURE_
+#define _FRAMECAPTURE_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Encoding of captured frames.
+	enum class CaptureFormat
+	{
+		/// @brief One PNG file per frame, named <path>_000000.png.
+		Png = 0,
+		/// @brief A single raw YUV 4:2:0 video file, named <path>.y4m.
+		Y4m = 1
+	};
+
+	/**
+	* @brief Structure to hold the settings of a frame capture.
+	* @param path The path of the output without its extension.
+	* @param format The encoding of the frames.
+	* @param frame_rate The frame rate written to the Y4M header.
+	* @param ring_size The number of pixel pack buffers in flight on the GPU.
+	* @param pool_size The number of frame buffers waiting for the encoders.
+	* @param encoder_threads The number of PNG encoder threads, 0 for half the hardware threads.
+	*/
+	struct CaptureSettings
+	{
+		std::string path = "capture";
+		CaptureFormat format = CaptureFormat::Png;
+		int frame_rate = 60;
+		size_t ring_size = 3;
+		size_t pool_size = 8;
+		unsigned int encoder_threads = 0;
+	};
+
+	/// @brief FrameCapture class
+	class FrameCapture
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		FrameCapture() = delete;
+		/// @brief Deleted copy constructor.
+		FrameCapture(const FrameCapture& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		FrameCapture& operator=(const FrameCapture& other) = delete;
+		/// @brief Deleted move constructor.
+		FrameCapture(const FrameCapture&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		FrameCapture& operator=(const FrameCapture&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief
+		* Custom constructor for the FrameCapture class. Creates the pixel pack
+		* buffers and starts the encoder threads. The OpenGL context must be current.
+		* @param settings The settings of the capture.
+		*/
+		explicit FrameCapture(const CaptureSettings& settings);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Closes the capture, the OpenGL context must be current.
+		~FrameCapture();
+
+		//Member methods
+
+		/**
+		* @brief Get the error status of the capture.
+		* @return True if the output couldn't be written, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
+		/**
+		* @brief
+		* Collect the readbacks that finished and queue a readback of the
+		* framebuffer. Never waits for the GPU or the encoders.
+		* @param frame_buffer The OpenGL framebuffer to read.
+		* @param width The width of the framebuffer.
+		* @param height The height of the framebuffer.
+		*/
+		void Capture(unsigned int frame_buffer, int width, int height);
+
+		/**
+		* @brief
+		* Wait for the readbacks in flight, encode the queued frames and stop the
+		* encoder threads. Safe to call more than once.
+		*/
+		void Close();
+
+		/**
+		* @brief Get the number of frames read back and queued for encoding.
+		* @return The number of frames captured.
+		*/
+		uint64_t GetCapturedFrames() const;
+
+		/**
+		* @brief Get the number of frames encoded and written.
+		* @return The number of frames written.
+		*/
+		uint64_t GetWrittenFrames() const;
+
+		/**
+		* @brief Get the number of frames dropped because the GPU or the encoders fell behind.
+		* @return The number of frames dropped.
+		*/
+		uint64_t GetDroppedFrames() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of FrameCaptureImpl struct.
+		struct FrameCaptureImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<FrameCaptureImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -10,14 +10,22 @@
 #include "ThermodynamicsRenderItems.hpp"
 
 #include "utils/GlfwIncludes.hpp"
+#include "graphics/BatchRenderer.hpp"
+#include "graphics/FrameCapture.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/ShaderRegistry.hpp"
 #include "graphics/Texture.hpp"
+#include "graphics/objects/CircleGeometry.hpp"
+#include "profiling/GpuProfiler.hpp"
+#include "profiling/Profiler.hpp"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+
 /// @brief Scene namespace
 namespace Graphics
 {
@@ -45,12 +53,14 @@ namespace Graphics
 		* @param width The width of the scene.
 		* @param height The height of the scene.
 		* @param bg_color The background color of the scene.
+		* @param offscreen True to create a hidden window with an offscreen context.
 		*/
 		SceneImpl(
 			const std::string& name,
 			const int& width,
 			const int& height,
-			const float* bg_color);
+			const float* bg_color,
+			bool offscreen);
 
 		//Default constructors/destructor
 
@@ -62,6 +72,14 @@ namespace Graphics
 		/// @brief Apply the background color (clear color) to the window.
 		void ApplyClearColor() const;
 
+		/**
+		* @brief
+		* Create a hidden window whose context doesn't need a display, trying an
+		* OSMesa context first and an EGL context second.
+		* @return True if the window was created, false otherwise.
+		*/
+		bool CreateOffscreenWindow();
+
 		/**
 		* @brief Callback function for GLFW error handling.
 		* @param error The error code.
@@ -69,6 +87,33 @@ namespace Graphics
 		*/
 		static void GLFWErrorCallback(int error, const char* description);
 
+		/**
+		* @brief Callback function for OpenGL debug output (KHR_debug).
+		* @param source The source of the message.
+		* @param type The type of the message.
+		* @param id The message id.
+		* @param severity The severity of the message.
+		* @param length The length of the message.
+		* @param message The message text.
+		* @param user_param Unused user pointer.
+		*/
+		static void APIENTRY GLDebugMessageCallback(
+			GLenum source,
+			GLenum type,
+			GLuint id,
+			GLenum severity,
+			GLsizei length,
+			const GLchar* message,
+			const void* user_param);
+
+		/**
+		* @brief
+		* Install the OpenGL debug message callback. Uses the core entry points on
+		* OpenGL 4.3 and the KHR_debug extension on older contexts.
+		* @return True if the callback was installed, false otherwise.
+		*/
+		bool EnableDebugOutput() const;
+
 		/**
 		* @brief Set the window size in OpenGL.
 		* @param window The window handle.
@@ -92,6 +137,14 @@ namespace Graphics
 		/// @brief Swap the buffers for the window.
 		void SwapBuffers() const;
 
+		/**
+		* @brief
+		* Render the simulation items through the trail frame buffer of the
+		* texture and draw the trails over the texture.
+		* @return True if the trails were drawn, false if they aren't available.
+		*/
+		bool RenderTrails();
+
 		//Member variables
 
 		/// @brief Name of the scene.
@@ -106,10 +159,28 @@ namespace Graphics
 		int height;
 		/// @brief Background color.
 		float bg_color[4];
+		/// @brief Display refreshes a buffer swap waits for.
+		int swap_interval = 1;
 		/// @brief Shared pointer to the Texture.
 		std::shared_ptr<Texture> texture;
-		/// @brief Unique pointer to the shader.
-		std::unique_ptr<Shader> shader;
+		/// @brief Shared pointer to the shader from the shader registry.
+		std::shared_ptr<Shader> shader;
+		/// @brief Unique pointer to the batch renderer of the scene objects.
+		std::unique_ptr<BatchRenderer> batch_renderer;
+		/// @brief Camera the simulation is viewed through.
+		Camera camera;
+		/// @brief Flag set while the particles leave trails.
+		bool trails = false;
+		/// @brief Fraction of the trails kept every frame.
+		float trail_persistence = 0.9f;
+		/// @brief Shared pointer to the trail fade shader from the shader registry.
+		std::shared_ptr<Shader> trail_fade_shader;
+		/// @brief Shared pointer to the trail composite shader from the shader registry.
+		std::shared_ptr<Shader> trail_composite_shader;
+		/// @brief Empty vertex array for the full screen trail passes.
+		GLuint trail_vao = 0;
+		/// @brief Unique pointer to the frame capture, set while capturing.
+		std::unique_ptr<FrameCapture> capture;
 		/// @brief Unique pointer to the thermodynamic simulation render structure.
 		std::unique_ptr<SimulationRenderStructs::SimulationRenderItems> sim_render;
 		/// @brief Error status of the scene.
@@ -119,13 +190,17 @@ namespace Graphics
 	/**
 	* @details
 	* Custom constructor for the SceneImpl class. Initializes the name, window
-	* manager, and render manager.
+	* manager, and render manager. An offscreen scene creates a hidden window
+	* with a context that renders without a display; everything after the
+	* context, the texture, shaders and render items, is the same as for the
+	* interactive window.
 	*/
 	Scene::SceneImpl::SceneImpl(
 		const std::string& name,
 		const int& width,
 		const int& height,
-		const float* bg_color) :
+		const float* bg_color,
+		bool offscreen) :
 		name(name),
 		width(width),
 		height(height),
@@ -137,6 +212,7 @@ namespace Graphics
 		{
 			spdlog::error("Failed to initialize GLFW");
 			glfwTerminate();
+			error_status = true;
 			return;
 		}
 
@@ -145,37 +221,54 @@ namespace Graphics
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#ifndef NDEBUG
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
 
-		window = glfwCreateWindow(
-			this->width,
-			this->height,
-			this->name.c_str(),
-			nullptr,
-			nullptr);
+		if (offscreen) CreateOffscreenWindow();
+		else
+		{
+			window = glfwCreateWindow(
+				this->width,
+				this->height,
+				this->name.c_str(),
+				nullptr,
+				nullptr);
+		}
 
 		if (window == nullptr)
 		{
 			spdlog::error("Failed to create GLFW window");
 			glfwTerminate();
+			error_status = true;
 			return;
 		}
 
 		glfwMakeContextCurrent(window);
 		glfwSetFramebufferSizeCallback(window, GLFWFramebufferSizeCallback);
 		glfwSetErrorCallback(GLFWErrorCallback);
-		glfwSwapInterval(1);
+		glfwSwapInterval(swap_interval);
 
 		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 		{
 			spdlog::error("Failed to initialize OpenGL context");
 			glfwTerminate();
+			error_status = true;
 			return;
 		}
 
-		shader = std::make_unique<Shader>(BASE_VS_PATH, BASE_FS_PATH);
+#ifndef NDEBUG
+		EnableDebugOutput();
+#endif
+		Profiling::GpuProfiler::Get().Init();
+		ShaderRegistry::Get().Init();
+		Object::CircleGeometry::Get().Init();
+
+		shader = ShaderRegistry::Get().GetShader(BASE_SHADER);
 		texture = std::make_shared<Texture>(width, height);
+		batch_renderer = std::make_unique<BatchRenderer>();
 
-		error_status = texture->GetErrorStatus() || shader->GetErrorStatus();
+		error_status = texture->GetErrorStatus() || !shader || shader->GetErrorStatus();
 
 		spdlog::info(
 			"Successfully created OpenGL window: {} ({}, {})",
@@ -192,6 +285,21 @@ namespace Graphics
 	{
 		spdlog::info("Destroying OpenGL scene: {}", name);
 
+		//The queries, buffers and programs belong to the context, delete them while it is alive
+		capture.reset();
+		sim_render.reset();
+		batch_renderer.reset();
+		trail_fade_shader.reset();
+		trail_composite_shader.reset();
+		shader.reset();
+		if (window != nullptr)
+		{
+			if (trail_vao != 0) glDeleteVertexArrays(1, &trail_vao);
+			Object::CircleGeometry::Get().Shutdown();
+			ShaderRegistry::Get().Shutdown();
+			Profiling::GpuProfiler::Get().Shutdown();
+		}
+
 		glfwDestroyWindow(window);
 		glfwTerminate();
 
@@ -213,6 +321,38 @@ namespace Graphics
 		glClear(GL_COLOR_BUFFER_BIT);
 	}
 
+	/**
+	* @details
+	* Hide the window and ask GLFW for an OSMesa context, which renders in
+	* software on Mesa without a display. If libOSMesa can't be loaded, try an
+	* EGL context, which Mesa's llvmpipe and the GPU drivers provide. The scene
+	* draws into its texture's frame buffer, so the hidden window's own
+	* surface is never used. On machines without any display GLFW has to be
+	* built with GLFW_USE_OSMESA, whose null platform doesn't open one.
+	*/
+	bool Scene::SceneImpl::CreateOffscreenWindow()
+	{
+		static const std::pair<int, const char*> context_apis[] = {
+			{ GLFW_OSMESA_CONTEXT_API, "OSMesa" },
+			{ GLFW_EGL_CONTEXT_API, "EGL" } };
+
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		for (const auto& [api, api_name] : context_apis)
+		{
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+			window = glfwCreateWindow(width, height, name.c_str(), nullptr, nullptr);
+			if (window != nullptr)
+			{
+				spdlog::info("Created offscreen {} context", api_name);
+				break;
+			}
+			spdlog::warn("Failed to create offscreen {} context", api_name);
+		}
+
+		glfwDefaultWindowHints();
+		return window != nullptr;
+	}
+
 	/**
 	* @details
 	* OpenGL error callback function. Logs the error with spdlog.
@@ -222,6 +362,67 @@ namespace Graphics
 		spdlog::error("GLFW Error ({0}): {1}", error, description);
 	}
 
+	/**
+	* @details
+	* OpenGL debug output callback function. Logs the message with spdlog at a
+	* level matching its severity. Errors are always logged as errors.
+	*/
+	void APIENTRY Scene::SceneImpl::GLDebugMessageCallback(
+		[[maybe_unused]] GLenum source,
+		GLenum type,
+		GLuint id,
+		GLenum severity,
+		[[maybe_unused]] GLsizei length,
+		const GLchar* message,
+		[[maybe_unused]] const void* user_param)
+	{
+		if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH)
+			spdlog::error("OpenGL debug ({0}): {1}", id, message);
+		else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+			spdlog::warn("OpenGL debug ({0}): {1}", id, message);
+		else if (severity == GL_DEBUG_SEVERITY_LOW)
+			spdlog::info("OpenGL debug ({0}): {1}", id, message);
+		else
+			spdlog::debug("OpenGL debug ({0}): {1}", id, message);
+	}
+
+	/**
+	* @details
+	* Load the debug entry points from KHR_debug if the context is older than
+	* OpenGL 4.3, enable synchronous debug output so messages are reported from
+	* the offending call, and mute notifications.
+	*/
+	bool Scene::SceneImpl::EnableDebugOutput() const
+	{
+		if (!GLAD_GL_VERSION_4_3 && glfwExtensionSupported("GL_KHR_debug"))
+		{
+			glad_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)
+				glfwGetProcAddress("glDebugMessageCallback");
+			glad_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)
+				glfwGetProcAddress("glDebugMessageControl");
+		}
+
+		if (glDebugMessageCallback == nullptr || glDebugMessageControl == nullptr)
+		{
+			spdlog::warn("OpenGL debug output is not supported by this context");
+			return false;
+		}
+
+		glEnable(GL_DEBUG_OUTPUT);
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		glDebugMessageCallback(GLDebugMessageCallback, nullptr);
+		glDebugMessageControl(
+			GL_DONT_CARE,
+			GL_DONT_CARE,
+			GL_DEBUG_SEVERITY_NOTIFICATION,
+			0,
+			nullptr,
+			GL_FALSE);
+
+		spdlog::info("OpenGL debug output enabled");
+		return true;
+	}
+
 	/**
 	* @details
 	* OpenGL frame buffer callback function. Sets the viewport to the new width
@@ -264,15 +465,73 @@ namespace Graphics
 
 	/**
 	* @details
-	* Custom constructor for the Scene class. Passes the name, width, and height
-	* to the PIMPL implementation.
+	* The trail frame buffer is faded with one full screen pass and the
+	* particles are drawn into it, so a trail of any length costs one extra
+	* pass per frame instead of keeping and redrawing past positions. The
+	* trails are then drawn over the background of the texture. The shaders
+	* are only taken from the registry once trails are first used.
+	*/
+	bool Scene::SceneImpl::RenderTrails()
+	{
+		if (!texture) return false;
+
+		if (trail_vao == 0)
+		{
+			trail_fade_shader = ShaderRegistry::Get().GetShader(TRAIL_FADE_SHADER);
+			trail_composite_shader = ShaderRegistry::Get().GetShader(TRAIL_COMPOSITE_SHADER);
+			glGenVertexArrays(1, &trail_vao);
+		}
+
+		if (!trail_fade_shader || trail_fade_shader->GetErrorStatus() ||
+			!trail_composite_shader || trail_composite_shader->GetErrorStatus())
+			return false;
+
+		if (!texture->BindTrails()) return false;
+
+		PROFILE_SCOPE("Particle Trails");
+
+		//Multiply the history by the persistence
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ZERO, GL_SRC_ALPHA);
+		glUseProgram(trail_fade_shader->GetGLFWShader());
+		glUniform1f(trail_fade_shader->GetUniformLocation("persistence"), trail_persistence);
+		glBindVertexArray(trail_vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+		glDisable(GL_BLEND);
+
+		sim_render->Render();
+
+		//Draw the premultiplied trails over the background
+		glBindFramebuffer(GL_FRAMEBUFFER, texture->GetFramebufferId());
+		glViewport(0, 0, texture->GetWidth(), texture->GetHeight());
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		glUseProgram(trail_composite_shader->GetGLFWShader());
+		glUniform1i(trail_composite_shader->GetUniformLocation("trails"), 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture->GetTrailTextureId());
+		glBindVertexArray(trail_vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+
+		glBindVertexArray(0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDisable(GL_BLEND);
+		return true;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the Scene class. Passes the name, width, height
+	* and offscreen flag to the PIMPL implementation.
 	*/
 	Scene::Scene(
 		const std::string& name,
 		const int& width,
 		const int& height,
-		const float* bg_color) :
-		_impl(std::make_unique<Scene::SceneImpl>(name, width, height, bg_color))
+		const float* bg_color,
+		bool offscreen) :
+		_impl(std::make_unique<Scene::SceneImpl>(name, width, height, bg_color, offscreen))
 	{}
 
 	/**
@@ -346,9 +605,63 @@ namespace Graphics
 			return;
 		}
 
+		//Trails of the previous particles don't belong to the new ones
+		if (_impl->texture) _impl->texture->ReleaseTrails();
+
 		spdlog::info("Successfully initialized simulation render items: {}", name);
 	}
 
+	/**
+	* @details
+	* Pass the positions to the simulation render items if there are any.
+	*/
+	void Scene::UpdateSimulationPositions(const std::vector<float>& positions)
+	{
+		if (_impl->sim_render) _impl->sim_render->UpdatePositions(positions);
+	}
+
+	/**
+	* @details
+	* Pass the color mode to the simulation render items if there are any.
+	*/
+	void Scene::SetColorMode(
+		SimulationRenderStructs::ColorBy color_by,
+		SimulationRenderStructs::ColorMap color_map)
+	{
+		if (_impl->sim_render) _impl->sim_render->SetColorMode(color_by, color_map);
+	}
+
+	/**
+	* @details
+	* Pass the scalars to the simulation render items if there are any.
+	*/
+	void Scene::UpdateSimulationScalars(const std::vector<float>& scalars, float min, float max)
+	{
+		if (_impl->sim_render) _impl->sim_render->UpdateScalars(scalars, min, max);
+	}
+
+	/**
+	* @details
+	* Pass the layout to the simulation render items if there are any.
+	*/
+	void Scene::SetCompactInstances(bool compact)
+	{
+		if (_impl->sim_render) _impl->sim_render->SetCompactInstances(compact);
+	}
+
+	/**
+	* @details
+	* Turning the trails off deletes the trail frame buffer, so they take no
+	* memory while unused and start without history when turned back on.
+	*/
+	void Scene::SetTrails(bool enabled, float persistence)
+	{
+		_impl->trail_persistence = std::clamp(persistence, 0.0f, 0.999f);
+
+		if (!enabled && _impl->trails && _impl->texture) _impl->texture->ReleaseTrails();
+		_impl->trails = enabled;
+	}
+
 	/**
 	* @details
 	* Passes the color values to the render manager for rendering the scene.
@@ -360,23 +673,36 @@ namespace Graphics
 		glfwGetFramebufferSize(_impl->window, &display_w, &display_h);
 		glViewport(0, 0, display_w, display_h);
 		_impl->ApplyClearColor();
-
-		GLenum err = glGetError();
-		if (err != GL_NO_ERROR) spdlog::error("OpenGL error in Render: {}", err);
 	}
 
 	/**
 	* @details
-	* Render the simulation items.
+	* Render the simulation items and flush the batch renderer, so objects
+	* queued during the frame are drawn over the particles in as few draws as
+	* there are kinds of objects. With trails the simulation items go through
+	* the trail frame buffer, the objects never leave trails.
 	*/
 	void Scene::RenderSimulationItems()
 	{
-		if (_impl->sim_render) _impl->sim_render->Render();
+		if (_impl->sim_render && !(_impl->trails && _impl->RenderTrails()))
+			_impl->sim_render->Render();
+		if (_impl->batch_renderer) _impl->batch_renderer->Flush();
+	}
+
+	/**
+	* @details
+	* Get the batch renderer of the scene objects.
+	*/
+	BatchRenderer& Scene::GetBatchRenderer()
+	{
+		return *_impl->batch_renderer;
 	}
 
 	/**
 	* @details
-	* Render the texture for the ImGui render window.
+	* Render the texture for the ImGui render window. Also uploads the matrices
+	* the shaders share for this frame. The camera's view of the simulation,
+	* 2 / zoom wide, is drawn across the whole texture.
 	*/
 	void Scene::RenderTexture()
 	{
@@ -387,27 +713,121 @@ namespace Graphics
 			float ortho_width = 1.0f;
 			float ortho_height = ortho_width / aspect_ratio;
 
-			glm::mat4 projection = glm::ortho(
+			FrameUniforms uniforms;
+			uniforms.projection = glm::ortho(
 				-ortho_width, ortho_width,
 				-ortho_height, ortho_height,
 				-1.0f, 1.0f);
+			const Camera& camera = _impl->camera;
+			const float half_extent = 1.0f / camera.zoom;
+			uniforms.simulation_projection = glm::ortho(
+				camera.center_x - half_extent, camera.center_x + half_extent,
+				camera.center_y - half_extent, camera.center_y + half_extent,
+				-1.0f, 1.0f);
 
-			GLuint shader = _impl->shader->GetGLFWShader();
+			ShaderRegistry::Get().SetFrameUniforms(uniforms);
 
-			glUseProgram(shader);
+			//Render the objects and texture
+			_impl->texture->Render();
+		}
+	}
 
-			//Use the shader program
-			GLuint projection_loc = glGetUniformLocation(shader, "projection");
-			glUniformMatrix4fv(projection_loc, 1, GL_FALSE, glm::value_ptr(projection));
+	/**
+	* @details
+	* Keep the camera for the next texture render. A zoom that isn't positive
+	* is ignored.
+	*/
+	void Scene::SetCamera(const Camera& camera)
+	{
+		if (camera.zoom > 0.0f) _impl->camera = camera;
+	}
 
-			//Grab the OpenGL error and pass it to the error handler if there is one
-			GLenum err = glGetError();
-			if (err != GL_NO_ERROR)
-				spdlog::error("OpenGL error in RenderTexture: {}", err);
+	/**
+	* @details
+	* Stop any earlier capture and create a new one. A capture whose output
+	* can't be opened is closed again right away.
+	*/
+	bool Scene::StartCapture(const CaptureSettings& settings)
+	{
+		StopCapture();
 
-			//Render the objects and texture
-			_impl->texture->Render();
+		_impl->capture = std::make_unique<FrameCapture>(settings);
+		if (_impl->capture->GetErrorStatus())
+		{
+			StopCapture();
+			return false;
 		}
+		return true;
+	}
+
+	/**
+	* @details
+	* Close the capture, which waits for the readbacks in flight and encodes
+	* the queued frames, and log how many frames were written and dropped.
+	*/
+	void Scene::StopCapture()
+	{
+		if (_impl->capture == nullptr) return;
+
+		_impl->capture->Close();
+		spdlog::info(
+			"Capture stopped: {} frames written, {} dropped",
+			_impl->capture->GetWrittenFrames(),
+			_impl->capture->GetDroppedFrames());
+		_impl->capture.reset();
+	}
+
+	/**
+	* @details
+	* Get whether a capture is running.
+	*/
+	bool Scene::IsCapturing() const
+	{
+		return _impl->capture != nullptr;
+	}
+
+	/**
+	* @details
+	* Pass the texture's frame buffer to the capture. Call it after the
+	* simulation items were rendered into the texture.
+	*/
+	void Scene::CaptureTexture()
+	{
+		if (_impl->capture == nullptr || !_impl->texture) return;
+
+		_impl->capture->Capture(
+			_impl->texture->GetFramebufferId(),
+			_impl->texture->GetWidth(),
+			_impl->texture->GetHeight());
+	}
+
+	/**
+	* @details
+	* Bind the texture's frame buffer for reading and read it into the vector.
+	* glReadPixels waits for the rendering to finish, which a batch job can
+	* afford; the interactive app uses the asynchronous capture instead.
+	*/
+	void Scene::ReadTexturePixels(std::vector<unsigned char>& pixels) const
+	{
+		PROFILE_SCOPE("Texture Readback");
+
+		const int width = _impl->texture->GetWidth();
+		const int height = _impl->texture->GetHeight();
+		pixels.resize(size_t(width) * size_t(height) * 4);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, _impl->texture->GetFramebufferId());
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+
+	/**
+	* @details
+	* Get the width and height of the texture.
+	*/
+	std::pair<int, int> Scene::GetTextureSize() const
+	{
+		return std::pair<int, int>(_impl->texture->GetWidth(), _impl->texture->GetHeight());
 	}
 
 	/**
@@ -428,6 +848,19 @@ namespace Graphics
 		_impl->SwapBuffers();
 	}
 
+	/**
+	* @details
+	* The interval only goes to GLFW when it changes, the window's context is
+	* current on the calling thread.
+	*/
+	void Scene::SetSwapInterval(int interval)
+	{
+		if (_impl->window == nullptr || interval == _impl->swap_interval) return;
+
+		glfwSwapInterval(interval);
+		_impl->swap_interval = interval;
+	}
+
 	/**
 	* @details
 	* Get whether the window should close.
@@ -2,7 +2,9 @@
 * @file Scene.hpp
 * @brief
 * Function declarations to create and manage the scene. Uses the PIMPL idiom to
-* hide implementation details. Based on the OpenGL tutorial at:
+* hide implementation details. The scene renders into an offscreen texture, and
+* can run without a visible window so batch jobs render with the same shaders
+* as the interactive app. Based on the OpenGL tutorial at:
 * https://learnopengl.com/Getting-started/OpenGL
 */
 
@@ -26,12 +28,32 @@ namespace Graphics
 	
 	//Internal declarations
 
-	/// @brief Basic vertex shader for testing.
-	static const std::string BASE_VS_PATH =
-		"src/graphics/shaders/BaseVertexShader.vs";
-	/// @brief Basic fragment shader for testing.
-	static const std::string BASE_FS_PATH =
-		"src/graphics/shaders/BaseFragmentShader.fs";
+	/// @brief Forward declaration of CaptureSettings struct.
+	struct CaptureSettings;
+	/// @brief Forward declaration of BatchRenderer class.
+	class BatchRenderer;
+
+	/// @brief Simulation render structures namespace
+	namespace SimulationRenderStructs
+	{
+		/// @brief Forward declaration of ColorBy enumeration.
+		enum class ColorBy;
+		/// @brief Forward declaration of ColorMap enumeration.
+		enum class ColorMap;
+	}
+
+	/**
+	* @brief Structure to hold the 2D camera of the render window.
+	* @param center_x The simulation x coordinate shown at the center of the view.
+	* @param center_y The simulation y coordinate shown at the center of the view.
+	* @param zoom The magnification, 1 shows the whole simulation box.
+	*/
+	struct Camera
+	{
+		float center_x = 0.0f;
+		float center_y = 0.0f;
+		float zoom = 1.0f;
+	};
 
 	/// @brief Simulation types enumeration
 	enum SimulationTypes
@@ -62,12 +84,14 @@ namespace Graphics
 		* @param width The width of the scene window.
 		* @param height The height of the scene window.
 		* @param bg_color The background color of the scene.
+		* @param offscreen True to create a hidden window with an OSMesa or EGL context.
 		*/
 		Scene(
 			const std::string& name,
 			const int& width,
 			const int& height,
-			const float* bg_color);
+			const float* bg_color,
+			bool offscreen = false);
 
 		//Default constructors/destructor
 
@@ -107,21 +131,106 @@ namespace Graphics
 			std::vector<float>& particles,
 			const float radius);
 
+		/**
+		* @brief Update the particle positions of the simulation render items.
+		* @param positions Three floats (x, y, z) per particle.
+		*/
+		void UpdateSimulationPositions(const std::vector<float>& positions);
+
+		/**
+		* @brief Set how the simulation render items color the particles.
+		* @param color_by The property the colors are taken from.
+		* @param color_map The colormap of the scalar properties.
+		*/
+		void SetColorMode(
+			SimulationRenderStructs::ColorBy color_by,
+			SimulationRenderStructs::ColorMap color_map);
+
+		/**
+		* @brief Update the per particle scalars of the simulation render items.
+		* @param scalars One scalar per particle.
+		* @param min The scalar at the start of the colormap.
+		* @param max The scalar at the end of the colormap.
+		*/
+		void UpdateSimulationScalars(const std::vector<float>& scalars, float min, float max);
+
+		/**
+		* @brief Choose the compact quantized instance layout of the simulation render items.
+		* @param compact True for the compact layout, false for the float layouts.
+		*/
+		void SetCompactInstances(bool compact);
+
+		/**
+		* @brief Let the particles leave fading trails, accumulated across frames.
+		* @param enabled True to draw trails, false to draw only the current positions.
+		* @param persistence Fraction of the trails kept every frame, in [0, 1).
+		*/
+		void SetTrails(bool enabled, float persistence);
+
 		/// @brief Poll the OpenGL events and process them.
 		void PollEvents();
 
 		/// @brief Render the scene.
 		void Render();
 
-		/// @brief Render the simulation items.
+		/// @brief Render the simulation items, then the objects queued in the batch renderer.
 		void RenderSimulationItems();
 
+		/**
+		* @brief Get the batch renderer objects are queued in, drawn after the simulation items.
+		* @return Reference to the batch renderer.
+		*/
+		BatchRenderer& GetBatchRenderer();
+
 		/// @brief Render the texture for the ImGui render window.
 		void RenderTexture();
 
+		/**
+		* @brief Set the camera the simulation is viewed through, from the next texture render on.
+		* @param camera The camera.
+		*/
+		void SetCamera(const Camera& camera);
+
+		/**
+		* @brief Start capturing the texture every frame, stopping any earlier capture.
+		* @param settings The settings of the capture.
+		* @return True if the capture started, false otherwise.
+		*/
+		bool StartCapture(const CaptureSettings& settings);
+
+		/// @brief Stop capturing and report what was written.
+		void StopCapture();
+
+		/**
+		* @brief Check if the texture is being captured.
+		* @return True while capturing, false otherwise.
+		*/
+		bool IsCapturing() const;
+
+		/// @brief Queue an asynchronous readback of the texture if capturing.
+		void CaptureTexture();
+
+		/**
+		* @brief Read the texture back, waiting for the GPU. Meant for batch rendering.
+		* @param pixels Set to the pixels, four bytes each, bottom row first.
+		*/
+		void ReadTexturePixels(std::vector<unsigned char>& pixels) const;
+
+		/**
+		* @brief Get the size of the texture.
+		* @return The width and height of the texture.
+		*/
+		std::pair<int, int> GetTextureSize() const;
+
 		/// @brief Swap the buffers.
 		void SwapBuffers() const;
 
+		/**
+		* @brief Set the number of display refreshes a buffer swap waits for.
+		* @param interval 1 for vertical sync, 0 to swap right away.
+		*/
+		void SetSwapInterval(int interval);
+
 		/**
 		* @brief Check if the window should close.
 		* @return True if the window should close, false otherwise.
@@ -11,12 +11,37 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 /// @brief Scene namespace
 namespace Graphics
 {
+	/// @brief Magic number at the start of a program binary cache file, "PSPB".
+	static constexpr uint32_t PROGRAM_CACHE_MAGIC = 0x42505350;
+
+	/**
+	* @details
+	* Continue a 64 bit FNV-1a hash over the text and a terminating zero, so
+	* consecutive strings can't run into each other.
+	*/
+	static uint64_t HashText(const char* text, uint64_t hash)
+	{
+		if (text != nullptr)
+		{
+			for (; *text != '\0'; text++)
+			{
+				hash ^= uint8_t(*text);
+				hash *= 0x100000001b3ULL;
+			}
+		}
+		return hash * 0x100000001b3ULL;
+	}
+
 	/// @brief Shader PIMPL implementation structure.
 	struct Shader::ShaderImpl
 	{
@@ -37,10 +62,16 @@ namespace Graphics
 
 		/**
 		* @brief Custom constructor for the ShaderImpl class.
-		* @param vs_file The vertex shader file.
-		* @param fs_file The fragment shader file.
+		* @param name The name of the shader.
+		* @param vertex_code The vertex shader source.
+		* @param fragment_code The fragment shader source.
+		* @param cache_path The program binary file, empty to always compile.
 		*/
-		ShaderImpl(const std::string& vs_file, const std::string& fs_file);
+		ShaderImpl(
+			const std::string& name,
+			const std::string& vertex_code,
+			const std::string& fragment_code,
+			const std::string& cache_path);
 
 		//Default constructors/destructor
 
@@ -56,81 +87,93 @@ namespace Graphics
 		*/
 		void CheckCompileErrors(unsigned int& shader, std::string type);
 
+		/**
+		* @brief
+		* Key of the program binary. Binaries only load on the driver that wrote
+		* them, so the key covers the driver strings as well as the sources.
+		* @param vertex_code The vertex shader source.
+		* @param fragment_code The fragment shader source.
+		* @return The key of the program binary.
+		*/
+		uint64_t BinaryKey(
+			const std::string& vertex_code,
+			const std::string& fragment_code) const;
+
+		/**
+		* @brief Load the program from the cache file.
+		* @param key The key the cached binary must have been written with.
+		* @return True if the program was loaded, false if it must be compiled.
+		*/
+		bool LoadBinary(uint64_t key);
+
+		/**
+		* @brief Write the program binary to the cache file.
+		* @param key The key of the program binary.
+		*/
+		void SaveBinary(uint64_t key) const;
+
+		/**
+		* @brief Compile and link the program.
+		* @param vertex_code The vertex shader source.
+		* @param fragment_code The fragment shader source.
+		* @param retrievable True to keep the binary so it can be cached.
+		*/
+		void Compile(
+			const std::string& vertex_code,
+			const std::string& fragment_code,
+			bool retrievable);
+
+		/// @brief Look up the locations of the active uniforms.
+		void ResolveUniforms();
+
 		//Member variables
 
+		/// @brief Name of the shader.
+		std::string name;
+		/// @brief Program binary cache file, empty if the program isn't cached.
+		std::string cache_path;
 		/// @brief OpenGL shader ID.
-		GLuint shader;
+		GLuint shader = 0;
+		/// @brief Locations of the active uniforms by name.
+		std::unordered_map<std::string, GLint> uniforms;
+		/// @brief Flag set when the program was loaded from the cache.
+		bool from_cache = false;
 		/// @brief Error status of the shader.
 		bool error_status = false;
 	};
 
 	/**
 	* @details
-	* Custom constructor for the ShaderImpl class. Reads the vertex and fragment
-	* shader files and compiles them into an OpenGL shader program.
+	* Custom constructor for the ShaderImpl class. Program binaries are core
+	* since OpenGL 4.1 and drivers may support no binary format at all, older
+	* contexts always compile the sources. A compiled program is written back to
+	* the cache so the next run can skip compiling.
 	*/
 	Shader::ShaderImpl::ShaderImpl(
-		const std::string& vs_file,
-		const std::string& fs_file)
+		const std::string& name,
+		const std::string& vertex_code,
+		const std::string& fragment_code,
+		const std::string& cache_path) :
+		name(name),
+		cache_path(cache_path)
 	{
-		spdlog::info(
-			"Creating OpenGL shader for files vs: {}, fs: {}",
-			vs_file,
-			fs_file);
+		spdlog::info("Creating OpenGL shader: {}", name);
 
-		std::ifstream vertex_shader_file;
-		std::ifstream fragment_shader_file;
-		std::stringstream vertex_shader_stream;
-		std::stringstream fragment_shader_stream;
+		GLint formats = 0;
+		if (!cache_path.empty() && GLAD_GL_VERSION_4_1)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
 
-		vertex_shader_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fragment_shader_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+		const bool cacheable = formats > 0;
+		const uint64_t key = cacheable ? BinaryKey(vertex_code, fragment_code) : 0;
 
-		try
+		from_cache = cacheable && LoadBinary(key);
+		if (!from_cache)
 		{
-			vertex_shader_file.open(vs_file);
-			fragment_shader_file.open(fs_file);
-
-			vertex_shader_stream << vertex_shader_file.rdbuf();
-			fragment_shader_stream << fragment_shader_file.rdbuf();
-
-			vertex_shader_file.close();
-			fragment_shader_file.close();
+			Compile(vertex_code, fragment_code, cacheable);
+			if (!error_status && cacheable) SaveBinary(key);
 		}
-		catch (std::ifstream::failure& e)
-		{
-			spdlog::error("ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: {}", e.what());
-			spdlog::error("Vertex shader file: {}", vs_file);
-			spdlog::error("Fragment shader file: {}", fs_file);
-			error_status = true;
-			return;
-		}
-
-		std::string vertex_code = vertex_shader_stream.str();
-		std::string fragment_code = fragment_shader_stream.str();
-		const char* vertex_shader_code = vertex_code.c_str();
-		const char* fragment_shader_code = fragment_code.c_str();
 
-		unsigned int vertex, fragment;
-
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vertex_shader_code, nullptr);
-		glCompileShader(vertex);
-		CheckCompileErrors(vertex, "VERTEX");
-
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fragment_shader_code, nullptr);
-		glCompileShader(fragment);
-		CheckCompileErrors(fragment, "FRAGMENT");
-
-		shader = glCreateProgram();
-		glAttachShader(shader, vertex);
-		glAttachShader(shader, fragment);
-		glLinkProgram(shader);
-		CheckCompileErrors(shader, "PROGRAM");
-
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
+		if (!error_status) ResolveUniforms();
 
 		GLenum err = glGetError();
 		if (err != GL_NO_ERROR)
@@ -139,7 +182,13 @@ namespace Graphics
 			error_status = true;
 		}
 
-		spdlog::info("Successfully created OpenGL shader");
+		if (!error_status)
+		{
+			spdlog::info(
+				"Successfully created OpenGL shader: {} ({})",
+				name,
+				from_cache ? "cached binary" : "compiled");
+		}
 	}
 
 	/**
@@ -190,11 +239,207 @@ namespace Graphics
 
 	/**
 	* @details
-	* Custom shader constructor. Passes the vertex and fragment shader files to
-	* the PIMPL implementation.
+	* Hash the sources and the vendor, renderer and version strings, which
+	* change with every driver update.
+	*/
+	uint64_t Shader::ShaderImpl::BinaryKey(
+		const std::string& vertex_code,
+		const std::string& fragment_code) const
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		hash = HashText(vertex_code.c_str(), hash);
+		hash = HashText(fragment_code.c_str(), hash);
+		hash = HashText((const char*)glGetString(GL_VENDOR), hash);
+		hash = HashText((const char*)glGetString(GL_RENDERER), hash);
+		hash = HashText((const char*)glGetString(GL_VERSION), hash);
+		return hash;
+	}
+
+	/**
+	* @details
+	* Read the cache file, a header with the magic number, key, binary format
+	* and length followed by the binary, and hand the binary to the driver. A
+	* missing or stale file, or a binary the driver rejects, makes the caller
+	* compile instead.
+	*/
+	bool Shader::ShaderImpl::LoadBinary(uint64_t key)
+	{
+		std::ifstream file(cache_path, std::ios::binary);
+		if (!file) return false;
+
+		uint32_t magic = 0;
+		uint64_t file_key = 0;
+		uint32_t format = 0;
+		uint32_t length = 0;
+		file.read((char*)&magic, sizeof(magic));
+		file.read((char*)&file_key, sizeof(file_key));
+		file.read((char*)&format, sizeof(format));
+		file.read((char*)&length, sizeof(length));
+
+		if (!file || magic != PROGRAM_CACHE_MAGIC || length == 0) return false;
+		if (file_key != key)
+		{
+			spdlog::info("Cached program binary for shader {} is out of date", name);
+			return false;
+		}
+
+		std::vector<char> binary(length);
+		file.read(binary.data(), length);
+		if (!file) return false;
+
+		shader = glCreateProgram();
+		glProgramBinary(shader, format, binary.data(), GLsizei(length));
+
+		GLint success = GL_FALSE;
+		glGetProgramiv(shader, GL_LINK_STATUS, &success);
+		if (success == GL_TRUE) return true;
+
+		spdlog::warn("Cached program binary for shader {} was rejected", name);
+		glDeleteProgram(shader);
+		shader = 0;
+		return false;
+	}
+
+	/**
+	* @details
+	* Write the binary to a temporary file and rename it over the cache file,
+	* so a run that stops halfway never leaves a truncated binary behind. A
+	* cache that can't be written only costs the next run a compile.
+	*/
+	void Shader::ShaderImpl::SaveBinary(uint64_t key) const
+	{
+		GLint length = 0;
+		glGetProgramiv(shader, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(shader, length, &length, &format, binary.data());
+		if (length <= 0) return;
+
+		const std::filesystem::path path(cache_path);
+		std::error_code error;
+		if (path.has_parent_path())
+			std::filesystem::create_directories(path.parent_path(), error);
+
+		const std::string temporary_path = cache_path + ".tmp";
+		{
+			const uint32_t magic = PROGRAM_CACHE_MAGIC;
+			const uint32_t binary_format = format;
+			const uint32_t binary_length = uint32_t(length);
+
+			std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&magic, sizeof(magic));
+			file.write((const char*)&key, sizeof(key));
+			file.write((const char*)&binary_format, sizeof(binary_format));
+			file.write((const char*)&binary_length, sizeof(binary_length));
+			file.write(binary.data(), length);
+
+			if (!file)
+			{
+				spdlog::warn("Failed to write program binary cache: {}", temporary_path);
+				return;
+			}
+		}
+
+		std::filesystem::rename(temporary_path, path, error);
+		if (error)
+		{
+			spdlog::warn(
+				"Failed to write program binary cache: {} ({})",
+				cache_path,
+				error.message());
+		}
+	}
+
+	/**
+	* @details
+	* Compile the vertex and fragment shaders and link them into a program.
+	* The retrievable hint must be set before linking for the driver to keep
+	* the binary.
 	*/
-	Shader::Shader(const std::string& vs_file, const std::string& fs_file) :
-		_impl(make_unique<ShaderImpl>(vs_file, fs_file))
+	void Shader::ShaderImpl::Compile(
+		const std::string& vertex_code,
+		const std::string& fragment_code,
+		bool retrievable)
+	{
+		const char* vertex_shader_code = vertex_code.c_str();
+		const char* fragment_shader_code = fragment_code.c_str();
+
+		unsigned int vertex, fragment;
+
+		vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertex, 1, &vertex_shader_code, nullptr);
+		glCompileShader(vertex);
+		CheckCompileErrors(vertex, "VERTEX");
+
+		fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragment, 1, &fragment_shader_code, nullptr);
+		glCompileShader(fragment);
+		CheckCompileErrors(fragment, "FRAGMENT");
+
+		shader = glCreateProgram();
+		glAttachShader(shader, vertex);
+		glAttachShader(shader, fragment);
+		if (retrievable)
+			glProgramParameteri(shader, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(shader);
+		CheckCompileErrors(shader, "PROGRAM");
+
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+	}
+
+	/**
+	* @details
+	* Query every active uniform once so drawing never calls
+	* glGetUniformLocation. Members of uniform blocks have no location and are
+	* skipped. Arrays are reported as name[0] and are also stored by their bare
+	* name.
+	*/
+	void Shader::ShaderImpl::ResolveUniforms()
+	{
+		GLint count = 0;
+		GLint max_length = 0;
+		glGetProgramiv(shader, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(shader, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+		std::vector<char> buffer(std::max(max_length, 1));
+		for (GLint i = 0; i < count; i++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(
+				shader,
+				GLuint(i),
+				GLsizei(buffer.size()),
+				&length,
+				&size,
+				&type,
+				buffer.data());
+
+			const std::string uniform(buffer.data(), length);
+			const GLint location = glGetUniformLocation(shader, uniform.c_str());
+			if (location == -1) continue;
+
+			uniforms[uniform] = location;
+			if (uniform.ends_with("[0]"))
+				uniforms[uniform.substr(0, uniform.size() - 3)] = location;
+		}
+	}
+
+	/**
+	* @details
+	* Custom shader constructor. Passes the name, sources and cache path to the
+	* PIMPL implementation.
+	*/
+	Shader::Shader(
+		const std::string& name,
+		const std::string& vertex_code,
+		const std::string& fragment_code,
+		const std::string& cache_path) :
+		_impl(make_unique<ShaderImpl>(name, vertex_code, fragment_code, cache_path))
 	{}
 
 	/**
@@ -226,4 +471,22 @@ namespace Graphics
 	{
 		return _impl->shader;
 	}
+	/**
+	* @details
+	* Get whether the program was loaded from the program binary cache.
+	*/
+	bool Shader::IsFromCache() const
+	{
+		return _impl->from_cache;
+	}
+
+	/**
+	* @details
+	* Look the uniform up in the locations resolved after linking.
+	*/
+	int Shader::GetUniformLocation(const std::string& name) const
+	{
+		auto it = _impl->uniforms.find(name);
+		return it != _impl->uniforms.end() ? it->second : -1;
+	}
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 /**
 * @file Shader.hpp
 * @brief
-* Function declarations to create and manage shaders. Uses the PIMPL idiom to hide
-* implementation details.
+* Function declarations to create and manage shaders. Programs are built from
+* sources held in memory and, when a cache path is given and the driver
+* supports it, stored as a program binary that later runs load instead of
+* compiling again. Uniform locations are looked up once after linking. Uses the
+* PIMPL idiom to hide implementation details.
 */
 
 #pragma once
@@ -42,11 +45,21 @@ namespace Graphics
 		//Custom constructors
 		
 		/**
-		* @brief Custom constructor for the Shader class.
-		* @param vs_file The vertex shader file.
-		* @param fs_file The fragment shader file.
+		* @brief
+		* Custom constructor for the Shader class. Loads the program binary from
+		* the cache path if it was built from the same sources by the same
+		* driver, and compiles the sources otherwise. The OpenGL context must be
+		* current.
+		* @param name The name of the shader, used in log messages.
+		* @param vertex_code The vertex shader source.
+		* @param fragment_code The fragment shader source.
+		* @param cache_path The program binary file, empty to always compile.
 		*/
-		Shader(const std::string& vs_file, const std::string& fs_file);
+		Shader(
+			const std::string& name,
+			const std::string& vertex_code,
+			const std::string& fragment_code,
+			const std::string& cache_path = "");
 
 		//Default constructors/destructor
 
@@ -69,6 +82,19 @@ namespace Graphics
 		*/
 		unsigned int& GetGLFWShader();
 
+		/**
+		* @brief Get whether the program was loaded from the program binary cache.
+		* @return True if the program was loaded from the cache, false if it was compiled.
+		*/
+		bool IsFromCache() const;
+
+		/**
+		* @brief Get the location of an active uniform, resolved when the program was linked.
+		* @param name The name of the uniform.
+		* @return The location of the uniform, -1 if the program has no such uniform.
+		*/
+		int GetUniformLocation(const std::string& name) const;
+
 		//PIMPL idiom
 	private:
 		/// @brief Forward declaration of ShaderImpl.
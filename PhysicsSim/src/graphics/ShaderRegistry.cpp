@@ -0,0 +1,309 @@
+/**
+* @file ShaderRegistry.cpp
+* @brief
+* Function definitions for the ShaderRegistry class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "ShaderRegistry.hpp"
+
+#include "graphics/Shader.hpp"
+#include "utils/GlfwIncludes.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <unordered_map>
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	/// @brief Source of the base vertex shader.
+	static const char* BASE_VERTEX_SOURCE =
+#include "shaders/BaseVertexShader.vs"
+		;
+	/// @brief Source of the base fragment shader.
+	static const char* BASE_FRAGMENT_SOURCE =
+#include "shaders/BaseFragmentShader.fs"
+		;
+	/// @brief Source of the instanced object vertex shader, drawn with the particle fragment shader.
+	static const char* OBJECT_INSTANCED_VERTEX_SOURCE =
+#include "shaders/ObjectInstancedVertexShader.vs"
+		;
+	/// @brief Source of the particle vertex shader.
+	static const char* PARTICLE_VERTEX_SOURCE =
+#include "shaders/ParticleVertexShader.vs"
+		;
+	/// @brief Source of the particle fragment shader.
+	static const char* PARTICLE_FRAGMENT_SOURCE =
+#include "shaders/ParticleFragmentShader.fs"
+		;
+	/// @brief Source of the density splat vertex shader.
+	static const char* DENSITY_SPLAT_VERTEX_SOURCE =
+#include "shaders/DensitySplatVertexShader.vs"
+		;
+	/// @brief Source of the density splat fragment shader.
+	static const char* DENSITY_SPLAT_FRAGMENT_SOURCE =
+#include "shaders/DensitySplatFragmentShader.fs"
+		;
+	/// @brief Source of the density resolve vertex shader.
+	static const char* DENSITY_RESOLVE_VERTEX_SOURCE =
+#include "shaders/DensityResolveVertexShader.vs"
+		;
+	/// @brief Source of the density resolve fragment shader.
+	static const char* DENSITY_RESOLVE_FRAGMENT_SOURCE =
+#include "shaders/DensityResolveFragmentShader.fs"
+		;
+	/// @brief Source of the trail fade fragment shader, drawn with the density resolve vertex shader.
+	static const char* TRAIL_FADE_FRAGMENT_SOURCE =
+#include "shaders/TrailFadeFragmentShader.fs"
+		;
+	/// @brief Source of the trail composite fragment shader, drawn with the density resolve vertex shader.
+	static const char* TRAIL_COMPOSITE_FRAGMENT_SOURCE =
+#include "shaders/TrailCompositeFragmentShader.fs"
+		;
+
+	static_assert(
+		sizeof(FrameUniforms) == 2 * 16 * sizeof(float),
+		"FrameUniforms must match the std140 layout of the uniform block");
+
+	/// @brief ShaderRegistry PIMPL implementation structure.
+	struct ShaderRegistry::ShaderRegistryImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		ShaderRegistryImpl(const ShaderRegistryImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ShaderRegistryImpl& operator=(const ShaderRegistryImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		ShaderRegistryImpl(const ShaderRegistryImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ShaderRegistryImpl& operator=(const ShaderRegistryImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		ShaderRegistryImpl() = default;
+		/// @brief Default destructor.
+		~ShaderRegistryImpl() = default;
+
+		//Member methods
+
+		/**
+		* @brief Find the embedded sources of a shader.
+		* @param name The name of the shader.
+		* @param vertex_code Set to the vertex shader source.
+		* @param fragment_code Set to the fragment shader source.
+		* @return True if the shader exists, false otherwise.
+		*/
+		static bool FindSources(
+			const std::string& name,
+			const char*& vertex_code,
+			const char*& fragment_code);
+
+		//Member variables
+
+		/// @brief Directory of the program binary cache, empty if caching is disabled.
+		std::string cache_directory;
+		/// @brief Shaders built so far by name.
+		std::unordered_map<std::string, std::shared_ptr<Shader>> shaders;
+		/// @brief Uniform buffer holding the FrameUniforms block.
+		GLuint frame_buffer = 0;
+		/// @brief Matrices last uploaded to the uniform buffer.
+		FrameUniforms frame_uniforms;
+	};
+
+	/**
+	* @details
+	* Match the name against the shaders compiled into the binary.
+	*/
+	bool ShaderRegistry::ShaderRegistryImpl::FindSources(
+		const std::string& name,
+		const char*& vertex_code,
+		const char*& fragment_code)
+	{
+		if (name == BASE_SHADER)
+		{
+			vertex_code = BASE_VERTEX_SOURCE;
+			fragment_code = BASE_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == PARTICLE_SHADER)
+		{
+			vertex_code = PARTICLE_VERTEX_SOURCE;
+			fragment_code = PARTICLE_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == DENSITY_SPLAT_SHADER)
+		{
+			vertex_code = DENSITY_SPLAT_VERTEX_SOURCE;
+			fragment_code = DENSITY_SPLAT_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == DENSITY_RESOLVE_SHADER)
+		{
+			vertex_code = DENSITY_RESOLVE_VERTEX_SOURCE;
+			fragment_code = DENSITY_RESOLVE_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == OBJECT_INSTANCED_SHADER)
+		{
+			vertex_code = OBJECT_INSTANCED_VERTEX_SOURCE;
+			fragment_code = PARTICLE_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == TRAIL_FADE_SHADER)
+		{
+			vertex_code = DENSITY_RESOLVE_VERTEX_SOURCE;
+			fragment_code = TRAIL_FADE_FRAGMENT_SOURCE;
+			return true;
+		}
+		if (name == TRAIL_COMPOSITE_SHADER)
+		{
+			vertex_code = DENSITY_RESOLVE_VERTEX_SOURCE;
+			fragment_code = TRAIL_COMPOSITE_FRAGMENT_SOURCE;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	* @details
+	* Constructor for the ShaderRegistry class. Initializes the PIMPL pointer.
+	*/
+	ShaderRegistry::ShaderRegistry() :
+		_impl(std::make_unique<ShaderRegistryImpl>())
+	{}
+
+	/**
+	* @details
+	* Default destructor for the ShaderRegistry class. The shaders and buffer
+	* must have been released with Shutdown while the context was alive.
+	*/
+	ShaderRegistry::~ShaderRegistry() = default;
+
+	/**
+	* @details
+	* Get the application wide shader registry. Constructed on first use.
+	*/
+	ShaderRegistry& ShaderRegistry::Get()
+	{
+		static ShaderRegistry registry;
+		return registry;
+	}
+
+	/**
+	* @details
+	* Create the uniform buffer with identity matrices and attach it to its
+	* binding point, where it stays for the life of the context.
+	*/
+	void ShaderRegistry::Init(const std::string& cache_directory)
+	{
+		_impl->cache_directory = cache_directory;
+
+		if (_impl->frame_buffer) return;
+
+		const FrameUniforms uniforms;
+		_impl->frame_uniforms = uniforms;
+		glGenBuffers(1, &_impl->frame_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, _impl->frame_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(uniforms), &uniforms, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, _impl->frame_buffer);
+	}
+
+	/**
+	* @details
+	* Drop the registry's references to the shaders, which deletes the
+	* programs nobody else holds, and delete the uniform buffer.
+	*/
+	void ShaderRegistry::Shutdown()
+	{
+		for (const auto& [name, shader] : _impl->shaders)
+		{
+			if (shader.use_count() > 1)
+				spdlog::warn("Shader {} is still in use at shutdown", name);
+		}
+		_impl->shaders.clear();
+
+		if (_impl->frame_buffer)
+		{
+			glDeleteBuffers(1, &_impl->frame_buffer);
+			_impl->frame_buffer = 0;
+		}
+	}
+
+	/**
+	* @details
+	* Return the shared shader if it was built already. Otherwise build it from
+	* its embedded sources, through the program binary cache when it is
+	* enabled, and bind its FrameUniforms block to the frame uniform buffer and
+	* its SpeciesUniforms block, if it has one, to the species binding point.
+	* Shaders that failed to build are kept too, so they aren't rebuilt on
+	* every request; callers check their error status.
+	*/
+	std::shared_ptr<Shader> ShaderRegistry::GetShader(const std::string& name)
+	{
+		auto it = _impl->shaders.find(name);
+		if (it != _impl->shaders.end()) return it->second;
+
+		const char* vertex_code = nullptr;
+		const char* fragment_code = nullptr;
+		if (!ShaderRegistryImpl::FindSources(name, vertex_code, fragment_code))
+		{
+			spdlog::error("Unknown shader: {}", name);
+			return nullptr;
+		}
+
+		const std::string cache_path = _impl->cache_directory.empty() ?
+			std::string() :
+			_impl->cache_directory + "/" + name + ".bin";
+
+		auto shader = std::make_shared<Shader>(
+			name,
+			vertex_code,
+			fragment_code,
+			cache_path);
+
+		if (!shader->GetErrorStatus())
+		{
+			GLuint program = shader->GetGLFWShader();
+			GLuint block = glGetUniformBlockIndex(program, "FrameUniforms");
+			if (block != GL_INVALID_INDEX)
+				glUniformBlockBinding(program, block, FRAME_UNIFORMS_BINDING);
+
+			block = glGetUniformBlockIndex(program, "SpeciesUniforms");
+			if (block != GL_INVALID_INDEX)
+				glUniformBlockBinding(program, block, SPECIES_UNIFORMS_BINDING);
+		}
+
+		_impl->shaders.emplace(name, shader);
+		return shader;
+	}
+
+	/**
+	* @details
+	* Overwrite the whole uniform buffer. Every shader reads the block through
+	* the same binding point, so one upload serves all draws of the frame.
+	*/
+	void ShaderRegistry::SetFrameUniforms(const FrameUniforms& uniforms)
+	{
+		if (!_impl->frame_buffer) return;
+
+		_impl->frame_uniforms = uniforms;
+
+		glBindBuffer(GL_UNIFORM_BUFFER, _impl->frame_buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(uniforms), &uniforms);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+	/**
+	* @details
+	* Get the copy of the matrices kept when they were uploaded.
+	*/
+	const FrameUniforms& ShaderRegistry::GetFrameUniforms() const
+	{
+		return _impl->frame_uniforms;
+	}
+}
\ No newline at end of file
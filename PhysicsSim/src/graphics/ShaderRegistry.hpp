@@ -0,0 +1,144 @@
+/**
+* @file ShaderRegistry.hpp
+* @brief
+* Class declaration for the shader registry. Builds the shader programs from
+* sources embedded in the binary, so nothing depends on the working directory,
+* and shares one program per shader between its users. Linked programs are
+* cached on disk as program binaries to skip compiling on later runs. Also owns
+* the uniform buffer with the matrices every shader shares, updated once per
+* frame. Must only be used on the thread that owns the OpenGL context. Uses the
+* PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _SHADERREGISTRY_
+#define _SHADERREGISTRY_
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Forward declaration of Shader class.
+	class Shader;
+
+	/// @brief Name of the shader for the scene objects.
+	static const std::string BASE_SHADER = "Base";
+	/// @brief Name of the shader for the scene objects batched into instanced draws.
+	static const std::string OBJECT_INSTANCED_SHADER = "ObjectInstanced";
+	/// @brief Name of the shader for the instanced particles.
+	static const std::string PARTICLE_SHADER = "Particle";
+	/// @brief Name of the shader adding particles up into a density texture.
+	static const std::string DENSITY_SPLAT_SHADER = "DensitySplat";
+	/// @brief Name of the shader drawing a density texture over the scene.
+	static const std::string DENSITY_RESOLVE_SHADER = "DensityResolve";
+	/// @brief Name of the shader fading the particle trails.
+	static const std::string TRAIL_FADE_SHADER = "TrailFade";
+	/// @brief Name of the shader drawing the particle trails over the scene.
+	static const std::string TRAIL_COMPOSITE_SHADER = "TrailComposite";
+	/// @brief Default directory of the program binary cache.
+	static const std::string SHADER_CACHE_DIRECTORY = "shader_cache";
+
+	/**
+	* @brief Structure matching the std140 FrameUniforms block of the shaders.
+	* @param projection Projection of the render texture, corrected for its aspect ratio.
+	* @param simulation_projection Projection of simulation coordinates onto the render texture.
+	*/
+	struct FrameUniforms
+	{
+		glm::mat4 projection = glm::mat4(1.0f);
+		glm::mat4 simulation_projection = glm::mat4(1.0f);
+	};
+
+	/// @brief ShaderRegistry class
+	class ShaderRegistry
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		ShaderRegistry(const ShaderRegistry& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ShaderRegistry& operator=(const ShaderRegistry& other) = delete;
+		/// @brief Deleted move constructor.
+		ShaderRegistry(const ShaderRegistry&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ShaderRegistry& operator=(const ShaderRegistry&& other) = delete;
+
+		/// @brief Uniform buffer binding point of the FrameUniforms block.
+		static constexpr unsigned int FRAME_UNIFORMS_BINDING = 0;
+		/// @brief Uniform buffer binding point of the SpeciesUniforms block, owned by the render items.
+		static constexpr unsigned int SPECIES_UNIFORMS_BINDING = 1;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		ShaderRegistry();
+		/// @brief Destructor
+		~ShaderRegistry();
+
+		//Member methods
+
+		/**
+		* @brief Get the application wide shader registry.
+		* @return Reference to the shader registry.
+		*/
+		static ShaderRegistry& Get();
+
+		/**
+		* @brief
+		* Create the frame uniform buffer. Must be called once the OpenGL context
+		* is current and loaded.
+		* @param cache_directory The directory of the program binary cache, empty to disable it.
+		*/
+		void Init(const std::string& cache_directory = SHADER_CACHE_DIRECTORY);
+
+		/**
+		* @brief
+		* Release the shaders and delete the frame uniform buffer. Must be called
+		* before the context is destroyed, after the users of the shaders released them.
+		*/
+		void Shutdown();
+
+		/**
+		* @brief Get a shader, building it on first use.
+		* @param name The name of the shader.
+		* @return Shared pointer to the shader, null if there is no shader with that name.
+		*/
+		std::shared_ptr<Shader> GetShader(const std::string& name);
+
+		/**
+		* @brief Upload the matrices shared by the shaders for this frame.
+		* @param uniforms The matrices shared by the shaders.
+		*/
+		void SetFrameUniforms(const FrameUniforms& uniforms);
+
+		/**
+		* @brief Get the matrices shared by the shaders for this frame.
+		* @return The matrices last uploaded.
+		*/
+		const FrameUniforms& GetFrameUniforms() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of ShaderRegistryImpl struct.
+		struct ShaderRegistryImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<ShaderRegistryImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
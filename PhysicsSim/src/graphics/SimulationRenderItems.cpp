@@ -8,6 +8,7 @@
 #include "SimulationRenderItems.hpp"
 
 #include "graphics/Shader.hpp"
+#include "graphics/ShaderRegistry.hpp"
 
 /// @brief Graphics namespace
 namespace Graphics
@@ -35,12 +36,9 @@ namespace Graphics
 
 			/**
 			* @brief Custom constructor for the SimulationRenderItemsImpl class.
-			* @param vs_file The vertex shader file.
-			* @param fs_file The fragment shader file.
+			* @param shader_name The name of the shader in the shader registry.
 			*/
-			SimulationRenderItemsImpl(
-				const std::string& vs_file,
-				const std::string& fs_file);
+			explicit SimulationRenderItemsImpl(const std::string& shader_name);
 
 			//Default constructors/destructor
 
@@ -57,13 +55,12 @@ namespace Graphics
 
 		/**
 		* @details
-		* Custom constructor for the SimulationRenderItemsImpl class. Initializes
-		* the shader object with the vertex and fragment shader files.
+		* Custom constructor for the SimulationRenderItemsImpl class. Gets the
+		* shader from the shader registry, which shares it with other users.
 		*/
 		SimulationRenderItems::SimulationRenderItemsImpl::SimulationRenderItemsImpl(
-			const std::string& vs_file,
-			const std::string& fs_file) :
-			shader(std::make_shared<Shader>(vs_file, fs_file))
+			const std::string& shader_name) :
+			shader(ShaderRegistry::Get().GetShader(shader_name))
 		{}
 
 		SimulationRenderItems::SimulationRenderItemsImpl::~SimulationRenderItemsImpl() = default;
@@ -71,15 +68,12 @@ namespace Graphics
 		/**
 		* @details
 		* Custom constructor for the SimulationRenderItems class. Passes the
-		* vertex and fragment to the PIMPL implementation.
+		* shader name to the PIMPL implementation.
 		*/
-		SimulationRenderItems::SimulationRenderItems(
-			const std::string& vs_file,
-			const std::string& fs_file) :
+		SimulationRenderItems::SimulationRenderItems(const std::string& shader_name) :
 			_impl(
 				std::make_unique<SimulationRenderItems::SimulationRenderItemsImpl>(
-					vs_file,
-					fs_file))
+					shader_name))
 		{}
 
 		/**
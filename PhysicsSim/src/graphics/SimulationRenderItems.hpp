@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 //External forward declarations
 
@@ -26,6 +27,30 @@ namespace Graphics
 	/// @brief SimulationRenderStructs namespace
 	namespace SimulationRenderStructs
 	{
+		/// @brief Particle property the particle colors are taken from.
+		enum class ColorBy
+		{
+			/// @brief The color stored with every particle, uploaded with the full instance layout.
+			ParticleColor = 0,
+			/// @brief The per-particle scalar, the particle index unless one was uploaded.
+			Scalar = 1,
+			/// @brief The x position.
+			PositionX = 2,
+			/// @brief The y position.
+			PositionY = 3,
+			/// @brief The distance from the center of the box.
+			Distance = 4
+		};
+
+		/// @brief Colormaps the scalar color modes map through.
+		enum class ColorMap
+		{
+			Viridis = 0,
+			Magma = 1,
+			CoolWarm = 2,
+			Grayscale = 3
+		};
+
 		/// @brief SimulationRenderItems class.
 		class SimulationRenderItems
 		{
@@ -45,12 +70,9 @@ namespace Graphics
 
 			/**
 			* @brief Custom constructor for the SimulationRenderItems class.
-			* @param vs_file The vertex shader file.
-			* @param fs_file The fragment shader file.
+			* @param shader_name The name of the shader in the shader registry.
 			*/
-			SimulationRenderItems(
-				const std::string& vs_file,
-				const std::string& fs_file);
+			explicit SimulationRenderItems(const std::string& shader_name);
 			
 			//Default constructors/destructor
 
@@ -70,6 +92,33 @@ namespace Graphics
 			/// @brief Virtual render method.
 			virtual void Render() = 0;
 
+			/**
+			* @brief Virtual method to update the particle positions.
+			* @param positions Three floats (x, y, z) per particle.
+			*/
+			virtual void UpdatePositions(const std::vector<float>& positions) = 0;
+
+			/**
+			* @brief Virtual method to choose how the particles are colored.
+			* @param color_by The property the colors are taken from.
+			* @param color_map The colormap the scalar modes map through.
+			*/
+			virtual void SetColorMode(ColorBy color_by, ColorMap color_map) = 0;
+
+			/**
+			* @brief Virtual method to upload the per-particle scalar the Scalar color mode maps.
+			* @param scalars One float per particle.
+			* @param min The scalar mapped to the start of the colormap.
+			* @param max The scalar mapped to the end of the colormap.
+			*/
+			virtual void UpdateScalars(const std::vector<float>& scalars, float min, float max) = 0;
+
+			/**
+			* @brief Virtual method to choose the compact quantized instance layout.
+			* @param compact True for the compact layout, false for the float layouts.
+			*/
+			virtual void SetCompactInstances(bool compact) = 0;
+
 			//PIMPL idiom
 		private:
 			/// @brief Forward declaration of SimulationRenderItemsImpl struct.
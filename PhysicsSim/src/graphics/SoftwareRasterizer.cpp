@@ -0,0 +1,557 @@
+/**
+* @file SoftwareRasterizer.cpp
+* @brief
+* Function definitions for the SoftwareRasterizer class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "SoftwareRasterizer.hpp"
+
+#include "profiling/PerfCounters.hpp"
+#include "profiling/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICSSIM_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	/// @brief Width and height of a tile in pixels, a multiple of four for the SIMD spans.
+	static constexpr int TILE_SIZE = 32;
+	/// @brief Background color, the same the render texture is cleared to.
+	static constexpr float BACKGROUND_COLOR[3] = { 0.2f, 0.3f, 0.3f };
+
+	/**
+	* @brief Structure to hold a particle binned to a tile, in pixels.
+	* @param x The x coordinate of the center.
+	* @param y The y coordinate of the center.
+	* @param radius The radius along x.
+	* @param y_scale The ratio of the x to the y radius, to keep discs round in non-square images.
+	* @param color The red, green and blue color.
+	*/
+	struct Disc
+	{
+		float x;
+		float y;
+		float radius;
+		float y_scale;
+		float color[3];
+	};
+
+	/// @brief SoftwareRasterizer PIMPL implementation structure.
+	struct SoftwareRasterizer::SoftwareRasterizerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		SoftwareRasterizerImpl() = delete;
+		/// @brief Deleted copy constructor.
+		SoftwareRasterizerImpl(const SoftwareRasterizerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		SoftwareRasterizerImpl& operator=(const SoftwareRasterizerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		SoftwareRasterizerImpl(const SoftwareRasterizerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		SoftwareRasterizerImpl& operator=(const SoftwareRasterizerImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the SoftwareRasterizerImpl class.
+		* @param width The width of the image.
+		* @param height The height of the image.
+		* @param threads The number of threads drawing, 0 for every hardware thread.
+		*/
+		SoftwareRasterizerImpl(int width, int height, unsigned int threads);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~SoftwareRasterizerImpl();
+
+		//Member methods
+
+		/**
+		* @brief Run tasks on the worker threads and the calling thread, and wait for them.
+		* @param task_count The number of tasks.
+		* @param task The task, called with the task index and the index of the thread running it.
+		*/
+		void RunParallel(size_t task_count, const std::function<void(size_t, unsigned int)>& task);
+
+		/**
+		* @brief Take tasks of the current job until none are left.
+		* @param thread The index of the thread taking them.
+		*/
+		void RunTasks(unsigned int thread);
+
+		/**
+		* @brief Worker thread loop. Runs the tasks of each job until stopped.
+		* @param thread The index of the worker thread.
+		*/
+		void WorkerLoop(unsigned int thread);
+
+		/**
+		* @brief Compute the screen extent of a chunk of particles and bin them per tile.
+		* @param chunk The index of the chunk.
+		*/
+		void BinChunk(size_t chunk);
+
+		/**
+		* @brief Draw the particles binned to a tile and copy it into the image.
+		* @param tile The index of the tile.
+		* @param thread The index of the thread drawing, which owns the tile buffer used.
+		*/
+		void DrawTile(size_t tile, unsigned int thread);
+
+		/**
+		* @brief Blend a disc into a tile buffer.
+		* @param planes The red, green and blue planes of the tile buffer.
+		* @param tile_x The x coordinate of the tile in the image.
+		* @param tile_y The y coordinate of the tile in the image.
+		* @param tile_width The width of the tile, less than TILE_SIZE at the image edge.
+		* @param tile_height The height of the tile, less than TILE_SIZE at the image edge.
+		* @param disc The disc.
+		*/
+		static void DrawDisc(
+			float* planes,
+			int tile_x,
+			int tile_y,
+			int tile_width,
+			int tile_height,
+			const Disc& disc);
+
+		//Member variables
+
+		/// @brief Width of the image.
+		int width;
+		/// @brief Height of the image.
+		int height;
+		/// @brief Number of tiles across the image.
+		int tiles_x;
+		/// @brief Number of tiles down the image.
+		int tiles_y;
+		/// @brief Number of threads drawing, including the calling thread.
+		unsigned int thread_count;
+		/// @brief The image, four bytes per pixel, top row first.
+		std::vector<unsigned char> pixels;
+		/// @brief Tile buffer of each thread, three planes of TILE_SIZE x TILE_SIZE floats.
+		std::vector<std::vector<float>> tile_planes;
+		/// @brief Discs per chunk and tile. Each chunk is binned by one thread.
+		std::vector<std::vector<std::vector<Disc>>> bins;
+		/// @brief Particles of the current render.
+		const float* positions = nullptr;
+		/// @brief Colors of the current render.
+		const float* colors = nullptr;
+		/// @brief Scales of the current render.
+		const float* scales = nullptr;
+		/// @brief Number of particles of the current render.
+		size_t count = 0;
+		/// @brief Radius of the current render.
+		float radius = 0.0f;
+
+		/// @brief The worker threads.
+		std::vector<std::thread> workers;
+		/// @brief Mutex guarding the job.
+		std::mutex mutex;
+		/// @brief Signalled when a job starts or the rasterizer stops.
+		std::condition_variable start_signal;
+		/// @brief Signalled when the last worker finished its tasks.
+		std::condition_variable done_signal;
+		/// @brief Counter of the jobs started, a worker runs each one once.
+		uint64_t generation = 0;
+		/// @brief Number of workers still running the current job.
+		unsigned int busy_workers = 0;
+		/// @brief Flag set to stop the worker threads.
+		bool stopping = false;
+		/// @brief The task of the current job.
+		const std::function<void(size_t, unsigned int)>* job = nullptr;
+		/// @brief Number of tasks of the current job.
+		size_t job_tasks = 0;
+		/// @brief Index of the next task of the current job to take.
+		std::atomic<size_t> next_task = 0;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the SoftwareRasterizerImpl class. Allocates the
+	* image, a tile buffer per thread and the bins, and starts one worker less
+	* than the thread count, since the calling thread draws too.
+	*/
+	SoftwareRasterizer::SoftwareRasterizerImpl::SoftwareRasterizerImpl(
+		int width,
+		int height,
+		unsigned int threads) :
+		width(std::max(width, 1)),
+		height(std::max(height, 1))
+	{
+		tiles_x = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+		tiles_y = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+
+		thread_count = threads != 0 ? threads : std::thread::hardware_concurrency();
+		thread_count = std::max(thread_count, 1u);
+
+		pixels.resize(size_t(this->width) * size_t(this->height) * 4);
+		tile_planes.assign(thread_count, std::vector<float>(3 * TILE_SIZE * TILE_SIZE));
+		bins.assign(thread_count, std::vector<std::vector<Disc>>(size_t(tiles_x) * size_t(tiles_y)));
+
+		for (unsigned int i = 1; i < thread_count; i++)
+			workers.emplace_back(&SoftwareRasterizerImpl::WorkerLoop, this, i);
+	}
+
+	/**
+	* @details
+	* Destructor for the SoftwareRasterizerImpl class. Stops and joins the
+	* worker threads.
+	*/
+	SoftwareRasterizer::SoftwareRasterizerImpl::~SoftwareRasterizerImpl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		start_signal.notify_all();
+
+		for (std::thread& worker : workers)
+			if (worker.joinable()) worker.join();
+	}
+
+	/**
+	* @details
+	* Publish the job and wake the workers, then take tasks on the calling
+	* thread as well and wait until every worker is done with the job. Tasks
+	* are handed out through an atomic counter, so threads that finish early
+	* take more of them.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::RunParallel(
+		size_t task_count,
+		const std::function<void(size_t, unsigned int)>& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = &task;
+			job_tasks = task_count;
+			next_task = 0;
+			busy_workers = unsigned(workers.size());
+			generation++;
+		}
+		start_signal.notify_all();
+
+		RunTasks(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done_signal.wait(lock, [this] { return busy_workers == 0; });
+		job = nullptr;
+	}
+
+	/**
+	* @details
+	* Take task indices until they run out.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::RunTasks(unsigned int thread)
+	{
+		for (size_t task = next_task++; task < job_tasks; task = next_task++)
+			(*job)(task, thread);
+	}
+
+	/**
+	* @details
+	* Wait for a job the worker hasn't run yet, run its tasks and report back.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::WorkerLoop(unsigned int thread)
+	{
+		PROFILE_THREAD("Raster Worker");
+
+		uint64_t seen = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				start_signal.wait(lock, [&] { return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+			}
+
+			RunTasks(thread);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busy_workers == 0) done_signal.notify_one();
+		}
+	}
+
+	/**
+	* @details
+	* Map each particle of the chunk to pixels, with x from -1 at the left to 1
+	* at the right and y from 1 at the top to -1 at the bottom, like the
+	* projection of the render items. Particles without area or off the image
+	* are skipped, the rest are copied into the bins of every tile their disc
+	* and its anti-aliased edge touch. Copying the disc rather than its index
+	* lets each tile read its bins front to back instead of gathering from the
+	* particle arrays. Chunks are contiguous and binned in their own lists, so
+	* the tiles draw the particles in their original order.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::BinChunk(size_t chunk)
+	{
+		std::vector<std::vector<Disc>>& chunk_bins = bins[chunk];
+		for (std::vector<Disc>& bin : chunk_bins) bin.clear();
+
+		const size_t begin = count * chunk / thread_count;
+		const size_t end = count * (chunk + 1) / thread_count;
+		const float half_width = 0.5f * float(width);
+		const float half_height = 0.5f * float(height);
+
+		for (size_t i = begin; i < end; i++)
+		{
+			const float x = (positions[3 * i + 0] + 1.0f) * half_width;
+			const float y = (1.0f - positions[3 * i + 1]) * half_height;
+			const float radius_x = radius * scales[3 * i + 0] * half_width;
+			const float radius_y = radius * scales[3 * i + 1] * half_height;
+			if (!(radius_x > 0.0f && radius_y > 0.0f)) continue;
+
+			const float extent_x = radius_x + 0.5f;
+			const float extent_y = extent_x * radius_y / radius_x;
+			const float left = x - extent_x;
+			const float right = x + extent_x;
+			const float top = y - extent_y;
+			const float bottom = y + extent_y;
+			if (!(right >= 0.0f && left < float(width) && bottom >= 0.0f && top < float(height)))
+				continue;
+
+			const Disc disc = {
+				x,
+				y,
+				radius_x,
+				radius_x / radius_y,
+				{ colors[3 * i + 0], colors[3 * i + 1], colors[3 * i + 2] } };
+
+			//Clamp in float first, a huge particle would overflow the int conversion
+			const int tile_left = int(std::max(left, 0.0f)) / TILE_SIZE;
+			const int tile_right = int(std::min(right, float(width - 1))) / TILE_SIZE;
+			const int tile_top = int(std::max(top, 0.0f)) / TILE_SIZE;
+			const int tile_bottom = int(std::min(bottom, float(height - 1))) / TILE_SIZE;
+			for (int tile_y = tile_top; tile_y <= tile_bottom; tile_y++)
+				for (int tile_x = tile_left; tile_x <= tile_right; tile_x++)
+					chunk_bins[size_t(tile_y) * size_t(tiles_x) + size_t(tile_x)].push_back(disc);
+		}
+	}
+
+	/**
+	* @details
+	* Clear the thread's tile buffer to the background, blend the tile's
+	* particles from every chunk in order, then convert the tile to bytes and
+	* copy it into the image. Tiles don't overlap, so threads never write the
+	* same pixels.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::DrawTile(size_t tile, unsigned int thread)
+	{
+		float* planes = tile_planes[thread].data();
+		const int tile_x = int(tile % size_t(tiles_x)) * TILE_SIZE;
+		const int tile_y = int(tile / size_t(tiles_x)) * TILE_SIZE;
+		const int tile_width = std::min(TILE_SIZE, width - tile_x);
+		const int tile_height = std::min(TILE_SIZE, height - tile_y);
+
+		for (int channel = 0; channel < 3; channel++)
+			std::fill_n(planes + channel * TILE_SIZE * TILE_SIZE, TILE_SIZE * TILE_SIZE, BACKGROUND_COLOR[channel]);
+
+		for (const std::vector<std::vector<Disc>>& chunk_bins : bins)
+			for (const Disc& disc : chunk_bins[tile])
+				DrawDisc(planes, tile_x, tile_y, tile_width, tile_height, disc);
+
+		for (int y = 0; y < tile_height; y++)
+		{
+			unsigned char* out = pixels.data() + (size_t(tile_y + y) * size_t(width) + size_t(tile_x)) * 4;
+			for (int x = 0; x < tile_width; x++, out += 4)
+			{
+				for (int channel = 0; channel < 3; channel++)
+				{
+					const float value = planes[channel * TILE_SIZE * TILE_SIZE + y * TILE_SIZE + x];
+					out[channel] = (unsigned char)(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+				}
+				out[3] = 255;
+			}
+		}
+	}
+
+	/**
+	* @details
+	* The coverage of a pixel is the distance from its center to the disc
+	* edge, clamped to [0, 1], which gives a one pixel anti-aliased edge. The
+	* y distance is scaled so the disc stays round in x pixels when the image
+	* isn't square. Each pixel is blended towards the particle color by its
+	* coverage. With SSE2 the rows are processed four pixels at a time from a
+	* multiple of four; the tile buffer rows are TILE_SIZE wide, so the extra
+	* pixels past the tile edge stay inside the buffer and are never copied.
+	*/
+	void SoftwareRasterizer::SoftwareRasterizerImpl::DrawDisc(
+		float* planes,
+		int tile_x,
+		int tile_y,
+		int tile_width,
+		int tile_height,
+		const Disc& disc)
+	{
+		const float x = disc.x - float(tile_x);
+		const float y = disc.y - float(tile_y);
+		const float edge = disc.radius + 0.5f;
+		const float y_scale = disc.y_scale;
+		const float extent_y = edge / y_scale;
+
+		const int left = int(std::max(std::floor(x - edge), 0.0f));
+		const int right = int(std::min(std::ceil(x + edge), float(tile_width - 1)));
+		const int top = int(std::max(std::floor(y - extent_y), 0.0f));
+		const int bottom = int(std::min(std::ceil(y + extent_y), float(tile_height - 1)));
+		if (left > right || top > bottom) return;
+
+		const float* color = disc.color;
+		float* red = planes;
+		float* green = planes + TILE_SIZE * TILE_SIZE;
+		float* blue = planes + 2 * TILE_SIZE * TILE_SIZE;
+
+#ifdef PHYSICSSIM_RASTER_SSE2
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 edge4 = _mm_set1_ps(edge);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 red4 = _mm_set1_ps(color[0]);
+		const __m128 green4 = _mm_set1_ps(color[1]);
+		const __m128 blue4 = _mm_set1_ps(color[2]);
+		const int span_left = left & ~3;
+
+		for (int row = top; row <= bottom; row++)
+		{
+			const float dy = (float(row) + 0.5f - y) * y_scale;
+			const float dy2 = dy * dy;
+			if (dy2 >= edge * edge) continue;
+
+			const __m128 dy2_4 = _mm_set1_ps(dy2);
+			const int offset = row * TILE_SIZE;
+			for (int column = span_left; column <= right; column += 4)
+			{
+				const __m128 dx = _mm_add_ps(_mm_set1_ps(float(column) - x), offsets);
+				const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2_4));
+				const __m128 coverage = _mm_min_ps(_mm_max_ps(_mm_sub_ps(edge4, distance), zero), one);
+
+				float* r = red + offset + column;
+				float* g = green + offset + column;
+				float* b = blue + offset + column;
+				const __m128 r4 = _mm_loadu_ps(r);
+				const __m128 g4 = _mm_loadu_ps(g);
+				const __m128 b4 = _mm_loadu_ps(b);
+				_mm_storeu_ps(r, _mm_add_ps(r4, _mm_mul_ps(coverage, _mm_sub_ps(red4, r4))));
+				_mm_storeu_ps(g, _mm_add_ps(g4, _mm_mul_ps(coverage, _mm_sub_ps(green4, g4))));
+				_mm_storeu_ps(b, _mm_add_ps(b4, _mm_mul_ps(coverage, _mm_sub_ps(blue4, b4))));
+			}
+		}
+#else
+		for (int row = top; row <= bottom; row++)
+		{
+			const float dy = (float(row) + 0.5f - y) * y_scale;
+			const float dy2 = dy * dy;
+			if (dy2 >= edge * edge) continue;
+
+			const int offset = row * TILE_SIZE;
+			for (int column = left; column <= right; column++)
+			{
+				const float dx = float(column) + 0.5f - x;
+				const float coverage = std::clamp(edge - std::sqrt(dx * dx + dy2), 0.0f, 1.0f);
+				red[offset + column] += coverage * (color[0] - red[offset + column]);
+				green[offset + column] += coverage * (color[1] - green[offset + column]);
+				blue[offset + column] += coverage * (color[2] - blue[offset + column]);
+			}
+		}
+#endif
+	}
+
+	/**
+	* @details
+	* Custom constructor for the SoftwareRasterizer class. Passes the size and
+	* thread count to the PIMPL implementation.
+	*/
+	SoftwareRasterizer::SoftwareRasterizer(int width, int height, unsigned int threads) :
+		_impl(std::make_unique<SoftwareRasterizerImpl>(width, height, threads))
+	{}
+
+	/**
+	* @details
+	* Default destructor for the SoftwareRasterizer class.
+	*/
+	SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+	/**
+	* @details
+	* Get the width of the image.
+	*/
+	int SoftwareRasterizer::GetWidth() const
+	{
+		return _impl->width;
+	}
+
+	/**
+	* @details
+	* Get the height of the image.
+	*/
+	int SoftwareRasterizer::GetHeight() const
+	{
+		return _impl->height;
+	}
+
+	/**
+	* @details
+	* Render in two parallel passes. The first splits the particles into one
+	* chunk per thread and bins each chunk per tile, the second draws each tile
+	* on one thread. Neither pass shares anything writable between threads, so
+	* no locks are taken while drawing, and the image doesn't depend on the
+	* thread count.
+	*/
+	void SoftwareRasterizer::Render(
+		const float* positions,
+		const float* colors,
+		const float* scales,
+		size_t count,
+		float radius)
+	{
+		PROFILE_SCOPE("Software Raster");
+		PROFILE_COUNTERS("Software Raster", count);
+
+		SoftwareRasterizerImpl& impl = *_impl;
+		impl.positions = positions;
+		impl.colors = colors;
+		impl.scales = scales;
+		impl.count = count;
+		impl.radius = radius;
+
+		{
+			PROFILE_SCOPE("Raster Bin");
+			impl.RunParallel(impl.thread_count, [&impl](size_t chunk, unsigned int) {
+				impl.BinChunk(chunk); });
+		}
+		{
+			PROFILE_SCOPE("Raster Tiles");
+			impl.RunParallel(size_t(impl.tiles_x) * size_t(impl.tiles_y), [&impl](size_t tile, unsigned int thread) {
+				impl.DrawTile(tile, thread); });
+		}
+
+		impl.positions = nullptr;
+		impl.colors = nullptr;
+		impl.scales = nullptr;
+	}
+
+	/**
+	* @details
+	* Get the image.
+	*/
+	const std::vector<unsigned char>& SoftwareRasterizer::GetPixels() const
+	{
+		return _impl->pixels;
+	}
+}
\ No newline at end of file
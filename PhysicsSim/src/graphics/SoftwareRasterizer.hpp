@@ -0,0 +1,113 @@
+/**
+* @file SoftwareRasterizer.hpp
+* @brief
+* Class declaration for the software rasterizer. Draws the particles as
+* anti-aliased discs into an RGBA image on the CPU, for machines without a GPU
+* or a display. The image is split into tiles, the particles are binned per
+* tile and the tiles are drawn in parallel, each by one thread, so no locks are
+* needed. Uses the same conventions as the particle instance data: positions in
+* [-1, 1] across the image, RGB colors in [0, 1] and a scale that multiplies
+* the particle radius. Uses the PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _SOFTWARERASTERIZER_
+#define _SOFTWARERASTERIZER_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Scene namespace
+namespace Graphics
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief SoftwareRasterizer class
+	class SoftwareRasterizer
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		SoftwareRasterizer() = delete;
+		/// @brief Deleted copy constructor.
+		SoftwareRasterizer(const SoftwareRasterizer& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		SoftwareRasterizer& operator=(const SoftwareRasterizer& other) = delete;
+		/// @brief Deleted move constructor.
+		SoftwareRasterizer(const SoftwareRasterizer&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		SoftwareRasterizer& operator=(const SoftwareRasterizer&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief
+		* Custom constructor for the SoftwareRasterizer class. Allocates the image
+		* and starts the worker threads.
+		* @param width The width of the image.
+		* @param height The height of the image.
+		* @param threads The number of threads drawing, 0 for every hardware thread.
+		*/
+		SoftwareRasterizer(int width, int height, unsigned int threads = 0);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Stops the worker threads.
+		~SoftwareRasterizer();
+
+		//Member methods
+
+		/**
+		* @brief Get the width of the image.
+		* @return The width of the image.
+		*/
+		int GetWidth() const;
+
+		/**
+		* @brief Get the height of the image.
+		* @return The height of the image.
+		*/
+		int GetHeight() const;
+
+		/**
+		* @brief
+		* Clear the image and draw the particles over it in order. The arrays hold
+		* three floats per particle, like the simulation state.
+		* @param positions The positions (x, y, z) of the particles.
+		* @param colors The colors (red, green, blue) of the particles.
+		* @param scales The scales (x, y, z) of the particles.
+		* @param count The number of particles.
+		* @param radius The radius of the particles before scaling.
+		*/
+		void Render(
+			const float* positions,
+			const float* colors,
+			const float* scales,
+			size_t count,
+			float radius);
+
+		/**
+		* @brief Get the image drawn by the last render.
+		* @return The pixels, four bytes each, top row first.
+		*/
+		const std::vector<unsigned char>& GetPixels() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of SoftwareRasterizerImpl struct.
+		struct SoftwareRasterizerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<SoftwareRasterizerImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
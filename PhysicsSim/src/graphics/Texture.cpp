@@ -10,6 +10,9 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <chrono>
+
 /// @brief Scene namespace
 namespace Graphics
 {
@@ -29,6 +32,30 @@ namespace Graphics
 		/// @brief Deleted move assignment operator.
 		TextureImpl& operator=(const TextureImpl&& other) = delete;
 
+		/// @brief Factor an outgrown frame buffer grows by in each direction.
+		static constexpr float GROWTH_FACTOR = 1.5f;
+		/// @brief Frame buffers with more than this many times the pixels needed are shrunk.
+		static constexpr int SHRINK_RATIO = 4;
+		/// @brief Number of unused frame buffers kept for reuse.
+		static constexpr size_t POOL_SIZE = 3;
+		/// @brief Time a size must be requested unchanged before it reallocates.
+		static constexpr std::chrono::milliseconds RESIZE_SETTLE_TIME{ 150 };
+
+		/**
+		* @brief Structure to hold a frame buffer and the texture attached to it.
+		* @param frame_buffer The OpenGL frame buffer ID.
+		* @param texture The OpenGL texture ID.
+		* @param width The allocated width.
+		* @param height The allocated height.
+		*/
+		struct Framebuffer
+		{
+			GLuint frame_buffer = 0;
+			GLuint texture = 0;
+			int width = 0;
+			int height = 0;
+		};
+
 		//Custom constructors
 		/**
 		* @brief Custom constructor for the TextureImpl class.
@@ -51,16 +78,84 @@ namespace Graphics
 		*/
 		void SetupFramebufferAndTexture(const int& width, const int& height);
 
+		/**
+		* @brief Set the size rendered into, which must be inside the frame buffer.
+		* @param width The width of the texture.
+		* @param height The height of the texture.
+		*/
+		void SetSize(const int& width, const int& height);
+
+		/**
+		* @brief Check if the current frame buffer can hold a size without waste.
+		* @param width The width of the texture.
+		* @param height The height of the texture.
+		* @return True if the size fits and doesn't need a smaller frame buffer.
+		*/
+		bool Fits(const int& width, const int& height) const;
+
+		/**
+		* @brief Create the frame buffer and texture of a buffer whose size is set.
+		* @param buffer The frame buffer, its IDs are set on success.
+		* @param internal_format The internal format of the texture.
+		* @param type The pixel type of the texture.
+		* @return True if the frame buffer is complete, false otherwise with nothing allocated.
+		*/
+		static bool Allocate(Framebuffer& buffer, GLint internal_format, GLenum type);
+
+		/**
+		* @brief
+		* Make sure the trail frame buffer has the size of the frame buffer and
+		* bind it, clearing the history if either changed size.
+		* @return True if the trail frame buffer is bound, false otherwise.
+		*/
+		bool SetupTrails();
+
+		/**
+		* @brief Take a frame buffer for a size from the pool, or allocate one.
+		* @param width The width needed.
+		* @param height The height needed.
+		* @return The frame buffer, with zero IDs if the allocation failed.
+		*/
+		Framebuffer Acquire(const int& width, const int& height);
+
+		/**
+		* @brief Put a frame buffer in the pool, deleting the oldest one if it is full.
+		* @param buffer The frame buffer.
+		*/
+		void Recycle(const Framebuffer& buffer);
+
+		/**
+		* @brief Delete a frame buffer and its texture.
+		* @param buffer The frame buffer.
+		*/
+		static void Release(const Framebuffer& buffer);
+
 		//Member variables
 
 		/// @brief Width of the texture.
-		int width;
+		int width = 0;
 		/// @brief Height of the texture.
-		int height;
-		/// @brief OpenGL frame buffer ID.
-		GLuint frame_buffer;
-		/// @brief OpenGL texture ID.
-		GLuint texture;
+		int height = 0;
+		/// @brief Frame buffer rendered into.
+		Framebuffer current;
+		/// @brief Unused frame buffers, oldest first.
+		std::vector<Framebuffer> pool;
+		/// @brief Flag set while a size that needs a new frame buffer is waiting.
+		bool resize_pending = false;
+		/// @brief Width waiting to be applied.
+		int pending_width = 0;
+		/// @brief Height waiting to be applied.
+		int pending_height = 0;
+		/// @brief Time the waiting size was first requested.
+		std::chrono::steady_clock::time_point pending_since;
+		/// @brief Frame buffer accumulating the particle trails.
+		Framebuffer trails;
+		/// @brief Width of the trail history, 0 when it must be cleared.
+		int trails_width = 0;
+		/// @brief Height of the trail history, 0 when it must be cleared.
+		int trails_height = 0;
+		/// @brief Flag set once the trail frame buffer failed to allocate.
+		bool trails_failed = false;
 		/// @brief Error status of the texture.
 		bool error_status = false;
 		/// @brief Aspect ratio of the texture.
@@ -74,48 +169,144 @@ namespace Graphics
 	*/
 	Texture::TextureImpl::TextureImpl(const int& width, const int& height)
 	{
-		spdlog::info("Setting up framebuffer and texture: {} x {}", width, height);
 		SetupFramebufferAndTexture(width, height);
-		spdlog::info("Framebuffer and texture setup complete");
 	}
 
 	/**
 	* @details
-	* Destructor for the TextureImpl class. Deletes the frame buffer and texture.
+	* Destructor for the TextureImpl class. Deletes the frame buffer and texture,
+	* and the ones in the pool.
 	*/
 	Texture::TextureImpl::~TextureImpl()
 	{
 		spdlog::info("Destroying framebuffer and texture");
-		glDeleteFramebuffers(1, &frame_buffer);
-		glDeleteTextures(1, &texture);
+		Release(current);
+		Release(trails);
+		for (const Framebuffer& buffer : pool) Release(buffer);
 	}
 
 	/**
 	* @details
-	* Sets up the frame buffer and texture in OpenGL.
+	* Use the current frame buffer if the size fits it, otherwise swap in a
+	* frame buffer from the pool or a new one and keep the current one in the
+	* pool. Only the viewport size changes when nothing is allocated.
 	*/
 	void Texture::TextureImpl::SetupFramebufferAndTexture(const int& width, const int& height)
+	{
+		if (width <= 0 || height <= 0) return;
+
+		if (!Fits(width, height))
+		{
+			Framebuffer buffer = Acquire(width, height);
+			if (buffer.frame_buffer == 0) return;
+
+			if (current.frame_buffer != 0) Recycle(current);
+			current = buffer;
+		}
+
+		SetSize(width, height);
+	}
+
+	/**
+	* @details
+	* Set the size and aspect ratio of the texture.
+	*/
+	void Texture::TextureImpl::SetSize(const int& width, const int& height)
 	{
 		this->width = width;
 		this->height = height;
+		aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
+	}
+
+	/**
+	* @details
+	* A size fits if it is inside the frame buffer and uses at least a
+	* SHRINK_RATIO'th of its pixels.
+	*/
+	bool Texture::TextureImpl::Fits(const int& width, const int& height) const
+	{
+		if (width > current.width || height > current.height) return false;
+
+		const long long needed = (long long)width * height;
+		const long long allocated = (long long)current.width * current.height;
+		return allocated <= SHRINK_RATIO * needed;
+	}
+
+	/**
+	* @details
+	* Prefer the smallest pooled frame buffer the size fits in. Otherwise
+	* allocate one: growing past the current frame buffer adds GROWTH_FACTOR
+	* slack in each direction so a window being enlarged reallocates a few
+	* times instead of every frame, while a first or shrinking allocation is
+	* exact.
+	*/
+	Texture::TextureImpl::Framebuffer Texture::TextureImpl::Acquire(
+		const int& width,
+		const int& height)
+	{
+		const long long needed = (long long)width * height;
+
+		auto best = pool.end();
+		for (auto it = pool.begin(); it != pool.end(); it++)
+		{
+			if (it->width < width || it->height < height) continue;
+			if ((long long)it->width * it->height > SHRINK_RATIO * needed) continue;
+			if (best == pool.end() ||
+				(long long)it->width * it->height < (long long)best->width * best->height)
+				best = it;
+		}
+
+		if (best != pool.end())
+		{
+			Framebuffer buffer = *best;
+			pool.erase(best);
+			spdlog::debug(
+				"Reusing pooled framebuffer: {} x {}",
+				buffer.width,
+				buffer.height);
+			return buffer;
+		}
+
+		Framebuffer buffer;
+		buffer.width = width;
+		buffer.height = height;
+		if (width > current.width)
+			buffer.width = std::max(width, int(current.width * GROWTH_FACTOR));
+		if (height > current.height)
+			buffer.height = std::max(height, int(current.height * GROWTH_FACTOR));
 
-		glDeleteFramebuffers(1, &frame_buffer);
-		glDeleteTextures(1, &texture);
+		spdlog::info("Setting up framebuffer and texture: {} x {}", buffer.width, buffer.height);
 
-		glGenFramebuffers(1, &frame_buffer);
-		glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
+		if (!Allocate(buffer, GL_RGBA, GL_UNSIGNED_BYTE))
+		{
+			error_status = true;
+			return Framebuffer();
+		}
 
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		return buffer;
+	}
+
+	/**
+	* @details
+	* Create the texture and attach it to a new frame buffer. Anything that
+	* failed is released again.
+	*/
+	bool Texture::TextureImpl::Allocate(Framebuffer& buffer, GLint internal_format, GLenum type)
+	{
+		glGenFramebuffers(1, &buffer.frame_buffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, buffer.frame_buffer);
+
+		glGenTextures(1, &buffer.texture);
+		glBindTexture(GL_TEXTURE_2D, buffer.texture);
 		glTexImage2D(
 			GL_TEXTURE_2D,
 			0,
-			GL_RGBA,
-			width,
-			height,
+			internal_format,
+			buffer.width,
+			buffer.height,
 			0,
 			GL_RGBA,
-			GL_UNSIGNED_BYTE,
+			type,
 			nullptr);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -123,25 +314,104 @@ namespace Graphics
 			GL_FRAMEBUFFER,
 			GL_COLOR_ATTACHMENT0,
 			GL_TEXTURE_2D,
-			texture,
+			buffer.texture,
 			0);
 
+		const bool complete =
+			glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		if (!complete)
 		{
 			spdlog::error("Framebuffer is not complete");
-			error_status = true;
 		}
 
 		GLenum err = glGetError();
 		if(err != GL_NO_ERROR)
 		{
 			spdlog::error("Texture setup failed: {}", err);
-			error_status = true;
 		}
 
-		aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
+		if (!complete || err != GL_NO_ERROR)
+		{
+			Release(buffer);
+			buffer.frame_buffer = 0;
+			buffer.texture = 0;
+			return false;
+		}
+
+		return true;
+	}
+
+	/**
+	* @details
+	* The trails follow the allocated size of the frame buffer, so they are
+	* only reallocated with it. Fading an 8 bit channel by a factor rounds
+	* dim pixels back up and leaves ghosts that never fade out, so the trails
+	* are half floats.
+	*/
+	bool Texture::TextureImpl::SetupTrails()
+	{
+		if (trails_failed || current.frame_buffer == 0) return false;
+
+		if (trails.width != current.width || trails.height != current.height)
+		{
+			Release(trails);
+			trails = Framebuffer();
+			trails.width = current.width;
+			trails.height = current.height;
+
+			spdlog::info("Setting up trail framebuffer: {} x {}", trails.width, trails.height);
+
+			if (!Allocate(trails, GL_RGBA16F, GL_HALF_FLOAT))
+			{
+				spdlog::error("Trail framebuffer is not available, drawing without trails");
+				trails = Framebuffer();
+				trails_failed = true;
+				return false;
+			}
+			trails_width = 0;
+			trails_height = 0;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, trails.frame_buffer);
+		glViewport(0, 0, width, height);
+
+		//The history of another size doesn't line up with the new view
+		if (trails_width != width || trails_height != height)
+		{
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			trails_width = width;
+			trails_height = height;
+		}
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Keep the frame buffer for a later size change, such as the window being
+	* dragged back. The pool is small, the oldest frame buffer makes room.
+	*/
+	void Texture::TextureImpl::Recycle(const Framebuffer& buffer)
+	{
+		if (pool.size() >= POOL_SIZE)
+		{
+			Release(pool.front());
+			pool.erase(pool.begin());
+		}
+		pool.push_back(buffer);
+	}
+
+	/**
+	* @details
+	* Delete the frame buffer and texture. Zero IDs are ignored by OpenGL.
+	*/
+	void Texture::TextureImpl::Release(const Framebuffer& buffer)
+	{
+		glDeleteFramebuffers(1, &buffer.frame_buffer);
+		glDeleteTextures(1, &buffer.texture);
 	}
 
 	/**
@@ -180,34 +450,141 @@ namespace Graphics
 	*/
 	unsigned int& Texture::GetTextureId()
 	{
-		return _impl->texture;
+		return _impl->current.texture;
+	}
+
+	/**
+	* @details
+	* Get the OpenGL frame buffer ID.
+	*/
+	unsigned int Texture::GetFramebufferId() const
+	{
+		return _impl->current.frame_buffer;
 	}
 
 	/**
 	* @details
-	* Render the texture with the texture's variables.
+	* Get the width of the texture.
+	*/
+	int Texture::GetWidth() const
+	{
+		return _impl->width;
+	}
+
+	/**
+	* @details
+	* Get the height of the texture.
+	*/
+	int Texture::GetHeight() const
+	{
+		return _impl->height;
+	}
+
+	/**
+	* @details
+	* Render the texture with the texture's variables. The viewport covers the
+	* lower left part of the frame buffer the texture uses.
 	*/
 	void Texture::Render()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, _impl->frame_buffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, _impl->current.frame_buffer);
 		glViewport(0, 0, _impl->width, _impl->height);
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
+	}
 
-		GLenum err = glGetError();
-		if (err != GL_NO_ERROR) spdlog::error("Texture render failed: {}", err);
+	/**
+	* @details
+	* Divide the size rendered into by the allocated size.
+	*/
+	std::pair<float, float> Texture::GetUvExtent() const
+	{
+		if (_impl->current.width <= 0 || _impl->current.height <= 0)
+			return std::pair<float, float>(1.0f, 1.0f);
+
+		return std::pair<float, float>(
+			float(_impl->width) / float(_impl->current.width),
+			float(_impl->height) / float(_impl->current.height));
 	}
 
 	/**
 	* @details
 	* Pass the width and height to the PIMPL implementation to setup the frame
-	* buffer and texture.
+	* buffer and texture. Any size waiting to be applied is dropped.
 	*/
 	void Texture::SetupFramebufferAndTexture(const int& width, const int& height)
 	{
-		spdlog::info("Setting up framebuffer and texture: {} x {}", width, height);
+		_impl->resize_pending = false;
 		_impl->SetupFramebufferAndTexture(width, height);
-		spdlog::info("Framebuffer and texture setup complete");
+	}
+
+	/**
+	* @details
+	* Sizes inside the current frame buffer only change the viewport and apply
+	* right away. Sizes that need a larger frame buffer, or leave most of it
+	* unused, restart the settle timer whenever they change. While a window is
+	* being enlarged the texture keeps its size and is stretched over the
+	* window, and the frame buffer is only swapped once the drag has stopped
+	* for RESIZE_SETTLE_TIME.
+	*/
+	void Texture::Resize(const int& width, const int& height)
+	{
+		if (width <= 0 || height <= 0) return;
+
+		if (width <= _impl->current.width && height <= _impl->current.height)
+			_impl->SetSize(width, height);
+
+		if (_impl->Fits(width, height))
+		{
+			_impl->resize_pending = false;
+			return;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		if (!_impl->resize_pending ||
+			width != _impl->pending_width ||
+			height != _impl->pending_height)
+		{
+			_impl->resize_pending = true;
+			_impl->pending_width = width;
+			_impl->pending_height = height;
+			_impl->pending_since = now;
+			return;
+		}
+
+		if (now - _impl->pending_since >= TextureImpl::RESIZE_SETTLE_TIME)
+			SetupFramebufferAndTexture(width, height);
+	}
+
+	/**
+	* @details
+	* Pass to the PIMPL implementation to set up and bind the trail frame buffer.
+	*/
+	bool Texture::BindTrails()
+	{
+		return _impl->SetupTrails();
+	}
+
+	/**
+	* @details
+	* Get the OpenGL texture ID of the trail frame buffer.
+	*/
+	unsigned int Texture::GetTrailTextureId() const
+	{
+		return _impl->trails.texture;
+	}
+
+	/**
+	* @details
+	* Delete the trail frame buffer and give a failed allocation another try.
+	*/
+	void Texture::ReleaseTrails()
+	{
+		TextureImpl::Release(_impl->trails);
+		_impl->trails = TextureImpl::Framebuffer();
+		_impl->trails_width = 0;
+		_impl->trails_height = 0;
+		_impl->trails_failed = false;
 	}
 
 	/**
@@ -1,8 +1,13 @@
 /**
 * @file Texture.hpp
 * @brief
-* Function declarations to create and manage textures. Uses the PIMPL idiom to hide
-* implementation details.
+* Function declarations to create and manage textures. The frame buffer is
+* allocated with slack and rendered into through a viewport in its lower left
+* corner, so most size changes only move the viewport. Allocations that are
+* outgrown or far too large are kept in a small pool for reuse, and interactive
+* resizes that need one wait until the size stops changing. A second, float
+* frame buffer of the same size accumulates particle trails across frames. Uses
+* the PIMPL idiom to hide implementation details.
 */
 
 #pragma once
@@ -11,6 +16,7 @@
 #define _TEXTURE_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 //External forward declarations
@@ -69,15 +75,69 @@ namespace Graphics
 		*/
 		unsigned int& GetTextureId();
 
+		/**
+		* @brief Get the OpenGL frame buffer ID the texture is attached to.
+		* @return The OpenGL frame buffer ID.
+		*/
+		unsigned int GetFramebufferId() const;
+
+		/**
+		* @brief Get the width of the texture, the part of the frame buffer rendered into.
+		* @return The width of the texture.
+		*/
+		int GetWidth() const;
+
+		/**
+		* @brief Get the height of the texture, the part of the frame buffer rendered into.
+		* @return The height of the texture.
+		*/
+		int GetHeight() const;
+
 		/// @brief Render the texture.
 		void Render();
 
 		/**
-		* @brief Setup the framebuffer and texture.
+		* @brief
+		* Get the texture coordinates of the upper right corner of the part of the
+		* frame buffer rendered into.
+		* @return The largest u and v texture coordinates.
+		*/
+		std::pair<float, float> GetUvExtent() const;
+
+		/**
+		* @brief Setup the framebuffer and texture right away.
 		* @param width The width of the texture.
 		* @param height The height of the texture.
 		*/
 		void SetupFramebufferAndTexture(const int& width, const int& height);
+
+		/**
+		* @brief
+		* Request a size for the texture, called every frame while it is shown.
+		* Sizes that fit the frame buffer apply right away, sizes that need a new
+		* allocation apply once they have been requested unchanged for a while.
+		* @param width The width of the texture.
+		* @param height The height of the texture.
+		*/
+		void Resize(const int& width, const int& height);
+
+		/**
+		* @brief
+		* Bind the trail frame buffer, kept across frames the size of the frame
+		* buffer, allocating it on first use. Its history is cleared whenever the
+		* size rendered into changes.
+		* @return True if the trail frame buffer is bound, false if it couldn't be allocated.
+		*/
+		bool BindTrails();
+
+		/**
+		* @brief Get the OpenGL texture ID of the trail frame buffer.
+		* @return The OpenGL texture ID, 0 while there is no trail frame buffer.
+		*/
+		unsigned int GetTrailTextureId() const;
+
+		/// @brief Delete the trail frame buffer, the next BindTrails starts without history.
+		void ReleaseTrails();
 		
 		/**
 		* @brief Get the aspect ratio of the texture.
@@ -8,7 +8,10 @@
 #include "ThermodynamicsRenderItems.hpp"
 
 #include "graphics/objects/Circle.hpp"
+#include "graphics/objects/CircleGeometry.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/ShaderRegistry.hpp"
+#include "profiling/Profiler.hpp"
 #include "utils/GlfwIncludes.hpp"
 
 #include "glm/glm.hpp"
@@ -16,6 +19,14 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
 /// @brief Graphics namespace
 namespace Graphics
 {
@@ -54,37 +65,317 @@ namespace Graphics
 			/// @brief Default destructor.
 			~ThermodynamicsRenderItemsImpl();
 
+			/// @brief Projected radius in pixels below which particles are drawn as a density.
+			static constexpr float LOD_RADIUS_PIXELS = 0.5f;
+			/// @brief Number of culling grid cells along each axis of the simulation box.
+			static constexpr int GRID_CELLS = 256;
+			/// @brief Number of texels of the colormap texture.
+			static constexpr int COLOR_MAP_SIZE = 256;
+			/// @brief Number of entries of the species tables, must match the particle shaders.
+			static constexpr size_t MAX_SPECIES = 16;
+
+			/// @brief Layouts of the instance buffer.
+			enum class Layout
+			{
+				/// @brief 48 bytes: position, color and scale as vec4s.
+				Full,
+				/// @brief 16 bytes: x, y, scale and scalar as floats.
+				Packed,
+				/// @brief 8 bytes: see CompactInstance.
+				Compact
+			};
+
+			/**
+			* @brief
+			* Particle in the compact layout. The position is quantized to 16 bit
+			* fractions of the [-1, 1] box, the scalar to an 8 bit fraction of the
+			* scalar range, and the species indexes the radius and color tables.
+			*/
+			struct CompactInstance
+			{
+				uint16_t x = 0;
+				uint16_t y = 0;
+				uint8_t scalar = 0;
+				uint8_t species = 0;
+				uint16_t padding = 0;
+			};
+			static_assert(sizeof(CompactInstance) == 8, "CompactInstance must stay 8 bytes");
+
+			/// @brief Draw command of glMultiDrawArraysIndirect, one per species.
+			struct DrawArraysIndirectCommand
+			{
+				GLuint count = 0;
+				GLuint instance_count = 0;
+				GLuint first = 0;
+				GLuint base_instance = 0;
+			};
+
 			//Member methods
 
+			/**
+			* @brief Get the layout of the instance buffer.
+			* @return The compact layout if chosen, else packed for the scalar color modes, else full.
+			*/
+			Layout GetLayout() const;
+
+			/**
+			* @brief Get the size of one instance in the current layout.
+			* @return The size of an instance in bytes.
+			*/
+			size_t InstanceStride() const;
+
+			/**
+			* @brief Get the instances of every particle in the current layout.
+			* @return Pointer to the first instance.
+			*/
+			const unsigned char* InstanceBytes() const;
+
+			/**
+			* @brief
+			* Point the instance attributes of a vertex array at the instance buffer,
+			* in the current layout.
+			* @param vao The vertex array.
+			* @param instanced True to advance the attributes per instance, false per vertex.
+			* @param first_instance The instance the attributes start at.
+			*/
+			void SetupAttributes(GLuint vao, bool instanced, size_t first_instance = 0);
+
+			/**
+			* @brief Get the slot of a particle in the species sorted instance data.
+			* @param particle The index of the particle.
+			* @return The slot of the particle.
+			*/
+			size_t Slot(size_t particle) const;
+
+			/**
+			* @brief Get the species of a slot.
+			* @param slot The slot in the instance data.
+			* @return The species, 0 if the particles have none.
+			*/
+			size_t SpeciesOf(size_t slot) const;
+
+			/**
+			* @brief Get the scalar the colormap maps for a slot.
+			* @param slot The slot in the instance data.
+			* @return The uploaded scalar, or the normalized particle index without one.
+			*/
+			float ScalarOf(size_t slot) const;
+
+			/// @brief Fill the packed instances from the full instances and the scalars.
+			void PackInstances();
+
+			/**
+			* @brief
+			* Give every distinct pair of particle color and scale a species and fill
+			* the species tables.
+			* @return True if the species fit in the tables, false otherwise.
+			*/
+			bool AssignSpecies();
+
+			/// @brief Sort the instance data by species and record the slot of every particle.
+			void SortBySpecies();
+
+			/**
+			* @brief
+			* Create the circle of every species in one vertex buffer, with the
+			* vertex count of its scaled radius, and the vertex array drawing them.
+			*/
+			void BuildMeshes();
+
+			/// @brief Fill the species uniform buffer from the species tables.
+			void UploadSpecies();
+
+			/**
+			* @brief
+			* Draw the circles of every species instanced, through one indirect
+			* multi-draw where OpenGL 4.3 is available. The species vertex array
+			* must be bound.
+			*/
+			void DrawBatches();
+
+			/**
+			* @brief Quantize a coordinate of the [-1, 1] box to 16 bits.
+			* @param coordinate The x or y coordinate.
+			* @return The quantized coordinate.
+			*/
+			static uint16_t QuantizeCoordinate(float coordinate);
+
+			/// @brief Quantize the scalar of every particle to 8 bits of the scalar range.
+			void QuantizeScalars();
+
+			/// @brief Fill the compact instances from the full instances, the scalars and the species.
+			void CompactInstances();
+
+			/**
+			* @brief
+			* Fill the instances of the current layout, free the others, repoint the
+			* vertex arrays and upload everything on the next render.
+			*/
+			void ChangeLayout();
+
+			/// @brief Fill the colormap texture with the current colormap.
+			void UploadColorMap();
+
+			/**
+			* @brief Set the color mode uniforms of a particle shader and bind the colormap.
+			* @param shader The shader in use.
+			*/
+			void ApplyColorUniforms(const Shader& shader) const;
+
+			/**
+			* @brief Get the culling grid cell of a coordinate, clamped to the grid.
+			* @param coordinate The x or y coordinate in the simulation box [-1, 1].
+			* @return The column or row of the cell.
+			*/
+			static int GridCell(float coordinate);
+
+			/**
+			* @brief
+			* Sort the particle indices by culling grid cell. Called once after the
+			* positions change, culling then only visits the visible cells.
+			*/
+			void BinParticles();
+
+			/**
+			* @brief
+			* Pack the particles of the cells the camera sees into the instance
+			* buffer, if the positions or the visible cells changed.
+			*/
+			void CullInstances();
+
+			/**
+			* @brief Get the radius of the largest particle in pixels.
+			* @param viewport_width The width of the viewport in pixels.
+			* @return The projected radius in pixels.
+			*/
+			float ProjectedRadius(int viewport_width) const;
+
+			/**
+			* @brief
+			* Create the objects of the density path on first use, and grow the
+			* density texture if the viewport doesn't fit in it.
+			* @param width The width of the viewport.
+			* @param height The height of the viewport.
+			* @return True if the density path can be used, false otherwise.
+			*/
+			bool SetupDensity(int width, int height);
+
+			/**
+			* @brief
+			* Draw the particles as one point each into the density texture and
+			* draw the averaged colors over the bound frame buffer.
+			* @param viewport The viewport of the bound frame buffer.
+			* @param projected_radius The particle radius in pixels.
+			*/
+			void RenderDensity(const GLint* viewport, float projected_radius);
+
 			//Member variables
 
-			/// @brief Circle object.
-			std::shared_ptr<Object::Circle> circle;
 			/// @brief Instance buffer for OpenGL instancing.
 			GLuint instance_buffer = 0;
-			/// @brief Instance data for OpenGL instancing.
+			/// @brief Instance data for OpenGL instancing, every particle.
 			std::vector<float> instance_data;
+			/// @brief Instance data in the packed layout: x, y, scale and scalar.
+			std::vector<float> packed_data;
+			/// @brief Instance data in the compact layout.
+			std::vector<CompactInstance> compact_data;
+			/// @brief Flag set when the compact layout is chosen.
+			bool compact = false;
+			/// @brief Flag set once a compact layout without species tables was reported.
+			bool compact_failed = false;
+			/// @brief Species of every slot, empty if the particles didn't fit the species tables.
+			std::vector<uint8_t> particle_species;
+			/// @brief Slot of every particle in the instance data, empty while slots are particle indices.
+			std::vector<uint32_t> particle_slots;
+			/// @brief Particle of every slot, empty while slots are particle indices.
+			std::vector<uint32_t> slot_particles;
+			/// @brief First slot of every species, plus the end.
+			std::vector<uint32_t> species_start;
+			/// @brief Uniform buffer holding the SpeciesUniforms block.
+			GLuint species_buffer = 0;
+			/// @brief Vertex array drawing the species circles instanced.
+			GLuint species_vao = 0;
+			/// @brief First vertex of the circle of every species in the mesh buffer.
+			std::vector<GLint> mesh_first;
+			/// @brief Number of vertices of the circle of every species.
+			std::vector<GLsizei> mesh_count;
+			/// @brief First instance of every species in the instance buffer.
+			std::vector<GLuint> batch_first;
+			/// @brief Number of instances of every species in the instance buffer.
+			std::vector<GLsizei> batch_count;
+			/// @brief Buffer holding the indirect draw commands.
+			GLuint indirect_buffer = 0;
+			/// @brief Scale of every species.
+			std::vector<float> species_scales;
+			/// @brief Color (red, green, blue) of every species.
+			std::vector<float> species_colors;
+			/// @brief Instance data of the particles in the visible cells, in the current layout.
+			std::vector<unsigned char> visible_data;
+			/// @brief Scalar of every particle for the Scalar color mode, empty for the particle index.
+			std::vector<float> scalars;
+			/// @brief Scalar mapped to the start of the colormap.
+			float scalar_min = 0.0f;
+			/// @brief Scalar mapped to the end of the colormap.
+			float scalar_max = 1.0f;
+			/// @brief Property the particle colors are taken from.
+			ColorBy color_by = ColorBy::ParticleColor;
+			/// @brief Colormap of the scalar color modes.
+			ColorMap color_map = ColorMap::Viridis;
+			/// @brief 1D texture holding the colormap.
+			GLuint color_map_texture = 0;
+			/// @brief Number of instances in the instance buffer.
+			size_t instance_count = 0;
+			/// @brief Index of the first slot of every grid cell in cell_particles, plus the end.
+			std::vector<uint32_t> cell_start;
+			/// @brief Slots sorted by grid cell.
+			std::vector<uint32_t> cell_particles;
+			/// @brief Grid cell of every slot.
+			std::vector<uint32_t> particle_cells;
+			/// @brief Flag set when the positions changed since they were uploaded.
+			bool positions_changed = true;
+			/// @brief Flag set when the particles are sorted by cell for the current positions.
+			bool binned = false;
+			/// @brief Visible cell range (first column, first row, last column, last row) last uploaded.
+			std::array<int, 4> uploaded_cells = { -1, -1, -1, -1 };
+			/// @brief Radius of the particles before scaling.
+			float radius = 0.0f;
+			/// @brief Largest particle scale.
+			float max_scale = 1.0f;
+			/// @brief Particle shader, for its uniform locations.
+			std::shared_ptr<Shader> particle_shader;
+			/// @brief Shader adding the particles up into the density texture.
+			std::shared_ptr<Shader> splat_shader;
+			/// @brief Shader drawing the density texture over the scene.
+			std::shared_ptr<Shader> resolve_shader;
+			/// @brief Vertex array reading one point per particle from the instance buffer.
+			GLuint point_vao = 0;
+			/// @brief Empty vertex array for the full screen triangle.
+			GLuint resolve_vao = 0;
+			/// @brief Frame buffer the density texture is attached to.
+			GLuint density_frame_buffer = 0;
+			/// @brief Float texture with the summed colors and the particle count per pixel.
+			GLuint density_texture = 0;
+			/// @brief Allocated width of the density texture.
+			int density_width = 0;
+			/// @brief Allocated height of the density texture.
+			int density_height = 0;
+			/// @brief Flag set when the density path failed to set up.
+			bool density_failed = false;
 		};
 
 		/**
 		* @details
 		* Custom constructor for the ThermodynamicsRenderItemsImpl class. Initializes
-		* instance data and instance buffer for OpenGL instancing. Creates the
-		* circle object for rendering.
+		* instance data and instance buffer for OpenGL instancing. Sorts the
+		* particles by species and creates a circle per species for rendering.
 		* Particle data is setup with the following format:
 		* x, y, z, padding, red, green, blue, padding, x_scale, y_scale, z_scale, padding
 		*/
 		ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::ThermodynamicsRenderItemsImpl(
 			std::vector<float>& particles,
 			const float radius) :
-			circle(std::make_shared<Object::Circle>(
-				radius,
-				0.0f, // x
-				0.0f, // y
-				0.0f, // z
-				1.0f, // red
-				0.0f, // green
-				0.0f)) // blue
+			radius(radius),
+			particle_shader(ShaderRegistry::Get().GetShader(PARTICLE_SHADER))
 		{
 			spdlog::info(
 				"Creating ThermodynamicsRenderItems with {} particles",
@@ -96,6 +387,19 @@ namespace Graphics
 			*/
 			instance_data = move(particles);
 
+			max_scale = 0.0f;
+			for (size_t i = 8; i + 1 < instance_data.size(); i += 12)
+				max_scale = std::max(max_scale, std::max(instance_data[i], instance_data[i + 1]));
+			if (max_scale <= 0.0f) max_scale = 1.0f;
+			instance_count = instance_data.size() / 12;
+
+			AssignSpecies();
+			SortBySpecies();
+			BuildMeshes();
+			UploadSpecies();
+
+			PROFILE_SCOPE("Instance Upload");
+
 			// Create and bind instance buffer
 			glGenBuffers(1, &instance_buffer);
 			glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
@@ -103,55 +407,19 @@ namespace Graphics
 				GL_ARRAY_BUFFER,
 				instance_data.size() * sizeof(float),
 				instance_data.data(),
-				GL_STATIC_DRAW);
+				GL_DYNAMIC_DRAW);
 
 			// Setup instanced attribute pointers when we create the instance buffer
-			GLuint vao = circle->GetVAO();
-			glBindVertexArray(vao);
-
-			// Position attribute (location 1)
-			glEnableVertexAttribArray(1);
-			glVertexAttribPointer(
-				1,
-				4,
-				GL_FLOAT,
-				GL_FALSE,
-				12 * sizeof(float),
-				(void*)0);
-			glVertexAttribDivisor(1, 1); // This makes it instanced
-
-			// Color attribute (location 2)
-			glEnableVertexAttribArray(2);
-			glVertexAttribPointer(
-				2,
-				4,
-				GL_FLOAT,
-				GL_FALSE,
-				12 * sizeof(float),
-				(void*)(4 * sizeof(float)));
-			glVertexAttribDivisor(2, 1); // This makes it instanced
-
-			// Scale attribute (location 3)
-			glEnableVertexAttribArray(3);
-			glVertexAttribPointer(
-				3,
-				4,
-				GL_FLOAT,
-				GL_FALSE,
-				12 * sizeof(float),
-				(void*)(8 * sizeof(float)));
-			glVertexAttribDivisor(3, 1); // This makes it instanced
-
-			glBindVertexArray(0);
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			SetupAttributes(species_vao, true);
 
 			GLuint err = glGetError();
 			if (err != GL_NO_ERROR)
 				spdlog::error("OpenGL error in ThermodynamicsRenderItemsImpl constructor: {}", err);
 
 			spdlog::info(
-				"ThermodynamicsRenderItems created with {} instanced particles",
-				instance_data.size() / 12);
+				"ThermodynamicsRenderItems created with {} instanced particles of {} species",
+				instance_data.size() / 12,
+				batch_first.size());
 		}
 
 		/**
@@ -167,18 +435,919 @@ namespace Graphics
 				glDeleteBuffers(1, &instance_buffer);
 				instance_buffer = 0;
 			}
+
+			glDeleteVertexArrays(1, &point_vao);
+			glDeleteVertexArrays(1, &resolve_vao);
+			glDeleteFramebuffers(1, &density_frame_buffer);
+			glDeleteTextures(1, &density_texture);
+			glDeleteTextures(1, &color_map_texture);
+			glDeleteVertexArrays(1, &species_vao);
+			glDeleteBuffers(1, &species_buffer);
+			glDeleteBuffers(1, &indirect_buffer);
+		}
+
+		/**
+		* @details
+		* The compact layout serves every color mode. Otherwise every mode except
+		* the particle color maps a scalar and uses the packed layout.
+		*/
+		ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::Layout
+			ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::GetLayout() const
+		{
+			if (compact) return Layout::Compact;
+			return color_by != ColorBy::ParticleColor ? Layout::Packed : Layout::Full;
+		}
+
+		/**
+		* @details
+		* The packed layout is 16 bytes, a third of the 48 byte full layout, and
+		* the compact layout is 8 bytes, a sixth.
+		*/
+		size_t ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::InstanceStride() const
+		{
+			switch (GetLayout())
+			{
+			case Layout::Compact:
+				return sizeof(CompactInstance);
+			case Layout::Packed:
+				return 4 * sizeof(float);
+			default:
+				return 12 * sizeof(float);
+			}
+		}
+
+		/**
+		* @details
+		* Get the instance data of the current layout.
+		*/
+		const unsigned char* ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::InstanceBytes() const
+		{
+			switch (GetLayout())
+			{
+			case Layout::Compact:
+				return (const unsigned char*)compact_data.data();
+			case Layout::Packed:
+				return (const unsigned char*)packed_data.data();
+			default:
+				return (const unsigned char*)instance_data.data();
+			}
+		}
+
+		/**
+		* @details
+		* The full layout feeds position, color and scale to locations 1 to 3.
+		* The packed layout only feeds location 1; the shaders take the scale and
+		* the color from it when colorSource isn't negative, and the disabled
+		* locations read a constant. The compact layout feeds the normalized
+		* position to location 4 and the scalar and species bytes, as integral
+		* floats, to location 5. Starting past the first instance lets one
+		* species be drawn without a base instance.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::SetupAttributes(
+			GLuint vao,
+			bool instanced,
+			size_t first_instance)
+		{
+			const GLsizei stride = GLsizei(InstanceStride());
+			const GLuint divisor = instanced ? 1 : 0;
+			const size_t base = first_instance * size_t(stride);
+
+			glBindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+
+			if (GetLayout() == Layout::Compact)
+			{
+				glDisableVertexAttribArray(1);
+				glDisableVertexAttribArray(2);
+				glDisableVertexAttribArray(3);
+
+				// Quantized position attribute (location 4)
+				glEnableVertexAttribArray(4);
+				glVertexAttribPointer(
+					4,
+					2,
+					GL_UNSIGNED_SHORT,
+					GL_TRUE,
+					stride,
+					(void*)(base + offsetof(CompactInstance, x)));
+				glVertexAttribDivisor(4, divisor);
+
+				// Scalar and species attribute (location 5)
+				glEnableVertexAttribArray(5);
+				glVertexAttribPointer(
+					5,
+					2,
+					GL_UNSIGNED_BYTE,
+					GL_FALSE,
+					stride,
+					(void*)(base + offsetof(CompactInstance, scalar)));
+				glVertexAttribDivisor(5, divisor);
+
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				return;
+			}
+
+			glDisableVertexAttribArray(4);
+			glDisableVertexAttribArray(5);
+
+			// Position attribute (location 1)
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)base);
+			glVertexAttribDivisor(1, divisor);
+
+			if (GetLayout() == Layout::Packed)
+			{
+				glDisableVertexAttribArray(2);
+				glDisableVertexAttribArray(3);
+			}
+			else
+			{
+				// Color attribute (location 2)
+				glEnableVertexAttribArray(2);
+				glVertexAttribPointer(
+					2,
+					4,
+					GL_FLOAT,
+					GL_FALSE,
+					stride,
+					(void*)(base + 4 * sizeof(float)));
+				glVertexAttribDivisor(2, divisor);
+
+				// Scale attribute (location 3)
+				glEnableVertexAttribArray(3);
+				glVertexAttribPointer(
+					3,
+					4,
+					GL_FLOAT,
+					GL_FALSE,
+					stride,
+					(void*)(base + 8 * sizeof(float)));
+				glVertexAttribDivisor(3, divisor);
+			}
+
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		/**
+		* @details
+		* Particles of a single species keep their index as slot.
+		*/
+		size_t ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::Slot(size_t particle) const
+		{
+			return particle_slots.empty() ? particle : particle_slots[particle];
+		}
+
+		/**
+		* @details
+		* Look the species of the slot up, particles without species tables are
+		* all species 0.
+		*/
+		size_t ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::SpeciesOf(size_t slot) const
+		{
+			return particle_species.empty() ? 0 : particle_species[slot];
+		}
+
+		/**
+		* @details
+		* The scalars are kept in slot order. Without uploaded scalars the index
+		* of the particle in the slot, normalized to [0, 1], is used.
+		*/
+		float ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::ScalarOf(size_t slot) const
+		{
+			const size_t count = instance_data.size() / 12;
+			if (scalars.size() == count) return scalars[slot];
+
+			const size_t particle = slot_particles.empty() ? slot : slot_particles[slot];
+			return count > 1 ? float(particle) / float(count - 1) : 0.0f;
+		}
+
+		/**
+		* @details
+		* Keep x, y and the x scale of every particle and add its scalar.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::PackInstances()
+		{
+			PROFILE_SCOPE("Instance Pack");
+
+			const size_t count = instance_data.size() / 12;
+			packed_data.resize(4 * count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				packed_data[4 * i + 0] = instance_data[12 * i + 0];
+				packed_data[4 * i + 1] = instance_data[12 * i + 1];
+				packed_data[4 * i + 2] = instance_data[12 * i + 8];
+				packed_data[4 * i + 3] = ScalarOf(i);
+			}
+		}
+
+		/**
+		* @details
+		* The simulator has no species of its own, so particles drawn alike share
+		* one: same color and same x scale. A linear search is enough for tables
+		* of MAX_SPECIES entries.
+		*/
+		bool ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::AssignSpecies()
+		{
+			const size_t count = instance_data.size() / 12;
+			species_scales.clear();
+			species_colors.clear();
+			particle_species.resize(count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const float* instance = instance_data.data() + 12 * i;
+				size_t species = 0;
+				while (species < species_scales.size() &&
+					(species_scales[species] != instance[8] ||
+					species_colors[3 * species + 0] != instance[4] ||
+					species_colors[3 * species + 1] != instance[5] ||
+					species_colors[3 * species + 2] != instance[6]))
+					species++;
+
+				if (species == species_scales.size())
+				{
+					if (species == MAX_SPECIES)
+					{
+						spdlog::warn(
+							"Particles have more than {} color and scale pairs, drawing them as one species",
+							MAX_SPECIES);
+						species_scales.clear();
+						species_colors.clear();
+						particle_species = std::vector<uint8_t>();
+						return false;
+					}
+					species_scales.push_back(instance[8]);
+					species_colors.insert(species_colors.end(), instance + 4, instance + 7);
+				}
+				particle_species[i] = uint8_t(species);
+			}
+
+			return true;
+		}
+
+		/**
+		* @details
+		* Counting sort of the slots by species, particles keep their order
+		* within a species. A single species leaves the instance data as it is.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::SortBySpecies()
+		{
+			const size_t count = instance_data.size() / 12;
+			const size_t species = std::max(species_scales.size(), size_t(1));
+			species_start.assign(species + 1, 0);
+
+			if (species == 1)
+			{
+				species_start[1] = uint32_t(count);
+				return;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				species_start[size_t(particle_species[i]) + 1]++;
+			for (size_t s = 1; s < species_start.size(); s++)
+				species_start[s] += species_start[s - 1];
+
+			std::vector<uint32_t> cursor(species_start.begin(), species_start.end() - 1);
+			particle_slots.resize(count);
+			slot_particles.resize(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				const uint32_t slot = cursor[particle_species[i]]++;
+				particle_slots[i] = slot;
+				slot_particles[slot] = uint32_t(i);
+			}
+
+			std::vector<float> sorted(instance_data.size());
+			std::vector<uint8_t> sorted_species(count);
+			for (size_t slot = 0; slot < count; slot++)
+			{
+				const size_t particle = slot_particles[slot];
+				std::copy_n(instance_data.data() + 12 * particle, 12, sorted.data() + 12 * slot);
+				sorted_species[slot] = particle_species[particle];
+			}
+			instance_data = std::move(sorted);
+			particle_species = std::move(sorted_species);
+		}
+
+		/**
+		* @details
+		* Every species draws the unit circle of the tessellation level of its
+		* scaled radius from the shared circle geometry, so small species draw
+		* fewer vertices. The shader scales it by the radius and the particle
+		* scale. No vertex data is built or uploaded, only the vertex array.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::BuildMeshes()
+		{
+			const size_t species = species_start.size() - 1;
+
+			for (size_t s = 0; s < species; s++)
+			{
+				const float scale = species_scales.empty() ? 1.0f : species_scales[s];
+				const int count = Object::Circle::VertexCount(radius * std::max(scale, 1e-6f));
+
+				mesh_first.push_back(GLint(Object::CircleGeometry::FirstVertex(count)));
+				mesh_count.push_back(GLsizei(count));
+
+				batch_first.push_back(species_start[s]);
+				batch_count.push_back(GLsizei(species_start[s + 1] - species_start[s]));
+			}
+
+			glGenVertexArrays(1, &species_vao);
+			glBindVertexArray(species_vao);
+
+			glBindBuffer(GL_ARRAY_BUFFER, Object::CircleGeometry::Get().GetVBO());
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+			glEnableVertexAttribArray(0);
+
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		/**
+		* @details
+		* The block is an std140 array of vec4, color in rgb and scale in alpha.
+		* Entries past the species count stay zero.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::UploadSpecies()
+		{
+			std::array<glm::vec4, MAX_SPECIES> table = {};
+			for (size_t s = 0; s < species_scales.size(); s++)
+			{
+				table[s] = glm::vec4(
+					species_colors[3 * s + 0],
+					species_colors[3 * s + 1],
+					species_colors[3 * s + 2],
+					species_scales[s]);
+			}
+
+			glGenBuffers(1, &species_buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, species_buffer);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(table), table.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+
+		/**
+		* @details
+		* One species is a single instanced draw. More species are one indirect
+		* multi-draw, each command drawing its circle for its range of instances
+		* through the base instance, so a mixture costs the driver as much as a
+		* single species. Without OpenGL 4.3 the instance attributes are pointed
+		* at each species in turn.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::DrawBatches()
+		{
+			const size_t species = batch_first.size();
+			if (species == 1)
+			{
+				glDrawArraysInstanced(GL_TRIANGLE_FAN, mesh_first[0], mesh_count[0], batch_count[0]);
+				return;
+			}
+
+			if (GLAD_GL_VERSION_4_3)
+			{
+				std::array<DrawArraysIndirectCommand, MAX_SPECIES> commands = {};
+				for (size_t s = 0; s < species; s++)
+				{
+					commands[s].count = GLuint(mesh_count[s]);
+					commands[s].instance_count = GLuint(batch_count[s]);
+					commands[s].first = GLuint(mesh_first[s]);
+					commands[s].base_instance = batch_first[s];
+				}
+
+				if (!indirect_buffer) glGenBuffers(1, &indirect_buffer);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+				glBufferData(
+					GL_DRAW_INDIRECT_BUFFER,
+					species * sizeof(DrawArraysIndirectCommand),
+					commands.data(),
+					GL_STREAM_DRAW);
+				glMultiDrawArraysIndirect(GL_TRIANGLE_FAN, nullptr, GLsizei(species), 0);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+				return;
+			}
+
+			for (size_t s = 0; s < species; s++)
+			{
+				if (batch_count[s] == 0) continue;
+
+				SetupAttributes(species_vao, true, batch_first[s]);
+				glBindVertexArray(species_vao);
+				glDrawArraysInstanced(GL_TRIANGLE_FAN, mesh_first[s], mesh_count[s], batch_count[s]);
+			}
+			SetupAttributes(species_vao, true);
+			glBindVertexArray(species_vao);
+		}
+
+		/**
+		* @details
+		* Map [-1, 1] onto the 16 bit range, rounding to the nearest step of
+		* about 3e-5. Coordinates outside the box are clamped to its edge.
+		*/
+		uint16_t ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::QuantizeCoordinate(
+			float coordinate)
+		{
+			const float fraction = std::clamp((coordinate + 1.0f) * 0.5f, 0.0f, 1.0f);
+			return uint16_t(std::lround(fraction * 65535.0f));
+		}
+
+		/**
+		* @details
+		* Use the same scalars as the packed layout and map the scalar range onto
+		* the 8 bit range, which the colormap can't resolve any finer.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::QuantizeScalars()
+		{
+			const size_t count = compact_data.size();
+			const float range = scalar_max != scalar_min ? scalar_max - scalar_min : 1.0f;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const float fraction = std::clamp((ScalarOf(i) - scalar_min) / range, 0.0f, 1.0f);
+				compact_data[i].scalar = uint8_t(std::lround(fraction * 255.0f));
+			}
+		}
+
+		/**
+		* @details
+		* Quantize the positions and scalars and copy the species. The z
+		* coordinate is dropped, the simulation is flat.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::CompactInstances()
+		{
+			PROFILE_SCOPE("Instance Pack");
+
+			const size_t count = instance_data.size() / 12;
+			compact_data.resize(count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				compact_data[i].x = QuantizeCoordinate(instance_data[12 * i + 0]);
+				compact_data[i].y = QuantizeCoordinate(instance_data[12 * i + 1]);
+				compact_data[i].species = particle_species[i];
+			}
+			QuantizeScalars();
+		}
+
+		/**
+		* @details
+		* Only the instances of the current layout are kept, the full instances
+		* always are since positions and culling read them.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::ChangeLayout()
+		{
+			const Layout layout = GetLayout();
+
+			if (layout == Layout::Packed) PackInstances();
+			else packed_data = std::vector<float>();
+
+			if (layout == Layout::Compact) CompactInstances();
+			else compact_data = std::vector<CompactInstance>();
+
+			SetupAttributes(species_vao, true);
+			if (point_vao) SetupAttributes(point_vao, false);
+
+			positions_changed = true;
+		}
+
+		/**
+		* @details
+		* The colormaps are piecewise linear through a few stops, sampled from
+		* the matplotlib colormaps of the same names and from Moreland's diverging
+		* cool to warm map.
+		*/
+		static void BuildColorMap(ColorMap color_map, unsigned char* rgb, int size)
+		{
+			static const float VIRIDIS[][3] = {
+				{ 0.267f, 0.005f, 0.329f }, { 0.283f, 0.141f, 0.458f },
+				{ 0.254f, 0.265f, 0.530f }, { 0.207f, 0.372f, 0.553f },
+				{ 0.164f, 0.471f, 0.558f }, { 0.128f, 0.567f, 0.551f },
+				{ 0.135f, 0.659f, 0.518f }, { 0.267f, 0.749f, 0.441f },
+				{ 0.478f, 0.821f, 0.318f }, { 0.741f, 0.873f, 0.150f },
+				{ 0.993f, 0.906f, 0.144f } };
+			static const float MAGMA[][3] = {
+				{ 0.001f, 0.000f, 0.014f }, { 0.078f, 0.054f, 0.212f },
+				{ 0.232f, 0.060f, 0.438f }, { 0.390f, 0.100f, 0.502f },
+				{ 0.550f, 0.161f, 0.506f }, { 0.716f, 0.215f, 0.475f },
+				{ 0.868f, 0.288f, 0.409f }, { 0.967f, 0.439f, 0.360f },
+				{ 0.994f, 0.624f, 0.427f }, { 0.995f, 0.812f, 0.573f },
+				{ 0.987f, 0.991f, 0.750f } };
+			static const float COOL_WARM[][3] = {
+				{ 0.230f, 0.299f, 0.754f }, { 0.552f, 0.690f, 0.996f },
+				{ 0.866f, 0.866f, 0.866f }, { 0.956f, 0.604f, 0.486f },
+				{ 0.706f, 0.016f, 0.150f } };
+			static const float GRAYSCALE[][3] = {
+				{ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } };
+
+			const float (*stops)[3] = VIRIDIS;
+			int count = int(std::size(VIRIDIS));
+			if (color_map == ColorMap::Magma)
+			{
+				stops = MAGMA;
+				count = int(std::size(MAGMA));
+			}
+			else if (color_map == ColorMap::CoolWarm)
+			{
+				stops = COOL_WARM;
+				count = int(std::size(COOL_WARM));
+			}
+			else if (color_map == ColorMap::Grayscale)
+			{
+				stops = GRAYSCALE;
+				count = int(std::size(GRAYSCALE));
+			}
+
+			for (int i = 0; i < size; i++)
+			{
+				const float t = float(i) / float(size - 1) * float(count - 1);
+				const int stop = std::min(int(t), count - 2);
+				const float f = t - float(stop);
+				for (int c = 0; c < 3; c++)
+				{
+					const float value = stops[stop][c] + f * (stops[stop + 1][c] - stops[stop][c]);
+					rgb[3 * i + c] = (unsigned char)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+				}
+			}
+		}
+
+		/**
+		* @details
+		* Create the texture on first use and replace its texels. Switching
+		* colormaps uploads 768 bytes and touches no instance.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::UploadColorMap()
+		{
+			unsigned char rgb[3 * COLOR_MAP_SIZE];
+			BuildColorMap(color_map, rgb, COLOR_MAP_SIZE);
+
+			if (!color_map_texture) glGenTextures(1, &color_map_texture);
+
+			glBindTexture(GL_TEXTURE_1D, color_map_texture);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage1D(
+				GL_TEXTURE_1D,
+				0,
+				GL_RGB8,
+				COLOR_MAP_SIZE,
+				0,
+				GL_RGB,
+				GL_UNSIGNED_BYTE,
+				rgb);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_1D, 0);
+		}
+
+		/**
+		* @details
+		* The particle color mode sets colorSource to -1 and needs no colormap.
+		* The scalar modes bind the colormap to texture unit 1, unit 0 is left to
+		* the density resolve.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::ApplyColorUniforms(
+			const Shader& shader) const
+		{
+			int source = -1;
+			float range_min = 0.0f;
+			float range_max = 1.0f;
+
+			switch (color_by)
+			{
+			case ColorBy::Scalar:
+				source = 0;
+				range_min = scalar_min;
+				range_max = scalar_max;
+				break;
+			case ColorBy::PositionX:
+				source = 1;
+				range_min = -1.0f;
+				break;
+			case ColorBy::PositionY:
+				source = 2;
+				range_min = -1.0f;
+				break;
+			case ColorBy::Distance:
+				source = 3;
+				range_max = std::sqrt(2.0f);
+				break;
+			default:
+				break;
+			}
+			if (range_max == range_min) range_max = range_min + 1.0f;
+
+			glUniform1i(shader.GetUniformLocation("colorSource"), source);
+			glUniform2f(shader.GetUniformLocation("colorRange"), range_min, range_max);
+			glUniform1i(shader.GetUniformLocation("colorMap"), 1);
+			glUniform1i(shader.GetUniformLocation("compactInstances"), compact ? 1 : 0);
+
+			if (source < 0) return;
+
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_1D, color_map_texture);
+			glActiveTexture(GL_TEXTURE0);
+		}
+
+		/**
+		* @details
+		* Map [-1, 1] onto the grid columns. Particles outside the box belong to
+		* the cells on its edge.
+		*/
+		int ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::GridCell(float coordinate)
+		{
+			const int cell = int(std::floor((coordinate + 1.0f) * 0.5f * GRID_CELLS));
+			return std::clamp(cell, 0, GRID_CELLS - 1);
+		}
+
+		/**
+		* @details
+		* Counting sort: count the particles of every cell, turn the counts into
+		* start offsets and place every particle index after its cell's start.
+		* Particles keep their order within a cell.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::BinParticles()
+		{
+			const size_t count = instance_data.size() / 12;
+			cell_start.assign(size_t(GRID_CELLS) * GRID_CELLS + 1, 0);
+			particle_cells.resize(count);
+			cell_particles.resize(count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const int column = GridCell(instance_data[12 * i + 0]);
+				const int row = GridCell(instance_data[12 * i + 1]);
+				particle_cells[i] = uint32_t(row * GRID_CELLS + column);
+				cell_start[particle_cells[i] + 1]++;
+			}
+
+			for (size_t c = 1; c < cell_start.size(); c++)
+				cell_start[c] += cell_start[c - 1];
+
+			std::vector<uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+			for (size_t i = 0; i < count; i++)
+				cell_particles[cursor[particle_cells[i]]++] = uint32_t(i);
+
+			binned = true;
+		}
+
+		/**
+		* @details
+		* The visible rectangle is the inverse of the simulation projection
+		* applied to the corners of clip space, grown by a particle radius so
+		* circles reaching in from outside are kept. When every cell is visible
+		* the instance data is uploaded as it is. Otherwise only the particles
+		* of the visible cells are copied, so zooming into a hundredth of the box
+		* packs, uploads and draws about a hundredth of the particles. The copies
+		* stay grouped by species, like the instance data, so every species
+		* remains one range of instances. Nothing is uploaded while neither the
+		* positions nor the visible cells change.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::CullInstances()
+		{
+			const glm::mat4& projection =
+				ShaderRegistry::Get().GetFrameUniforms().simulation_projection;
+			const float pad = radius * max_scale;
+			const float x0 = (-1.0f - projection[3][0]) / projection[0][0];
+			const float x1 = (1.0f - projection[3][0]) / projection[0][0];
+			const float y0 = (-1.0f - projection[3][1]) / projection[1][1];
+			const float y1 = (1.0f - projection[3][1]) / projection[1][1];
+
+			const std::array<int, 4> cells = {
+				GridCell(std::min(x0, x1) - pad),
+				GridCell(std::min(y0, y1) - pad),
+				GridCell(std::max(x0, x1) + pad),
+				GridCell(std::max(y0, y1) + pad) };
+
+			const bool all_visible =
+				cells[0] == 0 && cells[1] == 0 &&
+				cells[2] == GRID_CELLS - 1 && cells[3] == GRID_CELLS - 1;
+
+			if (!positions_changed && cells == uploaded_cells) return;
+
+			PROFILE_SCOPE("Instance Cull");
+
+			const size_t stride = InstanceStride();
+			const unsigned char* data = InstanceBytes();
+			const size_t species = batch_first.size();
+			instance_count = instance_data.size() / 12;
+
+			for (size_t s = 0; s < species; s++)
+			{
+				batch_first[s] = species_start[s];
+				batch_count[s] = GLsizei(species_start[s + 1] - species_start[s]);
+			}
+
+			if (!all_visible)
+			{
+				if (!binned) BinParticles();
+
+				//Count the visible particles of every species, then copy them into their species' range
+				std::fill(batch_count.begin(), batch_count.end(), 0);
+				for (int row = cells[1]; row <= cells[3]; row++)
+				{
+					const uint32_t first = cell_start[size_t(row) * GRID_CELLS + cells[0]];
+					const uint32_t last = cell_start[size_t(row) * GRID_CELLS + cells[2] + 1];
+					for (uint32_t k = first; k < last; k++)
+						batch_count[SpeciesOf(cell_particles[k])]++;
+				}
+
+				instance_count = 0;
+				for (size_t s = 0; s < species; s++)
+				{
+					batch_first[s] = GLuint(instance_count);
+					instance_count += size_t(batch_count[s]);
+				}
+
+				std::vector<GLuint> cursor(batch_first);
+				visible_data.resize(instance_count * stride);
+				for (int row = cells[1]; row <= cells[3]; row++)
+				{
+					const uint32_t first = cell_start[size_t(row) * GRID_CELLS + cells[0]];
+					const uint32_t last = cell_start[size_t(row) * GRID_CELLS + cells[2] + 1];
+					for (uint32_t k = first; k < last; k++)
+					{
+						const size_t slot = cell_particles[k];
+						std::memcpy(
+							visible_data.data() + stride * cursor[SpeciesOf(slot)]++,
+							data + stride * slot,
+							stride);
+					}
+				}
+
+				data = visible_data.data();
+			}
+
+			//Orphan the whole buffer so the driver doesn't wait for draws still reading it
+			glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+			glBufferData(
+				GL_ARRAY_BUFFER,
+				(instance_data.size() / 12) * stride,
+				nullptr,
+				GL_DYNAMIC_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, instance_count * stride, data);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			uploaded_cells = cells;
+			positions_changed = false;
+		}
+
+		/**
+		* @details
+		* Scale the radius by the simulation projection, which maps the simulation
+		* onto [-1, 1] across the viewport, and by half the viewport width.
+		*/
+		float ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::ProjectedRadius(
+			int viewport_width) const
+		{
+			const FrameUniforms& uniforms = ShaderRegistry::Get().GetFrameUniforms();
+			return radius * max_scale *
+				std::abs(uniforms.simulation_projection[0][0]) *
+				0.5f * float(viewport_width);
+		}
+
+		/**
+		* @details
+		* The point vertex array reads the instance of every particle as plain
+		* vertex attributes from the instance buffer, so the density path
+		* shares the uploads of the instanced path. The density texture holds
+		* 32 bit floats so the counts stay exact, and like the render texture it
+		* only grows and is drawn into through the viewport.
+		*/
+		bool ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::SetupDensity(
+			int width,
+			int height)
+		{
+			if (density_failed) return false;
+
+			if (!splat_shader)
+			{
+				splat_shader = ShaderRegistry::Get().GetShader(DENSITY_SPLAT_SHADER);
+				resolve_shader = ShaderRegistry::Get().GetShader(DENSITY_RESOLVE_SHADER);
+				if (!splat_shader || splat_shader->GetErrorStatus() ||
+					!resolve_shader || resolve_shader->GetErrorStatus())
+				{
+					spdlog::error("Density shaders are not valid, drawing every particle");
+					density_failed = true;
+					return false;
+				}
+
+				glGenVertexArrays(1, &point_vao);
+				SetupAttributes(point_vao, false);
+
+				glGenVertexArrays(1, &resolve_vao);
+				glGenFramebuffers(1, &density_frame_buffer);
+				glGenTextures(1, &density_texture);
+			}
+
+			if (width <= density_width && height <= density_height) return true;
+
+			density_width = std::max(width, density_width);
+			density_height = std::max(height, density_height);
+
+			spdlog::info("Setting up density texture: {} x {}", density_width, density_height);
+
+			glBindTexture(GL_TEXTURE_2D, density_texture);
+			glTexImage2D(
+				GL_TEXTURE_2D,
+				0,
+				GL_RGBA32F,
+				density_width,
+				density_height,
+				0,
+				GL_RGBA,
+				GL_FLOAT,
+				nullptr);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			GLint previous = 0;
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+			glBindFramebuffer(GL_FRAMEBUFFER, density_frame_buffer);
+			glFramebufferTexture2D(
+				GL_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0,
+				GL_TEXTURE_2D,
+				density_texture,
+				0);
+			const bool complete =
+				glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+			glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+			if (!complete)
+			{
+				spdlog::error("Density framebuffer is not complete, drawing every particle");
+				density_failed = true;
+			}
+			return complete;
+		}
+
+		/**
+		* @details
+		* Additive blending sums the colors and counts the particles of every
+		* pixel in one pass over the instance buffer, which costs a vertex per
+		* particle instead of a whole circle. The resolve pass then draws the
+		* average color of each pixel over the background. A particle covers
+		* particle_area of its pixel, so with n particles the pixel is covered
+		* by 1 - (1 - particle_area)^n, which fades sparse regions into the
+		* background like the circles would.
+		*/
+		void ThermodynamicsRenderItems::ThermodynamicsRenderItemsImpl::RenderDensity(
+			const GLint* viewport,
+			float projected_radius)
+		{
+			PROFILE_SCOPE("Particle Density");
+
+			GLint previous = 0;
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, density_frame_buffer);
+			glViewport(0, 0, viewport[2], viewport[3]);
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+
+			glUseProgram(splat_shader->GetGLFWShader());
+			ApplyColorUniforms(*splat_shader);
+			glBindVertexArray(point_vao);
+			glDrawArrays(GL_POINTS, 0, GLsizei(instance_count));
+
+			glBindFramebuffer(GL_FRAMEBUFFER, previous);
+			glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			const float pi = 3.14159265f;
+			const float particle_area = std::min(pi * projected_radius * projected_radius, 1.0f);
+
+			glUseProgram(resolve_shader->GetGLFWShader());
+			glUniform1i(resolve_shader->GetUniformLocation("density"), 0);
+			glUniform1f(resolve_shader->GetUniformLocation("particleArea"), particle_area);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, density_texture);
+
+			glBindVertexArray(resolve_vao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			glBindVertexArray(0);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glDisable(GL_BLEND);
 		}
 
 		/**
 		* @details
 		* Custom constructor for the ThermodynamicsRenderItems class. Passes the
 		* particles and radius to the PIMPL implementation. Initializes the parent
-		* class with the vertex and fragment shader file paths.
+		* class with the particle shader.
 		*/
 		ThermodynamicsRenderItems::ThermodynamicsRenderItems(
 			std::vector<float>& particles,
 			const float radius) :
-			SimulationRenderItems(PARTICLE_VS_PATH, PARTICLE_FS_PATH),
+			SimulationRenderItems(PARTICLE_SHADER),
 			_impl(std::make_unique<ThermodynamicsRenderItemsImpl>(
 				particles,
 				radius))
@@ -198,10 +1367,68 @@ namespace Graphics
 
 		/**
 		* @details
-		* Render the items in the simulation.
+		* Write the positions into the slots of their particles in the species
+		* sorted instance data. The particles in view are packed and uploaded by
+		* the next render, once the camera is known. Positions for a different
+		* particle count are rejected.
+		*/
+		void ThermodynamicsRenderItems::UpdatePositions(const std::vector<float>& positions)
+		{
+			PROFILE_SCOPE("Instance Update");
+
+			const size_t count = _impl->instance_data.size() / 12;
+			if (positions.size() != 3 * count || !_impl->instance_buffer)
+			{
+				spdlog::error(
+					"Position update for {} particles doesn't match {} instances",
+					positions.size() / 3,
+					count);
+				return;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const size_t slot = _impl->Slot(i);
+				_impl->instance_data[12 * slot + 0] = positions[3 * i + 0];
+				_impl->instance_data[12 * slot + 1] = positions[3 * i + 1];
+				_impl->instance_data[12 * slot + 2] = positions[3 * i + 2];
+			}
+
+			if (_impl->GetLayout() == ThermodynamicsRenderItemsImpl::Layout::Packed)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					const size_t slot = _impl->Slot(i);
+					_impl->packed_data[4 * slot + 0] = positions[3 * i + 0];
+					_impl->packed_data[4 * slot + 1] = positions[3 * i + 1];
+				}
+			}
+			else if (_impl->GetLayout() == ThermodynamicsRenderItemsImpl::Layout::Compact)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					const size_t slot = _impl->Slot(i);
+					_impl->compact_data[slot].x = _impl->QuantizeCoordinate(positions[3 * i + 0]);
+					_impl->compact_data[slot].y = _impl->QuantizeCoordinate(positions[3 * i + 1]);
+				}
+			}
+
+			_impl->positions_changed = true;
+			_impl->binned = false;
+		}
+
+		/**
+		* @details
+		* Render the items in the simulation. The projection comes from the frame
+		* uniform buffer, so no uniforms are set per draw. Particles smaller than
+		* a pixel are drawn as a density image instead of as circles, which keeps
+		* views of millions of particles interactive. Only the particles in the
+		* grid cells the camera sees are uploaded and drawn.
 		*/
 		void ThermodynamicsRenderItems::Render()
 		{
+			PROFILE_SCOPE("Particle Draw");
+
 			if (_impl->instance_data.empty() || !_impl->instance_buffer)
 				return;
 
@@ -213,53 +1440,122 @@ namespace Graphics
 				return;
 			}
 
-			glUseProgram(shader);
+			_impl->CullInstances();
+			if (_impl->instance_count == 0) return;
+
+			glBindBufferBase(
+				GL_UNIFORM_BUFFER,
+				ShaderRegistry::SPECIES_UNIFORMS_BINDING,
+				_impl->species_buffer);
 
-			glm::mat4 model = glm::mat4(1.0f);
-			GLuint model_loc = glGetUniformLocation(shader, "model");
-			glUniformMatrix4fv(model_loc, 1, GL_FALSE, glm::value_ptr(model));
+			GLint viewport[4] = {};
+			glGetIntegerv(GL_VIEWPORT, viewport);
 
-			if (model_loc == -1)
+			const float projected_radius = _impl->ProjectedRadius(viewport[2]);
+			if (projected_radius < ThermodynamicsRenderItemsImpl::LOD_RADIUS_PIXELS &&
+				_impl->SetupDensity(viewport[2], viewport[3]))
 			{
-				spdlog::error("Model matrix uniform location not found");
+				_impl->RenderDensity(viewport, projected_radius);
 				return;
 			}
 
-			glm::mat4 projection = glm::ortho(
-				-1.0f, 1.0f,
-				-1.0f, 1.0f,
-				-1.0f, 1.0f);
+			glUseProgram(shader);
+			_impl->ApplyColorUniforms(*_impl->particle_shader);
+			glUniform1f(_impl->particle_shader->GetUniformLocation("meshRadius"), _impl->radius);
+
+			//Bind the instance buffer
+			glBindBuffer(GL_ARRAY_BUFFER, _impl->instance_buffer);
 
-			GLuint projection_loc = glGetUniformLocation(shader, "projection");
-			glUniformMatrix4fv(projection_loc, 1, GL_FALSE, glm::value_ptr(projection));
+			//Render all particles using OpenGL instancing, one batch per species
+			glBindVertexArray(_impl->species_vao);
+			_impl->DrawBatches();
+			glBindVertexArray(0);
+		}
 
-			if (projection_loc == -1)
+		/**
+		* @details
+		* A new colormap only replaces the colormap texture. Moving between the
+		* particle color and the scalar modes changes the float instance layout,
+		* so the instances are repacked, the vertex arrays repointed and
+		* everything is uploaded once by the next render. The compact layout
+		* serves every mode and isn't touched.
+		*/
+		void ThermodynamicsRenderItems::SetColorMode(ColorBy color_by, ColorMap color_map)
+		{
+			if (color_map != _impl->color_map || !_impl->color_map_texture)
 			{
-				spdlog::error("Projection matrix uniform location not found");
-				return;
+				_impl->color_map = color_map;
+				_impl->UploadColorMap();
 			}
 
-			GLuint err = glGetError();
-			if (err != GL_NO_ERROR)
-				spdlog::error("OpenGL error in setting uniforms: {}", err);
+			if (color_by == _impl->color_by) return;
 
-			//Bind the instance buffer
-			glBindBuffer(GL_ARRAY_BUFFER, _impl->instance_buffer);
+			const ThermodynamicsRenderItemsImpl::Layout previous = _impl->GetLayout();
+			_impl->color_by = color_by;
+			if (_impl->GetLayout() != previous) _impl->ChangeLayout();
+		}
 
-			//Render all particles using OpenGL instancing
-			glBindVertexArray(_impl->circle->GetVAO());
+		/**
+		* @details
+		* Keep the scalars for the packed and compact layouts and write them
+		* into the one in use. Scalars for a different particle count are
+		* rejected.
+		*/
+		void ThermodynamicsRenderItems::UpdateScalars(
+			const std::vector<float>& scalars,
+			float min,
+			float max)
+		{
+			const size_t count = _impl->instance_data.size() / 12;
+			if (scalars.size() != count)
+			{
+				spdlog::error(
+					"Scalar update for {} particles doesn't match {} instances",
+					scalars.size(),
+					count);
+				return;
+			}
 
-			glDrawArraysInstanced(
-				GL_TRIANGLE_FAN,
-				0,
-				_impl->circle->GetNumVertices(),
-				int(_impl->instance_data.size() / 12));
+			_impl->scalars.resize(count);
+			for (size_t i = 0; i < count; i++)
+				_impl->scalars[_impl->Slot(i)] = scalars[i];
+			_impl->scalar_min = min;
+			_impl->scalar_max = max;
 
-			glBindVertexArray(0);
+			switch (_impl->GetLayout())
+			{
+			case ThermodynamicsRenderItemsImpl::Layout::Packed:
+				for (size_t slot = 0; slot < count; slot++)
+					_impl->packed_data[4 * slot + 3] = _impl->scalars[slot];
+				break;
+			case ThermodynamicsRenderItemsImpl::Layout::Compact:
+				_impl->QuantizeScalars();
+				break;
+			default:
+				return;
+			}
+			_impl->positions_changed = true;
+		}
 
-			err = glGetError();
-			if (err != GL_NO_ERROR)
-				spdlog::error("OpenGL error in ThermodynamicsRenderItems::Render: {}", err);
+		/**
+		* @details
+		* The species were assigned with the instance data, the compact layout
+		* needs their tables. Particles that didn't fit them are reported once
+		* and stay in the float layouts, since the layout is set every frame.
+		*/
+		void ThermodynamicsRenderItems::SetCompactInstances(bool compact)
+		{
+			if (compact == _impl->compact) return;
+			if (compact && _impl->species_scales.empty())
+			{
+				if (!_impl->compact_failed)
+					spdlog::warn("Particles have no species tables, keeping the float instances");
+				_impl->compact_failed = true;
+				return;
+			}
+
+			_impl->compact = compact;
+			_impl->ChangeLayout();
 		}
 	}
 }
\ No newline at end of file
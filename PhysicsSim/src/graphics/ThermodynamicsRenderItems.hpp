@@ -29,13 +29,6 @@ namespace Graphics
 	/// @brief SimulationRenderStructs namespace
 	namespace SimulationRenderStructs
 	{
-		/// @brief Thermodynamics particle vertex shader file path
-		static const std::string PARTICLE_VS_PATH =
-			"src/graphics/shaders/ParticleVertexShader.vs";
-		/// @brief Thermodynamics particle fragment shader file path
-		static const std::string PARTICLE_FS_PATH =
-			"src/graphics/shaders/ParticleFragmentShader.fs";
-
 		/// @brief ThermodynamicsRenderItems class
 		class ThermodynamicsRenderItems : public SimulationRenderItems
 		{
@@ -74,6 +67,40 @@ namespace Graphics
 			/// @brief Render method for the thermodynamic simulation items.
 			void Render() override;
 
+			/**
+			* @brief Update the particle positions and upload them to the instance buffer.
+			* @param positions Three floats (x, y, z) per particle.
+			*/
+			void UpdatePositions(const std::vector<float>& positions) override;
+
+			/**
+			* @brief
+			* Choose how the particles are colored. Switching between the particle
+			* color and a scalar mode repacks the instances once, switching between
+			* scalar modes or colormaps only changes uniforms.
+			* @param color_by The property the colors are taken from.
+			* @param color_map The colormap the scalar modes map through.
+			*/
+			void SetColorMode(ColorBy color_by, ColorMap color_map) override;
+
+			/**
+			* @brief Upload the per-particle scalar the Scalar color mode maps.
+			* @param scalars One float per particle.
+			* @param min The scalar mapped to the start of the colormap.
+			* @param max The scalar mapped to the end of the colormap.
+			*/
+			void UpdateScalars(const std::vector<float>& scalars, float min, float max) override;
+
+			/**
+			* @brief
+			* Choose the compact layout of 8 bytes per particle: quantized positions,
+			* an 8 bit scalar and a species indexing radius and color tables. Stays
+			* in the float layouts if the particles have more distinct radius and
+			* color pairs than the tables hold.
+			* @param compact True for the compact layout, false for the float layouts.
+			*/
+			void SetCompactInstances(bool compact) override;
+
 			//PIMPL idiom
 		private:
 			/// @brief Forward declaration of ThermodynamicsRenderItemsImpl struct.
@@ -4,12 +4,18 @@
 * Main function for the graphics library. Used as a testing environment.
 */
 
+#include "BatchRenderer.hpp"
 #include "Scene.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "Texture.hpp"
 #include "ThermodynamicsRenderItems.hpp"
+#include "objects/Circle.hpp"
 
 #include "spdlog/spdlog.h"
 
+#include <chrono>
 #include <random>
+#include <thread>
 
 /// @brief Create a test scene to work with.
 static std::shared_ptr<Graphics::Scene> CreateTestScene()
@@ -134,10 +140,148 @@ static void TestParticleGenerationAndRendering()
 	}
 }
 
+/// @brief Test drawing objects through the scene's batch renderer.
+static void TestObjectBatching()
+{
+	auto scene = CreateTestScene();
+
+	// Circles of a few radii, so a handful of tessellation levels is drawn.
+	const float radii[3] = { 0.01f, 0.03f, 0.08f };
+	std::vector<std::unique_ptr<Object::Circle>> circles;
+	for (int row = 0; row < 20; row++)
+	{
+		for (int column = 0; column < 20; column++)
+		{
+			const float x = -0.95f + 0.1f * column;
+			const float y = -0.95f + 0.1f * row;
+			circles.push_back(std::make_unique<Object::Circle>(
+				radii[(row + column) % 3],
+				x,
+				y,
+				0.0f,
+				0.5f + 0.5f * x,
+				0.5f + 0.5f * y,
+				1.0f));
+		}
+	}
+
+	bool logged = false;
+
+	// Generic OpenGL loop.
+	while (!scene->WindowShouldClose())
+	{
+		scene->PollEvents();
+		scene->Render();
+		for (const auto& circle : circles) circle->Draw(scene->GetBatchRenderer());
+		scene->RenderSimulationItems();
+		scene->RenderTexture();
+		scene->SwapBuffers();
+
+		if (!logged)
+		{
+			spdlog::info(
+				"Drew {} circles in {} draw calls",
+				scene->GetBatchRenderer().GetInstances(),
+				scene->GetBatchRenderer().GetDrawCalls());
+			logged = true;
+		}
+	}
+
+	// The circles share the scene's circle geometry, so they go first.
+	circles.clear();
+}
+
+/// @brief Time the CPU rasterizer on a million particles, on one thread and on all of them.
+static void TestSoftwareRasterizer()
+{
+	const int width = 1024;
+	const int height = 768;
+	const size_t num_particles = 1000000;
+	const int frames = 10;
+
+	std::vector<float> particles = GenerateParticles(int(num_particles), width, height);
+	std::vector<float> positions(num_particles * 3);
+	std::vector<float> colors(num_particles * 3);
+	std::vector<float> scales(num_particles * 3);
+	for (size_t i = 0; i < num_particles; i++)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			positions[i * 3 + j] = particles[i * 12 + j];
+			colors[i * 3 + j] = particles[i * 12 + 4 + j];
+			scales[i * 3 + j] = particles[i * 12 + 8 + j];
+		}
+	}
+	const float radius = 1.0f / (width / 2.0f);
+
+	for (unsigned int threads : { 1u, 0u })
+	{
+		Graphics::SoftwareRasterizer rasterizer(width, height, threads);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			rasterizer.Render(
+				positions.data(),
+				colors.data(),
+				scales.data(),
+				num_particles,
+				radius);
+		}
+		const std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::steady_clock::now() - start;
+
+		spdlog::info(
+			"Rasterized {} particles at {}x{} on {} threads in {:.1f} ms per frame",
+			num_particles,
+			width,
+			height,
+			threads == 0 ? std::thread::hardware_concurrency() : threads,
+			elapsed.count() / frames);
+	}
+}
+
+/// @brief Test that a window drag reallocates the render texture once and reuses pooled frame buffers.
+static void TestTextureResize()
+{
+	auto scene = CreateTestScene();
+	if (scene == nullptr) return;
+
+	Graphics::Texture texture(640, 360);
+	unsigned int frame_buffer = texture.GetFramebufferId();
+	const unsigned int first_frame_buffer = frame_buffer;
+	int allocations = 0;
+
+	auto resize = [&](int width, int height)
+	{
+		texture.Resize(width, height);
+		if (texture.GetFramebufferId() != frame_buffer)
+		{
+			frame_buffer = texture.GetFramebufferId();
+			allocations++;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	};
+
+	// A drag changes the size every frame, then holds it.
+	for (int frame = 0; frame < 100; frame++) resize(640 + 6 * frame, 360 + 3 * frame);
+	for (int frame = 0; frame < 40; frame++) resize(1234, 657);
+	spdlog::info("Drag to 1234x657 allocated {} frame buffers", allocations);
+
+	// Shrinking back leaves most of the allocation unused, so the pooled one returns.
+	for (int frame = 0; frame < 40; frame++) resize(640, 360);
+	spdlog::info(
+		"Shrink to 640x360 {} the first frame buffer",
+		frame_buffer == first_frame_buffer ? "reused" : "did not reuse");
+}
+
 int main()
 {
+	TestSoftwareRasterizer();
+	TestTextureResize();
 	//TestSceneManager();
 	TestParticleGenerationAndRendering();
+	TestObjectBatching();
 
 	return 0;
 }
\ No newline at end of file
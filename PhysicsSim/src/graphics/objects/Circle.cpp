@@ -6,11 +6,9 @@
 */
 
 #include "Circle.hpp"
+#include "CircleGeometry.hpp"
 #include "utils/GlfwIncludes.hpp"
 
-#include <cmath>
-#include <vector>
-
 /// @brief Object namespace
 namespace Object
 {
@@ -83,34 +81,14 @@ namespace Object
 		Object(x, y, z, red, green, blue),
 		_impl(std::make_unique<CircleImpl>(r))
 	{
-		std::vector<glm::vec2> vertices;
-
-		/*
-		* Determine the number of vertices based on the radius. Essentially scaled
-		* by the equation:
-		* max - (max - min) * max_r / r
-		* Where max_r / r is in (0, 1]. If the number of vertices is less than the
-		* minimum, set it to the minimum.
-		*/
-		const float max_num_vertices = 30.0f;
-		const float min_num_vertices = 10.0f;
-		const float diff = max_num_vertices - min_num_vertices;
-		const float max_radius = 0.10f;
-		int num_vertices = int(max_num_vertices - diff * max_radius / r);
-
-		if (num_vertices < min_num_vertices) num_vertices = int(min_num_vertices);
-
-		//Calculate each vertex along the circumference.
-		const float angle = 2.0f * 3.14159f / num_vertices;
-		for (int i = 0; i < num_vertices; i++)
-		{
-			const float x = r * cosf(i * angle);
-			const float y = r * sinf(i * angle);
-			vertices.push_back(glm::vec2(x, y));
-		}
-
-		//Set the vertices in the parent class.
-		SetVertices(vertices);
+		//Draw the unit circle of the tessellation level from the shared geometry, scaled to the radius
+		const int num_vertices = VertexCount(r);
+		SetSharedVertices(
+			CircleGeometry::Get().GetVAO(num_vertices),
+			CircleGeometry::Get().GetVBO(),
+			CircleGeometry::FirstVertex(num_vertices),
+			num_vertices,
+			r);
 	}
 
 	/**
@@ -133,4 +111,25 @@ namespace Object
 	{
 		return _impl->radius;
 	}
+
+	/**
+	* @details
+	* Determine the number of vertices based on the radius. Essentially scaled
+	* by the equation:
+	* max - (max - min) * max_r / r
+	* Where max_r / r is in (0, 1]. If the number of vertices is less than the
+	* minimum, set it to the minimum. The bounds are the tessellation levels of
+	* the shared circle geometry.
+	*/
+	int Circle::VertexCount(const float r)
+	{
+		const float max_num_vertices = float(CircleGeometry::MAX_VERTICES);
+		const float min_num_vertices = float(CircleGeometry::MIN_VERTICES);
+		const float diff = max_num_vertices - min_num_vertices;
+		const float max_radius = 0.10f;
+		int num_vertices = int(max_num_vertices - diff * max_radius / r);
+
+		if (num_vertices < min_num_vertices) num_vertices = int(min_num_vertices);
+		return num_vertices;
+	}
 }
\ No newline at end of file
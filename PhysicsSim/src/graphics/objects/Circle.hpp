@@ -14,6 +14,7 @@
 
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 
 //External forward declarations
 
@@ -83,6 +84,13 @@ namespace Object
 		*/
 		float GetRadius() const;
 
+		/**
+		* @brief Get the number of vertices a circle of the given radius is drawn with.
+		* @param r The radius of the circle.
+		* @return The number of vertices, fewer for smaller circles.
+		*/
+		static int VertexCount(const float r);
+
 		//PIMPL idiom
 	private:
 		/// @brief Forward declaration of CircleImpl.
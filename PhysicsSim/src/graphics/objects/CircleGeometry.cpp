@@ -0,0 +1,235 @@
+/**
+* @file CircleGeometry.cpp
+* @brief
+* Function definitions for the CircleGeometry class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "CircleGeometry.hpp"
+#include "utils/GlfwIncludes.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <array>
+
+/// @brief Object namespace
+namespace Object
+{
+	/// @brief Pi in double precision.
+	static constexpr double PI = 3.14159265358979323846;
+
+	/**
+	* @brief Sine evaluated at compile time.
+	* @param x The angle in [-pi, pi].
+	* @return The sine of the angle.
+	*/
+	static constexpr double ConstexprSin(const double x)
+	{
+		//Taylor series, the twelfth term is below 1e-12 on [-pi, pi]
+		double term = x;
+		double sum = x;
+		for (int n = 1; n < 13; n++)
+		{
+			term *= -x * x / double((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	/**
+	* @brief Cosine evaluated at compile time.
+	* @param x The angle in [-pi, pi].
+	* @return The cosine of the angle.
+	*/
+	static constexpr double ConstexprCos(const double x)
+	{
+		double term = 1.0;
+		double sum = 1.0;
+		for (int n = 1; n < 13; n++)
+		{
+			term *= -x * x / double((2 * n - 1) * (2 * n));
+			sum += term;
+		}
+		return sum;
+	}
+
+	/**
+	* @brief
+	* Build the unit circle of every tessellation level after each other, the
+	* vertices of a level evenly spaced counterclockwise from (1, 0).
+	* @return The x and y of every vertex.
+	*/
+	static constexpr std::array<float, 2 * CircleGeometry::TOTAL_VERTICES> BuildUnitCircles()
+	{
+		std::array<float, 2 * CircleGeometry::TOTAL_VERTICES> table = {};
+		int vertex = 0;
+		for (int n = CircleGeometry::MIN_VERTICES; n <= CircleGeometry::MAX_VERTICES; n++)
+		{
+			for (int i = 0; i < n; i++)
+			{
+				double angle = 2.0 * PI * double(i) / double(n);
+				if (angle > PI) angle -= 2.0 * PI;
+				table[2 * vertex + 0] = float(ConstexprCos(angle));
+				table[2 * vertex + 1] = float(ConstexprSin(angle));
+				vertex++;
+			}
+		}
+		return table;
+	}
+
+	/// @brief Unit circles of every tessellation level, computed at compile time.
+	static constexpr std::array<float, 2 * CircleGeometry::TOTAL_VERTICES> UNIT_CIRCLES =
+		BuildUnitCircles();
+
+	static_assert(
+		CircleGeometry::FirstVertex(CircleGeometry::MAX_VERTICES + 1) == CircleGeometry::TOTAL_VERTICES,
+		"The tessellation levels must fill the unit circle table");
+	static_assert(
+		UNIT_CIRCLES[0] == 1.0f && UNIT_CIRCLES[1] == 0.0f,
+		"Every unit circle starts at (1, 0)");
+
+	/// @brief CircleGeometry PIMPL implementation structure.
+	struct CircleGeometry::CircleGeometryImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		CircleGeometryImpl(const CircleGeometryImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		CircleGeometryImpl& operator=(const CircleGeometryImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		CircleGeometryImpl(const CircleGeometryImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		CircleGeometryImpl& operator=(const CircleGeometryImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		CircleGeometryImpl() = default;
+		/// @brief Default destructor.
+		~CircleGeometryImpl() = default;
+
+		//Member variables
+
+		/// @brief Vertex buffer shared by every circle.
+		GLuint vbo = 0;
+		/// @brief Vertex array of every tessellation level, from MIN_VERTICES up.
+		std::array<GLuint, NUM_LEVELS> vaos = {};
+	};
+
+	/**
+	* @details
+	* Constructor for the CircleGeometry class. Initializes the PIMPL pointer.
+	*/
+	CircleGeometry::CircleGeometry() :
+		_impl(std::make_unique<CircleGeometryImpl>())
+	{}
+
+	/**
+	* @details
+	* Destructor for the CircleGeometry class.
+	*/
+	CircleGeometry::~CircleGeometry() = default;
+
+	/**
+	* @details
+	* Get the application wide circle geometry. Constructed on first use.
+	*/
+	CircleGeometry& CircleGeometry::Get()
+	{
+		static CircleGeometry geometry;
+		return geometry;
+	}
+
+	/**
+	* @details
+	* Copy the compile time table into a static vertex buffer. The whole
+	* table is a few kilobytes, so every level is uploaded up front, along
+	* with a vertex array per level pointing at its range.
+	*/
+	void CircleGeometry::Init()
+	{
+		if (_impl->vbo) return;
+
+		glGenBuffers(1, &_impl->vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, _impl->vbo);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			sizeof(UNIT_CIRCLES),
+			UNIT_CIRCLES.data(),
+			GL_STATIC_DRAW);
+
+		glGenVertexArrays(NUM_LEVELS, _impl->vaos.data());
+		for (int level = 0; level < NUM_LEVELS; level++)
+		{
+			glBindVertexArray(_impl->vaos[level]);
+			glVertexAttribPointer(
+				0,
+				2,
+				GL_FLOAT,
+				GL_FALSE,
+				2 * sizeof(float),
+				(void*)(size_t(FirstVertex(MIN_VERTICES + level)) * 2 * sizeof(float)));
+			glEnableVertexAttribArray(0);
+		}
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		spdlog::info(
+			"Uploaded {} circle vertices for {} tessellation levels",
+			TOTAL_VERTICES,
+			MAX_VERTICES - MIN_VERTICES + 1);
+	}
+
+	/**
+	* @details
+	* Delete the vertex arrays and the vertex buffer, circles still using them
+	* stop drawing.
+	*/
+	void CircleGeometry::Shutdown()
+	{
+		if (_impl->vbo)
+		{
+			glDeleteVertexArrays(NUM_LEVELS, _impl->vaos.data());
+			_impl->vaos.fill(0);
+			glDeleteBuffers(1, &_impl->vbo);
+			_impl->vbo = 0;
+		}
+	}
+
+	/**
+	* @details
+	* Upload the table if it wasn't yet and return the vertex buffer.
+	*/
+	GLuint CircleGeometry::GetVBO()
+	{
+		Init();
+		return _impl->vbo;
+	}
+
+	/**
+	* @details
+	* Upload the geometry if it wasn't yet. Counts outside the levels are clamped.
+	*/
+	GLuint CircleGeometry::GetVAO(const int num_vertices)
+	{
+		Init();
+		const int level = num_vertices < MIN_VERTICES ? MIN_VERTICES :
+			(num_vertices > MAX_VERTICES ? MAX_VERTICES : num_vertices);
+		return _impl->vaos[level - MIN_VERTICES];
+	}
+
+	/**
+	* @details
+	* Index the compile time table, counts outside the levels are clamped.
+	*/
+	const float* CircleGeometry::UnitVertices(const int num_vertices)
+	{
+		const int level = num_vertices < MIN_VERTICES ? MIN_VERTICES :
+			(num_vertices > MAX_VERTICES ? MAX_VERTICES : num_vertices);
+		return UNIT_CIRCLES.data() + 2 * FirstVertex(level);
+	}
+}
\ No newline at end of file
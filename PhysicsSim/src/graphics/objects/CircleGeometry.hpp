@@ -0,0 +1,132 @@
+/**
+* @file CircleGeometry.hpp
+* @brief
+* Class declaration for the circle geometry cache. Holds a unit circle for
+* every tessellation level a Circle can be drawn with, computed at compile
+* time and uploaded once into a vertex buffer shared by every circle and
+* render item, which scale it to their radius in the shader. Every level has
+* one vertex array, which all circles of that level draw with. Uses the PIMPL
+* idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _CIRCLEGEOMETRY_
+#define _CIRCLEGEOMETRY_
+
+#include <memory>
+
+//External forward declarations
+
+/// @brief Forward declaration of GLuint.
+typedef unsigned int GLuint;
+
+//Internal declarations
+
+/// @brief Object namespace
+namespace Object
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief CircleGeometry class
+	class CircleGeometry
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		CircleGeometry(const CircleGeometry& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		CircleGeometry& operator=(const CircleGeometry& other) = delete;
+		/// @brief Deleted move constructor.
+		CircleGeometry(const CircleGeometry&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		CircleGeometry& operator=(const CircleGeometry&& other) = delete;
+
+		/// @brief Fewest vertices a circle is drawn with.
+		static constexpr int MIN_VERTICES = 10;
+		/// @brief Most vertices a circle is drawn with.
+		static constexpr int MAX_VERTICES = 30;
+		/// @brief Number of vertices of all tessellation levels together.
+		static constexpr int TOTAL_VERTICES =
+			(MIN_VERTICES + MAX_VERTICES) * (MAX_VERTICES - MIN_VERTICES + 1) / 2;
+		/// @brief Number of tessellation levels.
+		static constexpr int NUM_LEVELS = MAX_VERTICES - MIN_VERTICES + 1;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		CircleGeometry();
+		/// @brief Destructor
+		~CircleGeometry();
+
+		//Member methods
+
+		/**
+		* @brief Get the application wide circle geometry.
+		* @return Reference to the circle geometry.
+		*/
+		static CircleGeometry& Get();
+
+		/**
+		* @brief
+		* Upload the unit circles into the shared vertex buffer and create the
+		* vertex array of every level. Must be called once the OpenGL context
+		* is current and loaded.
+		*/
+		void Init();
+
+		/**
+		* @brief
+		* Delete the shared vertex buffer and vertex arrays. Must be called
+		* before the context is destroyed, after the circles using them were.
+		*/
+		void Shutdown();
+
+		/**
+		* @brief Get the shared vertex buffer, uploading it on first use.
+		* @return The vertex buffer holding two floats per vertex.
+		*/
+		GLuint GetVBO();
+
+		/**
+		* @brief
+		* Get the vertex array of a tessellation level, uploading the geometry
+		* on first use. Its position attribute starts at the level's first
+		* vertex, so it draws from vertex zero.
+		* @param num_vertices The number of vertices, in [MIN_VERTICES, MAX_VERTICES].
+		* @return The vertex array of the level.
+		*/
+		GLuint GetVAO(const int num_vertices);
+
+		/**
+		* @brief Get the first vertex of a tessellation level in the shared vertex buffer.
+		* @param num_vertices The number of vertices, in [MIN_VERTICES, MAX_VERTICES].
+		* @return The index of the first vertex.
+		*/
+		static constexpr int FirstVertex(const int num_vertices)
+		{
+			return (MIN_VERTICES + num_vertices - 1) * (num_vertices - MIN_VERTICES) / 2;
+		}
+
+		/**
+		* @brief Get the unit circle of a tessellation level.
+		* @param num_vertices The number of vertices, in [MIN_VERTICES, MAX_VERTICES].
+		* @return Pointer to the x and y of every vertex, in order for a triangle fan.
+		*/
+		static const float* UnitVertices(const int num_vertices);
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of CircleGeometryImpl struct.
+		struct CircleGeometryImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<CircleGeometryImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
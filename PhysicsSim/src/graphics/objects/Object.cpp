@@ -6,8 +6,11 @@
 */
 
 #include "Object.hpp"
+#include "graphics/BatchRenderer.hpp"
+#include "graphics/Shader.hpp"
 #include "utils/GlfwIncludes.hpp"
 
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 /// @brief Object namespace
@@ -51,6 +54,19 @@ namespace Object
 		*/
 		void SetVertices(std::vector<glm::vec2> vertices);
 
+		/**
+		* @brief Draw with a shared vertex array over a range of a shared vertex buffer.
+		* @param shared_vao The shared vertex array.
+		* @param shared_vbo The shared vertex buffer.
+		* @param first_vertex_index The first vertex in the buffer.
+		* @param num_vertices The number of vertices.
+		*/
+		void SetSharedVertices(
+			GLuint shared_vao,
+			GLuint shared_vbo,
+			int first_vertex_index,
+			int num_vertices);
+
 		//Member variables
 
 		/// @brief Position of the object.
@@ -63,6 +79,14 @@ namespace Object
 		GLuint vao;
 		/// @brief Vertex buffer object.
 		GLuint vbo;
+		/// @brief First vertex of the object in its vertex buffer.
+		GLint first_vertex;
+		/// @brief Number of vertices drawn.
+		GLsizei vertex_count;
+		/// @brief Uniform scale applied by the model matrix.
+		float scale;
+		/// @brief Flag set when the vertex array and buffer belong to the object.
+		bool owns_buffers;
 	};
 
 	/**
@@ -76,16 +100,21 @@ namespace Object
 		color(color),
 		vertices(),
 		vao(0),
-		vbo(0)
+		vbo(0),
+		first_vertex(0),
+		vertex_count(0),
+		scale(1.0f),
+		owns_buffers(true)
 	{}
 
 	/**
 	* @details
 	* Destructor for the ObjectImpl class. Deletes the vertex array object and
-	* deletes the buffers.
+	* the vertex buffer, unless they are shared.
 	*/
 	Object::ObjectImpl::~ObjectImpl()
 	{
+		if (!owns_buffers) return;
 		glDeleteVertexArrays(1, &vao);
 		glDeleteBuffers(1, &vbo);
 	}
@@ -98,6 +127,7 @@ namespace Object
 	void Object::ObjectImpl::SetVertices(std::vector<glm::vec2> verts)
 	{
 		vertices = std::move(verts);
+		vertex_count = GLsizei(vertices.size());
 
 		glGenVertexArrays(1, &vao);
 		glBindVertexArray(vao);
@@ -123,6 +153,32 @@ namespace Object
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
+	/**
+	* @details
+	* The vertex array and buffer are only referenced, no vertices are kept on
+	* the CPU. The vertex array's position attribute starts at the first vertex
+	* of the range, so the object draws from vertex zero like one with its own
+	* buffer, and every object sharing the range shares the vertex array.
+	*/
+	void Object::ObjectImpl::SetSharedVertices(
+		GLuint shared_vao,
+		GLuint shared_vbo,
+		int first_vertex_index,
+		int num_vertices)
+	{
+		if (owns_buffers)
+		{
+			glDeleteVertexArrays(1, &vao);
+			glDeleteBuffers(1, &vbo);
+		}
+
+		vao = shared_vao;
+		vbo = shared_vbo;
+		owns_buffers = false;
+		first_vertex = GLint(first_vertex_index);
+		vertex_count = GLsizei(num_vertices);
+	}
+
 	/**
 	* @details
 	* Custom constructor for the Object class. Passes the position and color to
@@ -155,24 +211,44 @@ namespace Object
 	* @details
 	* Draws the object with the given shader. Sets the color and model matrix
 	* and then binds the vertex array object. Draws the object using the triangle
-	* fan.
+	* fan. The uniform locations were resolved when the shader was linked.
 	*/
-	void Object::Draw(GLuint shader) const
+	void Object::Draw(Graphics::Shader& shader) const
 	{
-		glUseProgram(shader);
+		glUseProgram(shader.GetGLFWShader());
 
-		GLint color_loc = glGetUniformLocation(shader, "inColor");
+		GLint color_loc = shader.GetUniformLocation("inColor");
 		glUniform3fv(color_loc, 1, glm::value_ptr(_object_impl->color));
 
-		glm::mat4 model = glm::translate(glm::mat4(1.0f), _object_impl->position);
-		GLuint model_loc = glGetUniformLocation(shader, "model");
+		glm::mat4 model = GetModelMatrix();
+		GLint model_loc = shader.GetUniformLocation("model");
 		glUniformMatrix4fv(model_loc, 1, GL_FALSE, glm::value_ptr(model));
 
 		glBindVertexArray(_object_impl->vao);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, _object_impl->vertices.size());
+		glDrawArrays(GL_TRIANGLE_FAN, 0, _object_impl->vertex_count);
 		glBindVertexArray(0);
 	}
 
+	/**
+	* @details
+	* Submits the object to the batch renderer, which draws it instanced with
+	* every other object of the same mesh at its next flush.
+	*/
+	void Object::Draw(Graphics::BatchRenderer& batch) const
+	{
+		batch.Submit(*this);
+	}
+
+	/**
+	* @details
+	* Default constructed objects, like a Box without geometry yet, have no
+	* implementation and no vertices.
+	*/
+	bool Object::HasGeometry() const
+	{
+		return _object_impl && _object_impl->vertex_count > 0;
+	}
+
 	/**
 	* @details
 	* Passes the vertices to the PIMPL implementation.
@@ -182,13 +258,48 @@ namespace Object
 		_object_impl->SetVertices(vertices);
 	}
 
+	/**
+	* @details
+	* Passes the range to the PIMPL implementation and keeps the scale for
+	* the model matrix.
+	*/
+	void Object::SetSharedVertices(
+		GLuint vao,
+		GLuint vbo,
+		const int first_vertex,
+		const int num_vertices,
+		const float scale)
+	{
+		_object_impl->scale = scale;
+		_object_impl->SetSharedVertices(vao, vbo, first_vertex, num_vertices);
+	}
+
+	/**
+	* @details
+	* Scale first, so the object grows around its own origin.
+	*/
+	glm::mat4 Object::GetModelMatrix() const
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), _object_impl->position);
+		return glm::scale(model, glm::vec3(_object_impl->scale));
+	}
+
 	/**
 	* @details
 	* Get the number of vertices in the object.
 	*/
 	int Object::GetNumVertices() const
 	{
-		return int(_object_impl->vertices.size());
+		return int(_object_impl->vertex_count);
+	}
+
+	/**
+	* @details
+	* Objects with their own buffer start at its first vertex.
+	*/
+	int Object::GetFirstVertex() const
+	{
+		return int(_object_impl->first_vertex);
 	}
 
 	/**
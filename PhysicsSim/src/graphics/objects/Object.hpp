@@ -19,6 +19,15 @@
 /// @brief Forward declaration of GLuint.
 typedef unsigned int GLuint;
 
+/// @brief Scene namespace
+namespace Graphics
+{
+	/// @brief Forward declaration of Shader class.
+	class Shader;
+	/// @brief Forward declaration of BatchRenderer class.
+	class BatchRenderer;
+}
+
 //Internal declarations
 
 /// @brief Object namespace
@@ -75,7 +84,19 @@ namespace Object
 		* @brief Draw the object with the given shader.
 		* @param shader The shader to use for drawing.
 		*/
-		void Draw(GLuint shader) const;
+		void Draw(Graphics::Shader& shader) const;
+
+		/**
+		* @brief Queue the object in a batch renderer, drawn with the other objects of its kind.
+		* @param batch The batch renderer to queue the object in.
+		*/
+		void Draw(Graphics::BatchRenderer& batch) const;
+
+		/**
+		* @brief Check if the object has vertices to draw.
+		* @return True if the object has vertices, false otherwise.
+		*/
+		bool HasGeometry() const;
 
 		/**
 		* @brief Set the vertices of the object.
@@ -83,12 +104,42 @@ namespace Object
 		*/
 		void SetVertices(std::vector<glm::vec2> vertices);
 
+		/**
+		* @brief
+		* Draw the object from a range of a vertex buffer owned by someone
+		* else, scaled uniformly. The vertex array and buffer are left alone on
+		* destruction.
+		* @param vao The shared vertex array, its position starting at the first vertex.
+		* @param vbo The shared vertex buffer of two floats per vertex.
+		* @param first_vertex The first vertex of the object in the buffer.
+		* @param num_vertices The number of vertices of the object.
+		* @param scale The scale applied to the vertices by the model matrix.
+		*/
+		void SetSharedVertices(
+			GLuint vao,
+			GLuint vbo,
+			const int first_vertex,
+			const int num_vertices,
+			const float scale);
+
+		/**
+		* @brief Get the model matrix, the object's scale translated to its position.
+		* @return The model matrix.
+		*/
+		glm::mat4 GetModelMatrix() const;
+
 		/**
 		* @brief Get the number of vertices in the object.
 		* @return The number of vertices in the object.
 		*/
 		int GetNumVertices() const;
 
+		/**
+		* @brief Get the first vertex of the object in its vertex buffer.
+		* @return The index of the first vertex, 0 for objects with their own buffer.
+		*/
+		int GetFirstVertex() const;
+
 		/**
 		* @brief Get the position of the object.
 		* @return GLM vector of the object's position.
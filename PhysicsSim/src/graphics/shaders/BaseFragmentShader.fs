@@ -1,8 +1,10 @@
-#version 330 core
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
 out vec4 FragColor;
 uniform vec3 inColor;
 
 void main()
 {
     FragColor = vec4(inColor, 1.0);
-}
\ No newline at end of file
+}
+)GLSL"
\ No newline at end of file
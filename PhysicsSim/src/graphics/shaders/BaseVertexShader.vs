@@ -1,9 +1,15 @@
-#version 330 core
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
 layout(location = 0) in vec3 position;
+layout(std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 simulation_projection;
+};
 uniform mat4 model;
-uniform mat4 projection;
 
 void main()
 {
 	gl_Position = projection * model * vec4(position, 1.0);
-}
\ No newline at end of file
+}
+)GLSL"
\ No newline at end of file
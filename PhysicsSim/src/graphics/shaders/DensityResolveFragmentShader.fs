@@ -0,0 +1,18 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+uniform sampler2D density;
+uniform float particleArea;
+out vec4 FragColor;
+
+void main()
+{
+    vec4 sum = texelFetch(density, ivec2(gl_FragCoord.xy), 0);
+    if (sum.a <= 0.0)
+        discard;
+
+    // Average color, over the background by the chance that at least one of
+    // the particles in the pixel covers any given point of it
+    float coverage = 1.0 - pow(1.0 - particleArea, sum.a);
+    FragColor = vec4(sum.rgb / sum.a, coverage);
+}
+)GLSL"
\ No newline at end of file
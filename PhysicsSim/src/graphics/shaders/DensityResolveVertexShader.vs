@@ -0,0 +1,10 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+
+void main()
+{
+    // A single triangle covering the viewport, built from the vertex index
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)GLSL"
\ No newline at end of file
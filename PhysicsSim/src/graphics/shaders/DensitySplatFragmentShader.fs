@@ -0,0 +1,11 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+in vec3 splatColor;
+out vec4 FragColor;
+
+void main()
+{
+    // Added up by the blending: rgb sums the colors, alpha counts the particles
+    FragColor = vec4(splatColor, 1.0);
+}
+)GLSL"
\ No newline at end of file
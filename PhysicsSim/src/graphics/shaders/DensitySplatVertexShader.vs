@@ -0,0 +1,73 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+layout(location = 1) in vec4 instancePos;
+layout(location = 2) in vec4 instanceColor;
+layout(location = 4) in vec2 compactPos;
+layout(location = 5) in vec2 compactData;
+
+layout(std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 simulation_projection;
+};
+
+// Color (rgb) and radius scale (a) of every species
+layout(std140) uniform SpeciesUniforms
+{
+    vec4 species[16];
+};
+
+// Where the color comes from: -1 for the full layout's instanceColor, otherwise
+// the packed layout (x, y, scale, scalar) is mapped through the colormap by
+// 0 the scalar, 1 the x position, 2 the y position or 3 the distance from the
+// center of the box
+uniform int colorSource;
+uniform vec2 colorRange;
+uniform sampler1D colorMap;
+
+// The compact layout replaces the others with 8 bytes per particle: x and y as
+// 16 bit fractions of the [-1, 1] box, an 8 bit fraction of colorRange and an
+// 8 bit species indexing SpeciesUniforms
+uniform bool compactInstances;
+
+vec3 MapColor(vec4 data)
+{
+    float value = data.w;
+    if (colorSource == 1)
+        value = data.x;
+    else if (colorSource == 2)
+        value = data.y;
+    else if (colorSource == 3)
+        value = length(data.xy);
+
+    float t = clamp((value - colorRange.x) / (colorRange.y - colorRange.x), 0.0, 1.0);
+    return texture(colorMap, t).rgb;
+}
+
+out vec3 splatColor;
+
+void main()
+{
+    vec3 center = instancePos.xyz;
+    splatColor = instanceColor.rgb;
+
+    if (compactInstances)
+    {
+        center = vec3(compactPos * 2.0 - 1.0, 0.0);
+        splatColor = species[int(compactData.y)].rgb;
+        if (colorSource >= 0)
+        {
+            float scalar = mix(colorRange.x, colorRange.y, compactData.x / 255.0);
+            splatColor = MapColor(vec4(center.xy, 0.0, scalar));
+        }
+    }
+    else if (colorSource >= 0)
+    {
+        center = vec3(instancePos.xy, 0.0);
+        splatColor = MapColor(instancePos);
+    }
+
+    // Each particle becomes a single point in the pixel its center falls in
+    gl_Position = simulation_projection * vec4(center, 1.0);
+}
+)GLSL"
\ No newline at end of file
@@ -0,0 +1,21 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in mat4 instanceModel;
+layout(location = 5) in vec4 instanceColor;
+
+layout(std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 simulation_projection;
+};
+
+out vec3 outColor;
+
+void main()
+{
+    // Same transform as the base shader, with the model and color per instance
+    outColor = instanceColor.rgb;
+    gl_Position = projection * instanceModel * vec4(position, 1.0);
+}
+)GLSL"
\ No newline at end of file
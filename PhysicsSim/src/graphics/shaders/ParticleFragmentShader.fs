@@ -1,8 +1,10 @@
-#version 330 core
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
 in vec3 outColor;
 out vec4 FragColor;
 
 void main()
 {
     FragColor = vec4(outColor, 1.0);
-}
\ No newline at end of file
+}
+)GLSL"
\ No newline at end of file
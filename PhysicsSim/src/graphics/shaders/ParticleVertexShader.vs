@@ -1,28 +1,85 @@
-#version 330 core
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 instancePos;
 layout(location = 2) in vec4 instanceColor;
 layout(location = 3) in vec4 instanceScale;
+layout(location = 4) in vec2 compactPos;
+layout(location = 5) in vec2 compactData;
 
-uniform mat4 model;
-uniform mat4 projection;
+layout(std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 simulation_projection;
+};
+
+// Color (rgb) and radius scale (a) of every species
+layout(std140) uniform SpeciesUniforms
+{
+    vec4 species[16];
+};
+
+// Where the color comes from: -1 for the full layout's instanceColor, otherwise
+// the packed layout (x, y, scale, scalar) is mapped through the colormap by
+// 0 the scalar, 1 the x position, 2 the y position or 3 the distance from the
+// center of the box
+uniform int colorSource;
+uniform vec2 colorRange;
+uniform sampler1D colorMap;
+
+// The compact layout replaces the others with 8 bytes per particle: x and y as
+// 16 bit fractions of the [-1, 1] box, an 8 bit fraction of colorRange and an
+// 8 bit species indexing SpeciesUniforms
+uniform bool compactInstances;
+
+// Radius of the particles, the vertices are a unit circle from the shared circle geometry
+uniform float meshRadius;
+
+vec3 MapColor(vec4 data)
+{
+    float value = data.w;
+    if (colorSource == 1)
+        value = data.x;
+    else if (colorSource == 2)
+        value = data.y;
+    else if (colorSource == 3)
+        value = length(data.xy);
+
+    float t = clamp((value - colorRange.x) / (colorRange.y - colorRange.x), 0.0, 1.0);
+    return texture(colorMap, t).rgb;
+}
 
 out vec3 outColor;
 
 void main()
 {
-    // Scale the vertex by the instance scale
-    vec3 scaledPosition = position * instanceScale.xyz;
-    
-    // Calculate final position with model matrix
-    vec4 worldPos = model * vec4(scaledPosition, 1.0);
-    
-    // Apply instance position offset
-    worldPos.xyz += instancePos.xyz;
+    vec3 center = instancePos.xyz;
+    vec3 scale = instanceScale.xyz;
+    outColor = instanceColor.rgb;
+
+    if (compactInstances)
+    {
+        vec4 speciesData = species[int(compactData.y)];
+        center = vec3(compactPos * 2.0 - 1.0, 0.0);
+        scale = vec3(speciesData.a);
+        outColor = speciesData.rgb;
+        if (colorSource >= 0)
+        {
+            float scalar = mix(colorRange.x, colorRange.y, compactData.x / 255.0);
+            outColor = MapColor(vec4(center.xy, scale.x, scalar));
+        }
+    }
+    else if (colorSource >= 0)
+    {
+        center = vec3(instancePos.xy, 0.0);
+        scale = vec3(instancePos.z);
+        outColor = MapColor(instancePos);
+    }
+
+    // Scale the unit circle by the radius and the instance scale and offset it by the instance position
+    vec4 worldPos = vec4(position * meshRadius * scale + center, 1.0);
     
     // Apply projection
-    gl_Position = projection * worldPos;
-    
-    // Pass color to fragment shader
-    outColor = instanceColor.rgb;
-}
\ No newline at end of file
+    gl_Position = simulation_projection * worldPos;
+}
+)GLSL"
\ No newline at end of file
@@ -0,0 +1,16 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+uniform sampler2D trails;
+out vec4 FragColor;
+
+void main()
+{
+    // The trails cover the same pixels as the texture, and fading scaled their
+    // color and alpha alike, so they are premultiplied
+    vec4 trail = texelFetch(trails, ivec2(gl_FragCoord.xy), 0);
+    if (trail.a <= 0.0)
+        discard;
+
+    FragColor = trail;
+}
+)GLSL"
\ No newline at end of file
@@ -0,0 +1,11 @@
+//Embedded into the binary by ShaderRegistry.cpp, keep the raw string delimiters
+R"GLSL(#version 330 core
+uniform float persistence;
+out vec4 FragColor;
+
+void main()
+{
+    // Blended with (zero, source alpha), so the trails are multiplied by the persistence
+    FragColor = vec4(0.0, 0.0, 0.0, persistence);
+}
+)GLSL"
\ No newline at end of file
@@ -0,0 +1,958 @@
+/**
+* @file Checkpoint.cpp
+* @brief
+* Function definitions for checkpoint files and the Checkpointer class. Uses
+* the PIMPL idiom to hide implementation details.
+*/
+
+#include "Checkpoint.hpp"
+
+#include "profiling/Profiler.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/// @brief IO namespace
+namespace IO
+{
+	//Arrays are copied as raw bytes, which is only the file's byte order on little endian targets.
+	static_assert(std::endian::native == std::endian::little, "Checkpoints assume a little endian target");
+
+	/// @brief Size of the checkpoint header in bytes.
+	static constexpr size_t CHECKPOINT_HEADER_SIZE = 24;
+	/// @brief Size of a section header in bytes.
+	static constexpr size_t CHECKPOINT_SECTION_SIZE = 16;
+	/// @brief Size of the checkpoint footer in bytes.
+	static constexpr size_t CHECKPOINT_FOOTER_SIZE = 8;
+
+	/**
+	* @details
+	* Build a section tag from four characters.
+	*/
+	static constexpr uint32_t SectionTag(const char (&name)[5])
+	{
+		return uint32_t(uint8_t(name[0])) |
+			uint32_t(uint8_t(name[1])) << 8 |
+			uint32_t(uint8_t(name[2])) << 16 |
+			uint32_t(uint8_t(name[3])) << 24;
+	}
+
+	/// @brief Tag of the section holding the step count and simulation parameters.
+	static constexpr uint32_t SECTION_PARAMETERS = SectionTag("PARM");
+	/// @brief Tag of the section holding the particle positions.
+	static constexpr uint32_t SECTION_POSITIONS = SectionTag("POSN");
+	/// @brief Tag of the section holding the particle colors.
+	static constexpr uint32_t SECTION_COLORS = SectionTag("COLR");
+	/// @brief Tag of the section holding the particle scales.
+	static constexpr uint32_t SECTION_SCALES = SectionTag("SCAL");
+
+	/// @brief Size of the parameter section payload in bytes.
+	static constexpr size_t PARAMETERS_SIZE = 40;
+	/// @brief Size of the manifest header in bytes.
+	static constexpr size_t MANIFEST_HEADER_SIZE = 40;
+	/// @brief Size of a block entry in a manifest section in bytes.
+	static constexpr size_t MANIFEST_ENTRY_SIZE = 24;
+
+	/// @brief Number of particle arrays in a simulation state.
+	static constexpr int ARRAY_COUNT = 3;
+	/// @brief Section tags of the particle arrays, in the order of StateArray.
+	static constexpr uint32_t ARRAY_TAGS[ARRAY_COUNT] = { SECTION_POSITIONS, SECTION_COLORS, SECTION_SCALES };
+
+	/**
+	* @brief Structure to hold where a block of a particle array is stored.
+	* @param offset The offset of the block in the block file.
+	* @param hash The hash of the block.
+	* @param size The size of the block in bytes.
+	*/
+	struct CheckpointBlock
+	{
+		uint64_t offset = 0;
+		uint64_t hash = 0;
+		uint32_t size = 0;
+	};
+
+	/**
+	* @details
+	* Write an unsigned integer of the given width in little endian order.
+	*/
+	static void PutUnsigned(uint8_t* out, uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++) out[i] = uint8_t(value >> (8 * i));
+	}
+
+	/**
+	* @details
+	* Read an unsigned integer of the given width in little endian order.
+	*/
+	static uint64_t GetUnsigned(const uint8_t* data, int bytes)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; i++) value |= uint64_t(data[i]) << (8 * i);
+		return value;
+	}
+
+	/**
+	* @details
+	* Write a float by its bit pattern.
+	*/
+	static void PutFloat(uint8_t* out, float value)
+	{
+		uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		PutUnsigned(out, bits, 4);
+	}
+
+	/**
+	* @details
+	* Read a float by its bit pattern.
+	*/
+	static float GetFloat(const uint8_t* data)
+	{
+		const uint32_t bits = uint32_t(GetUnsigned(data, 4));
+		float value = 0.0f;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	/**
+	* @details
+	* Round a size up to the next multiple of 8, so every section payload starts
+	* aligned.
+	*/
+	static constexpr size_t PadTo8(size_t size)
+	{
+		return (size + 7) & ~size_t(7);
+	}
+
+	/**
+	* @details
+	* Append a section header and reserve its padded payload. Returns a pointer
+	* to the payload.
+	*/
+	static uint8_t* AppendSection(std::vector<uint8_t>& out, uint32_t tag, size_t size)
+	{
+		const size_t offset = out.size();
+		out.resize(offset + CHECKPOINT_SECTION_SIZE + PadTo8(size), 0);
+		PutUnsigned(&out[offset], tag, 4);
+		PutUnsigned(&out[offset + 8], size, 8);
+		return &out[offset + CHECKPOINT_SECTION_SIZE];
+	}
+
+	/**
+	* @details
+	* Append a section holding a float array. The array is copied in one go, the
+	* floats' bit patterns are stored unchanged.
+	*/
+	static void AppendArray(std::vector<uint8_t>& out, uint32_t tag, const std::vector<float>& values)
+	{
+		const size_t size = values.size() * sizeof(float);
+		uint8_t* payload = AppendSection(out, tag, size);
+		if (size > 0) std::memcpy(payload, values.data(), size);
+	}
+
+	/**
+	* @details
+	* Read a float array section. The payload must hold three floats per
+	* particle.
+	*/
+	static bool GetArray(const uint8_t* data, uint64_t size, int num_particles, std::vector<float>& values)
+	{
+		if (size != 3 * uint64_t(num_particles) * sizeof(float)) return false;
+		values.resize(size_t(size / sizeof(float)));
+		if (size > 0) std::memcpy(values.data(), data, size_t(size));
+		return true;
+	}
+
+	/**
+	* @details
+	* Get a particle array of the state by its index in ARRAY_TAGS.
+	*/
+	static const std::vector<float>& StateArray(const Simulation::SimulationState& state, int index)
+	{
+		return index == 0 ? state.positions : index == 1 ? state.colors : state.scales;
+	}
+
+	/**
+	* @details
+	* Get a particle array of the state by its index in ARRAY_TAGS.
+	*/
+	static std::vector<float>& StateArray(Simulation::SimulationState& state, int index)
+	{
+		return index == 0 ? state.positions : index == 1 ? state.colors : state.scales;
+	}
+
+	/**
+	* @details
+	* Write the step count and simulation parameters into a parameter section
+	* payload.
+	*/
+	static void PutParameters(uint8_t* out, const Simulation::SimulationState& state)
+	{
+		PutUnsigned(out, state.step, 8);
+		PutUnsigned(out + 8, uint32_t(state.num_particles), 4);
+		PutUnsigned(out + 12, uint32_t(state.box_width_perc), 4);
+		PutUnsigned(out + 16, uint32_t(state.box_height_perc), 4);
+		PutFloat(out + 20, state.energy_value);
+		PutFloat(out + 24, state.temperature);
+		PutFloat(out + 28, state.chem_potential);
+		PutFloat(out + 32, state.radius);
+	}
+
+	/**
+	* @details
+	* Read the step count and simulation parameters from a parameter section
+	* payload.
+	*/
+	static bool GetParameters(const uint8_t* data, uint64_t size, Simulation::SimulationState& state)
+	{
+		if (size < 36) return false;
+		state.step = GetUnsigned(data, 8);
+		state.num_particles = int(int32_t(GetUnsigned(data + 8, 4)));
+		state.box_width_perc = int(int32_t(GetUnsigned(data + 12, 4)));
+		state.box_height_perc = int(int32_t(GetUnsigned(data + 16, 4)));
+		state.energy_value = GetFloat(data + 20);
+		state.temperature = GetFloat(data + 24);
+		state.chem_potential = GetFloat(data + 28);
+		state.radius = GetFloat(data + 32);
+		return state.num_particles >= 0;
+	}
+
+	/**
+	* @details
+	* Check the magic, version, size and hash footer of a checkpoint or
+	* manifest, so a truncated or corrupt file is rejected as a whole.
+	*/
+	static bool CheckFile(const uint8_t* data, size_t size, const char (&magic)[8], size_t header_size)
+	{
+		if (size < header_size + CHECKPOINT_FOOTER_SIZE) return false;
+		if (std::memcmp(data, magic, sizeof(magic)) != 0) return false;
+		if (GetUnsigned(data + 8, 4) != CHECKPOINT_VERSION) return false;
+		if (GetUnsigned(data + 16, 8) != size) return false;
+
+		const size_t body_size = size - CHECKPOINT_FOOTER_SIZE;
+		return HashBytes(data, body_size) == GetUnsigned(data + body_size, 8);
+	}
+
+	/**
+	* @details
+	* Walk the sections after the header and pass each tag and payload to the
+	* callback. Stops and fails if a section runs past the footer or the
+	* callback fails.
+	*/
+	template <typename Callback>
+	static bool ForEachSection(const uint8_t* data, size_t size, size_t header_size, Callback callback)
+	{
+		const size_t body_size = size - CHECKPOINT_FOOTER_SIZE;
+		const uint64_t section_count = GetUnsigned(data + 12, 4);
+
+		size_t offset = header_size;
+		for (uint64_t i = 0; i < section_count; i++)
+		{
+			if (body_size - offset < CHECKPOINT_SECTION_SIZE) return false;
+			const uint32_t tag = uint32_t(GetUnsigned(data + offset, 4));
+			const uint64_t section_size = GetUnsigned(data + offset + 8, 8);
+			offset += CHECKPOINT_SECTION_SIZE;
+			if (section_size > body_size - offset || PadTo8(size_t(section_size)) > body_size - offset)
+				return false;
+
+			if (!callback(tag, data + offset, section_size)) return false;
+			offset += PadTo8(size_t(section_size));
+		}
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Set the total size in the header and append the hash footer.
+	*/
+	static void FinishFile(std::vector<uint8_t>& out)
+	{
+		const size_t size = out.size() + CHECKPOINT_FOOTER_SIZE;
+		PutUnsigned(&out[16], size, 8);
+
+		const uint64_t hash = HashBytes(out.data(), out.size());
+		out.resize(size);
+		PutUnsigned(&out[size - CHECKPOINT_FOOTER_SIZE], hash, 8);
+	}
+
+	/**
+	* @details
+	* Read a whole file with a single read.
+	*/
+	static bool ReadFile(const std::string& path, std::vector<uint8_t>& bytes)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr) return false;
+
+		bool success = std::fseek(file, 0, SEEK_END) == 0;
+		const long size = success ? std::ftell(file) : -1;
+		success = size > 0 && std::fseek(file, 0, SEEK_SET) == 0;
+		if (success)
+		{
+			bytes.resize(size_t(size));
+			success = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		}
+		std::fclose(file);
+		return success;
+	}
+
+	/**
+	* @details
+	* Get the path of a manifest's block file. The block files live next to the
+	* manifest and are named after it and their generation.
+	*/
+	static std::string BlockFilePath(const std::string& path, uint64_t generation)
+	{
+		return path + "." + std::to_string(generation) + ".blk";
+	}
+
+	/**
+	* @details
+	* Hash eight bytes at a time with a multiply and xor-shift round, folding in
+	* the tail and the size, then mix the result with the splitmix64 finalizer.
+	* Not cryptographic, only meant to catch torn or corrupt data.
+	*/
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+	{
+		constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed ^ (uint64_t(size) * MULTIPLIER);
+
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, bytes + i, sizeof(word));
+			hash = (hash ^ word) * MULTIPLIER;
+			hash ^= hash >> 32;
+		}
+
+		uint64_t tail = 0;
+		for (size_t shift = 0; i < size; i++, shift += 8) tail |= uint64_t(bytes[i]) << shift;
+		hash = (hash ^ tail) * MULTIPLIER;
+
+		hash ^= hash >> 30;
+		hash *= 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 27;
+		hash *= 0x94D049BB133111EBull;
+		hash ^= hash >> 31;
+		return hash;
+	}
+
+	/**
+	* @details
+	* Lay out the header, the parameter section and one section per particle
+	* array, then append a hash of everything before the footer. The buffer is
+	* sized once, so reserving it across checkpoints avoids reallocating.
+	*/
+	void SerializeCheckpoint(const Simulation::SimulationState& state, std::vector<uint8_t>& out)
+	{
+		constexpr uint32_t SECTION_COUNT = 1 + ARRAY_COUNT;
+
+		out.clear();
+		out.resize(CHECKPOINT_HEADER_SIZE, 0);
+		std::memcpy(out.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+		PutUnsigned(&out[8], CHECKPOINT_VERSION, 4);
+		PutUnsigned(&out[12], SECTION_COUNT, 4);
+
+		PutParameters(AppendSection(out, SECTION_PARAMETERS, PARAMETERS_SIZE), state);
+		for (int i = 0; i < ARRAY_COUNT; i++) AppendArray(out, ARRAY_TAGS[i], StateArray(state, i));
+
+		FinishFile(out);
+	}
+
+	/**
+	* @details
+	* Check the magic, version, size and hash before reading any section, so a
+	* truncated or corrupt file is rejected as a whole. Sections with unknown
+	* tags are skipped, which lets newer writers add state that older readers
+	* don't know about.
+	*/
+	bool ParseCheckpoint(const uint8_t* data, size_t size, Simulation::SimulationState& state)
+	{
+		if (!CheckFile(data, size, CHECKPOINT_MAGIC, CHECKPOINT_HEADER_SIZE)) return false;
+
+		bool has_parameters = false;
+		bool has_arrays[ARRAY_COUNT] = {};
+		const bool valid = ForEachSection(data, size, CHECKPOINT_HEADER_SIZE,
+			[&](uint32_t tag, const uint8_t* payload, uint64_t section_size) {
+				if (tag == SECTION_PARAMETERS)
+					return has_parameters = GetParameters(payload, section_size, state);
+
+				for (int i = 0; has_parameters && i < ARRAY_COUNT; i++)
+					if (tag == ARRAY_TAGS[i])
+						has_arrays[i] = GetArray(payload, section_size, state.num_particles, StateArray(state, i));
+				return true;
+			});
+
+		return valid && has_parameters && has_arrays[0] && has_arrays[1] && has_arrays[2];
+	}
+
+	/**
+	* @details
+	* Lay out the manifest header, the parameter section and one section per
+	* particle array listing its blocks. An array section holds the array's
+	* size in bytes followed by an offset, hash and size entry per block.
+	*/
+	static void SerializeManifest(
+		const Simulation::SimulationState& state,
+		uint64_t generation,
+		uint64_t data_size,
+		const std::vector<CheckpointBlock> (&blocks)[ARRAY_COUNT],
+		std::vector<uint8_t>& out)
+	{
+		constexpr uint32_t SECTION_COUNT = 1 + ARRAY_COUNT;
+
+		out.clear();
+		out.resize(MANIFEST_HEADER_SIZE, 0);
+		std::memcpy(out.data(), CHECKPOINT_MANIFEST_MAGIC, sizeof(CHECKPOINT_MANIFEST_MAGIC));
+		PutUnsigned(&out[8], CHECKPOINT_VERSION, 4);
+		PutUnsigned(&out[12], SECTION_COUNT, 4);
+		PutUnsigned(&out[24], generation, 8);
+		PutUnsigned(&out[32], data_size, 8);
+
+		PutParameters(AppendSection(out, SECTION_PARAMETERS, PARAMETERS_SIZE), state);
+		for (int i = 0; i < ARRAY_COUNT; i++)
+		{
+			uint8_t* payload = AppendSection(
+				out,
+				ARRAY_TAGS[i],
+				8 + MANIFEST_ENTRY_SIZE * blocks[i].size());
+			PutUnsigned(payload, StateArray(state, i).size() * sizeof(float), 8);
+
+			uint8_t* entry = payload + 8;
+			for (const CheckpointBlock& block : blocks[i])
+			{
+				PutUnsigned(entry, block.offset, 8);
+				PutUnsigned(entry + 8, block.hash, 8);
+				PutUnsigned(entry + 16, block.size, 4);
+				entry += MANIFEST_ENTRY_SIZE;
+			}
+		}
+
+		FinishFile(out);
+	}
+
+	/**
+	* @details
+	* Parse a manifest and gather each array's blocks from its block file. Each
+	* block's hash is checked, and the blocks must tile the array exactly.
+	*/
+	static bool ReadManifest(
+		const std::string& path,
+		const std::vector<uint8_t>& manifest,
+		Simulation::SimulationState& state)
+	{
+		if (!CheckFile(manifest.data(), manifest.size(), CHECKPOINT_MANIFEST_MAGIC, MANIFEST_HEADER_SIZE))
+			return false;
+
+		const uint64_t generation = GetUnsigned(&manifest[24], 8);
+		const uint64_t data_size = GetUnsigned(&manifest[32], 8);
+
+		std::vector<uint8_t> data;
+		if (!ReadFile(BlockFilePath(path, generation), data) || data.size() < data_size)
+		{
+			spdlog::error("Missing or truncated checkpoint blocks: {}", BlockFilePath(path, generation));
+			return false;
+		}
+
+		bool has_parameters = false;
+		bool has_arrays[ARRAY_COUNT] = {};
+		const bool valid = ForEachSection(manifest.data(), manifest.size(), MANIFEST_HEADER_SIZE,
+			[&](uint32_t tag, const uint8_t* payload, uint64_t section_size) {
+				if (tag == SECTION_PARAMETERS)
+					return has_parameters = GetParameters(payload, section_size, state);
+
+				int index = 0;
+				while (index < ARRAY_COUNT && ARRAY_TAGS[index] != tag) index++;
+				if (!has_parameters || index == ARRAY_COUNT) return true;
+
+				if (section_size < 8 || (section_size - 8) % MANIFEST_ENTRY_SIZE != 0) return false;
+				const uint64_t array_size = GetUnsigned(payload, 8);
+				if (array_size != 3 * uint64_t(state.num_particles) * sizeof(float)) return false;
+
+				std::vector<float>& values = StateArray(state, index);
+				values.resize(size_t(array_size / sizeof(float)));
+				uint8_t* out = reinterpret_cast<uint8_t*>(values.data());
+
+				uint64_t filled = 0;
+				for (const uint8_t* entry = payload + 8; entry < payload + section_size; entry += MANIFEST_ENTRY_SIZE)
+				{
+					const uint64_t offset = GetUnsigned(entry, 8);
+					const uint64_t hash = GetUnsigned(entry + 8, 8);
+					const uint64_t size = GetUnsigned(entry + 16, 4);
+					if (offset > data_size || size > data_size - offset || size > array_size - filled) return false;
+					if (HashBytes(&data[size_t(offset)], size_t(size)) != hash) return false;
+
+					std::memcpy(out + filled, &data[size_t(offset)], size_t(size));
+					filled += size;
+				}
+
+				has_arrays[index] = filled == array_size;
+				return true;
+			});
+
+		return valid && has_parameters && has_arrays[0] && has_arrays[1] && has_arrays[2];
+	}
+
+	/**
+	* @details
+	* Read the generation from a manifest's header without validating the rest,
+	* so a new block file never reuses the name of one a manifest on disk still
+	* points at. Returns 0 if there is no manifest.
+	*/
+	static uint64_t PeekManifestGeneration(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr) return 0;
+
+		uint8_t header[MANIFEST_HEADER_SIZE];
+		const bool complete = std::fread(header, 1, sizeof(header), file) == sizeof(header);
+		std::fclose(file);
+
+		if (!complete || std::memcmp(header, CHECKPOINT_MANIFEST_MAGIC, sizeof(CHECKPOINT_MANIFEST_MAGIC)) != 0)
+			return 0;
+		return GetUnsigned(header + 24, 8);
+	}
+
+#if !defined(_WIN32)
+	/**
+	* @details
+	* Sync the directory holding a file, so a rename into it survives a crash.
+	* POSIX only makes the new directory entry durable once the directory
+	* itself is synced.
+	*/
+	static bool SyncParentDirectory(const std::string& path)
+	{
+		std::filesystem::path directory = std::filesystem::path(path).parent_path();
+		if (directory.empty()) directory = ".";
+
+		const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+		if (fd < 0) return false;
+
+		const bool success = fsync(fd) == 0;
+		return close(fd) == 0 && success;
+	}
+#endif
+
+	/**
+	* @details
+	* Write the whole buffer to a temporary file next to the target with stdio
+	* buffering turned off, so it reaches the OS as one large write. The file is
+	* flushed to disk before it is renamed over the target, so the target always
+	* holds either the old or the new contents. On POSIX the directory is synced
+	* after the rename, as MOVEFILE_WRITE_THROUGH does on Windows.
+	*/
+	bool WriteFileAtomic(const std::string& path, const void* data, size_t size)
+	{
+		const std::string temporary = path + ".tmp";
+
+		std::FILE* file = std::fopen(temporary.c_str(), "wb");
+		if (file == nullptr)
+		{
+			spdlog::error("Failed to open file for writing: {}", temporary);
+			return false;
+		}
+
+		std::setvbuf(file, nullptr, _IONBF, 0);
+		bool success = std::fwrite(data, 1, size, file) == size;
+#if defined(_WIN32)
+		success = success && _commit(_fileno(file)) == 0;
+#else
+		success = success && fsync(fileno(file)) == 0;
+#endif
+		success = std::fclose(file) == 0 && success;
+
+		if (success)
+		{
+#if defined(_WIN32)
+			success = MoveFileExA(
+				temporary.c_str(),
+				path.c_str(),
+				MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+			success = std::rename(temporary.c_str(), path.c_str()) == 0;
+			if (success && !SyncParentDirectory(path))
+				spdlog::warn("Failed to sync the directory of {}", path);
+#endif
+		}
+
+		if (!success)
+		{
+			spdlog::error("Failed to write file: {}", path);
+			std::remove(temporary.c_str());
+		}
+		return success;
+	}
+
+	/**
+	* @details
+	* Serialize the state and write it atomically.
+	*/
+	bool WriteCheckpoint(const std::string& path, const Simulation::SimulationState& state)
+	{
+		PROFILE_SCOPE("Checkpoint Write");
+
+		std::vector<uint8_t> bytes;
+		SerializeCheckpoint(state, bytes);
+		return WriteFileAtomic(path, bytes.data(), bytes.size());
+	}
+
+	/**
+	* @details
+	* Read the whole file with a single read and parse it as a full checkpoint
+	* or, if it starts with the manifest magic, as an incremental one.
+	*/
+	bool ReadCheckpoint(const std::string& path, Simulation::SimulationState& state)
+	{
+		PROFILE_SCOPE("Checkpoint Read");
+
+		std::vector<uint8_t> bytes;
+		if (!ReadFile(path, bytes))
+		{
+			spdlog::error("Failed to open checkpoint file: {}", path);
+			return false;
+		}
+
+		const bool incremental = bytes.size() >= sizeof(CHECKPOINT_MANIFEST_MAGIC) &&
+			std::memcmp(bytes.data(), CHECKPOINT_MANIFEST_MAGIC, sizeof(CHECKPOINT_MANIFEST_MAGIC)) == 0;
+		const bool valid = incremental ?
+			ReadManifest(path, bytes, state) :
+			ParseCheckpoint(bytes.data(), bytes.size(), state);
+		if (!valid)
+		{
+			spdlog::error("Checkpoint file is malformed or incomplete: {}", path);
+			return false;
+		}
+
+		spdlog::info("Read checkpoint {}: {} particles at step {}", path, state.num_particles, state.step);
+		return true;
+	}
+
+	/// @brief Checkpointer PIMPL implementation structure.
+	struct Checkpointer::CheckpointerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		CheckpointerImpl(const CheckpointerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		CheckpointerImpl& operator=(const CheckpointerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		CheckpointerImpl(const CheckpointerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		CheckpointerImpl& operator=(const CheckpointerImpl&& other) = delete;
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		CheckpointerImpl() = default;
+
+		/// @brief Destructor.
+		~CheckpointerImpl();
+
+		//Member methods
+
+		/**
+		* @brief Write the snapshot as a full checkpoint.
+		* @param path The path of the checkpoint file.
+		* @return True if the checkpoint was written, false otherwise.
+		*/
+		bool WriteFull(const std::string& path);
+
+		/**
+		* @brief Write the snapshot's changed blocks and a manifest.
+		* @param path The path of the manifest.
+		* @return True if the checkpoint was written, false otherwise.
+		*/
+		bool WriteIncremental(const std::string& path);
+
+		/**
+		* @brief Append the staged blocks to the block file and sync it.
+		* @param path The path of the block file.
+		* @param offset The offset to write the staged blocks at.
+		* @param create True to create a new block file, false to extend the existing one.
+		* @return True if the blocks were written, false otherwise.
+		*/
+		bool WriteBlocks(const std::string& path, uint64_t offset, bool create);
+
+		//Member variables
+
+		/// @brief Spare buffer the simulation state is snapshotted into.
+		Simulation::SimulationState snapshot;
+		/// @brief Serialized checkpoint or manifest, kept to reuse its allocation.
+		std::vector<uint8_t> bytes;
+		/// @brief Changed blocks staged for a single write, kept to reuse its allocation.
+		std::vector<uint8_t> staged_blocks;
+		/// @brief Manifest path the block layout belongs to.
+		std::string layout_path;
+		/// @brief Flag set while the block layout matches the manifest on disk.
+		bool layout_valid = false;
+		/// @brief Generation of the current block file.
+		uint64_t generation = 0;
+		/// @brief Bytes written to the current block file.
+		uint64_t data_size = 0;
+		/// @brief Bytes of the current block file the manifest still refers to.
+		uint64_t live_size = 0;
+		/// @brief Blocks of each particle array in the last manifest written.
+		std::vector<CheckpointBlock> blocks[ARRAY_COUNT];
+		/// @brief Thread writing the current checkpoint.
+		std::thread writer;
+		/// @brief Flag set while a checkpoint is being written.
+		std::atomic<bool> busy = false;
+		/// @brief Result of the last checkpoint written.
+		std::atomic<bool> error_status = false;
+	};
+
+	/**
+	* @details
+	* Destructor for the CheckpointerImpl class. Waits for the checkpoint being
+	* written, so a checkpoint requested before exit still lands on disk.
+	*/
+	Checkpointer::CheckpointerImpl::~CheckpointerImpl()
+	{
+		if (writer.joinable()) writer.join();
+	}
+
+	/**
+	* @details
+	* Serialize the snapshot and write it atomically. The target no longer is a
+	* manifest, so the next incremental checkpoint starts a new block file. A
+	* manifest the checkpoint replaces takes its block file with it, nothing
+	* else would ever remove that file.
+	*/
+	bool Checkpointer::CheckpointerImpl::WriteFull(const std::string& path)
+	{
+		const uint64_t old_generation = PeekManifestGeneration(path);
+		layout_valid = false;
+
+		SerializeCheckpoint(snapshot, bytes);
+		if (!WriteFileAtomic(path, bytes.data(), bytes.size())) return false;
+
+		if (old_generation != 0) std::remove(BlockFilePath(path, old_generation).c_str());
+
+		spdlog::info(
+			"Wrote checkpoint {}: {} particles at step {}",
+			path,
+			snapshot.num_particles,
+			snapshot.step);
+		return true;
+	}
+
+	/**
+	* @details
+	* Hash every block of every particle array and stage the blocks whose hash
+	* or size differs from the last manifest, then write them to the block file
+	* in one go and write the new manifest atomically. Blocks are appended past
+	* the data the last manifest refers to, so that manifest stays valid until
+	* the new one replaces it. Once the superseded blocks outweigh the live
+	* ones, the checkpoint is compacted: every block is written to a new block
+	* file and the old one is removed after the manifest points away from it.
+	* Arrays that didn't change since the last checkpoint cost only a hash.
+	*/
+	bool Checkpointer::CheckpointerImpl::WriteIncremental(const std::string& path)
+	{
+		const bool compact = !layout_valid || layout_path != path || data_size - live_size > live_size;
+		const uint64_t old_generation = layout_valid && layout_path == path ?
+			generation :
+			PeekManifestGeneration(path);
+
+		if (compact)
+		{
+			generation = std::max(generation, old_generation) + 1;
+			data_size = 0;
+			for (std::vector<CheckpointBlock>& array_blocks : blocks) array_blocks.clear();
+		}
+
+		layout_valid = false;
+		staged_blocks.clear();
+		live_size = 0;
+		size_t changed = 0;
+		size_t total = 0;
+
+		for (int i = 0; i < ARRAY_COUNT; i++)
+		{
+			const std::vector<float>& values = StateArray(snapshot, i);
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(values.data());
+			const size_t size = values.size() * sizeof(float);
+			const size_t count = (size + CHECKPOINT_BLOCK_SIZE - 1) / CHECKPOINT_BLOCK_SIZE;
+
+			std::vector<CheckpointBlock>& array_blocks = blocks[i];
+			array_blocks.resize(count);
+			for (size_t b = 0; b < count; b++)
+			{
+				const size_t start = b * CHECKPOINT_BLOCK_SIZE;
+				const uint32_t block_size = uint32_t(std::min(CHECKPOINT_BLOCK_SIZE, size - start));
+				const uint64_t hash = HashBytes(data + start, block_size);
+
+				CheckpointBlock& block = array_blocks[b];
+				if (block.size != block_size || block.hash != hash)
+				{
+					block.offset = data_size + staged_blocks.size();
+					block.hash = hash;
+					block.size = block_size;
+					staged_blocks.insert(staged_blocks.end(), data + start, data + start + block_size);
+					changed++;
+				}
+			}
+
+			live_size += size;
+			total += count;
+		}
+
+		const std::string block_path = BlockFilePath(path, generation);
+		if (!staged_blocks.empty() || compact)
+		{
+			if (!WriteBlocks(block_path, data_size, compact)) return false;
+			data_size += staged_blocks.size();
+		}
+
+		SerializeManifest(snapshot, generation, data_size, blocks, bytes);
+		if (!WriteFileAtomic(path, bytes.data(), bytes.size())) return false;
+
+		if (compact && old_generation != 0 && old_generation != generation)
+			std::remove(BlockFilePath(path, old_generation).c_str());
+
+		layout_path = path;
+		layout_valid = true;
+
+		spdlog::info(
+			"Wrote incremental checkpoint {}: {} of {} blocks changed, {} bytes{}",
+			path,
+			changed,
+			total,
+			staged_blocks.size(),
+			compact ? " (compacted)" : "");
+		return true;
+	}
+
+	/**
+	* @details
+	* Write the staged blocks at the offset with stdio buffering turned off, so
+	* they reach the OS as one large write, and sync the file before the
+	* manifest that refers to them is written.
+	*/
+	bool Checkpointer::CheckpointerImpl::WriteBlocks(const std::string& path, uint64_t offset, bool create)
+	{
+		std::FILE* file = std::fopen(path.c_str(), create ? "wb" : "r+b");
+		if (file == nullptr)
+		{
+			spdlog::error("Failed to open checkpoint blocks: {}", path);
+			return false;
+		}
+
+		std::setvbuf(file, nullptr, _IONBF, 0);
+#if defined(_WIN32)
+		bool success = _fseeki64(file, int64_t(offset), SEEK_SET) == 0;
+#else
+		bool success = fseeko(file, off_t(offset), SEEK_SET) == 0;
+#endif
+		success = success && std::fwrite(staged_blocks.data(), 1, staged_blocks.size(), file) == staged_blocks.size();
+#if defined(_WIN32)
+		success = success && _commit(_fileno(file)) == 0;
+#else
+		success = success && fsync(fileno(file)) == 0;
+#endif
+		success = std::fclose(file) == 0 && success;
+
+		if (!success) spdlog::error("Failed to write checkpoint blocks: {}", path);
+		return success;
+	}
+
+	/**
+	* @details
+	* Default constructor for the Checkpointer class.
+	*/
+	Checkpointer::Checkpointer() :
+		_impl(std::make_unique<CheckpointerImpl>())
+	{}
+
+	/**
+	* @details
+	* Default destructor for the Checkpointer class.
+	*/
+	Checkpointer::~Checkpointer() = default;
+
+	/**
+	* @details
+	* Hand out the spare buffer unless the writer thread still owns it. The
+	* finished writer thread is joined first so the buffer can be reused.
+	*/
+	Simulation::SimulationState* Checkpointer::BeginSnapshot()
+	{
+		if (_impl->busy) return nullptr;
+		if (_impl->writer.joinable()) _impl->writer.join();
+		return &_impl->snapshot;
+	}
+
+	/**
+	* @details
+	* Start a thread that writes the snapshot as a full or incremental
+	* checkpoint. Stepping carries on while it runs, since the snapshot is a
+	* copy the simulation doesn't touch.
+	*/
+	void Checkpointer::CommitSnapshot(const std::string& path, bool incremental)
+	{
+		if (_impl->busy) return;
+		if (_impl->writer.joinable()) _impl->writer.join();
+
+		_impl->busy = true;
+		_impl->writer = std::thread([impl = _impl.get(), path, incremental]() {
+			PROFILE_THREAD("Checkpoint Writer");
+
+			{
+				PROFILE_SCOPE("Checkpoint Write");
+				impl->error_status = incremental ? !impl->WriteIncremental(path) : !impl->WriteFull(path);
+			}
+
+			impl->busy = false;
+		});
+	}
+
+	/**
+	* @details
+	* Check if the writer thread is still writing.
+	*/
+	bool Checkpointer::IsBusy() const
+	{
+		return _impl->busy;
+	}
+
+	/**
+	* @details
+	* Join the writer thread if there is one.
+	*/
+	void Checkpointer::Wait()
+	{
+		if (_impl->writer.joinable()) _impl->writer.join();
+	}
+
+	/**
+	* @details
+	* Get the result of the last checkpoint written.
+	*/
+	bool Checkpointer::GetErrorStatus() const
+	{
+		return _impl->error_status;
+	}
+}
\ No newline at end of file
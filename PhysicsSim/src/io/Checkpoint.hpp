@@ -0,0 +1,161 @@
+/**
+* @file Checkpoint.hpp
+* @brief
+* Declarations for checkpoint files. A checkpoint holds the full state of a
+* simulation in a versioned binary format of tagged sections, so a restarted
+* run continues bit for bit where the saved one stopped. The file is built in
+* memory and written with a single write, then synced and renamed over the
+* target so a preempted write never leaves a torn checkpoint behind. An
+* incremental checkpoint is a manifest listing fixed size blocks of each
+* particle array, stored in a block file next to it, so only the blocks that
+* changed since the last checkpoint are written. The Checkpointer class
+* snapshots into a spare buffer and writes it on a background thread. Uses
+* the PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _CHECKPOINT_
+#define _CHECKPOINT_
+
+#include "simulation/SimulationState.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief IO namespace
+namespace IO
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Magic bytes at the start of a checkpoint file.
+	inline constexpr char CHECKPOINT_MAGIC[8] = { 'P', 'S', 'C', 'H', 'K', 'P', 'T', '\0' };
+	/// @brief Magic bytes at the start of an incremental checkpoint manifest.
+	inline constexpr char CHECKPOINT_MANIFEST_MAGIC[8] = { 'P', 'S', 'C', 'H', 'K', 'M', 'F', '\0' };
+	/// @brief Version of the checkpoint and manifest formats.
+	inline constexpr uint32_t CHECKPOINT_VERSION = 1;
+	/// @brief Size of the particle array blocks of incremental checkpoints in bytes.
+	inline constexpr size_t CHECKPOINT_BLOCK_SIZE = 64 * 1024;
+
+	/**
+	* @brief Hash a block of bytes with a fast 64-bit non-cryptographic hash.
+	* @param data The bytes to hash.
+	* @param size The number of bytes.
+	* @param seed The seed of the hash.
+	* @return The hash.
+	*/
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+	/**
+	* @brief Serialize a simulation state into the checkpoint format.
+	* @param state The state to serialize.
+	* @param out Set to the bytes of the checkpoint file.
+	*/
+	void SerializeCheckpoint(const Simulation::SimulationState& state, std::vector<uint8_t>& out);
+
+	/**
+	* @brief Parse a simulation state from the bytes of a checkpoint file.
+	* @param data The bytes of the checkpoint file.
+	* @param size The number of bytes.
+	* @param state Set to the parsed state.
+	* @return True if the checkpoint is valid, false otherwise.
+	*/
+	bool ParseCheckpoint(const uint8_t* data, size_t size, Simulation::SimulationState& state);
+
+	/**
+	* @brief Write a file with a single write, sync it and rename it over the target.
+	* @param path The path of the file.
+	* @param data The bytes to write.
+	* @param size The number of bytes.
+	* @return True if the file was written, false otherwise.
+	*/
+	bool WriteFileAtomic(const std::string& path, const void* data, size_t size);
+
+	/**
+	* @brief Write a checkpoint file.
+	* @param path The path of the checkpoint file.
+	* @param state The state to write.
+	* @return True if the checkpoint was written, false otherwise.
+	*/
+	bool WriteCheckpoint(const std::string& path, const Simulation::SimulationState& state);
+
+	/**
+	* @brief Read a full or incremental checkpoint file.
+	* @param path The path of the checkpoint file.
+	* @param state Set to the state in the checkpoint.
+	* @return True if the checkpoint was read, false otherwise.
+	*/
+	bool ReadCheckpoint(const std::string& path, Simulation::SimulationState& state);
+
+	/// @brief Checkpointer class
+	class Checkpointer
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		Checkpointer(const Checkpointer& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		Checkpointer& operator=(const Checkpointer& other) = delete;
+		/// @brief Deleted move constructor.
+		Checkpointer(const Checkpointer&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		Checkpointer& operator=(const Checkpointer&& other) = delete;
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		Checkpointer();
+
+		/// @brief Destructor. Waits for the checkpoint being written.
+		~Checkpointer();
+
+		//Member methods
+
+		/**
+		* @brief Get the spare snapshot buffer to save the simulation state into.
+		* @return Pointer to the buffer, or null while a checkpoint is being written.
+		*/
+		Simulation::SimulationState* BeginSnapshot();
+
+		/**
+		* @brief Write the snapshot buffer to a checkpoint file on a background thread.
+		* @param path The path of the checkpoint file.
+		* @param incremental True to write only the blocks changed since the last checkpoint.
+		*/
+		void CommitSnapshot(const std::string& path, bool incremental = false);
+
+		/**
+		* @brief Check if a checkpoint is being written.
+		* @return True if a checkpoint is being written, false otherwise.
+		*/
+		bool IsBusy() const;
+
+		/// @brief Wait for the checkpoint being written to finish.
+		void Wait();
+
+		/**
+		* @brief Get the result of the last checkpoint written.
+		* @return True if the last checkpoint failed, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of CheckpointerImpl struct.
+		struct CheckpointerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<CheckpointerImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
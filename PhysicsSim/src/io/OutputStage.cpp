@@ -0,0 +1,365 @@
+/**
+* @file OutputStage.cpp
+* @brief
+* Function definitions for the OutputStage class. Uses the PIMPL idiom to hide
+* implementation details.
+*/
+
+#include "OutputStage.hpp"
+#include "TrajectoryWriter.hpp"
+
+#include "profiling/Profiler.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/// @brief IO namespace
+namespace IO
+{
+	/// @brief OutputStage PIMPL implementation structure.
+	struct OutputStage::OutputStageImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		OutputStageImpl() = delete;
+		/// @brief Deleted copy constructor.
+		OutputStageImpl(const OutputStageImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		OutputStageImpl& operator=(const OutputStageImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		OutputStageImpl(const OutputStageImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		OutputStageImpl& operator=(const OutputStageImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the OutputStageImpl class.
+		* @param settings The settings of the output stage.
+		*/
+		explicit OutputStageImpl(const OutputSettings& settings);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~OutputStageImpl();
+
+		//Member methods
+
+		/// @brief Writer thread loop. Writes queued snapshots until stopped.
+		void WriterLoop();
+
+		/// @brief Stop the writer thread after it wrote the queued snapshots.
+		void Stop();
+
+		//Member variables
+
+		/// @brief Size of the stdio buffer of the observables file.
+		static constexpr size_t OBSERVABLES_BUFFER_SIZE = 1 << 20;
+
+		/// @brief Structure to hold a published frame.
+		struct Snapshot
+		{
+			uint64_t step = 0;
+			std::vector<float> positions;
+			std::vector<double> observables;
+		};
+
+		/// @brief Settings of the output stage.
+		OutputSettings settings;
+		/// @brief Trajectory writer, only used by the writer thread.
+		std::unique_ptr<TrajectoryWriter> trajectory;
+		/// @brief Observables file, only used by the writer thread.
+		std::FILE* observables = nullptr;
+		/// @brief Every snapshot buffer.
+		std::vector<std::unique_ptr<Snapshot>> pool;
+		/// @brief Buffers that are free to publish into.
+		std::vector<Snapshot*> free_snapshots;
+		/// @brief Published buffers waiting for the writer thread, oldest first.
+		std::deque<Snapshot*> ready_snapshots;
+		/// @brief Mutex guarding the free and ready lists.
+		std::mutex mutex;
+		/// @brief Signalled when a snapshot is ready or the stage stops.
+		std::condition_variable ready_signal;
+		/// @brief Signalled when a buffer is freed or the stage stops.
+		std::condition_variable free_signal;
+		/// @brief Flag set to stop the writer thread.
+		bool stopping = false;
+		/// @brief The writer thread.
+		std::thread writer;
+		/// @brief Number of frames published.
+		std::atomic<uint64_t> published = 0;
+		/// @brief Number of frames written.
+		std::atomic<uint64_t> written = 0;
+		/// @brief Number of frames dropped.
+		std::atomic<uint64_t> dropped = 0;
+		/// @brief Error status of the output stage.
+		std::atomic<bool> error_status = false;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the OutputStageImpl class. Opens the trajectory and
+	* observables files, allocates the snapshot pool up front so publishing
+	* never allocates, and starts the writer thread.
+	*/
+	OutputStage::OutputStageImpl::OutputStageImpl(const OutputSettings& settings) :
+		settings(settings)
+	{
+		if (!settings.trajectory_path.empty())
+		{
+			trajectory = std::make_unique<TrajectoryWriter>(
+				settings.trajectory_path,
+				settings.header);
+			if (trajectory->GetErrorStatus()) error_status = true;
+		}
+
+		if (!settings.observables_path.empty())
+		{
+			observables = std::fopen(settings.observables_path.c_str(), "wb");
+			if (observables == nullptr)
+			{
+				spdlog::error("Failed to open observables file: {}", settings.observables_path);
+				error_status = true;
+			}
+			else
+			{
+				std::setvbuf(observables, nullptr, _IOFBF, OBSERVABLES_BUFFER_SIZE);
+				std::fputs("step", observables);
+				for (const std::string& name : settings.observable_names)
+					std::fprintf(observables, ",%s", name.c_str());
+				std::fputc('\n', observables);
+			}
+		}
+
+		const size_t pool_size = settings.pool_size > 0 ? settings.pool_size : 1;
+		for (size_t i = 0; i < pool_size; i++)
+		{
+			pool.push_back(std::make_unique<Snapshot>());
+			pool.back()->positions.resize(3 * size_t(settings.header.num_particles));
+			pool.back()->observables.reserve(settings.observable_names.size());
+			free_snapshots.push_back(pool.back().get());
+		}
+
+		writer = std::thread(&OutputStageImpl::WriterLoop, this);
+	}
+
+	/**
+	* @details
+	* Destructor for the OutputStageImpl class. Stops the writer thread.
+	*/
+	OutputStage::OutputStageImpl::~OutputStageImpl()
+	{
+		Stop();
+	}
+
+	/**
+	* @details
+	* Wait for a ready snapshot, write it outside the lock and hand the buffer
+	* back. When stopped, the remaining snapshots are written before the files
+	* are closed, so no published frame is lost.
+	*/
+	void OutputStage::OutputStageImpl::WriterLoop()
+	{
+		PROFILE_THREAD("Output Writer");
+
+		while (true)
+		{
+			Snapshot* snapshot = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready_signal.wait(lock, [this] { return stopping || !ready_snapshots.empty(); });
+				if (ready_snapshots.empty()) break;
+
+				snapshot = ready_snapshots.front();
+				ready_snapshots.pop_front();
+			}
+
+			{
+				PROFILE_SCOPE("Write Frame");
+
+				if (trajectory != nullptr &&
+					!trajectory->WriteFrame(snapshot->step, snapshot->positions.data()))
+					error_status = true;
+
+				if (observables != nullptr)
+				{
+					std::fprintf(observables, "%llu", (unsigned long long)snapshot->step);
+					for (double value : snapshot->observables)
+						std::fprintf(observables, ",%.17g", value);
+					std::fputc('\n', observables);
+				}
+			}
+
+			written++;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				free_snapshots.push_back(snapshot);
+			}
+			free_signal.notify_one();
+		}
+
+		if (trajectory != nullptr && !trajectory->Close()) error_status = true;
+
+		if (observables != nullptr)
+		{
+			if (std::ferror(observables) != 0 || std::fclose(observables) != 0)
+			{
+				spdlog::error("Failed to write observables file: {}", settings.observables_path);
+				error_status = true;
+			}
+			observables = nullptr;
+		}
+	}
+
+	/**
+	* @details
+	* Set the stop flag, wake both sides and join the writer thread.
+	*/
+	void OutputStage::OutputStageImpl::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		ready_signal.notify_all();
+		free_signal.notify_all();
+
+		if (writer.joinable()) writer.join();
+	}
+
+	/**
+	* @details
+	* Custom constructor for the OutputStage class. Passes the settings to the
+	* PIMPL implementation.
+	*/
+	OutputStage::OutputStage(const OutputSettings& settings) :
+		_impl(std::make_unique<OutputStageImpl>(settings))
+	{}
+
+	/**
+	* @details
+	* Default destructor for the OutputStage class.
+	*/
+	OutputStage::~OutputStage() = default;
+
+	/**
+	* @details
+	* Get the error status of the output stage.
+	*/
+	bool OutputStage::GetErrorStatus() const
+	{
+		return _impl->error_status;
+	}
+
+	/**
+	* @details
+	* Take a free buffer, copy the frame into it and queue it. The lock is only
+	* held to move buffer pointers between the lists, the copy happens outside
+	* of it. If no buffer is free, the Drop policy counts and drops the frame
+	* and the Block policy waits until the writer thread frees one. A frame of
+	* the wrong size would overrun or underfill the buffer, and the trajectory
+	* can't change its particle count, so it fails the stage instead.
+	*/
+	bool OutputStage::Publish(
+		uint64_t step,
+		std::span<const float> positions,
+		const std::vector<double>& observables)
+	{
+		PROFILE_SCOPE("Output Publish");
+
+		const size_t expected = 3 * size_t(_impl->settings.header.num_particles);
+		if (positions.size() != expected)
+		{
+			if (!_impl->error_status.exchange(true))
+				spdlog::error(
+					"Output frame has {} position values, expected {}",
+					positions.size(),
+					expected);
+			return false;
+		}
+
+		OutputStageImpl::Snapshot* snapshot = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(_impl->mutex);
+			if (_impl->stopping) return false;
+
+			if (_impl->free_snapshots.empty())
+			{
+				if (_impl->settings.policy == BackpressurePolicy::Drop)
+				{
+					_impl->dropped++;
+					return false;
+				}
+
+				_impl->free_signal.wait(lock, [this] {
+					return _impl->stopping || !_impl->free_snapshots.empty(); });
+				if (_impl->stopping) return false;
+			}
+
+			snapshot = _impl->free_snapshots.back();
+			_impl->free_snapshots.pop_back();
+		}
+
+		snapshot->step = step;
+		std::memcpy(
+			snapshot->positions.data(),
+			positions.data(),
+			positions.size_bytes());
+		snapshot->observables.assign(observables.begin(), observables.end());
+
+		{
+			std::lock_guard<std::mutex> lock(_impl->mutex);
+			_impl->ready_snapshots.push_back(snapshot);
+		}
+		_impl->ready_signal.notify_one();
+
+		_impl->published++;
+		return true;
+	}
+
+	/**
+	* @details
+	* Stop the writer thread. Safe to call more than once.
+	*/
+	void OutputStage::Close()
+	{
+		_impl->Stop();
+	}
+
+	/**
+	* @details
+	* Get the number of frames published.
+	*/
+	uint64_t OutputStage::GetPublishedFrames() const
+	{
+		return _impl->published;
+	}
+
+	/**
+	* @details
+	* Get the number of frames written.
+	*/
+	uint64_t OutputStage::GetWrittenFrames() const
+	{
+		return _impl->written;
+	}
+
+	/**
+	* @details
+	* Get the number of frames dropped.
+	*/
+	uint64_t OutputStage::GetDroppedFrames() const
+	{
+		return _impl->dropped;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+/**
+* @file OutputStage.hpp
+* @brief
+* Class declaration for the asynchronous output stage. The simulation loop
+* publishes frame snapshots by copying them into a pooled buffer, and a
+* dedicated writer thread encodes the trajectory and writes the observables.
+* When the pool runs dry because the disk fell behind, the backpressure policy
+* decides whether the frame is dropped or the publisher waits. Uses the PIMPL
+* idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _OUTPUTSTAGE_
+#define _OUTPUTSTAGE_
+
+#include "Trajectory.hpp"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief IO namespace
+namespace IO
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Behaviour when a frame is published while every buffer is in use.
+	enum class BackpressurePolicy
+	{
+		/// @brief Drop the frame and keep the simulation running.
+		Drop,
+		/// @brief Wait for the writer thread to free a buffer.
+		Block
+	};
+
+	/**
+	* @brief Structure to hold the settings of an output stage.
+	* @param trajectory_path The path of the trajectory file, empty to skip it.
+	* @param observables_path The path of the observables CSV file, empty to skip it.
+	* @param observable_names The column names of the observables.
+	* @param header The header of the trajectory.
+	* @param pool_size The number of snapshot buffers.
+	* @param policy The backpressure policy.
+	*/
+	struct OutputSettings
+	{
+		std::string trajectory_path;
+		std::string observables_path;
+		std::vector<std::string> observable_names;
+		TrajectoryHeader header;
+		size_t pool_size = 4;
+		BackpressurePolicy policy = BackpressurePolicy::Drop;
+	};
+
+	/// @brief OutputStage class
+	class OutputStage
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		OutputStage() = delete;
+		/// @brief Deleted copy constructor.
+		OutputStage(const OutputStage& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		OutputStage& operator=(const OutputStage& other) = delete;
+		/// @brief Deleted move constructor.
+		OutputStage(const OutputStage&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		OutputStage& operator=(const OutputStage&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief
+		* Custom constructor for the OutputStage class. Opens the output files and
+		* starts the writer thread.
+		* @param settings The settings of the output stage.
+		*/
+		explicit OutputStage(const OutputSettings& settings);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Writes the queued frames and stops the writer thread.
+		~OutputStage();
+
+		//Member methods
+
+		/**
+		* @brief Get the error status of the output stage.
+		* @return True if an output file failed, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
+		/**
+		* @brief
+		* Copy a frame into a free buffer and queue it for writing. A frame with
+		* a particle count other than the header's sets the error status.
+		* @param step The simulation step of the frame.
+		* @param positions Positions with three floats (x, y, z) per particle.
+		* @param observables The observable values, one per observable name.
+		* @return True if the frame was queued, false if it was dropped or rejected.
+		*/
+		bool Publish(
+			uint64_t step,
+			std::span<const float> positions,
+			const std::vector<double>& observables = {});
+
+		/// @brief Write the queued frames, stop the writer thread and close the files.
+		void Close();
+
+		/**
+		* @brief Get the number of frames queued for writing.
+		* @return The number of frames published.
+		*/
+		uint64_t GetPublishedFrames() const;
+
+		/**
+		* @brief Get the number of frames written by the writer thread.
+		* @return The number of frames written.
+		*/
+		uint64_t GetWrittenFrames() const;
+
+		/**
+		* @brief Get the number of frames dropped because every buffer was in use.
+		* @return The number of frames dropped.
+		*/
+		uint64_t GetDroppedFrames() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of OutputStageImpl struct.
+		struct OutputStageImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<OutputStageImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
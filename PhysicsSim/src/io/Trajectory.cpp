@@ -0,0 +1,437 @@
+/**
+* @file Trajectory.cpp
+* @brief
+* Function definitions for the binary trajectory format and its frame codec.
+*/
+
+#include "Trajectory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/// @brief IO namespace
+namespace IO
+{
+	/**
+	* @details
+	* Append an unsigned integer of the given width in little endian order.
+	*/
+	static void PutUnsigned(std::vector<uint8_t>& out, uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++) out.push_back(uint8_t(value >> (8 * i)));
+	}
+
+	/**
+	* @details
+	* Read an unsigned integer of the given width in little endian order.
+	*/
+	static uint64_t GetUnsigned(const uint8_t* data, int bytes)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; i++) value |= uint64_t(data[i]) << (8 * i);
+		return value;
+	}
+
+	/**
+	* @details
+	* Append a float by its bit pattern.
+	*/
+	static void PutFloat(std::vector<uint8_t>& out, float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		PutUnsigned(out, bits, 4);
+	}
+
+	/**
+	* @details
+	* Read a float by its bit pattern.
+	*/
+	static float GetFloat(const uint8_t* data)
+	{
+		const uint32_t bits = uint32_t(GetUnsigned(data, 4));
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	/**
+	* @details
+	* Get the number of bytes used per axis value in a keyframe.
+	*/
+	static int KeyframeBytes(const TrajectoryHeader& header)
+	{
+		return int((header.quantization_bits + 7) / 8);
+	}
+
+	/**
+	* @details
+	* Get the largest quantized value.
+	*/
+	static uint32_t MaxQuantized(const TrajectoryHeader& header)
+	{
+		return uint32_t((uint64_t(1) << header.quantization_bits) - 1);
+	}
+
+	/**
+	* @details
+	* The particle count must be nonzero, the dimensions 2 or 3, the bits between
+	* 8 and 32, the keyframe interval nonzero, the stored axes of the box must
+	* have a positive extent, and the species table must be empty or have one
+	* entry per particle.
+	*/
+	bool ValidateTrajectoryHeader(const TrajectoryHeader& header)
+	{
+		if (header.num_particles == 0) return false;
+		if (header.dimensions < 2 || header.dimensions > 3) return false;
+		if (header.quantization_bits < 8 || header.quantization_bits > 32) return false;
+		if (header.keyframe_interval == 0) return false;
+		for (uint32_t axis = 0; axis < header.dimensions; axis++)
+			if (!(header.box_max[axis] > header.box_min[axis])) return false;
+		if (!header.species.empty() && header.species.size() != header.num_particles)
+			return false;
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Write the fixed fields followed by the species table.
+	*/
+	void SerializeTrajectoryHeader(
+		const TrajectoryHeader& header,
+		std::vector<uint8_t>& out)
+	{
+		out.insert(out.end(), TRAJECTORY_MAGIC, TRAJECTORY_MAGIC + 8);
+		PutUnsigned(out, TRAJECTORY_VERSION, 4);
+		PutUnsigned(out, header.num_particles, 4);
+		PutUnsigned(out, header.dimensions, 4);
+		PutUnsigned(out, header.quantization_bits, 4);
+		PutUnsigned(out, header.keyframe_interval, 4);
+		for (float value : header.box_min) PutFloat(out, value);
+		for (float value : header.box_max) PutFloat(out, value);
+		PutUnsigned(out, header.species.size(), 4);
+		out.insert(out.end(), header.species.begin(), header.species.end());
+	}
+
+	/**
+	* @details
+	* Check the magic and version, read the fixed fields and the species table,
+	* then validate the result.
+	*/
+	bool ParseTrajectoryHeader(
+		const uint8_t* data,
+		size_t size,
+		TrajectoryHeader& header,
+		size_t& header_size)
+	{
+		const size_t fixed_size = 8 + 5 * 4 + 6 * 4 + 4;
+		if (size < fixed_size) return false;
+		if (std::memcmp(data, TRAJECTORY_MAGIC, 8) != 0) return false;
+		if (GetUnsigned(data + 8, 4) != TRAJECTORY_VERSION) return false;
+
+		header.num_particles = uint32_t(GetUnsigned(data + 12, 4));
+		header.dimensions = uint32_t(GetUnsigned(data + 16, 4));
+		header.quantization_bits = uint32_t(GetUnsigned(data + 20, 4));
+		header.keyframe_interval = uint32_t(GetUnsigned(data + 24, 4));
+		for (int axis = 0; axis < 3; axis++)
+		{
+			header.box_min[axis] = GetFloat(data + 28 + 4 * axis);
+			header.box_max[axis] = GetFloat(data + 40 + 4 * axis);
+		}
+
+		const uint64_t num_species = GetUnsigned(data + 52, 4);
+		if (num_species > size - fixed_size) return false;
+		header.species.assign(data + fixed_size, data + fixed_size + num_species);
+
+		header_size = fixed_size + size_t(num_species);
+		return ValidateTrajectoryHeader(header);
+	}
+
+	/**
+	* @details
+	* Write the magic, the frame count and the first frame followed by one entry
+	* per frame.
+	*/
+	void SerializeChunkHeader(
+		uint64_t first_frame,
+		const std::vector<TrajectoryFrameEntry>& frames,
+		std::vector<uint8_t>& out)
+	{
+		PutUnsigned(out, TRAJECTORY_CHUNK_MAGIC, 4);
+		PutUnsigned(out, frames.size(), 4);
+		PutUnsigned(out, first_frame, 8);
+		for (const TrajectoryFrameEntry& frame : frames)
+		{
+			PutUnsigned(out, frame.step, 8);
+			PutUnsigned(out, frame.offset, 4);
+			PutUnsigned(out, frame.size, 4);
+		}
+	}
+
+	/**
+	* @details
+	* Check the magic, read the frame table and make sure every payload lies
+	* inside the chunk.
+	*/
+	bool ParseChunkHeader(
+		const uint8_t* data,
+		size_t size,
+		uint64_t& first_frame,
+		std::vector<TrajectoryFrameEntry>& frames)
+	{
+		if (size < TRAJECTORY_CHUNK_HEADER_SIZE) return false;
+		if (GetUnsigned(data, 4) != TRAJECTORY_CHUNK_MAGIC) return false;
+
+		const uint64_t frame_count = GetUnsigned(data + 4, 4);
+		first_frame = GetUnsigned(data + 8, 8);
+		if (frame_count == 0 ||
+			frame_count > (size - TRAJECTORY_CHUNK_HEADER_SIZE) / TRAJECTORY_FRAME_ENTRY_SIZE)
+			return false;
+
+		frames.resize(size_t(frame_count));
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			const uint8_t* entry =
+				data + TRAJECTORY_CHUNK_HEADER_SIZE + i * TRAJECTORY_FRAME_ENTRY_SIZE;
+			frames[i].step = GetUnsigned(entry, 8);
+			frames[i].offset = uint32_t(GetUnsigned(entry + 8, 4));
+			frames[i].size = uint32_t(GetUnsigned(entry + 12, 4));
+			if (uint64_t(frames[i].offset) + frames[i].size > size) return false;
+		}
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Write one entry per chunk followed by the footer.
+	*/
+	void SerializeChunkIndex(
+		uint64_t index_offset,
+		const std::vector<TrajectoryChunkEntry>& chunks,
+		uint64_t num_frames,
+		std::vector<uint8_t>& out)
+	{
+		for (const TrajectoryChunkEntry& chunk : chunks)
+		{
+			PutUnsigned(out, chunk.first_frame, 8);
+			PutUnsigned(out, chunk.offset, 8);
+			PutUnsigned(out, chunk.frame_count, 4);
+			PutUnsigned(out, chunk.size, 4);
+		}
+
+		PutUnsigned(out, index_offset, 8);
+		PutUnsigned(out, chunks.size(), 8);
+		PutUnsigned(out, num_frames, 8);
+		out.insert(out.end(), TRAJECTORY_FOOTER_MAGIC, TRAJECTORY_FOOTER_MAGIC + 8);
+	}
+
+	/**
+	* @details
+	* Read the footer from the end of the file, then the chunk index it points
+	* to. Every chunk must lie between the header and the index.
+	*/
+	bool ParseChunkIndex(
+		const uint8_t* data,
+		size_t size,
+		std::vector<TrajectoryChunkEntry>& chunks,
+		uint64_t& num_frames)
+	{
+		if (size < TRAJECTORY_FOOTER_SIZE) return false;
+
+		const uint8_t* footer = data + size - TRAJECTORY_FOOTER_SIZE;
+		if (std::memcmp(footer + 24, TRAJECTORY_FOOTER_MAGIC, 8) != 0) return false;
+
+		const uint64_t index_offset = GetUnsigned(footer, 8);
+		const uint64_t num_chunks = GetUnsigned(footer + 8, 8);
+		num_frames = GetUnsigned(footer + 16, 8);
+
+		const uint64_t index_end = size - TRAJECTORY_FOOTER_SIZE;
+		if (index_offset > index_end ||
+			num_chunks != (index_end - index_offset) / TRAJECTORY_INDEX_ENTRY_SIZE)
+			return false;
+
+		chunks.resize(size_t(num_chunks));
+		uint64_t frames = 0;
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			const uint8_t* entry = data + index_offset + i * TRAJECTORY_INDEX_ENTRY_SIZE;
+			chunks[i].first_frame = GetUnsigned(entry, 8);
+			chunks[i].offset = GetUnsigned(entry + 8, 8);
+			chunks[i].frame_count = uint32_t(GetUnsigned(entry + 16, 4));
+			chunks[i].size = uint32_t(GetUnsigned(entry + 20, 4));
+			//Compare without adding to the offset, which a corrupt file could wrap around
+			if (chunks[i].first_frame != frames ||
+				chunks[i].offset > index_offset ||
+				chunks[i].size > index_offset - chunks[i].offset)
+				return false;
+			frames += chunks[i].frame_count;
+		}
+
+		return frames == num_frames;
+	}
+
+	/**
+	* @details
+	* Map each stored axis of the box onto [0, 2^bits - 1] and round to the
+	* nearest step. Values outside the box are clamped to its bounds.
+	*/
+	void QuantizePositions(
+		const TrajectoryHeader& header,
+		const float* positions,
+		std::vector<uint32_t>& q)
+	{
+		const size_t n = header.num_particles;
+		const double max_q = double(MaxQuantized(header));
+		q.resize(n * header.dimensions);
+
+		for (uint32_t axis = 0; axis < header.dimensions; axis++)
+		{
+			const double min = header.box_min[axis];
+			const double scale = max_q / (double(header.box_max[axis]) - min);
+			uint32_t* out = q.data() + axis * n;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				const double value = std::round((positions[3 * i + axis] - min) * scale);
+				out[i] = uint32_t(std::clamp(value, 0.0, max_q));
+			}
+		}
+	}
+
+	/**
+	* @details
+	* Map each quantized value back into the box. Axes that aren't stored are
+	* set to the box's lower bound.
+	*/
+	void DequantizePositions(
+		const TrajectoryHeader& header,
+		const std::vector<uint32_t>& q,
+		std::vector<float>& positions)
+	{
+		const size_t n = header.num_particles;
+		const double max_q = double(MaxQuantized(header));
+		positions.resize(3 * n);
+
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const double min = header.box_min[axis];
+
+			if (axis >= header.dimensions)
+			{
+				for (size_t i = 0; i < n; i++) positions[3 * i + axis] = float(min);
+				continue;
+			}
+
+			const double step = (double(header.box_max[axis]) - min) / max_q;
+			const uint32_t* in = q.data() + axis * n;
+			for (size_t i = 0; i < n; i++)
+				positions[3 * i + axis] = float(min + double(in[i]) * step);
+		}
+	}
+
+	/**
+	* @details
+	* Write every value with the fixed width of the quantization bits.
+	*/
+	void EncodeKeyframe(
+		const TrajectoryHeader& header,
+		const std::vector<uint32_t>& q,
+		std::vector<uint8_t>& out)
+	{
+		const int bytes = KeyframeBytes(header);
+		out.reserve(out.size() + q.size() * bytes);
+		for (uint32_t value : q) PutUnsigned(out, value, bytes);
+	}
+
+	/**
+	* @details
+	* Write the difference of every value to the keyframe as a zigzag varint.
+	* Zigzag maps small negative and positive differences onto small unsigned
+	* values, so a particle that moved less than 64 steps along an axis costs a
+	* single byte for that axis.
+	*/
+	void EncodeDeltaFrame(
+		const std::vector<uint32_t>& q,
+		const std::vector<uint32_t>& key,
+		std::vector<uint8_t>& out)
+	{
+		out.reserve(out.size() + q.size() * 2);
+		for (size_t i = 0; i < q.size(); i++)
+		{
+			const int64_t delta = int64_t(q[i]) - int64_t(key[i]);
+			uint64_t zigzag = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+
+			while (zigzag >= 0x80)
+			{
+				out.push_back(uint8_t(zigzag | 0x80));
+				zigzag >>= 7;
+			}
+			out.push_back(uint8_t(zigzag));
+		}
+	}
+
+	/**
+	* @details
+	* Read the fixed width values. The payload must have exactly one value per
+	* stored axis and particle.
+	*/
+	bool DecodeKeyframe(
+		const TrajectoryHeader& header,
+		const uint8_t* data,
+		size_t size,
+		std::vector<uint32_t>& q)
+	{
+		const int bytes = KeyframeBytes(header);
+		const size_t count = size_t(header.num_particles) * header.dimensions;
+		if (size != count * bytes) return false;
+
+		q.resize(count);
+		for (size_t i = 0; i < count; i++)
+			q[i] = uint32_t(GetUnsigned(data + i * bytes, bytes));
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Read one zigzag varint per value and add it to the keyframe. Fails if the
+	* payload ends early, has trailing bytes, or a value leaves the quantized
+	* range.
+	*/
+	bool DecodeDeltaFrame(
+		const TrajectoryHeader& header,
+		const uint8_t* data,
+		size_t size,
+		const std::vector<uint32_t>& key,
+		std::vector<uint32_t>& q)
+	{
+		const size_t count = size_t(header.num_particles) * header.dimensions;
+		if (key.size() != count) return false;
+
+		const int64_t max_q = MaxQuantized(header);
+		q.resize(count);
+
+		size_t pos = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t zigzag = 0;
+			for (int shift = 0;; shift += 7)
+			{
+				if (pos >= size || shift > 63) return false;
+				const uint8_t byte = data[pos++];
+				zigzag |= uint64_t(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) break;
+			}
+
+			const int64_t delta = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+			const int64_t value = int64_t(key[i]) + delta;
+			if (value < 0 || value > max_q) return false;
+			q[i] = uint32_t(value);
+		}
+
+		return pos == size;
+	}
+}
\ No newline at end of file
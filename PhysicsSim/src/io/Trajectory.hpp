@@ -0,0 +1,266 @@
+/**
+* @file Trajectory.hpp
+* @brief
+* Declarations for the binary trajectory format and its frame codec.
+*
+* A trajectory file has the following layout, all values little endian:
+* 1. File header: magic, version, particle count, dimensions, quantization
+*    bits, keyframe interval, box bounds and one species id per particle.
+* 2. Chunks: each chunk holds up to keyframe_interval frames. Its first frame
+*    is a keyframe, the rest are delta frames against that keyframe, so any
+*    frame is decoded from at most two payloads. A chunk starts with a table of
+*    the step, offset and size of each of its frames.
+* 3. Chunk index: one entry per chunk with its first frame, frame count,
+*    file offset and size.
+* 4. Footer: offset of the chunk index, chunk and frame counts and a magic.
+*
+* Positions are quantized to quantization_bits per axis relative to the box.
+* Keyframes store the quantized values with a fixed width, delta frames store
+* the zigzag varint encoded difference to the keyframe, which is one or two
+* bytes per axis for particles that moved little.
+*/
+
+#pragma once
+
+#ifndef _TRAJECTORY_
+#define _TRAJECTORY_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief IO namespace
+namespace IO
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Magic at the start of a trajectory file.
+	constexpr char TRAJECTORY_MAGIC[8] = { 'P', 'S', 'T', 'R', 'A', 'J', '\0', '\0' };
+	/// @brief Magic at the end of a trajectory file.
+	constexpr char TRAJECTORY_FOOTER_MAGIC[8] = { 'P', 'S', 'T', 'R', 'I', 'D', 'X', '\0' };
+	/// @brief Magic at the start of every chunk.
+	constexpr uint32_t TRAJECTORY_CHUNK_MAGIC = 0x4B4E4843;
+	/// @brief Current version of the trajectory format.
+	constexpr uint32_t TRAJECTORY_VERSION = 1;
+	/// @brief Size of the footer in bytes.
+	constexpr size_t TRAJECTORY_FOOTER_SIZE = 32;
+	/// @brief Size of a chunk header without its frame table in bytes.
+	constexpr size_t TRAJECTORY_CHUNK_HEADER_SIZE = 16;
+	/// @brief Size of a frame table entry in bytes.
+	constexpr size_t TRAJECTORY_FRAME_ENTRY_SIZE = 16;
+	/// @brief Size of a chunk index entry in bytes.
+	constexpr size_t TRAJECTORY_INDEX_ENTRY_SIZE = 24;
+
+	/**
+	* @brief Structure to hold the header of a trajectory.
+	* @param num_particles The number of particles in every frame.
+	* @param dimensions The number of stored axes, 2 or 3. Unstored axes decode to box_min.
+	* @param quantization_bits Bits per axis, between 8 and 32.
+	* @param keyframe_interval The number of frames per chunk.
+	* @param box_min The lower bounds of the box.
+	* @param box_max The upper bounds of the box.
+	* @param species The species id of every particle.
+	*/
+	struct TrajectoryHeader
+	{
+		uint32_t num_particles = 0;
+		uint32_t dimensions = 2;
+		uint32_t quantization_bits = 16;
+		uint32_t keyframe_interval = 32;
+		float box_min[3] = { -1.0f, -1.0f, 0.0f };
+		float box_max[3] = { 1.0f, 1.0f, 0.0f };
+		std::vector<uint8_t> species;
+	};
+
+	/**
+	* @brief Structure to hold a chunk index entry.
+	* @param first_frame The index of the chunk's keyframe.
+	* @param offset The file offset of the chunk.
+	* @param frame_count The number of frames in the chunk.
+	* @param size The size of the chunk in bytes.
+	*/
+	struct TrajectoryChunkEntry
+	{
+		uint64_t first_frame = 0;
+		uint64_t offset = 0;
+		uint32_t frame_count = 0;
+		uint32_t size = 0;
+	};
+
+	/**
+	* @brief Structure to hold a frame table entry of a chunk.
+	* @param step The simulation step of the frame.
+	* @param offset The offset of the frame's payload from the start of the chunk.
+	* @param size The size of the frame's payload in bytes.
+	*/
+	struct TrajectoryFrameEntry
+	{
+		uint64_t step = 0;
+		uint32_t offset = 0;
+		uint32_t size = 0;
+	};
+
+	/**
+	* @brief Check that a header describes a valid trajectory.
+	* @param header The header to check.
+	* @return True if the header is valid, false otherwise.
+	*/
+	bool ValidateTrajectoryHeader(const TrajectoryHeader& header);
+
+	/**
+	* @brief Append the serialized header to a buffer.
+	* @param header The header to serialize.
+	* @param out The buffer to append to.
+	*/
+	void SerializeTrajectoryHeader(
+		const TrajectoryHeader& header,
+		std::vector<uint8_t>& out);
+
+	/**
+	* @brief Parse a serialized header.
+	* @param data The start of the file.
+	* @param size The number of bytes available.
+	* @param header The header to fill.
+	* @param header_size Set to the size of the serialized header.
+	* @return True if a valid header was parsed, false otherwise.
+	*/
+	bool ParseTrajectoryHeader(
+		const uint8_t* data,
+		size_t size,
+		TrajectoryHeader& header,
+		size_t& header_size);
+
+	/**
+	* @brief Append a chunk header with its frame table to a buffer.
+	* @param first_frame The index of the chunk's keyframe.
+	* @param frames The frame table of the chunk.
+	* @param out The buffer to append to.
+	*/
+	void SerializeChunkHeader(
+		uint64_t first_frame,
+		const std::vector<TrajectoryFrameEntry>& frames,
+		std::vector<uint8_t>& out);
+
+	/**
+	* @brief Parse a chunk header and its frame table.
+	* @param data The start of the chunk.
+	* @param size The size of the chunk in bytes.
+	* @param first_frame Set to the index of the chunk's keyframe.
+	* @param frames Set to the frame table of the chunk.
+	* @return True if a valid chunk header was parsed, false otherwise.
+	*/
+	bool ParseChunkHeader(
+		const uint8_t* data,
+		size_t size,
+		uint64_t& first_frame,
+		std::vector<TrajectoryFrameEntry>& frames);
+
+	/**
+	* @brief Append the chunk index and the footer to a buffer.
+	* @param index_offset The file offset the chunk index is written at.
+	* @param chunks The chunk index.
+	* @param num_frames The total number of frames.
+	* @param out The buffer to append to.
+	*/
+	void SerializeChunkIndex(
+		uint64_t index_offset,
+		const std::vector<TrajectoryChunkEntry>& chunks,
+		uint64_t num_frames,
+		std::vector<uint8_t>& out);
+
+	/**
+	* @brief Parse the footer and the chunk index at the end of a file.
+	* @param data The start of the file.
+	* @param size The size of the file in bytes.
+	* @param chunks Set to the chunk index.
+	* @param num_frames Set to the total number of frames.
+	* @return True if a valid index was parsed, false otherwise.
+	*/
+	bool ParseChunkIndex(
+		const uint8_t* data,
+		size_t size,
+		std::vector<TrajectoryChunkEntry>& chunks,
+		uint64_t& num_frames);
+
+	/**
+	* @brief Quantize positions relative to the box.
+	* @param header The header with the box and quantization bits.
+	* @param positions Positions with three floats (x, y, z) per particle.
+	* @param q Set to the quantized values, one axis after the other.
+	*/
+	void QuantizePositions(
+		const TrajectoryHeader& header,
+		const float* positions,
+		std::vector<uint32_t>& q);
+
+	/**
+	* @brief Convert quantized values back to positions.
+	* @param header The header with the box and quantization bits.
+	* @param q The quantized values, one axis after the other.
+	* @param positions Set to three floats (x, y, z) per particle.
+	*/
+	void DequantizePositions(
+		const TrajectoryHeader& header,
+		const std::vector<uint32_t>& q,
+		std::vector<float>& positions);
+
+	/**
+	* @brief Append a keyframe payload to a buffer.
+	* @param header The header of the trajectory.
+	* @param q The quantized values of the frame.
+	* @param out The buffer to append to.
+	*/
+	void EncodeKeyframe(
+		const TrajectoryHeader& header,
+		const std::vector<uint32_t>& q,
+		std::vector<uint8_t>& out);
+
+	/**
+	* @brief Append a delta frame payload to a buffer.
+	* @param q The quantized values of the frame.
+	* @param key The quantized values of the chunk's keyframe.
+	* @param out The buffer to append to.
+	*/
+	void EncodeDeltaFrame(
+		const std::vector<uint32_t>& q,
+		const std::vector<uint32_t>& key,
+		std::vector<uint8_t>& out);
+
+	/**
+	* @brief Decode a keyframe payload.
+	* @param header The header of the trajectory.
+	* @param data The payload.
+	* @param size The size of the payload in bytes.
+	* @param q Set to the quantized values of the frame.
+	* @return True if the payload was decoded, false if it is malformed.
+	*/
+	bool DecodeKeyframe(
+		const TrajectoryHeader& header,
+		const uint8_t* data,
+		size_t size,
+		std::vector<uint32_t>& q);
+
+	/**
+	* @brief Decode a delta frame payload.
+	* @param header The header of the trajectory.
+	* @param data The payload.
+	* @param size The size of the payload in bytes.
+	* @param key The quantized values of the chunk's keyframe.
+	* @param q Set to the quantized values of the frame.
+	* @return True if the payload was decoded, false if it is malformed.
+	*/
+	bool DecodeDeltaFrame(
+		const TrajectoryHeader& header,
+		const uint8_t* data,
+		size_t size,
+		const std::vector<uint32_t>& key,
+		std::vector<uint32_t>& q);
+}
+
+#endif
\ No newline at end of file
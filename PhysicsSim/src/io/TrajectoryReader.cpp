@@ -0,0 +1,341 @@
+/**
+* @file TrajectoryReader.cpp
+* @brief
+* Function definitions for the TrajectoryReader class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "TrajectoryReader.hpp"
+
+#include "profiling/Profiler.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// @brief IO namespace
+namespace IO
+{
+	/// @brief TrajectoryReader PIMPL implementation structure.
+	struct TrajectoryReader::TrajectoryReaderImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		TrajectoryReaderImpl() = delete;
+		/// @brief Deleted copy constructor.
+		TrajectoryReaderImpl(const TrajectoryReaderImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		TrajectoryReaderImpl& operator=(const TrajectoryReaderImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		TrajectoryReaderImpl(const TrajectoryReaderImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		TrajectoryReaderImpl& operator=(const TrajectoryReaderImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the TrajectoryReaderImpl class.
+		* @param path The path of the trajectory file.
+		*/
+		explicit TrajectoryReaderImpl(const std::string& path);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~TrajectoryReaderImpl();
+
+		//Member methods
+
+		/**
+		* @brief Map the file into memory.
+		* @return True if the file was mapped, false otherwise.
+		*/
+		bool Map();
+
+		/// @brief Unmap the file.
+		void Unmap();
+
+		/**
+		* @brief Make the chunk holding a frame the current chunk.
+		* @param frame The index of the frame.
+		* @return True if the chunk and its keyframe were decoded, false otherwise.
+		*/
+		bool LoadChunk(uint64_t frame);
+
+		//Member variables
+
+		/// @brief Path of the trajectory file.
+		std::string path;
+		/// @brief Start of the mapped file.
+		const uint8_t* data = nullptr;
+		/// @brief Size of the mapped file in bytes.
+		size_t size = 0;
+#if defined(_WIN32)
+		/// @brief Handle of the file.
+		HANDLE file = INVALID_HANDLE_VALUE;
+		/// @brief Handle of the file mapping.
+		HANDLE mapping = nullptr;
+#endif
+		/// @brief Header of the trajectory.
+		TrajectoryHeader header;
+		/// @brief Chunk index of the trajectory.
+		std::vector<TrajectoryChunkEntry> chunks;
+		/// @brief Number of frames in the trajectory.
+		uint64_t frame_count = 0;
+		/// @brief Index of the current chunk, -1 if none.
+		int64_t current_chunk = -1;
+		/// @brief Frame table of the current chunk.
+		std::vector<TrajectoryFrameEntry> frames;
+		/// @brief Quantized values of the current chunk's keyframe.
+		std::vector<uint32_t> key;
+		/// @brief Quantized values of the frame being decoded.
+		std::vector<uint32_t> q;
+		/// @brief Error status of the reader.
+		bool error_status = false;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the TrajectoryReaderImpl class. Maps the file, then
+	* parses the header from its start and the chunk index from its end.
+	*/
+	TrajectoryReader::TrajectoryReaderImpl::TrajectoryReaderImpl(const std::string& path) :
+		path(path)
+	{
+		if (!Map())
+		{
+			spdlog::error("Failed to map trajectory file: {}", path);
+			error_status = true;
+			return;
+		}
+
+		size_t header_size = 0;
+		if (!ParseTrajectoryHeader(data, size, header, header_size) ||
+			!ParseChunkIndex(data, size, chunks, frame_count))
+		{
+			spdlog::error("Trajectory file is malformed or incomplete: {}", path);
+			error_status = true;
+			return;
+		}
+
+		spdlog::info(
+			"Opened trajectory {}: {} particles, {} frames in {} chunks",
+			path,
+			header.num_particles,
+			frame_count,
+			chunks.size());
+	}
+
+	/**
+	* @details
+	* Destructor for the TrajectoryReaderImpl class. Unmaps the file.
+	*/
+	TrajectoryReader::TrajectoryReaderImpl::~TrajectoryReaderImpl()
+	{
+		Unmap();
+	}
+
+	/**
+	* @details
+	* Map the whole file read only. The mapping reserves address space only,
+	* pages are read on first access, so a file larger than RAM can be opened.
+	* Access is hinted as random since scrubbing jumps between chunks.
+	*/
+	bool TrajectoryReader::TrajectoryReaderImpl::Map()
+	{
+#if defined(_WIN32)
+		file = CreateFileA(
+			path.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_FLAG_RANDOM_ACCESS,
+			nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) return false;
+		size = size_t(file_size.QuadPart);
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) return false;
+
+		data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		return data != nullptr;
+#else
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+		size = size_t(info.st_size);
+
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (address == MAP_FAILED) return false;
+
+		madvise(address, size, MADV_RANDOM);
+		data = static_cast<const uint8_t*>(address);
+		return true;
+#endif
+	}
+
+	/**
+	* @details
+	* Unmap the file and close its handles.
+	*/
+	void TrajectoryReader::TrajectoryReaderImpl::Unmap()
+	{
+#if defined(_WIN32)
+		if (data != nullptr) UnmapViewOfFile(data);
+		if (mapping != nullptr) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	/**
+	* @details
+	* Find the chunk by binary search over the first frames of the index. If it
+	* isn't the current chunk, parse its frame table and decode its keyframe,
+	* which every other frame of the chunk is decoded against.
+	*/
+	bool TrajectoryReader::TrajectoryReaderImpl::LoadChunk(uint64_t frame)
+	{
+		auto it = std::upper_bound(
+			chunks.begin(),
+			chunks.end(),
+			frame,
+			[](uint64_t value, const TrajectoryChunkEntry& chunk) {
+				return value < chunk.first_frame; });
+		if (it == chunks.begin()) return false;
+
+		const int64_t index = int64_t(it - chunks.begin()) - 1;
+		if (index == current_chunk) return true;
+
+		current_chunk = -1;
+		const TrajectoryChunkEntry& chunk = chunks[size_t(index)];
+		const uint8_t* start = data + chunk.offset;
+
+		uint64_t first_frame = 0;
+		if (!ParseChunkHeader(start, chunk.size, first_frame, frames) ||
+			first_frame != chunk.first_frame ||
+			frames.size() != chunk.frame_count ||
+			!DecodeKeyframe(header, start + frames[0].offset, frames[0].size, key))
+			return false;
+
+		current_chunk = index;
+		return true;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the TrajectoryReader class. Passes the path to the
+	* PIMPL implementation.
+	*/
+	TrajectoryReader::TrajectoryReader(const std::string& path) :
+		_impl(std::make_unique<TrajectoryReaderImpl>(path))
+	{}
+
+	/**
+	* @details
+	* Default destructor for the TrajectoryReader class.
+	*/
+	TrajectoryReader::~TrajectoryReader() = default;
+
+	/**
+	* @details
+	* Get the error status of the reader.
+	*/
+	bool TrajectoryReader::GetErrorStatus() const
+	{
+		return _impl->error_status;
+	}
+
+	/**
+	* @details
+	* Get the header of the trajectory.
+	*/
+	const TrajectoryHeader& TrajectoryReader::GetHeader() const
+	{
+		return _impl->header;
+	}
+
+	/**
+	* @details
+	* Get the number of frames in the trajectory.
+	*/
+	uint64_t TrajectoryReader::GetFrameCount() const
+	{
+		return _impl->frame_count;
+	}
+
+	/**
+	* @details
+	* Load the frame's chunk, then dequantize the keyframe directly or decode
+	* the frame's delta against it. Frames of the current chunk skip the index
+	* search and keyframe decode.
+	*/
+	bool TrajectoryReader::ReadFrame(
+		uint64_t frame,
+		std::vector<float>& positions,
+		uint64_t* step)
+	{
+		PROFILE_SCOPE("Trajectory Decode");
+
+		if (_impl->error_status || frame >= _impl->frame_count) return false;
+
+		if (!_impl->LoadChunk(frame))
+		{
+			spdlog::error("Failed to load trajectory chunk for frame {}", frame);
+			return false;
+		}
+
+		const TrajectoryChunkEntry& chunk = _impl->chunks[size_t(_impl->current_chunk)];
+		const size_t local = size_t(frame - chunk.first_frame);
+		const TrajectoryFrameEntry& entry = _impl->frames[local];
+
+		if (local == 0) DequantizePositions(_impl->header, _impl->key, positions);
+		else
+		{
+			if (!DecodeDeltaFrame(
+				_impl->header,
+				_impl->data + chunk.offset + entry.offset,
+				entry.size,
+				_impl->key,
+				_impl->q))
+			{
+				spdlog::error("Failed to decode trajectory frame {}", frame);
+				return false;
+			}
+
+			DequantizePositions(_impl->header, _impl->q, positions);
+		}
+
+		if (step != nullptr) *step = entry.step;
+		return true;
+	}
+}
\ No newline at end of file
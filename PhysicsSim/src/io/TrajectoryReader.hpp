@@ -0,0 +1,102 @@
+/**
+* @file TrajectoryReader.hpp
+* @brief
+* Class declaration for the trajectory reader. The file is memory mapped, so
+* only the pages of the chunks that are decoded are ever read from disk. A
+* frame is found through the chunk index and decoded from its chunk's keyframe
+* and its own delta, so seeking costs the same for any frame. Uses the PIMPL
+* idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _TRAJECTORYREADER_
+#define _TRAJECTORYREADER_
+
+#include "Trajectory.hpp"
+
+#include <memory>
+#include <string>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief IO namespace
+namespace IO
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief TrajectoryReader class
+	class TrajectoryReader
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		TrajectoryReader() = delete;
+		/// @brief Deleted copy constructor.
+		TrajectoryReader(const TrajectoryReader& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		TrajectoryReader& operator=(const TrajectoryReader& other) = delete;
+		/// @brief Deleted move constructor.
+		TrajectoryReader(const TrajectoryReader&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		TrajectoryReader& operator=(const TrajectoryReader&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief
+		* Custom constructor for the TrajectoryReader class. Maps the file and
+		* parses the header and the chunk index.
+		* @param path The path of the trajectory file.
+		*/
+		explicit TrajectoryReader(const std::string& path);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Unmaps the file.
+		~TrajectoryReader();
+
+		//Member methods
+
+		/**
+		* @brief Get the error status of the reader.
+		* @return True if the file couldn't be opened or is malformed, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
+		/**
+		* @brief Get the header of the trajectory.
+		* @return Reference to the header.
+		*/
+		const TrajectoryHeader& GetHeader() const;
+
+		/**
+		* @brief Get the number of frames in the trajectory.
+		* @return The number of frames.
+		*/
+		uint64_t GetFrameCount() const;
+
+		/**
+		* @brief Decode a frame.
+		* @param frame The index of the frame.
+		* @param positions Set to three floats (x, y, z) per particle.
+		* @param step Set to the simulation step of the frame if not null.
+		* @return True if the frame was decoded, false otherwise.
+		*/
+		bool ReadFrame(uint64_t frame, std::vector<float>& positions, uint64_t* step = nullptr);
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of TrajectoryReaderImpl struct.
+		struct TrajectoryReaderImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<TrajectoryReaderImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,329 @@
+/**
+* @file TrajectoryWriter.cpp
+* @brief
+* Function definitions for the TrajectoryWriter class. Uses the PIMPL idiom to
+* hide implementation details.
+*/
+
+#include "TrajectoryWriter.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <cstdio>
+#include <limits>
+
+/// @brief IO namespace
+namespace IO
+{
+	/// @brief TrajectoryWriter PIMPL implementation structure.
+	struct TrajectoryWriter::TrajectoryWriterImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		TrajectoryWriterImpl() = delete;
+		/// @brief Deleted copy constructor.
+		TrajectoryWriterImpl(const TrajectoryWriterImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		TrajectoryWriterImpl& operator=(const TrajectoryWriterImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		TrajectoryWriterImpl(const TrajectoryWriterImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		TrajectoryWriterImpl& operator=(const TrajectoryWriterImpl&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the TrajectoryWriterImpl class.
+		* @param path The path of the trajectory file.
+		* @param header The header of the trajectory.
+		*/
+		TrajectoryWriterImpl(const std::string& path, const TrajectoryHeader& header);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor.
+		~TrajectoryWriterImpl();
+
+		//Member methods
+
+		/**
+		* @brief Write raw bytes to the file.
+		* @param data The bytes to write.
+		* @param size The number of bytes to write.
+		* @return True if every byte was written, false otherwise.
+		*/
+		bool Write(const uint8_t* data, size_t size);
+
+		/**
+		* @brief Write the current chunk and add it to the chunk index.
+		* @return True if the chunk was written, false otherwise.
+		*/
+		bool FlushChunk();
+
+		/**
+		* @brief Flush the last chunk, write the index and close the file.
+		* @return True if the file was completed successfully, false otherwise.
+		*/
+		bool Close();
+
+		//Member variables
+
+		/// @brief Largest chunk payload before a chunk is closed early.
+		static constexpr size_t MAX_CHUNK_PAYLOAD =
+			std::numeric_limits<uint32_t>::max() / 2;
+
+		/// @brief Path of the trajectory file.
+		std::string path;
+		/// @brief Header of the trajectory.
+		TrajectoryHeader header;
+		/// @brief Handle of the trajectory file.
+		std::FILE* file = nullptr;
+		/// @brief Quantized values of the current chunk's keyframe.
+		std::vector<uint32_t> key;
+		/// @brief Quantized values of the frame being written.
+		std::vector<uint32_t> q;
+		/// @brief Frame payloads of the current chunk.
+		std::vector<uint8_t> payload;
+		/// @brief Frame table of the current chunk, offsets relative to the payload.
+		std::vector<TrajectoryFrameEntry> frames;
+		/// @brief Serialization buffer for headers and the index.
+		std::vector<uint8_t> scratch;
+		/// @brief Index of every chunk written.
+		std::vector<TrajectoryChunkEntry> chunks;
+		/// @brief Number of frames written.
+		uint64_t frame_count = 0;
+		/// @brief Number of bytes written to the file.
+		uint64_t bytes_written = 0;
+		/// @brief Error status of the writer.
+		bool error_status = false;
+	};
+
+	/**
+	* @details
+	* Custom constructor for the TrajectoryWriterImpl class. Validates the
+	* header, opens the file and writes the header.
+	*/
+	TrajectoryWriter::TrajectoryWriterImpl::TrajectoryWriterImpl(
+		const std::string& path,
+		const TrajectoryHeader& header) :
+		path(path),
+		header(header)
+	{
+		if (!ValidateTrajectoryHeader(header))
+		{
+			spdlog::error("Invalid trajectory header for {}", path);
+			error_status = true;
+			return;
+		}
+
+		file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			spdlog::error("Failed to open trajectory file: {}", path);
+			error_status = true;
+			return;
+		}
+
+		SerializeTrajectoryHeader(header, scratch);
+		if (!Write(scratch.data(), scratch.size())) return;
+
+		spdlog::info(
+			"Recording trajectory to {} ({} particles, {} bit quantization)",
+			path,
+			header.num_particles,
+			header.quantization_bits);
+	}
+
+	/**
+	* @details
+	* Destructor for the TrajectoryWriterImpl class. Completes the file if it
+	* wasn't closed explicitly.
+	*/
+	TrajectoryWriter::TrajectoryWriterImpl::~TrajectoryWriterImpl()
+	{
+		Close();
+	}
+
+	/**
+	* @details
+	* Write the bytes and count them. Sets the error status on a short write.
+	*/
+	bool TrajectoryWriter::TrajectoryWriterImpl::Write(const uint8_t* data, size_t size)
+	{
+		if (error_status || file == nullptr) return false;
+
+		if (std::fwrite(data, 1, size, file) != size)
+		{
+			spdlog::error("Failed to write trajectory file: {}", path);
+			error_status = true;
+			return false;
+		}
+
+		bytes_written += size;
+		return true;
+	}
+
+	/**
+	* @details
+	* Shift the frame offsets past the chunk header, write the header and the
+	* payload back to back, and record the chunk in the index.
+	*/
+	bool TrajectoryWriter::TrajectoryWriterImpl::FlushChunk()
+	{
+		if (frames.empty()) return true;
+
+		const size_t header_size =
+			TRAJECTORY_CHUNK_HEADER_SIZE + frames.size() * TRAJECTORY_FRAME_ENTRY_SIZE;
+		for (TrajectoryFrameEntry& frame : frames) frame.offset += uint32_t(header_size);
+
+		TrajectoryChunkEntry chunk;
+		chunk.first_frame = frame_count - frames.size();
+		chunk.offset = bytes_written;
+		chunk.frame_count = uint32_t(frames.size());
+		chunk.size = uint32_t(header_size + payload.size());
+
+		scratch.clear();
+		SerializeChunkHeader(chunk.first_frame, frames, scratch);
+		const bool success =
+			Write(scratch.data(), scratch.size()) &&
+			Write(payload.data(), payload.size());
+
+		if (success) chunks.push_back(chunk);
+		frames.clear();
+		payload.clear();
+		return success;
+	}
+
+	/**
+	* @details
+	* Flush the last chunk and append the chunk index and the footer. The index
+	* offset is the current end of the file.
+	*/
+	bool TrajectoryWriter::TrajectoryWriterImpl::Close()
+	{
+		if (file == nullptr) return !error_status;
+
+		FlushChunk();
+
+		scratch.clear();
+		SerializeChunkIndex(bytes_written, chunks, frame_count, scratch);
+		Write(scratch.data(), scratch.size());
+
+		if (std::fclose(file) != 0 && !error_status)
+		{
+			spdlog::error("Failed to close trajectory file: {}", path);
+			error_status = true;
+		}
+		file = nullptr;
+
+		if (!error_status)
+			spdlog::info(
+				"Trajectory written to {}: {} frames, {} bytes",
+				path,
+				frame_count,
+				bytes_written);
+
+		return !error_status;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the TrajectoryWriter class. Passes the path and
+	* header to the PIMPL implementation.
+	*/
+	TrajectoryWriter::TrajectoryWriter(
+		const std::string& path,
+		const TrajectoryHeader& header) :
+		_impl(std::make_unique<TrajectoryWriterImpl>(path, header))
+	{}
+
+	/**
+	* @details
+	* Default destructor for the TrajectoryWriter class.
+	*/
+	TrajectoryWriter::~TrajectoryWriter() = default;
+
+	/**
+	* @details
+	* Get the error status of the writer.
+	*/
+	bool TrajectoryWriter::GetErrorStatus() const
+	{
+		return _impl->error_status;
+	}
+
+	/**
+	* @details
+	* Get the header of the trajectory.
+	*/
+	const TrajectoryHeader& TrajectoryWriter::GetHeader() const
+	{
+		return _impl->header;
+	}
+
+	/**
+	* @details
+	* Quantize the positions and encode them as a keyframe if the chunk is empty
+	* or as a delta frame against the chunk's keyframe otherwise. The chunk is
+	* written once it holds keyframe_interval frames, or early if its payload
+	* grows too large for the 32 bit offsets of the frame table.
+	*/
+	bool TrajectoryWriter::WriteFrame(uint64_t step, const float* positions)
+	{
+		if (_impl->error_status || _impl->file == nullptr) return false;
+
+		if (_impl->payload.size() > TrajectoryWriterImpl::MAX_CHUNK_PAYLOAD &&
+			!_impl->FlushChunk())
+			return false;
+
+		QuantizePositions(_impl->header, positions, _impl->q);
+
+		TrajectoryFrameEntry frame;
+		frame.step = step;
+		frame.offset = uint32_t(_impl->payload.size());
+
+		if (_impl->frames.empty())
+		{
+			_impl->key.swap(_impl->q);
+			EncodeKeyframe(_impl->header, _impl->key, _impl->payload);
+		}
+		else EncodeDeltaFrame(_impl->q, _impl->key, _impl->payload);
+
+		frame.size = uint32_t(_impl->payload.size() - frame.offset);
+		_impl->frames.push_back(frame);
+		_impl->frame_count++;
+
+		if (_impl->frames.size() >= _impl->header.keyframe_interval)
+			return _impl->FlushChunk();
+
+		return true;
+	}
+
+	/**
+	* @details
+	* Complete and close the file.
+	*/
+	bool TrajectoryWriter::Close()
+	{
+		return _impl->Close();
+	}
+
+	/**
+	* @details
+	* Get the number of frames written.
+	*/
+	uint64_t TrajectoryWriter::GetFrameCount() const
+	{
+		return _impl->frame_count;
+	}
+
+	/**
+	* @details
+	* Get the number of bytes written to the file.
+	*/
+	uint64_t TrajectoryWriter::GetBytesWritten() const
+	{
+		return _impl->bytes_written;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+/**
+* @file TrajectoryWriter.hpp
+* @brief
+* Class declaration for the trajectory writer. Frames are encoded into an
+* in-memory chunk that is written with large sequential writes once it holds
+* keyframe_interval frames. The chunk index and footer are written on close.
+* Uses the PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _TRAJECTORYWRITER_
+#define _TRAJECTORYWRITER_
+
+#include "Trajectory.hpp"
+
+#include <memory>
+#include <string>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief IO namespace
+namespace IO
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief TrajectoryWriter class
+	class TrajectoryWriter
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		TrajectoryWriter() = delete;
+		/// @brief Deleted copy constructor.
+		TrajectoryWriter(const TrajectoryWriter& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		TrajectoryWriter& operator=(const TrajectoryWriter& other) = delete;
+		/// @brief Deleted move constructor.
+		TrajectoryWriter(const TrajectoryWriter&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		TrajectoryWriter& operator=(const TrajectoryWriter&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the TrajectoryWriter class.
+		* @param path The path of the trajectory file.
+		* @param header The header of the trajectory.
+		*/
+		TrajectoryWriter(const std::string& path, const TrajectoryHeader& header);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Closes the file if it is still open.
+		~TrajectoryWriter();
+
+		//Member methods
+
+		/**
+		* @brief Get the error status of the writer.
+		* @return True if an error occurred, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
+		/**
+		* @brief Get the header of the trajectory.
+		* @return Reference to the header.
+		*/
+		const TrajectoryHeader& GetHeader() const;
+
+		/**
+		* @brief Encode a frame and append it to the current chunk.
+		* @param step The simulation step of the frame.
+		* @param positions Positions with three floats (x, y, z) per particle.
+		* @return True if the frame was written, false otherwise.
+		*/
+		bool WriteFrame(uint64_t step, const float* positions);
+
+		/**
+		* @brief Write the last chunk, the chunk index and the footer and close the file.
+		* @return True if the file was completed successfully, false otherwise.
+		*/
+		bool Close();
+
+		/**
+		* @brief Get the number of frames written.
+		* @return The number of frames written.
+		*/
+		uint64_t GetFrameCount() const;
+
+		/**
+		* @brief Get the number of bytes written to the file.
+		* @return The number of bytes written to the file.
+		*/
+		uint64_t GetBytesWritten() const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of TrajectoryWriterImpl struct.
+		struct TrajectoryWriterImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<TrajectoryWriterImpl> _impl;
+	};
+}
+
+#endif
\ No newline at end of file
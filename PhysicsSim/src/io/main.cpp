@@ -0,0 +1,574 @@
+/**
+* @file main.cpp
+* @brief
+* Main function for the IO library. Used as a testing environment: runs the
+* round trip checks of the trajectory format, the output stage and the
+* checkpoints, which need no OpenGL context.
+*/
+
+#include "Checkpoint.hpp"
+#include "OutputStage.hpp"
+#include "Trajectory.hpp"
+#include "TrajectoryReader.hpp"
+#include "TrajectoryWriter.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+* @brief Generate positions spread over the box of a header.
+* @param header The header with the particle count and box.
+* @param gen The random generator.
+* @return Three floats (x, y, z) per particle, z at box_min for 2D headers.
+*/
+static std::vector<float> GeneratePositions(
+	const IO::TrajectoryHeader& header,
+	std::mt19937& gen)
+{
+	std::vector<float> positions(3 * size_t(header.num_particles));
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		std::uniform_real_distribution<float> dis(header.box_min[axis], header.box_max[axis]);
+		for (uint32_t i = 0; i < header.num_particles; i++)
+			positions[3 * i + axis] = axis < header.dimensions ? dis(gen) : header.box_min[axis];
+	}
+
+	return positions;
+}
+
+/**
+* @brief Move every particle a small step inside the box, like a random walk.
+* @param header The header with the box.
+* @param gen The random generator.
+* @param positions The positions to move.
+*/
+static void WalkPositions(
+	const IO::TrajectoryHeader& header,
+	std::mt19937& gen,
+	std::vector<float>& positions)
+{
+	std::normal_distribution<float> dis(0.0f, 0.002f);
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		const uint32_t axis = uint32_t(i % 3);
+		if (axis >= header.dimensions) continue;
+		positions[i] = std::fmin(
+			std::fmax(positions[i] + dis(gen), header.box_min[axis]),
+			header.box_max[axis]);
+	}
+}
+
+/**
+* @brief Get the largest error quantization may introduce on an axis.
+* @param header The header with the box and quantization bits.
+* @param axis The axis.
+* @return Half a quantization step, with slack for float rounding.
+*/
+static double QuantizationTolerance(const IO::TrajectoryHeader& header, uint32_t axis)
+{
+	const double max_q = double((uint64_t(1) << header.quantization_bits) - 1);
+	return 0.5 * (double(header.box_max[axis]) - header.box_min[axis]) / max_q + 1e-6;
+}
+
+/**
+* @brief Check that decoded positions match the originals within quantization.
+* @param header The header of the trajectory.
+* @param expected The positions that were encoded.
+* @param actual The decoded positions.
+* @return True if every position is within tolerance, false otherwise.
+*/
+static bool PositionsMatch(
+	const IO::TrajectoryHeader& header,
+	const std::vector<float>& expected,
+	const std::vector<float>& actual)
+{
+	if (expected.size() != actual.size()) return false;
+
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		const uint32_t axis = uint32_t(i % 3);
+		if (std::fabs(double(expected[i]) - actual[i]) > QuantizationTolerance(header, axis))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+* @brief
+* Encode a keyframe and a delta frame and decode them again. The quantized
+* values must come back exactly, the positions within half a step.
+* @return True if the check passed, false otherwise.
+*/
+static bool CheckFrameCodec()
+{
+	IO::TrajectoryHeader header;
+	header.num_particles = 1000;
+	header.species.assign(header.num_particles, 0);
+
+	std::mt19937 gen(1);
+	std::vector<float> positions = GeneratePositions(header, gen);
+
+	std::vector<uint32_t> key;
+	IO::QuantizePositions(header, positions.data(), key);
+	std::vector<uint8_t> payload;
+	IO::EncodeKeyframe(header, key, payload);
+
+	std::vector<uint32_t> decoded_key;
+	if (!IO::DecodeKeyframe(header, payload.data(), payload.size(), decoded_key) ||
+		decoded_key != key)
+	{
+		spdlog::error("Keyframe did not decode to its quantized values");
+		return false;
+	}
+
+	std::vector<float> decoded;
+	IO::DequantizePositions(header, decoded_key, decoded);
+	if (!PositionsMatch(header, positions, decoded))
+	{
+		spdlog::error("Keyframe positions are off by more than half a quantization step");
+		return false;
+	}
+
+	WalkPositions(header, gen, positions);
+	std::vector<uint32_t> q;
+	IO::QuantizePositions(header, positions.data(), q);
+	payload.clear();
+	IO::EncodeDeltaFrame(q, key, payload);
+
+	std::vector<uint32_t> decoded_q;
+	if (!IO::DecodeDeltaFrame(header, payload.data(), payload.size(), key, decoded_q) ||
+		decoded_q != q)
+	{
+		spdlog::error("Delta frame did not decode to its quantized values");
+		return false;
+	}
+
+	//A truncated payload must be rejected, not read past its end
+	if (IO::DecodeDeltaFrame(header, payload.data(), payload.size() - 1, key, decoded_q))
+	{
+		spdlog::error("Truncated delta frame was accepted");
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* @brief
+* Write a trajectory over several chunks and read every frame back in random
+* order through the memory-mapped reader. A chunk offset that would wrap
+* around past the chunk index must be rejected.
+* @param path The path of the temporary trajectory file.
+* @return True if the check passed, false otherwise.
+*/
+static bool CheckTrajectoryFile(const std::string& path)
+{
+	IO::TrajectoryHeader header;
+	header.num_particles = 500;
+	header.keyframe_interval = 8;
+	header.species.assign(header.num_particles, 1);
+
+	const uint64_t num_frames = 37;
+	std::mt19937 gen(2);
+	std::vector<std::vector<float>> frames;
+	{
+		IO::TrajectoryWriter writer(path, header);
+		if (writer.GetErrorStatus()) return false;
+
+		std::vector<float> positions = GeneratePositions(header, gen);
+		for (uint64_t frame = 0; frame < num_frames; frame++)
+		{
+			if (!writer.WriteFrame(10 * frame, positions.data())) return false;
+			frames.push_back(positions);
+			WalkPositions(header, gen, positions);
+		}
+
+		if (!writer.Close()) return false;
+	}
+
+	IO::TrajectoryReader reader(path);
+	if (reader.GetErrorStatus()) return false;
+	if (reader.GetFrameCount() != num_frames ||
+		reader.GetHeader().num_particles != header.num_particles ||
+		reader.GetHeader().species != header.species)
+	{
+		spdlog::error("Trajectory header or frame count did not survive the round trip");
+		return false;
+	}
+
+	std::vector<uint64_t> order(num_frames);
+	for (uint64_t frame = 0; frame < num_frames; frame++) order[frame] = frame;
+	std::shuffle(order.begin(), order.end(), gen);
+
+	std::vector<float> decoded;
+	for (uint64_t frame : order)
+	{
+		uint64_t step = 0;
+		if (!reader.ReadFrame(frame, decoded, &step) ||
+			step != 10 * frame ||
+			!PositionsMatch(header, frames[frame], decoded))
+		{
+			spdlog::error("Trajectory frame {} did not survive the round trip", frame);
+			return false;
+		}
+	}
+
+	// Point the first chunk at an offset that wraps around when its size is added
+	std::vector<uint8_t> bytes;
+	{
+		std::ifstream file(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	if (bytes.size() < IO::TRAJECTORY_FOOTER_SIZE) return false;
+
+	uint64_t index_offset = 0;
+	const uint8_t* footer = bytes.data() + bytes.size() - IO::TRAJECTORY_FOOTER_SIZE;
+	for (int i = 7; i >= 0; i--) index_offset = (index_offset << 8) | footer[i];
+	if (index_offset + IO::TRAJECTORY_INDEX_ENTRY_SIZE > bytes.size()) return false;
+	std::memset(bytes.data() + index_offset + 8, 0xFF, 8);
+
+	const std::string corrupt_path = path + ".corrupt";
+	{
+		std::ofstream file(corrupt_path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+	}
+
+	std::vector<IO::TrajectoryChunkEntry> chunks;
+	uint64_t frame_count = 0;
+	if (IO::ParseChunkIndex(bytes.data(), bytes.size(), chunks, frame_count) ||
+		!IO::TrajectoryReader(corrupt_path).GetErrorStatus())
+	{
+		spdlog::error("Trajectory with a wrapped around chunk offset was accepted");
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* @brief
+* Publish frames through the output stage with the Block policy, which must
+* write every one of them, then check that a frame of the wrong size is
+* rejected and fails the stage.
+* @param path The path of the temporary trajectory file.
+* @return True if the check passed, false otherwise.
+*/
+static bool CheckOutputStage(const std::string& path)
+{
+	IO::OutputSettings settings;
+	settings.trajectory_path = path;
+	settings.header.num_particles = 2000;
+	settings.header.species.assign(settings.header.num_particles, 0);
+	settings.pool_size = 2;
+	settings.policy = IO::BackpressurePolicy::Block;
+
+	const uint64_t num_frames = 50;
+	std::mt19937 gen(3);
+	std::vector<float> positions = GeneratePositions(settings.header, gen);
+	{
+		IO::OutputStage output(settings);
+		if (output.GetErrorStatus()) return false;
+
+		for (uint64_t frame = 0; frame < num_frames; frame++)
+		{
+			if (!output.Publish(frame, positions))
+			{
+				spdlog::error("Blocking output stage dropped frame {}", frame);
+				return false;
+			}
+			WalkPositions(settings.header, gen, positions);
+		}
+
+		const std::vector<float> short_frame(positions.begin(), positions.end() - 3);
+		if (output.Publish(num_frames, short_frame) || !output.GetErrorStatus())
+		{
+			spdlog::error("Output stage accepted a frame of the wrong size");
+			return false;
+		}
+
+		output.Close();
+		if (output.GetWrittenFrames() != num_frames || output.GetDroppedFrames() != 0)
+		{
+			spdlog::error(
+				"Output stage wrote {} of {} frames",
+				output.GetWrittenFrames(),
+				num_frames);
+			return false;
+		}
+	}
+
+	IO::TrajectoryReader reader(path);
+	return !reader.GetErrorStatus() && reader.GetFrameCount() == num_frames;
+}
+
+/**
+* @brief Fill a simulation state with random particles.
+* @param num_particles The number of particles.
+* @param gen The random generator.
+* @return The state.
+*/
+static Simulation::SimulationState GenerateState(int num_particles, std::mt19937& gen)
+{
+	Simulation::SimulationState state;
+	state.step = 12345;
+	state.num_particles = num_particles;
+	state.box_width_perc = 80;
+	state.box_height_perc = 60;
+	state.energy_value = 1.5f;
+	state.temperature = 300.0f;
+	state.chem_potential = -0.25f;
+	state.radius = 0.01f;
+
+	std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+	for (std::vector<float>* values : { &state.positions, &state.colors, &state.scales })
+	{
+		values->resize(3 * size_t(num_particles));
+		for (float& value : *values) value = dis(gen);
+	}
+
+	return state;
+}
+
+/**
+* @brief Check that two float arrays hold the same bits.
+* @param a The first array.
+* @param b The second array.
+* @return True if the arrays are bit for bit equal, false otherwise.
+*/
+static bool SameBits(const std::vector<float>& a, const std::vector<float>& b)
+{
+	return a.size() == b.size() &&
+		(a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+}
+
+/**
+* @brief Check that a restored state matches the saved one bit for bit.
+* @param expected The saved state.
+* @param actual The restored state.
+* @return True if the states match, false otherwise.
+*/
+static bool StatesMatch(
+	const Simulation::SimulationState& expected,
+	const Simulation::SimulationState& actual)
+{
+	return expected.step == actual.step &&
+		expected.num_particles == actual.num_particles &&
+		expected.box_width_perc == actual.box_width_perc &&
+		expected.box_height_perc == actual.box_height_perc &&
+		std::memcmp(&expected.energy_value, &actual.energy_value, sizeof(float)) == 0 &&
+		std::memcmp(&expected.temperature, &actual.temperature, sizeof(float)) == 0 &&
+		std::memcmp(&expected.chem_potential, &actual.chem_potential, sizeof(float)) == 0 &&
+		std::memcmp(&expected.radius, &actual.radius, sizeof(float)) == 0 &&
+		SameBits(expected.positions, actual.positions) &&
+		SameBits(expected.colors, actual.colors) &&
+		SameBits(expected.scales, actual.scales);
+}
+
+/**
+* @brief
+* Write a checkpoint directly and through the Checkpointer's writer thread
+* and read both back, which must restore the state bit for bit. A checkpoint
+* with a flipped byte must be rejected by its hash.
+* @param path The path of the temporary checkpoint file.
+* @return True if the check passed, false otherwise.
+*/
+static bool CheckCheckpointFile(const std::string& path)
+{
+	std::mt19937 gen(4);
+	const Simulation::SimulationState state = GenerateState(3000, gen);
+
+	Simulation::SimulationState restored;
+	if (!IO::WriteCheckpoint(path, state) ||
+		!IO::ReadCheckpoint(path, restored) ||
+		!StatesMatch(state, restored))
+	{
+		spdlog::error("Checkpoint did not survive the round trip");
+		return false;
+	}
+
+	IO::Checkpointer checkpointer;
+	Simulation::SimulationState* snapshot = checkpointer.BeginSnapshot();
+	if (snapshot == nullptr) return false;
+	*snapshot = GenerateState(3000, gen);
+	const Simulation::SimulationState expected = *snapshot;
+	checkpointer.CommitSnapshot(path);
+	checkpointer.Wait();
+
+	if (checkpointer.GetErrorStatus() ||
+		!IO::ReadCheckpoint(path, restored) ||
+		!StatesMatch(expected, restored))
+	{
+		spdlog::error("Background checkpoint did not survive the round trip");
+		return false;
+	}
+
+	std::vector<uint8_t> bytes;
+	IO::SerializeCheckpoint(state, bytes);
+	bytes[bytes.size() / 2] ^= 0x01;
+	if (IO::ParseCheckpoint(bytes.data(), bytes.size(), restored))
+	{
+		spdlog::error("Corrupted checkpoint was accepted");
+		return false;
+	}
+
+	return true;
+}
+
+/**
+* @brief List the block files of incremental checkpoints in a directory.
+* @param dir The directory.
+* @return The paths of the block files, sorted.
+*/
+static std::vector<std::filesystem::path> BlockFiles(const std::filesystem::path& dir)
+{
+	std::vector<std::filesystem::path> files;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+		if (entry.path().extension() == ".blk") files.push_back(entry.path());
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+/**
+* @brief
+* Write incremental checkpoints through the Checkpointer and read each one
+* back. An unchanged state must not grow the block file, a partial change
+* must append only the changed block, and enough changes must compact into a
+* new block file. Switching between full and incremental checkpoints at one
+* path must leave no block file behind that no manifest refers to.
+* @param dir The empty directory the checkpoints are written to.
+* @return True if the check passed, false otherwise.
+*/
+static bool CheckIncrementalCheckpoints(const std::filesystem::path& dir)
+{
+	const std::string path = (dir / "checkpoint.man").string();
+	std::mt19937 gen(5);
+	Simulation::SimulationState state = GenerateState(30000, gen);
+	const uint64_t live_size = 3 * state.positions.size() * sizeof(float);
+
+	IO::Checkpointer checkpointer;
+	auto write = [&](bool incremental)
+	{
+		Simulation::SimulationState* snapshot = checkpointer.BeginSnapshot();
+		if (snapshot == nullptr) return false;
+		*snapshot = state;
+		checkpointer.CommitSnapshot(path, incremental);
+		checkpointer.Wait();
+
+		Simulation::SimulationState restored;
+		return !checkpointer.GetErrorStatus() &&
+			IO::ReadCheckpoint(path, restored) &&
+			StatesMatch(state, restored);
+	};
+	auto block_file_size = [&]()
+	{
+		const std::vector<std::filesystem::path> files = BlockFiles(dir);
+		return files.size() == 1 ? uint64_t(std::filesystem::file_size(files[0])) : uint64_t(0);
+	};
+
+	if (!write(true) || block_file_size() != live_size)
+	{
+		spdlog::error("First incremental checkpoint did not survive the round trip");
+		return false;
+	}
+
+	state.step++;
+	if (!write(true) || block_file_size() != live_size)
+	{
+		spdlog::error("Unchanged incremental checkpoint wrote blocks");
+		return false;
+	}
+
+	state.step++;
+	state.positions[0] += 1.0f;
+	if (!write(true) || block_file_size() != live_size + IO::CHECKPOINT_BLOCK_SIZE)
+	{
+		spdlog::error("Partially changed incremental checkpoint wrote more than the changed block");
+		return false;
+	}
+
+	// Changing everything leaves more superseded data than live data, so the next write compacts
+	const std::vector<std::filesystem::path> before = BlockFiles(dir);
+	for (int i = 0; i < 2; i++)
+	{
+		state.step++;
+		for (std::vector<float>* values : { &state.positions, &state.colors, &state.scales })
+			for (float& value : *values) value += 1.0f;
+		if (!write(true))
+		{
+			spdlog::error("Changed incremental checkpoint did not survive the round trip");
+			return false;
+		}
+	}
+	if (BlockFiles(dir) == before || block_file_size() != live_size)
+	{
+		spdlog::error("Incremental checkpoint was not compacted into a new block file");
+		return false;
+	}
+
+	// The GUI can switch between full and incremental checkpoints at one path
+	for (bool incremental : { false, true, false, true, true, false })
+	{
+		state.step++;
+		state.positions[state.positions.size() / 2] += 1.0f;
+		if (!write(incremental))
+		{
+			spdlog::error("Mixed full and incremental checkpoints did not survive the round trip");
+			return false;
+		}
+
+		if (BlockFiles(dir).size() != (incremental ? 1u : 0u))
+		{
+			spdlog::error("Stale checkpoint block files were left behind");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+* @brief Run a check and log its outcome.
+* @param name The name of the check.
+* @param passed The result of the check.
+* @return The result of the check.
+*/
+static bool Report(const char* name, bool passed)
+{
+	if (passed) spdlog::info("{}: passed", name);
+	else spdlog::error("{}: FAILED", name);
+	return passed;
+}
+
+/**
+* @brief Main function. Runs every check.
+* @return 0 if every check passed, 1 otherwise.
+*/
+int main()
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "physicssim_io_test";
+	std::error_code error;
+	std::filesystem::create_directories(dir, error);
+
+	bool passed = true;
+	passed &= Report("Frame codec", CheckFrameCodec());
+	passed &= Report("Trajectory file", CheckTrajectoryFile((dir / "trajectory.pstraj").string()));
+	passed &= Report("Output stage", CheckOutputStage((dir / "output.pstraj").string()));
+	passed &= Report("Checkpoint file", CheckCheckpointFile((dir / "checkpoint.pschk").string()));
+
+	std::filesystem::create_directories(dir / "incremental", error);
+	passed &= Report("Incremental checkpoints", CheckIncrementalCheckpoints(dir / "incremental"));
+
+	std::filesystem::remove_all(dir, error);
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+/**
+* @file GpuProfiler.cpp
+* @brief
+* Function definitions for the GpuProfiler class. Uses the PIMPL idiom to hide
+* implementation details.
+*/
+
+#include "GpuProfiler.hpp"
+
+#include "utils/GlfwIncludes.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <array>
+#include <cstring>
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	/// @brief GpuProfiler PIMPL implementation structure.
+	struct GpuProfiler::GpuProfilerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		GpuProfilerImpl(const GpuProfilerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		GpuProfilerImpl& operator=(const GpuProfilerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		GpuProfilerImpl(const GpuProfilerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		GpuProfilerImpl& operator=(const GpuProfilerImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Default constructor.
+		GpuProfilerImpl() = default;
+		/// @brief Default destructor.
+		~GpuProfilerImpl() = default;
+
+		//Member methods
+
+		/**
+		* @brief Read back a frame's results if they are available.
+		* @param frame The index of the frame in the ring.
+		* @return True if the results were read, false if they are still pending.
+		*/
+		bool Resolve(int frame);
+
+		/**
+		* @brief Add a pass time to the pass's moving average.
+		* @param name The name of the pass.
+		* @param ms The GPU time of the pass in milliseconds.
+		*/
+		void Record(const char* name, float ms);
+
+		//Member variables
+
+		/// @brief Number of frames the queries are kept in flight.
+		static constexpr int FRAMES_IN_FLIGHT = 4;
+		/// @brief Maximum number of passes timed per frame.
+		static constexpr int MAX_PASSES = 16;
+		/// @brief Weight of the newest frame in the moving averages.
+		static constexpr float AVERAGE_WEIGHT = 0.1f;
+
+		/// @brief Structure to hold the queries of a single frame.
+		struct FrameQueries
+		{
+			std::array<GLuint, MAX_PASSES> queries = {};
+			std::array<const char*, MAX_PASSES> names = {};
+			int count = 0;
+			bool pending = false;
+		};
+
+		/// @brief Ring of frames in flight.
+		std::array<FrameQueries, FRAMES_IN_FLIGHT> frames;
+		/// @brief Index of the frame currently being recorded.
+		int current = 0;
+		/// @brief Flag set while a pass is being timed.
+		bool in_pass = false;
+		/// @brief Flag set when the query objects were created.
+		bool available = false;
+		/// @brief Number of frames dropped because their results never arrived.
+		uint64_t dropped_frames = 0;
+		/// @brief GPU times of every timed pass, ordered by first use.
+		std::vector<GpuPassTime> times;
+	};
+
+	/**
+	* @details
+	* Check the last query of the frame first. Queries complete in order, so once
+	* the last one is available the whole frame can be read without waiting.
+	* Passes timed more than once in a frame are summed.
+	*/
+	bool GpuProfiler::GpuProfilerImpl::Resolve(int frame)
+	{
+		FrameQueries& queries = frames[frame];
+		if (!queries.pending) return true;
+
+		GLint ready = GL_FALSE;
+		glGetQueryObjectiv(
+			queries.queries[queries.count - 1],
+			GL_QUERY_RESULT_AVAILABLE,
+			&ready);
+		if (ready == GL_FALSE) return false;
+
+		for (int i = 0; i < queries.count; i++)
+		{
+			if (queries.names[i] == nullptr) continue;
+
+			GLuint64 ns = 0;
+			GLuint64 sum = 0;
+			glGetQueryObjectui64v(queries.queries[i], GL_QUERY_RESULT, &ns);
+			sum += ns;
+
+			for (int j = i + 1; j < queries.count; j++)
+			{
+				if (queries.names[j] != queries.names[i]) continue;
+				glGetQueryObjectui64v(queries.queries[j], GL_QUERY_RESULT, &ns);
+				sum += ns;
+				queries.names[j] = nullptr;
+			}
+
+			Record(queries.names[i], float(double(sum) * 1e-6));
+		}
+
+		queries.pending = false;
+		return true;
+	}
+
+	/**
+	* @details
+	* Update the pass's last time and moving average. The first sample of a pass
+	* initializes the average.
+	*/
+	void GpuProfiler::GpuProfilerImpl::Record(const char* name, float ms)
+	{
+		for (GpuPassTime& time : times)
+		{
+			if (time.name != name && std::strcmp(time.name, name) != 0) continue;
+			time.last_ms = ms;
+			time.average_ms += AVERAGE_WEIGHT * (ms - time.average_ms);
+			return;
+		}
+
+		GpuPassTime time;
+		time.name = name;
+		time.last_ms = ms;
+		time.average_ms = ms;
+		times.push_back(time);
+	}
+
+	/**
+	* @details
+	* Constructor for the GpuProfiler class. Initializes the PIMPL pointer.
+	*/
+	GpuProfiler::GpuProfiler() :
+		_impl(std::make_unique<GpuProfilerImpl>())
+	{}
+
+	/**
+	* @details
+	* Default destructor for the GpuProfiler class. The query objects must have
+	* been deleted with Shutdown while the context was alive.
+	*/
+	GpuProfiler::~GpuProfiler() = default;
+
+	/**
+	* @details
+	* Get the application wide GPU profiler. Constructed on first use.
+	*/
+	GpuProfiler& GpuProfiler::Get()
+	{
+		static GpuProfiler profiler;
+		return profiler;
+	}
+
+	/**
+	* @details
+	* Create the query objects for every frame in flight. GL_TIME_ELAPSED queries
+	* are core in OpenGL 3.3, older contexts leave the profiler unavailable.
+	*/
+	void GpuProfiler::Init()
+	{
+		if (_impl->available) return;
+
+		if (!GLAD_GL_VERSION_3_3)
+		{
+			spdlog::warn("GPU timer queries require OpenGL 3.3, GPU profiling disabled");
+			return;
+		}
+
+		for (GpuProfilerImpl::FrameQueries& frame : _impl->frames)
+		{
+			glGenQueries(GpuProfilerImpl::MAX_PASSES, frame.queries.data());
+			frame.count = 0;
+			frame.pending = false;
+		}
+
+		_impl->current = 0;
+		_impl->in_pass = false;
+		_impl->available = true;
+	}
+
+	/**
+	* @details
+	* Delete the query objects and mark the profiler unavailable.
+	*/
+	void GpuProfiler::Shutdown()
+	{
+		if (!_impl->available) return;
+
+		if (_impl->in_pass) glEndQuery(GL_TIME_ELAPSED);
+
+		for (GpuProfilerImpl::FrameQueries& frame : _impl->frames)
+		{
+			glDeleteQueries(GpuProfilerImpl::MAX_PASSES, frame.queries.data());
+			frame.queries.fill(0);
+			frame.count = 0;
+			frame.pending = false;
+		}
+
+		if (_impl->dropped_frames > 0)
+			spdlog::info("GPU profiler dropped {} unresolved frames", _impl->dropped_frames);
+
+		_impl->in_pass = false;
+		_impl->available = false;
+	}
+
+	/**
+	* @details
+	* Get whether timer queries are available.
+	*/
+	bool GpuProfiler::IsAvailable() const
+	{
+		return _impl->available;
+	}
+
+	/**
+	* @details
+	* Begin the next query of the current frame. Ignored if the profiler is
+	* unavailable, a pass is already running, or the frame is out of queries.
+	*/
+	bool GpuProfiler::BeginPass(const char* name)
+	{
+		GpuProfilerImpl::FrameQueries& frame = _impl->frames[_impl->current];
+		if (!_impl->available ||
+			_impl->in_pass ||
+			frame.count == GpuProfilerImpl::MAX_PASSES)
+			return false;
+
+		frame.names[frame.count] = name;
+		glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.count]);
+		frame.count++;
+		_impl->in_pass = true;
+		return true;
+	}
+
+	/**
+	* @details
+	* End the running query.
+	*/
+	void GpuProfiler::EndPass()
+	{
+		if (!_impl->in_pass) return;
+
+		glEndQuery(GL_TIME_ELAPSED);
+		_impl->in_pass = false;
+	}
+
+	/**
+	* @details
+	* End the current frame using the following steps:
+	* 1. Mark the current frame pending if it timed any passes.
+	* 2. Resolve every pending frame, oldest first, whose results have arrived.
+	* 3. Advance to the next frame in the ring. If that frame's results still
+	*    haven't arrived after FRAMES_IN_FLIGHT frames, drop them rather than
+	*    wait on the GPU.
+	*/
+	void GpuProfiler::EndFrame()
+	{
+		if (!_impl->available) return;
+
+		GpuProfilerImpl::FrameQueries& frame = _impl->frames[_impl->current];
+		frame.pending = frame.count > 0;
+
+		for (int i = 1; i <= GpuProfilerImpl::FRAMES_IN_FLIGHT; i++)
+		{
+			const int index = (_impl->current + i) % GpuProfilerImpl::FRAMES_IN_FLIGHT;
+			if (!_impl->Resolve(index)) break;
+		}
+
+		_impl->current = (_impl->current + 1) % GpuProfilerImpl::FRAMES_IN_FLIGHT;
+
+		GpuProfilerImpl::FrameQueries& next = _impl->frames[_impl->current];
+		if (next.pending)
+		{
+			next.pending = false;
+			_impl->dropped_frames++;
+		}
+		next.count = 0;
+	}
+
+	/**
+	* @details
+	* Get the GPU times of every timed pass.
+	*/
+	const std::vector<GpuPassTime>& GpuProfiler::GetPassTimes() const
+	{
+		return _impl->times;
+	}
+
+	/**
+	* @details
+	* Find the pass by name. Names are compared by content so CPU scope names
+	* from other translation units match as well.
+	*/
+	const GpuPassTime* GpuProfiler::FindPass(const char* name) const
+	{
+		for (const GpuPassTime& time : _impl->times)
+			if (time.name == name || std::strcmp(time.name, name) == 0) return &time;
+
+		return nullptr;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the ScopedGpuTimer class. Starts the pass.
+	*/
+	ScopedGpuTimer::ScopedGpuTimer(const char* name) :
+		active(GpuProfiler::Get().BeginPass(name))
+	{}
+
+	/**
+	* @details
+	* Destructor for the ScopedGpuTimer class. Ends the pass if it was started.
+	*/
+	ScopedGpuTimer::~ScopedGpuTimer()
+	{
+		if (active) GpuProfiler::Get().EndPass();
+	}
+}
\ No newline at end of file
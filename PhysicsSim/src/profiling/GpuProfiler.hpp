@@ -0,0 +1,184 @@
+/**
+* @file GpuProfiler.hpp
+* @brief
+* Class declaration for the GPU profiler. Times render passes with
+* GL_TIME_ELAPSED queries kept in a ring of frames so results are read back
+* several frames later without stalling the pipeline. Passes can't nest, a pass
+* started inside another one is ignored. Must only be used on the thread that
+* owns the OpenGL context. Defining PHYSICSSIM_NO_PROFILING compiles the
+* instrumentation macros out. Uses the PIMPL idiom to hide implementation
+* details.
+*/
+
+#pragma once
+
+#ifndef _GPUPROFILER_
+#define _GPUPROFILER_
+
+#include "Profiler.hpp"
+
+#include <memory>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold the GPU time of a render pass.
+	* @param name The name of the pass.
+	* @param last_ms The GPU time of the most recently resolved frame.
+	* @param average_ms Moving average of the GPU time.
+	*/
+	struct GpuPassTime
+	{
+		const char* name = nullptr;
+		float last_ms = 0.0f;
+		float average_ms = 0.0f;
+	};
+
+	/// @brief GPU profiler class
+	class GpuProfiler
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		GpuProfiler(const GpuProfiler& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		GpuProfiler& operator=(const GpuProfiler& other) = delete;
+		/// @brief Deleted move constructor.
+		GpuProfiler(const GpuProfiler&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		GpuProfiler& operator=(const GpuProfiler&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		GpuProfiler();
+		/// @brief Destructor
+		~GpuProfiler();
+
+		//Member methods
+
+		/**
+		* @brief Get the application wide GPU profiler.
+		* @return Reference to the GPU profiler.
+		*/
+		static GpuProfiler& Get();
+
+		/**
+		* @brief
+		* Create the query objects. Must be called once the OpenGL context is
+		* current and loaded.
+		*/
+		void Init();
+
+		/// @brief Delete the query objects. Must be called before the context is destroyed.
+		void Shutdown();
+
+		/**
+		* @brief Get whether timer queries are available.
+		* @return True if passes are timed, false otherwise.
+		*/
+		bool IsAvailable() const;
+
+		/**
+		* @brief Start timing a render pass.
+		* @param name The name of the pass. Must have static storage duration.
+		* @return True if the pass was started, false if it was ignored.
+		*/
+		bool BeginPass(const char* name);
+
+		/// @brief Stop timing the current render pass.
+		void EndPass();
+
+		/**
+		* @brief
+		* End the current frame. Reads back the results of earlier frames that are
+		* available and recycles the oldest frame's queries.
+		*/
+		void EndFrame();
+
+		/**
+		* @brief Get the GPU times of every timed pass.
+		* @return Vector of pass times ordered by first use.
+		*/
+		const std::vector<GpuPassTime>& GetPassTimes() const;
+
+		/**
+		* @brief Get the GPU time of a pass by name.
+		* @param name The name of the pass.
+		* @return Pointer to the pass time, nullptr if the pass isn't timed.
+		*/
+		const GpuPassTime* FindPass(const char* name) const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of GpuProfilerImpl struct.
+		struct GpuProfilerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<GpuProfilerImpl> _impl;
+	};
+
+	/// @brief Scoped GPU timer class. Times the render commands of a scope.
+	class ScopedGpuTimer
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		ScopedGpuTimer() = delete;
+		/// @brief Deleted copy constructor.
+		ScopedGpuTimer(const ScopedGpuTimer& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ScopedGpuTimer& operator=(const ScopedGpuTimer& other) = delete;
+		/// @brief Deleted move constructor.
+		ScopedGpuTimer(const ScopedGpuTimer&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ScopedGpuTimer& operator=(const ScopedGpuTimer&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the ScopedGpuTimer class.
+		* @param name The name of the pass. Must have static storage duration.
+		*/
+		explicit ScopedGpuTimer(const char* name);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Ends the pass if it was started.
+		~ScopedGpuTimer();
+
+		//Member variables
+	private:
+		/// @brief Flag set when the pass was started.
+		bool active;
+	};
+}
+
+//Instrumentation macros
+
+#ifndef PHYSICSSIM_NO_PROFILING
+/// @brief Time the enclosing scope on both the CPU and the GPU.
+#define PROFILE_GPU_SCOPE(name) \
+	PROFILE_SCOPE(name); \
+	::Profiling::ScopedGpuTimer PROFILE_CONCAT(_profile_gpu_scope_, __LINE__)(name)
+/// @brief Mark the end of a GPU frame.
+#define PROFILE_GPU_END_FRAME() ::Profiling::GpuProfiler::Get().EndFrame()
+#else
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_GPU_END_FRAME()
+#endif
+
+#endif
\ No newline at end of file
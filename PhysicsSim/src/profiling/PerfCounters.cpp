@@ -0,0 +1,400 @@
+/**
+* @file PerfCounters.cpp
+* @brief
+* Function definitions for the hardware performance counter layer. Uses the
+* PIMPL idiom to hide implementation details.
+*/
+
+#include "PerfCounters.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_SUPPORTED
+#endif
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	/// @brief Registry of the reports of every instrumented scope.
+	struct CounterRegistry
+	{
+		/// @brief Mutex guarding the reports.
+		std::mutex mutex;
+		/// @brief Reports ordered by first use.
+		std::vector<CounterReport> reports;
+		/// @brief Flag to read the counters around instrumented scopes.
+		std::atomic<bool> enabled = false;
+	};
+
+	/**
+	* @details
+	* Get the process wide counter registry.
+	*/
+	static CounterRegistry& GetCounterRegistry()
+	{
+		static CounterRegistry registry;
+		return registry;
+	}
+
+	/**
+	* @details
+	* Get the calling thread's counter group, opened on first use.
+	*/
+	static const PerfCounters& GetThreadCounters()
+	{
+		thread_local PerfCounters counters;
+		return counters;
+	}
+
+	/// @brief PerfCounters PIMPL implementation structure.
+	struct PerfCounters::PerfCountersImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		PerfCountersImpl(const PerfCountersImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		PerfCountersImpl& operator=(const PerfCountersImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		PerfCountersImpl(const PerfCountersImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		PerfCountersImpl& operator=(const PerfCountersImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor.
+		PerfCountersImpl();
+		/// @brief Destructor.
+		~PerfCountersImpl();
+
+		//Member methods
+
+		/**
+		* @brief Open a single counter.
+		* @param type The perf event type.
+		* @param config The perf event configuration.
+		* @return The file descriptor of the counter, -1 on failure.
+		*/
+		int Open(uint32_t type, uint64_t config);
+
+		//Member variables
+
+		/// @brief Number of counters in the group.
+		static constexpr int NUM_COUNTERS = 5;
+
+		/// @brief File descriptor of the group leader (cycles).
+		int leader = -1;
+		/// @brief File descriptors of every counter, -1 if it failed to open.
+		int fds[NUM_COUNTERS] = { -1, -1, -1, -1, -1 };
+		/// @brief Position of each counter in the group read, -1 if missing.
+		int slots[NUM_COUNTERS] = { -1, -1, -1, -1, -1 };
+		/// @brief Number of counters that were opened.
+		int opened = 0;
+	};
+
+	/**
+	* @details
+	* Constructor for the PerfCountersImpl class. Opens the counters as one group
+	* led by the cycle counter so they are scheduled together and read with a
+	* single read call. Counters that the processor or a virtual machine doesn't
+	* expose are skipped. Only user space is counted, which works with the
+	* default perf_event_paranoid setting of most distributions.
+	*/
+	PerfCounters::PerfCountersImpl::PerfCountersImpl()
+	{
+#ifdef PERF_COUNTERS_SUPPORTED
+		const uint64_t l1_read_miss =
+			PERF_COUNT_HW_CACHE_L1D |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+		const struct
+		{
+			uint32_t type;
+			uint64_t config;
+		} events[NUM_COUNTERS] = {
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, l1_read_miss },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES } };
+
+		for (int i = 0; i < NUM_COUNTERS; i++)
+		{
+			fds[i] = Open(events[i].type, events[i].config);
+			if (i == 0) leader = fds[0];
+			if (leader < 0) return;
+			if (fds[i] >= 0) slots[i] = opened++;
+		}
+
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	/**
+	* @details
+	* Destructor for the PerfCountersImpl class. Closes every open counter.
+	*/
+	PerfCounters::PerfCountersImpl::~PerfCountersImpl()
+	{
+#ifdef PERF_COUNTERS_SUPPORTED
+		for (int fd : fds)
+			if (fd >= 0) close(fd);
+#endif
+	}
+
+	/**
+	* @details
+	* Open a counter for the calling thread on any CPU. The leader starts
+	* disabled and is enabled once the whole group is open.
+	*/
+	int PerfCounters::PerfCountersImpl::Open(uint32_t type, uint64_t config)
+	{
+#ifdef PERF_COUNTERS_SUPPORTED
+		perf_event_attr attr{};
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = leader < 0 ? 1 : 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		return int(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+#else
+		return -1;
+#endif
+	}
+
+	/**
+	* @details
+	* Constructor for the PerfCounters class. Initializes the PIMPL pointer.
+	*/
+	PerfCounters::PerfCounters() :
+		_impl(std::make_unique<PerfCountersImpl>())
+	{}
+
+	/**
+	* @details
+	* Default destructor for the PerfCounters class.
+	*/
+	PerfCounters::~PerfCounters() = default;
+
+	/**
+	* @details
+	* Get whether the group leader was opened.
+	*/
+	bool PerfCounters::IsOpen() const
+	{
+		return _impl->leader >= 0;
+	}
+
+	/**
+	* @details
+	* Read the whole group at once. Counters that failed to open read as 0.
+	*/
+	bool PerfCounters::Read(CounterSample& sample) const
+	{
+#ifdef PERF_COUNTERS_SUPPORTED
+		if (_impl->leader < 0) return false;
+
+		uint64_t values[1 + PerfCountersImpl::NUM_COUNTERS] = {};
+		if (read(_impl->leader, values, sizeof(values)) <= 0) return false;
+
+		uint64_t* out[PerfCountersImpl::NUM_COUNTERS] = {
+			&sample.cycles,
+			&sample.instructions,
+			&sample.l1_misses,
+			&sample.llc_misses,
+			&sample.branch_misses };
+		for (int i = 0; i < PerfCountersImpl::NUM_COUNTERS; i++)
+		{
+			const int slot = _impl->slots[i];
+			*out[i] = slot >= 0 && uint64_t(slot) < values[0] ? values[1 + slot] : 0;
+		}
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	* @details
+	* Check once whether a counter group can be opened on the calling thread.
+	*/
+	bool CountersAvailable()
+	{
+		static const bool available = PerfCounters().IsOpen();
+		return available;
+	}
+
+	/**
+	* @details
+	* Enable or disable counter collection. Logs a warning if the counters are
+	* not available on this system.
+	*/
+	void SetCountersEnabled(bool enabled)
+	{
+		if (enabled && !CountersAvailable())
+		{
+			spdlog::warn("Hardware performance counters are not available");
+			enabled = false;
+		}
+
+		GetCounterRegistry().enabled = enabled;
+	}
+
+	/**
+	* @details
+	* Get whether counter collection is enabled.
+	*/
+	bool CountersEnabled()
+	{
+		return GetCounterRegistry().enabled;
+	}
+
+	/**
+	* @details
+	* Copy the accumulated reports.
+	*/
+	std::vector<CounterReport> GetCounterReports()
+	{
+		CounterRegistry& registry = GetCounterRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		return registry.reports;
+	}
+
+	/**
+	* @details
+	* Clear the accumulated reports.
+	*/
+	void ResetCounterReports()
+	{
+		CounterRegistry& registry = GetCounterRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.reports.clear();
+	}
+
+	/**
+	* @details
+	* Write the reports as a JSON object with a "scopes" array. Each scope has
+	* the raw totals along with IPC and the per item rates used to judge memory
+	* layout changes.
+	*/
+	bool WriteCounterReport(const std::string& path)
+	{
+		std::vector<CounterReport> reports = GetCounterReports();
+
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			spdlog::error("Failed to open counter report: {}", path);
+			return false;
+		}
+
+		std::fprintf(
+			file,
+			"{\n\"available\": %s,\n\"scopes\": [",
+			CountersAvailable() ? "true" : "false");
+
+		for (size_t i = 0; i < reports.size(); i++)
+		{
+			const CounterReport& r = reports[i];
+			const double items = r.items ? double(r.items) : 1.0;
+			const double ipc = r.counters.cycles ?
+				double(r.counters.instructions) / double(r.counters.cycles) : 0.0;
+
+			std::fprintf(
+				file,
+				"%s\n{\"name\": \"%s\", \"calls\": %llu, \"items\": %llu, "
+				"\"cycles\": %llu, \"instructions\": %llu, \"l1_misses\": %llu, "
+				"\"llc_misses\": %llu, \"branch_misses\": %llu, \"ipc\": %.4f, "
+				"\"cycles_per_item\": %.4f, \"l1_misses_per_item\": %.4f, "
+				"\"llc_misses_per_item\": %.4f, \"branch_misses_per_item\": %.4f}",
+				i == 0 ? "" : ",",
+				r.name,
+				(unsigned long long)r.calls,
+				(unsigned long long)r.items,
+				(unsigned long long)r.counters.cycles,
+				(unsigned long long)r.counters.instructions,
+				(unsigned long long)r.counters.l1_misses,
+				(unsigned long long)r.counters.llc_misses,
+				(unsigned long long)r.counters.branch_misses,
+				ipc,
+				double(r.counters.cycles) / items,
+				double(r.counters.l1_misses) / items,
+				double(r.counters.llc_misses) / items,
+				double(r.counters.branch_misses) / items);
+		}
+
+		std::fputs("\n]\n}\n", file);
+
+		const bool success = std::ferror(file) == 0;
+		std::fclose(file);
+
+		if (success) spdlog::info("Counter report written to {}", path);
+		else spdlog::error("Failed to write counter report: {}", path);
+		return success;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the ScopedCounters class. Reads the start sample if
+	* counter collection is enabled.
+	*/
+	ScopedCounters::ScopedCounters(const char* name, uint64_t items) :
+		name(name),
+		items(items),
+		active(false)
+	{
+		if (CountersEnabled()) active = GetThreadCounters().Read(start);
+	}
+
+	/**
+	* @details
+	* Destructor for the ScopedCounters class. Reads the end sample and adds the
+	* difference to the scope's report.
+	*/
+	ScopedCounters::~ScopedCounters()
+	{
+		if (!active) return;
+
+		CounterSample end;
+		if (!GetThreadCounters().Read(end)) return;
+
+		CounterRegistry& registry = GetCounterRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		CounterReport* report = nullptr;
+		for (CounterReport& r : registry.reports)
+			if (r.name == name) report = &r;
+
+		if (report == nullptr)
+		{
+			registry.reports.push_back(CounterReport());
+			report = &registry.reports.back();
+			report->name = name;
+		}
+
+		report->calls++;
+		report->items += items;
+		report->counters.cycles += end.cycles - start.cycles;
+		report->counters.instructions += end.instructions - start.instructions;
+		report->counters.l1_misses += end.l1_misses - start.l1_misses;
+		report->counters.llc_misses += end.llc_misses - start.llc_misses;
+		report->counters.branch_misses += end.branch_misses - start.branch_misses;
+	}
+}
\ No newline at end of file
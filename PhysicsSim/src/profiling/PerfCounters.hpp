@@ -0,0 +1,205 @@
+/**
+* @file PerfCounters.hpp
+* @brief
+* Function declarations for the optional hardware performance counter layer.
+* Counters are read through perf_event_open on Linux. On other platforms the
+* layer reports itself as unavailable and the scopes record nothing. Defining
+* PHYSICSSIM_NO_PERF_COUNTERS compiles the instrumentation macro out. Uses the
+* PIMPL idiom to hide implementation details.
+*/
+
+#pragma once
+
+#ifndef _PERFCOUNTERS_
+#define _PERFCOUNTERS_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold a set of counter values.
+	* @param cycles Number of core cycles.
+	* @param instructions Number of retired instructions.
+	* @param l1_misses Number of L1 data cache read misses.
+	* @param llc_misses Number of last level cache misses.
+	* @param branch_misses Number of mispredicted branches.
+	*/
+	struct CounterSample
+	{
+		uint64_t cycles = 0;
+		uint64_t instructions = 0;
+		uint64_t l1_misses = 0;
+		uint64_t llc_misses = 0;
+		uint64_t branch_misses = 0;
+	};
+
+	/**
+	* @brief Structure to hold the accumulated counters of an instrumented scope.
+	* @param name The name of the scope.
+	* @param calls Number of times the scope was entered.
+	* @param items Total number of items (particles) processed by the scope.
+	* @param counters Counter totals over all calls.
+	*/
+	struct CounterReport
+	{
+		const char* name = nullptr;
+		uint64_t calls = 0;
+		uint64_t items = 0;
+		CounterSample counters;
+	};
+
+	/**
+	* @brief Get whether hardware counters can be read on this system.
+	* @return True if the counters are available, false otherwise.
+	*/
+	bool CountersAvailable();
+
+	/**
+	* @brief Enable or disable counter collection at runtime.
+	* @param enabled True to read the counters around instrumented scopes.
+	*/
+	void SetCountersEnabled(bool enabled);
+
+	/**
+	* @brief Get whether counter collection is enabled.
+	* @return True if counter collection is enabled, false otherwise.
+	*/
+	bool CountersEnabled();
+
+	/**
+	* @brief Get the accumulated reports of every instrumented scope.
+	* @return Vector of reports ordered by first use.
+	*/
+	std::vector<CounterReport> GetCounterReports();
+
+	/// @brief Clear the accumulated reports.
+	void ResetCounterReports();
+
+	/**
+	* @brief
+	* Write the accumulated reports as JSON with IPC and misses per item for
+	* each scope.
+	* @param path The path of the output file.
+	* @return True if the file was written successfully, false otherwise.
+	*/
+	bool WriteCounterReport(const std::string& path);
+
+	/// @brief Per-thread group of hardware counters.
+	class PerfCounters
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		PerfCounters(const PerfCounters& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		PerfCounters& operator=(const PerfCounters& other) = delete;
+		/// @brief Deleted move constructor.
+		PerfCounters(const PerfCounters&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		PerfCounters& operator=(const PerfCounters&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor. Opens the counters for the calling thread.
+		PerfCounters();
+		/// @brief Destructor. Closes the counters.
+		~PerfCounters();
+
+		//Member methods
+
+		/**
+		* @brief Get whether the counter group was opened.
+		* @return True if the counters can be read, false otherwise.
+		*/
+		bool IsOpen() const;
+
+		/**
+		* @brief Read the current counter values.
+		* @param sample The sample to fill.
+		* @return True if the counters were read, false otherwise.
+		*/
+		bool Read(CounterSample& sample) const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of PerfCountersImpl struct.
+		struct PerfCountersImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<PerfCountersImpl> _impl;
+	};
+
+	/// @brief Scoped counter class. Accumulates the counter deltas of a scope.
+	class ScopedCounters
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		ScopedCounters() = delete;
+		/// @brief Deleted copy constructor.
+		ScopedCounters(const ScopedCounters& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ScopedCounters& operator=(const ScopedCounters& other) = delete;
+		/// @brief Deleted move constructor.
+		ScopedCounters(const ScopedCounters&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ScopedCounters& operator=(const ScopedCounters&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the ScopedCounters class.
+		* @param name The name of the scope. Must have static storage duration.
+		* @param items The number of items processed in the scope.
+		*/
+		ScopedCounters(const char* name, uint64_t items);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Adds the counter deltas to the scope's report.
+		~ScopedCounters();
+
+		//Member variables
+	private:
+		/// @brief The name of the scope.
+		const char* name;
+		/// @brief The number of items processed in the scope.
+		uint64_t items;
+		/// @brief Flag set when the start sample was read.
+		bool active;
+		/// @brief Counter values when the scope was entered.
+		CounterSample start;
+	};
+}
+
+//Instrumentation macros
+
+#ifndef PHYSICSSIM_NO_PERF_COUNTERS
+/// @brief Read the hardware counters around the enclosing scope.
+#define PROFILE_COUNTERS(name, items) \
+	::Profiling::ScopedCounters PROFILE_COUNTERS_CONCAT(_profile_counters_, __LINE__)( \
+		name, \
+		items)
+#define PROFILE_COUNTERS_CONCAT_INNER(a, b) a##b
+#define PROFILE_COUNTERS_CONCAT(a, b) PROFILE_COUNTERS_CONCAT_INNER(a, b)
+#else
+#define PROFILE_COUNTERS(name, items)
+#endif
+
+#endif
\ No newline at end of file
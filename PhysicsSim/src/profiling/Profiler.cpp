@@ -0,0 +1,762 @@
+/**
+* @file Profiler.cpp
+* @brief
+* Function definitions for the hierarchical scope profiler. Uses the PIMPL idiom
+* to hide implementation details.
+*/
+
+#include "Profiler.hpp"
+#include "TraceExport.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_RDTSC
+#endif
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	/**
+	* @brief Structure to hold a single completed scope.
+	* @param name The name of the scope.
+	* @param start The tick count when the scope was entered.
+	* @param end The tick count when the scope was left.
+	* @param depth The nesting depth of the scope on its thread.
+	*/
+	struct ProfileEvent
+	{
+		const char* name = nullptr;
+		uint64_t start = 0;
+		uint64_t end = 0;
+		uint32_t depth = 0;
+	};
+
+	/**
+	* @brief
+	* Single producer, single consumer ring buffer of events for one thread. The
+	* owning thread writes events and publishes them through write_index. The
+	* profiler drains them in EndFrame. If the profiler falls more than CAPACITY
+	* events behind, the oldest events are overwritten and dropped.
+	*/
+	struct ThreadBuffer
+	{
+		/// @brief Number of events held by each thread.
+		static constexpr uint64_t CAPACITY = 1 << 14;
+
+		/// @brief Event storage.
+		std::vector<ProfileEvent> events = std::vector<ProfileEvent>(CAPACITY);
+		/// @brief Number of events written by the owning thread.
+		std::atomic<uint64_t> write_index = 0;
+		/// @brief Number of events consumed by the profiler.
+		uint64_t read_index = 0;
+		/// @brief Current scope depth of the owning thread.
+		uint32_t depth = 0;
+		/// @brief Registration order of the thread.
+		uint32_t thread_index = 0;
+		/// @brief Name of the thread.
+		std::atomic<const char*> name = nullptr;
+		/// @brief Flag set when the owning thread exited, after its last event was published.
+		std::atomic<bool> exited = false;
+	};
+
+	/// @brief Registry of every thread that has recorded an event.
+	struct ThreadRegistry
+	{
+		/// @brief Mutex guarding the buffer list.
+		std::mutex mutex;
+		/// @brief Buffers of the registered threads, kept until drained after their thread exits.
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		/// @brief Registration index of the next thread, never reused.
+		uint32_t next_index = 0;
+	};
+
+	/**
+	* @brief
+	* Thread local owner of a thread's ring buffer, marking it exited when the
+	* thread ends so the profiler can drain and release it.
+	*/
+	struct ThreadBufferOwner
+	{
+		/// @brief The thread's ring buffer, null until the thread records an event.
+		std::shared_ptr<ThreadBuffer> buffer;
+
+		/// @brief Destructor, run on thread exit.
+		~ThreadBufferOwner()
+		{
+			if (buffer) buffer->exited.store(true, std::memory_order_release);
+		}
+	};
+
+	/**
+	* @details
+	* Get the process wide thread registry.
+	*/
+	static ThreadRegistry& GetRegistry()
+	{
+		static ThreadRegistry registry;
+		return registry;
+	}
+
+	/**
+	* @details
+	* Get the calling thread's ring buffer, registering it on first use. The
+	* first thread to register is named "Main". Short lived threads, like the
+	* checkpoint and image writers, register once each, so their buffers are
+	* released by EndFrame after the thread exits.
+	*/
+	static ThreadBuffer& GetThreadBuffer()
+	{
+		thread_local ThreadBufferOwner owner;
+		if (!owner.buffer)
+		{
+			owner.buffer = std::make_shared<ThreadBuffer>();
+
+			ThreadRegistry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			owner.buffer->thread_index = registry.next_index++;
+			if (owner.buffer->thread_index == 0) owner.buffer->name = "Main";
+			registry.buffers.push_back(owner.buffer);
+		}
+
+		return *owner.buffer;
+	}
+
+	/**
+	* @details
+	* Read the time stamp counter where available. The counter is assumed to be
+	* invariant, which holds for every x86 processor of the last decade. Other
+	* platforms fall back to steady_clock in nanoseconds.
+	*/
+	uint64_t ReadTicks()
+	{
+#ifdef PROFILER_HAS_RDTSC
+		return __rdtsc();
+#else
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	/**
+	* @details
+	* Name the calling thread. The name is shown as the root of the thread's
+	* timing tree.
+	*/
+	void SetThreadName(const char* name)
+	{
+		GetThreadBuffer().name = name;
+	}
+
+	/**
+	* @details
+	* Custom constructor for the ScopedTimer class. Increments the thread's scope
+	* depth and records the start tick.
+	*/
+	ScopedTimer::ScopedTimer(const char* name) :
+		name(name),
+		start(0)
+	{
+		GetThreadBuffer().depth++;
+		start = ReadTicks();
+	}
+
+	/**
+	* @details
+	* Destructor for the ScopedTimer class. Writes the completed event into the
+	* thread's ring buffer and publishes it with a release store.
+	*/
+	ScopedTimer::~ScopedTimer()
+	{
+		const uint64_t end = ReadTicks();
+		ThreadBuffer& buffer = GetThreadBuffer();
+		buffer.depth--;
+
+		const uint64_t index = buffer.write_index.load(std::memory_order_relaxed);
+		ProfileEvent& event = buffer.events[index & (ThreadBuffer::CAPACITY - 1)];
+		event.name = name;
+		event.start = start;
+		event.end = end;
+		event.depth = buffer.depth;
+		buffer.write_index.store(index + 1, std::memory_order_release);
+	}
+
+	/// @brief Profiler PIMPL implementation structure.
+	struct Profiler::ProfilerImpl
+	{
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		ProfilerImpl(const ProfilerImpl& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ProfilerImpl& operator=(const ProfilerImpl& other) = delete;
+		/// @brief Deleted move constructor.
+		ProfilerImpl(const ProfilerImpl&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ProfilerImpl& operator=(const ProfilerImpl&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor.
+		ProfilerImpl();
+		/// @brief Destructor.
+		~ProfilerImpl();
+
+		//Member methods
+
+		/// @brief Update the tick to millisecond conversion factor.
+		void Calibrate();
+
+		/**
+		* @brief Copy the unread events of a thread into a scratch vector.
+		* @param buffer The thread's ring buffer.
+		* @param out The vector to append the events to.
+		*/
+		void Drain(ThreadBuffer& buffer, std::vector<ProfileEvent>& out);
+
+		/**
+		* @brief Add one thread's events to the frame tree.
+		* @param name The name of the thread.
+		* @param events The events of the thread.
+		* @param frame_ticks The duration of the frame, used for the main thread.
+		*/
+		void BuildThreadTree(
+			const char* name,
+			std::vector<ProfileEvent>& events,
+			uint64_t frame_ticks);
+
+		/**
+		* @brief Find or create a child node with the given name.
+		* @param parent The parent node index.
+		* @param name The name of the child.
+		* @return The index of the child node.
+		*/
+		int GetChild(int parent, const char* name);
+
+		/// @brief Apply the moving averages to the nodes of the new tree.
+		void UpdateAverages();
+
+		/**
+		* @brief Append a thread's drained events to the capture.
+		* @param thread The registration index of the thread.
+		*/
+		void CaptureEvents(uint32_t thread);
+
+		/// @brief Hand the captured events to a writer thread.
+		void FinishCapture();
+
+		//Member variables
+
+		/// @brief Number of frames kept in the frame time history.
+		static constexpr int HISTORY_SIZE = 240;
+		/// @brief Weight of the newest frame in the moving averages.
+		static constexpr float AVERAGE_WEIGHT = 0.1f;
+
+		/// @brief Timing tree of the last frame.
+		std::vector<ProfileNode> nodes;
+		/// @brief Stable keys of the nodes, used to match them across frames.
+		std::vector<uint64_t> keys;
+		/// @brief Moving averages indexed by node key.
+		std::unordered_map<uint64_t, float> averages;
+		/// @brief Last root node added, used to link the roots.
+		int last_root = -1;
+		/// @brief Scratch vector for drained events.
+		std::vector<ProfileEvent> scratch;
+		/// @brief Ring buffer of frame times in milliseconds.
+		std::vector<float> frame_times;
+		/// @brief Index of the next frame time to write.
+		int frame_index = 0;
+		/// @brief Duration of the last frame in milliseconds.
+		float last_frame_ms = 0.0f;
+		/// @brief Tick count at the end of the previous frame.
+		uint64_t last_frame_tick = 0;
+		/// @brief Tick count at calibration start.
+		uint64_t calibration_tick = 0;
+		/// @brief steady_clock time at calibration start.
+		std::chrono::steady_clock::time_point calibration_time;
+		/// @brief Milliseconds per tick.
+		double ms_per_tick = 1.0e-6;
+		/// @brief Flag to freeze the tree and history.
+		bool paused = false;
+
+		//Capture variables
+
+		/// @brief Upper limit of captured events to bound the capture's memory.
+		static constexpr size_t MAX_CAPTURE_EVENTS = 1 << 22;
+
+		/// @brief Number of frames requested for the current capture.
+		int capture_frames = 0;
+		/// @brief Number of frames captured so far.
+		int captured_frames = 0;
+		/// @brief Path of the trace file for the current capture.
+		std::string capture_path;
+		/// @brief Events of the current capture.
+		std::vector<TraceEvent> capture_events;
+		/// @brief Names of the threads seen during the current capture, by registration index.
+		std::unordered_map<uint32_t, const char*> capture_threads;
+		/// @brief Tick count at the start of the capture.
+		uint64_t capture_origin = 0;
+		/// @brief Thread writing the previous capture to disk.
+		std::thread capture_writer;
+	};
+
+	/**
+	* @details
+	* Constructor for the ProfilerImpl class. Constructs the thread registry and
+	* the default logger first so they outlive the profiler and its trace writer
+	* during static destruction. Busy waits for a millisecond to get an initial
+	* tick rate estimate. The estimate is refined every frame.
+	*/
+	Profiler::ProfilerImpl::ProfilerImpl() :
+		frame_times(HISTORY_SIZE, 0.0f)
+	{
+		GetRegistry();
+		spdlog::default_logger();
+
+		calibration_time = std::chrono::steady_clock::now();
+		calibration_tick = ReadTicks();
+
+		while (std::chrono::steady_clock::now() - calibration_time <
+			std::chrono::milliseconds(1)) {}
+
+		Calibrate();
+		last_frame_tick = ReadTicks();
+	}
+
+	/**
+	* @details
+	* Destructor for the ProfilerImpl class. Waits for a pending trace file to
+	* finish writing.
+	*/
+	Profiler::ProfilerImpl::~ProfilerImpl()
+	{
+		if (capture_writer.joinable()) capture_writer.join();
+	}
+
+	/**
+	* @details
+	* Compare the ticks elapsed since construction with steady_clock. The longer
+	* the application runs the more accurate the factor becomes.
+	*/
+	void Profiler::ProfilerImpl::Calibrate()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const uint64_t ticks = ReadTicks() - calibration_tick;
+		const double ms = std::chrono::duration<double, std::milli>(
+			now - calibration_time).count();
+
+		if (ticks > 0) ms_per_tick = ms / double(ticks);
+	}
+
+	/**
+	* @details
+	* Copy the unread events of the given buffer. Events that may have been
+	* overwritten by the owning thread while copying are discarded.
+	*/
+	void Profiler::ProfilerImpl::Drain(
+		ThreadBuffer& buffer,
+		std::vector<ProfileEvent>& out)
+	{
+		const uint64_t write = buffer.write_index.load(std::memory_order_acquire);
+		uint64_t read = buffer.read_index;
+		if (write - read > ThreadBuffer::CAPACITY)
+			read = write - ThreadBuffer::CAPACITY;
+
+		const size_t first = out.size();
+		for (uint64_t i = read; i < write; i++)
+			out.push_back(buffer.events[i & (ThreadBuffer::CAPACITY - 1)]);
+
+		//Drop anything the writer may have lapped during the copy
+		const uint64_t after = buffer.write_index.load(std::memory_order_acquire);
+		if (after - read > ThreadBuffer::CAPACITY)
+		{
+			const uint64_t lost = after - read - ThreadBuffer::CAPACITY;
+			const size_t drop = size_t(std::min<uint64_t>(lost, write - read));
+			out.erase(out.begin() + first, out.begin() + first + drop);
+		}
+
+		buffer.read_index = write;
+	}
+
+	/**
+	* @details
+	* Find the child of the parent with the given name. Names are string
+	* literals so they are compared by pointer. A new node is appended to the
+	* parent's child list if there is no match.
+	*/
+	int Profiler::ProfilerImpl::GetChild(int parent, const char* name)
+	{
+		int child = parent >= 0 ? nodes[parent].first_child : -1;
+		int last = -1;
+		while (child >= 0)
+		{
+			if (nodes[child].name == name) return child;
+			last = child;
+			child = nodes[child].next_sibling;
+		}
+
+		ProfileNode node;
+		node.name = name;
+		node.parent = parent;
+		node.depth = parent >= 0 ? nodes[parent].depth + 1 : 0;
+
+		const int index = int(nodes.size());
+		nodes.push_back(node);
+
+		//Key the node by its path so averages survive the tree being rebuilt
+		const uint64_t parent_key = parent >= 0 ? keys[parent] : 0;
+		keys.push_back(parent_key * 1099511628211ull ^ uint64_t(uintptr_t(name)));
+
+		if (last >= 0) nodes[last].next_sibling = index;
+		else if (parent >= 0) nodes[parent].first_child = index;
+
+		return index;
+	}
+
+	/**
+	* @details
+	* Sort the thread's events by start time and nest them with a stack of open
+	* scopes. Each scope is merged into the node with the same name under the
+	* same parent. The thread itself becomes a root node.
+	*/
+	void Profiler::ProfilerImpl::BuildThreadTree(
+		const char* name,
+		std::vector<ProfileEvent>& events,
+		uint64_t frame_ticks)
+	{
+		if (events.empty()) return;
+
+		std::sort(
+			events.begin(),
+			events.end(),
+			[](const ProfileEvent& a, const ProfileEvent& b)
+			{
+				return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+			});
+
+		//Create the thread root and link it after the previous root
+		ProfileNode root;
+		root.name = name;
+		root.calls = 1;
+		const int root_index = int(nodes.size());
+		nodes.push_back(root);
+		keys.push_back(uint64_t(uintptr_t(name)));
+		if (last_root >= 0) nodes[last_root].next_sibling = root_index;
+		last_root = root_index;
+
+		std::vector<std::pair<int, uint64_t>> stack;
+		uint64_t top_level_ticks = 0;
+		for (const ProfileEvent& event : events)
+		{
+			while (!stack.empty() && stack.back().second <= event.start)
+				stack.pop_back();
+
+			const int parent = stack.empty() ? root_index : stack.back().first;
+			const int node = GetChild(parent, event.name);
+			const uint64_t ticks = event.end - event.start;
+			nodes[node].calls++;
+			nodes[node].total_ms += float(ticks * ms_per_tick);
+
+			if (stack.empty()) top_level_ticks += ticks;
+			stack.emplace_back(node, event.end);
+		}
+
+		nodes[root_index].total_ms =
+			float((frame_ticks ? frame_ticks : top_level_ticks) * ms_per_tick);
+	}
+
+	/**
+	* @details
+	* Blend each node's frame time into its moving average. Nodes that were not
+	* present last frame start at their current value.
+	*/
+	void Profiler::ProfilerImpl::UpdateAverages()
+	{
+		std::unordered_map<uint64_t, float> next;
+		next.reserve(nodes.size());
+
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			auto it = averages.find(keys[i]);
+			const float previous =
+				it != averages.end() ? it->second : nodes[i].total_ms;
+			nodes[i].average_ms =
+				previous + AVERAGE_WEIGHT * (nodes[i].total_ms - previous);
+			next[keys[i]] = nodes[i].average_ms;
+		}
+
+		averages = std::move(next);
+	}
+
+	/**
+	* @details
+	* Append the events in the scratch vector to the capture. Once the capture
+	* is full the remaining events are dropped.
+	*/
+	void Profiler::ProfilerImpl::CaptureEvents(uint32_t thread)
+	{
+		for (const ProfileEvent& event : scratch)
+		{
+			if (capture_events.size() >= MAX_CAPTURE_EVENTS) return;
+			capture_events.push_back({ event.name, event.start, event.end, thread });
+		}
+	}
+
+	/**
+	* @details
+	* Collect the names of the threads seen during the capture, which may have
+	* exited since, and move the captured events to a writer thread so the file
+	* is written without stalling the frame. A previous writer is joined first.
+	*/
+	void Profiler::ProfilerImpl::FinishCapture()
+	{
+		std::vector<TraceThread> threads;
+		for (const auto& [index, name] : capture_threads)
+			threads.push_back({ index, name ? name : "Worker" });
+		std::sort(
+			threads.begin(),
+			threads.end(),
+			[](const TraceThread& a, const TraceThread& b) { return a.thread < b.thread; });
+
+		if (capture_writer.joinable()) capture_writer.join();
+
+		spdlog::info(
+			"Writing {} profiler events over {} frames to {}",
+			capture_events.size(),
+			captured_frames,
+			capture_path);
+
+		capture_writer = std::thread(
+			[events = std::move(capture_events),
+			threads = std::move(threads),
+			path = capture_path,
+			origin = capture_origin,
+			ms = ms_per_tick]()
+			{
+				PROFILE_THREAD("Trace Writer");
+				if (WriteChromeTrace(path, events, threads, origin, ms))
+					spdlog::info("Trace written to {}", path);
+			});
+
+		capture_events.clear();
+		capture_threads.clear();
+		capture_frames = 0;
+	}
+
+	/**
+	* @details
+	* Constructor for the Profiler class. Initializes the PIMPL pointer.
+	*/
+	Profiler::Profiler() :
+		_impl(std::make_unique<ProfilerImpl>())
+	{}
+
+	/**
+	* @details
+	* Default destructor for the Profiler class.
+	*/
+	Profiler::~Profiler() = default;
+
+	/**
+	* @details
+	* Get the application wide profiler. Constructed on first use.
+	*/
+	Profiler& Profiler::Get()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	/**
+	* @details
+	* End the current frame using the following steps:
+	* 1. Record the frame time since the previous call.
+	* 2. Drain the ring buffer of every registered thread.
+	* 3. Rebuild the timing tree with one root per thread.
+	* 4. Update the moving averages.
+	* 5. Append the events to the capture if one is in progress.
+	* 6. Release the buffers of threads that exited, now that they are drained.
+	* The buffers are drained even while paused so they never overflow.
+	*/
+	void Profiler::EndFrame()
+	{
+		const uint64_t now = ReadTicks();
+		const uint64_t frame_ticks = now - _impl->last_frame_tick;
+		_impl->last_frame_tick = now;
+		_impl->Calibrate();
+
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		{
+			ThreadRegistry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			buffers = registry.buffers;
+		}
+
+		if (!_impl->paused)
+		{
+			_impl->last_frame_ms = float(frame_ticks * _impl->ms_per_tick);
+			_impl->frame_times[_impl->frame_index] = _impl->last_frame_ms;
+			_impl->frame_index = (_impl->frame_index + 1) % ProfilerImpl::HISTORY_SIZE;
+
+			_impl->nodes.clear();
+			_impl->keys.clear();
+			_impl->last_root = -1;
+		}
+
+		const bool capturing = _impl->capture_frames > 0;
+		if (capturing)
+		{
+			//Record the frame itself on the main thread as the outermost scope
+			_impl->capture_events.push_back(
+				{ "Frame", now - frame_ticks, now, 0 });
+		}
+
+		std::vector<ThreadBuffer*> exited;
+		for (const auto& buffer : buffers)
+		{
+			//Read the flag before draining, so the events it covers are all drained
+			if (buffer->exited.load(std::memory_order_acquire)) exited.push_back(buffer.get());
+
+			_impl->scratch.clear();
+			_impl->Drain(*buffer, _impl->scratch);
+			if (capturing)
+			{
+				_impl->capture_threads[buffer->thread_index] = buffer->name.load();
+				_impl->CaptureEvents(buffer->thread_index);
+			}
+			if (_impl->paused) continue;
+
+			const char* name = buffer->name.load();
+			_impl->BuildThreadTree(
+				name ? name : "Worker",
+				_impl->scratch,
+				buffer->thread_index == 0 ? frame_ticks : 0);
+		}
+
+		if (!_impl->paused) _impl->UpdateAverages();
+
+		if (capturing && ++_impl->captured_frames >= _impl->capture_frames)
+			_impl->FinishCapture();
+
+		if (!exited.empty())
+		{
+			ThreadRegistry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			std::erase_if(
+				registry.buffers,
+				[&exited](const std::shared_ptr<ThreadBuffer>& buffer)
+				{
+					return std::find(exited.begin(), exited.end(), buffer.get()) != exited.end();
+				});
+		}
+	}
+
+	/**
+	* @details
+	* Pause or resume the collection of new frames.
+	*/
+	void Profiler::SetPaused(bool paused)
+	{
+		_impl->paused = paused;
+	}
+
+	/**
+	* @details
+	* Get whether the profiler is paused.
+	*/
+	bool Profiler::IsPaused() const
+	{
+		return _impl->paused;
+	}
+
+	/**
+	* @details
+	* Get the timing tree of the last frame.
+	*/
+	const std::vector<ProfileNode>& Profiler::GetFrameTree() const
+	{
+		return _impl->nodes;
+	}
+
+	/**
+	* @details
+	* Copy the frame time ring buffer into a vector ordered oldest first.
+	*/
+	std::vector<float> Profiler::GetFrameTimes() const
+	{
+		std::vector<float> out;
+		out.reserve(ProfilerImpl::HISTORY_SIZE);
+		for (int i = 0; i < ProfilerImpl::HISTORY_SIZE; i++)
+			out.push_back(_impl->frame_times[
+				(_impl->frame_index + i) % ProfilerImpl::HISTORY_SIZE]);
+
+		return out;
+	}
+
+	/**
+	* @details
+	* Get the duration of the last frame.
+	*/
+	float Profiler::GetLastFrameTime() const
+	{
+		return _impl->last_frame_ms;
+	}
+
+	/**
+	* @details
+	* Start capturing the given number of frames. A capture already in progress
+	* is restarted. The capture origin is the end of the current frame.
+	*/
+	void Profiler::StartCapture(int frames, const std::string& path)
+	{
+		if (frames <= 0) return;
+
+		spdlog::info("Capturing {} profiler frames", frames);
+
+		_impl->capture_events.clear();
+		_impl->capture_frames = frames;
+		_impl->captured_frames = 0;
+		_impl->capture_path = path;
+		_impl->capture_origin = _impl->last_frame_tick;
+	}
+
+	/**
+	* @details
+	* Get whether a capture is in progress.
+	*/
+	bool Profiler::IsCapturing() const
+	{
+		return _impl->capture_frames > 0;
+	}
+
+	/**
+	* @details
+	* Get the number of frames captured so far.
+	*/
+	int Profiler::GetCapturedFrames() const
+	{
+		return _impl->captured_frames;
+	}
+
+	/**
+	* @details
+	* Convert ticks into milliseconds with the current calibration.
+	*/
+	double Profiler::TicksToMilliseconds(uint64_t ticks) const
+	{
+		return double(ticks) * _impl->ms_per_tick;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+* @file Profiler.hpp
+* @brief
+* Function declarations for the hierarchical scope profiler. Scope timers write
+* into per-thread ring buffers that are drained once per frame into a timing
+* tree and a frame time history. Defining PHYSICSSIM_NO_PROFILING compiles all
+* of the instrumentation macros out. Uses the PIMPL idiom to hide
+* implementation details.
+*/
+
+#pragma once
+
+#ifndef _PROFILER_
+#define _PROFILER_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold a single node of the frame timing tree.
+	* @param name The name of the instrumented scope.
+	* @param depth The depth of the node in the tree, roots are at depth 0.
+	* @param parent Index of the parent node, -1 for roots.
+	* @param first_child Index of the first child node, -1 if there is none.
+	* @param next_sibling Index of the next sibling node, -1 if there is none.
+	* @param calls Number of times the scope was entered during the frame.
+	* @param total_ms Total time spent in the scope during the frame.
+	* @param average_ms Exponential moving average of total_ms across frames.
+	*/
+	struct ProfileNode
+	{
+		const char* name = nullptr;
+		int depth = 0;
+		int parent = -1;
+		int first_child = -1;
+		int next_sibling = -1;
+		int calls = 0;
+		float total_ms = 0.0f;
+		float average_ms = 0.0f;
+	};
+
+	/**
+	* @brief Read the profiler clock. Uses rdtsc on x86 and steady_clock otherwise.
+	* @return The current tick count.
+	*/
+	uint64_t ReadTicks();
+
+	/**
+	* @brief Name the calling thread in the profiler output.
+	* @param name The name of the thread. Must have static storage duration.
+	*/
+	void SetThreadName(const char* name);
+
+	/// @brief Scoped timer class. Records a single event when it is destroyed.
+	class ScopedTimer
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted default constructor.
+		ScopedTimer() = delete;
+		/// @brief Deleted copy constructor.
+		ScopedTimer(const ScopedTimer& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		ScopedTimer& operator=(const ScopedTimer& other) = delete;
+		/// @brief Deleted move constructor.
+		ScopedTimer(const ScopedTimer&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		ScopedTimer& operator=(const ScopedTimer&& other) = delete;
+
+		//Custom constructors
+
+		/**
+		* @brief Custom constructor for the ScopedTimer class.
+		* @param name The name of the scope. Must have static storage duration.
+		*/
+		explicit ScopedTimer(const char* name);
+
+		//Default constructors/destructor
+
+		/// @brief Destructor. Writes the event to the thread's ring buffer.
+		~ScopedTimer();
+
+		//Member variables
+	private:
+		/// @brief The name of the scope.
+		const char* name;
+		/// @brief The tick count when the scope was entered.
+		uint64_t start;
+	};
+
+	/// @brief Profiler class
+	class Profiler
+	{
+	public:
+		//Deleted constructors
+
+		/// @brief Deleted copy constructor.
+		Profiler(const Profiler& other) = delete;
+		/// @brief Deleted copy assignment operator.
+		Profiler& operator=(const Profiler& other) = delete;
+		/// @brief Deleted move constructor.
+		Profiler(const Profiler&& other) = delete;
+		/// @brief Deleted move assignment operator.
+		Profiler& operator=(const Profiler&& other) = delete;
+
+		//Custom constructors
+
+		//Default constructors/destructor
+
+		/// @brief Constructor
+		Profiler();
+		/// @brief Destructor
+		~Profiler();
+
+		//Member methods
+
+		/**
+		* @brief Get the application wide profiler.
+		* @return Reference to the profiler.
+		*/
+		static Profiler& Get();
+
+		/**
+		* @brief
+		* End the current frame. Drains every thread's ring buffer, rebuilds the
+		* timing tree and records the frame time.
+		*/
+		void EndFrame();
+
+		/**
+		* @brief Pause or resume the collection of new frames.
+		* @param paused True to freeze the current tree and history.
+		*/
+		void SetPaused(bool paused);
+
+		/**
+		* @brief Get whether the profiler is paused.
+		* @return True if the profiler is paused, false otherwise.
+		*/
+		bool IsPaused() const;
+
+		/**
+		* @brief Get the timing tree of the last frame.
+		* @return Vector of nodes, roots are linked through next_sibling.
+		*/
+		const std::vector<ProfileNode>& GetFrameTree() const;
+
+		/**
+		* @brief Get the frame time history, oldest frame first.
+		* @return Vector of frame times in milliseconds.
+		*/
+		std::vector<float> GetFrameTimes() const;
+
+		/**
+		* @brief Get the duration of the last frame.
+		* @return The duration of the last frame in milliseconds.
+		*/
+		float GetLastFrameTime() const;
+
+		/**
+		* @brief
+		* Capture every thread's events for the given number of frames and write
+		* them to a Chrome trace event JSON file once the capture completes.
+		* @param frames The number of frames to capture.
+		* @param path The path of the trace file.
+		*/
+		void StartCapture(int frames, const std::string& path);
+
+		/**
+		* @brief Get whether a capture is in progress.
+		* @return True if a capture is in progress, false otherwise.
+		*/
+		bool IsCapturing() const;
+
+		/**
+		* @brief Get the progress of the current capture.
+		* @return The number of frames captured so far.
+		*/
+		int GetCapturedFrames() const;
+
+		/**
+		* @brief Convert a tick interval into milliseconds.
+		* @param ticks The tick interval.
+		* @return The interval in milliseconds.
+		*/
+		double TicksToMilliseconds(uint64_t ticks) const;
+
+		//PIMPL idiom
+	private:
+		/// @brief Forward declaration of ProfilerImpl struct.
+		struct ProfilerImpl;
+		/// @brief Class member variable to hold the implementation details.
+		std::unique_ptr<ProfilerImpl> _impl;
+	};
+}
+
+//Instrumentation macros
+
+#ifndef PHYSICSSIM_NO_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+/// @brief Time the enclosing scope under the given string literal.
+#define PROFILE_SCOPE(name) \
+	::Profiling::ScopedTimer PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+/// @brief Time the enclosing function.
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+/// @brief Name the calling thread.
+#define PROFILE_THREAD(name) ::Profiling::SetThreadName(name)
+/// @brief Mark the end of a frame.
+#define PROFILE_END_FRAME() ::Profiling::Profiler::Get().EndFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+#define PROFILE_END_FRAME()
+#endif
+
+#endif
\ No newline at end of file
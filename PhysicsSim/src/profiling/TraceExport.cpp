@@ -0,0 +1,109 @@
+/**
+* @file TraceExport.cpp
+* @brief
+* Function definitions to export captured profiler events as Chrome trace event
+* JSON.
+*/
+
+#include "TraceExport.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <cstdio>
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	/**
+	* @details
+	* Write a JSON string literal with quotes, backslashes, and control
+	* characters escaped.
+	*/
+	static void WriteJsonString(std::FILE* file, const char* text)
+	{
+		std::fputc('"', file);
+		for (const char* c = text ? text : ""; *c; c++)
+		{
+			switch (*c)
+			{
+			case '"': std::fputs("\\\"", file); break;
+			case '\\': std::fputs("\\\\", file); break;
+			default:
+				if (static_cast<unsigned char>(*c) < 0x20)
+					std::fprintf(file, "\\u%04x", *c);
+				else std::fputc(*c, file);
+			}
+		}
+		std::fputc('"', file);
+	}
+
+	/**
+	* @details
+	* Write the events using the following layout:
+	* 1. One thread_name metadata event ("ph": "M") per thread.
+	* 2. One complete event ("ph": "X") per scope with the start and duration in
+	* microseconds relative to the origin tick.
+	* All events share a single process id. The file is buffered by stdio so the
+	* events go out in large sequential writes.
+	*/
+	bool WriteChromeTrace(
+		const std::string& path,
+		const std::vector<TraceEvent>& events,
+		const std::vector<TraceThread>& threads,
+		uint64_t origin_tick,
+		double ms_per_tick)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			spdlog::error("Failed to open trace file: {}", path);
+			return false;
+		}
+
+		std::vector<char> buffer(1 << 20);
+		std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+		const double us_per_tick = ms_per_tick * 1000.0;
+		bool first = true;
+
+		std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+
+		for (const TraceThread& thread : threads)
+		{
+			std::fputs(first ? "" : ",\n", file);
+			first = false;
+			std::fprintf(
+				file,
+				"{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,"
+				"\"args\":{\"name\":",
+				thread.thread);
+			WriteJsonString(file, thread.name);
+			std::fputs("}}", file);
+		}
+
+		for (const TraceEvent& event : events)
+		{
+			const double ts = double(int64_t(event.start - origin_tick)) * us_per_tick;
+			const double dur = double(event.end - event.start) * us_per_tick;
+
+			std::fputs(first ? "" : ",\n", file);
+			first = false;
+			std::fputs("{\"ph\":\"X\",\"name\":", file);
+			WriteJsonString(file, event.name);
+			std::fprintf(
+				file,
+				",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.thread,
+				ts,
+				dur);
+		}
+
+		std::fputs("\n]}\n", file);
+
+		const bool success = std::ferror(file) == 0;
+		std::fclose(file);
+
+		if (!success) spdlog::error("Failed to write trace file: {}", path);
+		return success;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+/**
+* @file TraceExport.hpp
+* @brief
+* Function declarations to export captured profiler events as Chrome trace event
+* JSON. The output can be loaded in chrome://tracing or https://ui.perfetto.dev.
+*/
+
+#pragma once
+
+#ifndef _TRACEEXPORT_
+#define _TRACEEXPORT_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Profiling namespace
+namespace Profiling
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold a single captured scope.
+	* @param name The name of the scope.
+	* @param start The tick count when the scope was entered.
+	* @param end The tick count when the scope was left.
+	* @param thread The registration index of the thread that recorded it.
+	*/
+	struct TraceEvent
+	{
+		const char* name = nullptr;
+		uint64_t start = 0;
+		uint64_t end = 0;
+		uint32_t thread = 0;
+	};
+
+	/**
+	* @brief Structure to hold the name of a captured thread.
+	* @param thread The registration index of the thread.
+	* @param name The name of the thread.
+	*/
+	struct TraceThread
+	{
+		uint32_t thread = 0;
+		const char* name = nullptr;
+	};
+
+	/**
+	* @brief Write captured events to a Chrome trace event JSON file.
+	* @param path The path of the output file.
+	* @param events The captured events.
+	* @param threads The names of the captured threads.
+	* @param origin_tick The tick count mapped to time zero.
+	* @param ms_per_tick The tick to millisecond conversion factor.
+	* @return True if the file was written successfully, false otherwise.
+	*/
+	bool WriteChromeTrace(
+		const std::string& path,
+		const std::vector<TraceEvent>& events,
+		const std::vector<TraceThread>& threads,
+		uint64_t origin_tick,
+		double ms_per_tick);
+}
+
+#endif
\ No newline at end of file
@@ -10,10 +10,14 @@
 
 #include "graphics/Shader.hpp"
 #include "graphics/objects/Object.hpp"
+#include "profiling/PerfCounters.hpp"
+#include "profiling/Profiler.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <random>
 
 /// @brief Simulation namespace
@@ -46,6 +50,7 @@ namespace Simulation
 		* @param temperature The temperature for the simulation.
 		* @param chem_potential The chemical potential for the simulation.
 		* @param radius The radius of the particles in the simulation.
+		* @param seed The seed of the particle setup, 0 to draw one from the system.
 		*/
 		ThermodynamicParticleSimulatorImpl(
 			const int num_particles,
@@ -54,7 +59,14 @@ namespace Simulation
 			const float energy_value,
 			const float temperature,
 			const float chem_potential,
-			const float radius);
+			const float radius,
+			const uint64_t seed);
+
+		/**
+		* @brief Custom constructor to restore the simulation from a snapshot.
+		* @param state The state to restore.
+		*/
+		explicit ThermodynamicParticleSimulatorImpl(const SimulationState& state);
 
 		//Default constructors/destructor
 
@@ -72,6 +84,7 @@ namespace Simulation
 		* @param temperature The temperature for the simulation.
 		* @param chem_potential The chemical potential for the simulation.
 		* @param radius The radius of the particles in the simulation.
+		* @param seed The seed of the particle setup, 0 to draw one from the system.
 		*/
 		void SetupSimulation(
 			const int num_particles,
@@ -80,12 +93,34 @@ namespace Simulation
 			const float energy_value,
 			const float temperature,
 			const float chem_potential,
-			const float radius);
+			const float radius,
+			const uint64_t seed);
+
+		/**
+		* @brief Restore the simulation from a snapshot.
+		* @param state The state to restore.
+		* @return True if the state was restored, false if it is inconsistent.
+		*/
+		bool LoadState(const SimulationState& state);
 
 		//Member variables
 
 		/// @brief Vector of particles in the simulation
 		std::vector<std::shared_ptr<SimulationItems::Particle>> particles;
+		/// @brief The width of the simulation box as a percentage of the window.
+		int box_width_perc = 0;
+		/// @brief The height of the simulation box as a percentage of the window.
+		int box_height_perc = 0;
+		/// @brief The energy value for the simulation.
+		float energy_value = 0.0f;
+		/// @brief The temperature for the simulation.
+		float temperature = 0.0f;
+		/// @brief The chemical potential for the simulation.
+		float chem_potential = 0.0f;
+		/// @brief The radius of the particles in the simulation.
+		float radius = 0.0f;
+		/// @brief Error status of the simulator, set when a snapshot failed to restore.
+		bool error_status = false;
 	};
 
 	/**
@@ -100,23 +135,26 @@ namespace Simulation
 		const float energy_value,
 		const float temperature,
 		const float chem_potential,
-		const float radius)
+		const float radius,
+		const uint64_t seed)
 	{
 		SetupSimulation(
 			num_particles,
 			box_width_perc,
 			box_height_perc,
-			radius,
+			energy_value,
 			temperature,
 			chem_potential,
-			radius);
+			radius,
+			seed);
 	}
 
 	/**
 	* @details
 	* Setup the simulation with the given parameters. This method generates a
 	* number of particles and assigns them to random positions within the box
-	* dimensions.
+	* dimensions. The same seed always produces the same positions, and a seed
+	* drawn from the system is logged so the run can be repeated.
 	*/
 	void ThermodynamicParticleSimulator::ThermodynamicParticleSimulatorImpl::SetupSimulation(
 		const int num_particles,
@@ -125,10 +163,21 @@ namespace Simulation
 		const float energy_value,
 		const float temperature,
 		const float chem_potential,
-		const float radius)
+		const float radius,
+		const uint64_t seed)
 	{
+		PROFILE_SCOPE("Particle Setup");
+		PROFILE_COUNTERS("Particle Setup", num_particles);
+
 		particles.clear();
 
+		this->box_width_perc = box_width_perc;
+		this->box_height_perc = box_height_perc;
+		this->energy_value = energy_value;
+		this->temperature = temperature;
+		this->chem_potential = chem_potential;
+		this->radius = radius;
+
 		/*
 		* Setup the particles using uniform distribution for the X and Y
 		* coordinates. With the given width and height percentages as the limits.
@@ -136,8 +185,15 @@ namespace Simulation
 		*/
 		const float width_perc = float(box_width_perc) / 100.0f * 0.90f;
 		const float height_perc = float(box_height_perc) / 100.0f * 0.90f;
-		std::random_device rd;
-		std::mt19937 gen(rd());
+		uint64_t setup_seed = seed;
+		if (setup_seed == 0)
+		{
+			std::random_device rd;
+			setup_seed = (uint64_t(rd()) << 32) | rd();
+			spdlog::info("Particle setup seed: {}", setup_seed);
+		}
+		std::seed_seq sequence{ uint32_t(setup_seed), uint32_t(setup_seed >> 32) };
+		std::mt19937 gen(sequence);
 		std::uniform_real_distribution<float> xdis(-width_perc, width_perc);
 		std::uniform_real_distribution<float> ydis(-height_perc, height_perc);
 		for (int i = 0; i < num_particles; i++)
@@ -166,6 +222,59 @@ namespace Simulation
 		}
 	}
 
+	/**
+	* @details
+	* Custom constructor for the ThermodynamicParticleSimulatorImpl class. Passes
+	* the state to the LoadState method and sets the error status if it fails.
+	*/
+	ThermodynamicParticleSimulator::ThermodynamicParticleSimulatorImpl::ThermodynamicParticleSimulatorImpl(
+		const SimulationState& state)
+	{
+		error_status = !LoadState(state);
+	}
+
+	/**
+	* @details
+	* Rebuild the particles from the snapshot's arrays. The values are copied
+	* as is, so a restored simulation continues from exactly the same bits.
+	* Nothing is changed if the arrays don't match the particle count.
+	*/
+	bool ThermodynamicParticleSimulator::ThermodynamicParticleSimulatorImpl::LoadState(
+		const SimulationState& state)
+	{
+		const size_t n = size_t(state.num_particles);
+		if (state.num_particles < 0 ||
+			state.positions.size() != 3 * n ||
+			state.colors.size() != 3 * n ||
+			state.scales.size() != 3 * n)
+		{
+			spdlog::error("Simulation state arrays don't match {} particles", state.num_particles);
+			return false;
+		}
+
+		box_width_perc = state.box_width_perc;
+		box_height_perc = state.box_height_perc;
+		energy_value = state.energy_value;
+		temperature = state.temperature;
+		chem_potential = state.chem_potential;
+		radius = state.radius;
+
+		particles.clear();
+		particles.reserve(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			const float* p = &state.positions[3 * i];
+			const float* c = &state.colors[3 * i];
+			const float* s = &state.scales[3 * i];
+			particles.push_back(std::make_shared<SimulationItems::Particle>(
+				p[0], p[1], p[2],
+				c[0], c[1], c[2],
+				s[0], s[1], s[2]));
+		}
+
+		return true;
+	}
+
 	/**
 	* @details
 	* Default constructor for the ThermodynamicParticleSimulatorImpl class.
@@ -178,6 +287,15 @@ namespace Simulation
 	*/
 	ThermodynamicParticleSimulator::~ThermodynamicParticleSimulator() = default;
 
+	/**
+	* @details
+	* Get the error status of the simulator.
+	*/
+	bool ThermodynamicParticleSimulator::GetErrorStatus() const
+	{
+		return _thermodynamic_impl->error_status;
+	}
+
 	/**
 	* @details
 	* Empty the vector of particles
@@ -198,7 +316,8 @@ namespace Simulation
 		const float energy_value,
 		const float temperature,
 		const float chem_potential,
-		const float radius) :
+		const float radius,
+		const uint64_t seed) :
 		_thermodynamic_impl(std::make_unique<ThermodynamicParticleSimulator::ThermodynamicParticleSimulatorImpl>(
 			num_particles,
 			box_width_perc,
@@ -206,7 +325,19 @@ namespace Simulation
 			energy_value,
 			temperature,
 			chem_potential,
-			radius))
+			radius,
+			seed))
+	{}
+
+	/**
+	* @details
+	* Custom constructor for the ThermodynamicParticleSimulator class. Passes the
+	* state to the ThermodynamicParticleSimulatorImpl constructor.
+	*/
+	ThermodynamicParticleSimulator::ThermodynamicParticleSimulator(
+		const SimulationState& state) :
+		_thermodynamic_impl(std::make_unique<ThermodynamicParticleSimulator::ThermodynamicParticleSimulatorImpl>(
+			state))
 	{}
 
 	/**
@@ -215,6 +346,9 @@ namespace Simulation
 	*/
 	std::vector<float> ThermodynamicParticleSimulator::GetParticleInstanceData()
 	{
+		PROFILE_SCOPE("Instance Pack");
+		PROFILE_COUNTERS("Instance Pack", _thermodynamic_impl->particles.size());
+
 		std::vector<float> out;
 
 		for (const auto& particle : _thermodynamic_impl->particles)
@@ -233,6 +367,72 @@ namespace Simulation
 		return out;
 	}
 
+	/**
+	* @details
+	* Copy the position of every particle into the given vector. The vector is
+	* resized but keeps its capacity, so repeated calls don't allocate.
+	*/
+	void ThermodynamicParticleSimulator::GetParticlePositions(
+		std::vector<float>& positions) const
+	{
+		PROFILE_SCOPE("Position Gather");
+
+		positions.resize(3 * _thermodynamic_impl->particles.size());
+
+		size_t i = 0;
+		for (const auto& particle : _thermodynamic_impl->particles)
+		{
+			auto p = particle->GetPosition();
+			positions[i++] = p[0];
+			positions[i++] = p[1];
+			positions[i++] = p[2];
+		}
+	}
+
+	/**
+	* @details
+	* Copy the parameters and the particle arrays into the snapshot. The arrays
+	* are resized in place, so saving into the same snapshot again doesn't
+	* allocate.
+	*/
+	void ThermodynamicParticleSimulator::SaveState(SimulationState& state) const
+	{
+		PROFILE_SCOPE("State Snapshot");
+
+		const ThermodynamicParticleSimulatorImpl& impl = *_thermodynamic_impl;
+		const size_t n = impl.particles.size();
+
+		state.num_particles = int(n);
+		state.box_width_perc = impl.box_width_perc;
+		state.box_height_perc = impl.box_height_perc;
+		state.energy_value = impl.energy_value;
+		state.temperature = impl.temperature;
+		state.chem_potential = impl.chem_potential;
+		state.radius = impl.radius;
+		state.positions.resize(3 * n);
+		state.colors.resize(3 * n);
+		state.scales.resize(3 * n);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			auto p = impl.particles[i]->GetPosition();
+			auto c = impl.particles[i]->GetColor();
+			auto s = impl.particles[i]->GetScale();
+			std::copy(p.begin(), p.end(), state.positions.begin() + 3 * i);
+			std::copy(c.begin(), c.end(), state.colors.begin() + 3 * i);
+			std::copy(s.begin(), s.end(), state.scales.begin() + 3 * i);
+		}
+	}
+
+	/**
+	* @details
+	* Pass the state to the LoadState method in the PIMPL implementation.
+	*/
+	bool ThermodynamicParticleSimulator::LoadState(const SimulationState& state)
+	{
+		return _thermodynamic_impl->LoadState(state);
+	}
+
 	/**
 	* @details
 	* Update the thermodynamics simulation. Passes the parameters to the
@@ -245,7 +445,8 @@ namespace Simulation
 		const float energy_value,
 		const float temperature,
 		const float chem_potential,
-		const float radius)
+		const float radius,
+		const uint64_t seed)
 	{
 		_thermodynamic_impl->SetupSimulation(
 			num_particles,
@@ -254,6 +455,7 @@ namespace Simulation
 			energy_value,
 			temperature,
 			chem_potential,
-			radius);
+			radius,
+			seed);
 	}
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #ifndef _SIMULATION_
 #define _SIMULATION_
 
+#include "SimulationState.hpp"
+
 #include <memory>
 #include <vector>
 
@@ -61,6 +63,7 @@ namespace Simulation
 		* @param temperature The temperature for the simulation.
 		* @param chem_potential The chemical potential for the simulation.
 		* @param radius The radius of the particles in the simulation.
+		* @param seed The seed of the particle setup, 0 to draw one from the system.
 		*/
 		ThermodynamicParticleSimulator(
 			const int num_particles,
@@ -69,7 +72,16 @@ namespace Simulation
 			const float energy_value,
 			const float temperature,
 			const float chem_potential,
-			const float radius);
+			const float radius,
+			const uint64_t seed = 0);
+
+		/**
+		* @brief
+		* Custom constructor to restore the simulation from a snapshot. Check
+		* GetErrorStatus, an inconsistent snapshot leaves the simulator empty.
+		* @param state The state to restore.
+		*/
+		explicit ThermodynamicParticleSimulator(const SimulationState& state);
 
 		//Default constructors/destructor
 
@@ -81,6 +93,12 @@ namespace Simulation
 
 		//Member methods
 
+		/**
+		* @brief Get the error status of the simulator.
+		* @return True if restoring it from a snapshot failed, false otherwise.
+		*/
+		bool GetErrorStatus() const;
+
 		/// @brief Clear particle data.
 		void ClearParticles();
 
@@ -90,6 +108,27 @@ namespace Simulation
 		*/
 		std::vector<float> GetParticleInstanceData();
 
+		/**
+		* @brief Copy the particle positions.
+		* @param positions Set to three floats (x, y, z) per particle.
+		*/
+		void GetParticlePositions(std::vector<float>& positions) const;
+
+		/**
+		* @brief
+		* Copy the full simulation state into a snapshot. The step count is owned
+		* by the caller and left untouched.
+		* @param state The snapshot to fill. Its buffers are reused.
+		*/
+		void SaveState(SimulationState& state) const;
+
+		/**
+		* @brief Restore the simulation from a snapshot.
+		* @param state The state to restore.
+		* @return True if the state was restored, false if it is inconsistent.
+		*/
+		bool LoadState(const SimulationState& state);
+
 		/**
 		* @brief Update the thermodynamic simulation.
 		* @param num_particles The number of particles to simulate.
@@ -99,6 +138,7 @@ namespace Simulation
 		* @param temperature The temperature for the simulation.
 		* @param chem_potential The chemical potential for the simulation.
 		* @param radius The radius of the particles in the simulation.
+		* @param seed The seed of the particle setup, 0 to draw one from the system.
 		*/
 		void UpdateThermodynamicSimulation(
 			const int num_particles,
@@ -107,7 +147,8 @@ namespace Simulation
 			const float energy_value,
 			const float temperature,
 			const float chem_potential,
-			const float radius);
+			const float radius,
+			const uint64_t seed = 0);
 
 		//PIMPL idiom
 	private:
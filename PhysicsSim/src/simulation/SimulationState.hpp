@@ -0,0 +1,57 @@
+/**
+* @file SimulationState.hpp
+* @brief
+* Declaration of the plain data snapshot of a simulation. Used to checkpoint
+* and restore a simulator without exposing its implementation.
+*/
+
+#pragma once
+
+#ifndef _SIMULATIONSTATE_
+#define _SIMULATIONSTATE_
+
+#include <cstdint>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Simulation namespace
+namespace Simulation
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold the full state of a thermodynamic simulation.
+	* @param step The number of steps the simulation has run.
+	* @param num_particles The number of particles.
+	* @param box_width_perc The width of the simulation box as a percentage of the window.
+	* @param box_height_perc The height of the simulation box as a percentage of the window.
+	* @param energy_value The energy value for the simulation.
+	* @param temperature The temperature for the simulation.
+	* @param chem_potential The chemical potential for the simulation.
+	* @param radius The radius of the particles.
+	* @param positions Three floats (x, y, z) per particle.
+	* @param colors Three floats (red, green, blue) per particle.
+	* @param scales Three floats (x, y, z) per particle.
+	*/
+	struct SimulationState
+	{
+		uint64_t step = 0;
+		int num_particles = 0;
+		int box_width_perc = 0;
+		int box_height_perc = 0;
+		float energy_value = 0.0f;
+		float temperature = 0.0f;
+		float chem_potential = 0.0f;
+		float radius = 0.0f;
+		std::vector<float> positions;
+		std::vector<float> colors;
+		std::vector<float> scales;
+	};
+}
+
+#endif
\ No newline at end of file
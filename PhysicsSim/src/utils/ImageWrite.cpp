@@ -0,0 +1,47 @@
+/**
+* @file ImageWrite.cpp
+* @brief
+* Function definitions for writing images to disk.
+*/
+
+#include "ImageWrite.hpp"
+
+#include "spdlog/spdlog.h"
+
+//stb_image_write ships with GLFW's dependencies, keep its symbols private
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#include <cstddef>
+
+/// @brief Utils namespace
+namespace Utils
+{
+	/**
+	* @details
+	* Write the image with stb_image_write. A bottom up image is passed from its
+	* last row with a negative stride, which flips it without a copy.
+	*/
+	bool WritePng(
+		const std::string& path,
+		int width,
+		int height,
+		const unsigned char* pixels,
+		bool bottom_up)
+	{
+		int stride = width * 4;
+		if (bottom_up)
+		{
+			pixels += size_t(height - 1) * size_t(stride);
+			stride = -stride;
+		}
+
+		if (stbi_write_png(path.c_str(), width, height, 4, pixels, stride) == 0)
+		{
+			spdlog::error("Failed to write image: {}", path);
+			return false;
+		}
+		return true;
+	}
+}
\ No newline at end of file
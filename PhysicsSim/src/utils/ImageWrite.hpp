@@ -0,0 +1,43 @@
+/**
+* @file ImageWrite.hpp
+* @brief
+* Declarations for writing images to disk. Wraps stb_image_write, which ships
+* with GLFW's dependencies, so its implementation is compiled once.
+*/
+
+#pragma once
+
+#ifndef _IMAGEWRITE_
+#define _IMAGEWRITE_
+
+#include <string>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Utils namespace
+namespace Utils
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Write an RGBA image with eight bits per channel as a PNG file.
+	* @param path The path of the file.
+	* @param width The width of the image.
+	* @param height The height of the image.
+	* @param pixels The pixels, four bytes each, with rows packed together.
+	* @param bottom_up True if the first row is the bottom of the image, as OpenGL reads it.
+	* @return True if the file was written, false otherwise.
+	*/
+	bool WritePng(
+		const std::string& path,
+		int width,
+		int height,
+		const unsigned char* pixels,
+		bool bottom_up = false);
+}
+
+#endif
\ No newline at end of file
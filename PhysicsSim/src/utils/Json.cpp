@@ -0,0 +1,386 @@
+/**
+* @file Json.cpp
+* @brief
+* Function definitions for the JSON reader.
+*/
+
+#include "Json.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+/// @brief Utils namespace
+namespace Utils
+{
+	/**
+	* @brief Structure to hold the state of a parse.
+	* @param text The document being parsed.
+	* @param position The index of the next character.
+	* @param error Description of the first error.
+	*/
+	struct JsonParser
+	{
+		/**
+		* @brief Start a parse at the beginning of a document.
+		* @param text The document to parse, which must outlive the parser.
+		*/
+		explicit JsonParser(const std::string& text) :
+			text(text)
+		{}
+
+		const std::string& text;
+		size_t position = 0;
+		std::string error;
+	};
+
+	/// @brief Nesting depth at which a document is rejected.
+	static constexpr int MAX_JSON_DEPTH = 64;
+
+	static bool ParseValue(JsonParser& parser, JsonValue& value, int depth);
+
+	/**
+	* @details
+	* Record an error with the line and column of the current position. Only the
+	* first error is kept.
+	*/
+	static bool Fail(JsonParser& parser, const char* message)
+	{
+		if (!parser.error.empty()) return false;
+
+		size_t line = 1;
+		size_t column = 1;
+		for (size_t i = 0; i < parser.position && i < parser.text.size(); i++)
+		{
+			if (parser.text[i] == '\n')
+			{
+				line++;
+				column = 1;
+			}
+			else column++;
+		}
+
+		parser.error = std::string(message) +
+			" at line " + std::to_string(line) +
+			", column " + std::to_string(column);
+		return false;
+	}
+
+	/**
+	* @details
+	* Skip whitespace. Comments aren't valid JSON, but a line starting with //
+	* is skipped too so configuration files can be annotated.
+	*/
+	static void SkipWhitespace(JsonParser& parser)
+	{
+		const std::string& text = parser.text;
+		while (parser.position < text.size())
+		{
+			const char c = text[parser.position];
+			if (c == ' ' || c == '\t' || c == '\n' || c == '\r') parser.position++;
+			else if (c == '/' && parser.position + 1 < text.size() && text[parser.position + 1] == '/')
+			{
+				while (parser.position < text.size() && text[parser.position] != '\n') parser.position++;
+			}
+			else break;
+		}
+	}
+
+	/**
+	* @details
+	* Consume the literal if the text continues with it.
+	*/
+	static bool Consume(JsonParser& parser, const char* literal)
+	{
+		const size_t length = std::strlen(literal);
+		if (parser.text.compare(parser.position, length, literal) != 0) return false;
+		parser.position += length;
+		return true;
+	}
+
+	/**
+	* @details
+	* Append a code point to the string as UTF-8.
+	*/
+	static void AppendUtf8(std::string& out, uint32_t code_point)
+	{
+		if (code_point < 0x80) out += char(code_point);
+		else if (code_point < 0x800)
+		{
+			out += char(0xC0 | (code_point >> 6));
+			out += char(0x80 | (code_point & 0x3F));
+		}
+		else if (code_point < 0x10000)
+		{
+			out += char(0xE0 | (code_point >> 12));
+			out += char(0x80 | ((code_point >> 6) & 0x3F));
+			out += char(0x80 | (code_point & 0x3F));
+		}
+		else
+		{
+			out += char(0xF0 | (code_point >> 18));
+			out += char(0x80 | ((code_point >> 12) & 0x3F));
+			out += char(0x80 | ((code_point >> 6) & 0x3F));
+			out += char(0x80 | (code_point & 0x3F));
+		}
+	}
+
+	/**
+	* @details
+	* Read the four hex digits of a \u escape.
+	*/
+	static bool ParseHex4(JsonParser& parser, uint32_t& value)
+	{
+		if (parser.position + 4 > parser.text.size()) return Fail(parser, "Truncated unicode escape");
+
+		value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			const char c = parser.text[parser.position++];
+			value <<= 4;
+			if (c >= '0' && c <= '9') value |= uint32_t(c - '0');
+			else if (c >= 'a' && c <= 'f') value |= uint32_t(c - 'a' + 10);
+			else if (c >= 'A' && c <= 'F') value |= uint32_t(c - 'A' + 10);
+			else return Fail(parser, "Invalid unicode escape");
+		}
+		return true;
+	}
+
+	/**
+	* @details
+	* Parse a string after its opening quote, decoding escapes. Surrogate pairs
+	* are combined into one code point.
+	*/
+	static bool ParseString(JsonParser& parser, std::string& out)
+	{
+		const std::string& text = parser.text;
+		out.clear();
+
+		while (parser.position < text.size())
+		{
+			const char c = text[parser.position++];
+			if (c == '"') return true;
+			if (uint8_t(c) < 0x20) return Fail(parser, "Control character in string");
+			if (c != '\\')
+			{
+				out += c;
+				continue;
+			}
+
+			if (parser.position >= text.size()) break;
+			const char escape = text[parser.position++];
+			switch (escape)
+			{
+			case '"': out += '"'; break;
+			case '\\': out += '\\'; break;
+			case '/': out += '/'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u':
+			{
+				uint32_t code_point = 0;
+				if (!ParseHex4(parser, code_point)) return false;
+				if (code_point >= 0xD800 && code_point < 0xDC00)
+				{
+					uint32_t low = 0;
+					if (!Consume(parser, "\\u") || !ParseHex4(parser, low) || low < 0xDC00 || low >= 0xE000)
+						return Fail(parser, "Invalid surrogate pair");
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+				}
+				AppendUtf8(out, code_point);
+				break;
+			}
+			default:
+				parser.position--;
+				return Fail(parser, "Invalid escape in string");
+			}
+		}
+
+		return Fail(parser, "Unterminated string");
+	}
+
+	/**
+	* @details
+	* Check the number against the JSON grammar, then convert it with strtod.
+	*/
+	static bool ParseNumber(JsonParser& parser, double& out)
+	{
+		const std::string& text = parser.text;
+		const size_t start = parser.position;
+		auto digits = [&]() {
+			const size_t first = parser.position;
+			while (parser.position < text.size() && text[parser.position] >= '0' && text[parser.position] <= '9')
+				parser.position++;
+			return parser.position > first;
+		};
+
+		if (parser.position < text.size() && text[parser.position] == '-') parser.position++;
+		if (!digits()) return Fail(parser, "Invalid number");
+		if (parser.position < text.size() && text[parser.position] == '.')
+		{
+			parser.position++;
+			if (!digits()) return Fail(parser, "Invalid number");
+		}
+		if (parser.position < text.size() && (text[parser.position] == 'e' || text[parser.position] == 'E'))
+		{
+			parser.position++;
+			if (parser.position < text.size() && (text[parser.position] == '+' || text[parser.position] == '-'))
+				parser.position++;
+			if (!digits()) return Fail(parser, "Invalid number");
+		}
+
+		out = std::strtod(text.substr(start, parser.position - start).c_str(), nullptr);
+		return true;
+	}
+
+	/**
+	* @details
+	* Parse the elements of an array after its opening bracket.
+	*/
+	static bool ParseArray(JsonParser& parser, JsonValue& value, int depth)
+	{
+		value.type = JsonType::Array;
+		SkipWhitespace(parser);
+		if (Consume(parser, "]")) return true;
+
+		while (true)
+		{
+			value.elements.emplace_back();
+			if (!ParseValue(parser, value.elements.back(), depth + 1)) return false;
+
+			SkipWhitespace(parser);
+			if (Consume(parser, "]")) return true;
+			if (!Consume(parser, ",")) return Fail(parser, "Expected ',' or ']'");
+		}
+	}
+
+	/**
+	* @details
+	* Parse the members of an object after its opening brace. A repeated key
+	* replaces the earlier member.
+	*/
+	static bool ParseObject(JsonParser& parser, JsonValue& value, int depth)
+	{
+		value.type = JsonType::Object;
+		SkipWhitespace(parser);
+		if (Consume(parser, "}")) return true;
+
+		while (true)
+		{
+			SkipWhitespace(parser);
+			if (!Consume(parser, "\"")) return Fail(parser, "Expected a member name");
+
+			std::string key;
+			if (!ParseString(parser, key)) return false;
+
+			SkipWhitespace(parser);
+			if (!Consume(parser, ":")) return Fail(parser, "Expected ':'");
+
+			JsonValue member;
+			if (!ParseValue(parser, member, depth + 1)) return false;
+
+			bool replaced = false;
+			for (auto& existing : value.members)
+			{
+				if (existing.first != key) continue;
+				existing.second = std::move(member);
+				replaced = true;
+				break;
+			}
+			if (!replaced) value.members.emplace_back(std::move(key), std::move(member));
+
+			SkipWhitespace(parser);
+			if (Consume(parser, "}")) return true;
+			if (!Consume(parser, ",")) return Fail(parser, "Expected ',' or '}'");
+		}
+	}
+
+	/**
+	* @details
+	* Parse any value, dispatching on its first character.
+	*/
+	static bool ParseValue(JsonParser& parser, JsonValue& value, int depth)
+	{
+		if (depth > MAX_JSON_DEPTH) return Fail(parser, "Document is nested too deeply");
+
+		SkipWhitespace(parser);
+		if (parser.position >= parser.text.size()) return Fail(parser, "Unexpected end of document");
+
+		const char c = parser.text[parser.position];
+		if (c == '{')
+		{
+			parser.position++;
+			return ParseObject(parser, value, depth);
+		}
+		if (c == '[')
+		{
+			parser.position++;
+			return ParseArray(parser, value, depth);
+		}
+		if (c == '"')
+		{
+			parser.position++;
+			value.type = JsonType::String;
+			return ParseString(parser, value.string);
+		}
+		if (c == '-' || (c >= '0' && c <= '9'))
+		{
+			value.type = JsonType::Number;
+			return ParseNumber(parser, value.number);
+		}
+		if (Consume(parser, "true"))
+		{
+			value.type = JsonType::Bool;
+			value.boolean = true;
+			return true;
+		}
+		if (Consume(parser, "false"))
+		{
+			value.type = JsonType::Bool;
+			value.boolean = false;
+			return true;
+		}
+		if (Consume(parser, "null"))
+		{
+			value.type = JsonType::Null;
+			return true;
+		}
+
+		return Fail(parser, "Unexpected character");
+	}
+
+	/**
+	* @details
+	* Find a member by name with a linear search. Configuration objects are
+	* small, so this beats building a map.
+	*/
+	const JsonValue* JsonValue::Find(const std::string& key) const
+	{
+		for (const auto& member : members)
+			if (member.first == key) return &member.second;
+		return nullptr;
+	}
+
+	/**
+	* @details
+	* Parse the root value and make sure nothing but whitespace follows it.
+	*/
+	bool ParseJson(const std::string& text, JsonValue& value, std::string& error)
+	{
+		JsonParser parser(text);
+		value = JsonValue();
+
+		bool success = ParseValue(parser, value, 0);
+		if (success)
+		{
+			SkipWhitespace(parser);
+			if (parser.position != text.size()) success = Fail(parser, "Unexpected text after the document");
+		}
+
+		error = parser.error;
+		return success;
+	}
+}
\ No newline at end of file
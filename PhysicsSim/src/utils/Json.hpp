@@ -0,0 +1,76 @@
+/**
+* @file Json.hpp
+* @brief
+* Declarations for a small JSON reader. Parses a document into a tree of
+* values, which is all the configuration files need. Numbers are held as
+* doubles and object members keep the order they appear in.
+*/
+
+#pragma once
+
+#ifndef _JSON_
+#define _JSON_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Utils namespace
+namespace Utils
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/// @brief Type of a JSON value.
+	enum class JsonType
+	{
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	/**
+	* @brief Structure to hold a parsed JSON value.
+	* @param type The type of the value.
+	* @param boolean The value if it is a bool.
+	* @param number The value if it is a number.
+	* @param string The value if it is a string.
+	* @param elements The elements if it is an array.
+	* @param members The members if it is an object, in document order.
+	*/
+	struct JsonValue
+	{
+		JsonType type = JsonType::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<JsonValue> elements;
+		std::vector<std::pair<std::string, JsonValue>> members;
+
+		/**
+		* @brief Find a member of an object.
+		* @param key The name of the member.
+		* @return Pointer to the member's value, or null if there is none.
+		*/
+		const JsonValue* Find(const std::string& key) const;
+	};
+
+	/**
+	* @brief Parse a JSON document.
+	* @param text The text of the document.
+	* @param value Set to the root value.
+	* @param error Set to a description of the first error, with its line and column.
+	* @return True if the document was parsed, false otherwise.
+	*/
+	bool ParseJson(const std::string& text, JsonValue& value, std::string& error);
+}
+
+#endif
\ No newline at end of file
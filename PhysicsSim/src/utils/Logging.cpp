@@ -0,0 +1,252 @@
+/**
+* @file Logging.cpp
+* @brief
+* Function definitions for the application's logging pipeline.
+*/
+
+#include "Logging.hpp"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
+#include "spdlog/sinks/dist_sink.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+/// @brief Utils namespace
+namespace Utils
+{
+	/// @brief Maximum number of messages waiting for the logging thread.
+	static constexpr size_t QUEUE_SIZE = 8192;
+	/// @brief Window in which repeats of the same message are suppressed.
+	static constexpr std::chrono::seconds REPEAT_WINDOW(5);
+	/// @brief Number of distinct messages tracked by the repeat filter.
+	static constexpr size_t MAX_TRACKED_MESSAGES = 256;
+
+	/**
+	* @brief
+	* Ring buffer of formatted messages. Written by the logging thread only and
+	* read by the UI thread. Each slot is guarded by a sequence number that is
+	* odd while the slot is being written, so the reader can detect and skip
+	* slots that were overwritten under it without taking a lock.
+	*/
+	struct LogRing
+	{
+		/// @brief Number of messages kept in the ring.
+		static constexpr uint64_t CAPACITY = 512;
+		/// @brief Maximum length of a stored message, longer ones are cut.
+		static constexpr size_t TEXT_SIZE = 256;
+
+		/// @brief Structure to hold a single message slot.
+		struct Slot
+		{
+			std::atomic<uint64_t> sequence = 0;
+			int level = 0;
+			char text[TEXT_SIZE] = {};
+		};
+
+		/// @brief Message slots.
+		std::array<Slot, CAPACITY> slots;
+		/// @brief Number of messages written.
+		std::atomic<uint64_t> write_index = 0;
+	};
+
+	/**
+	* @details
+	* Get the process wide message ring.
+	*/
+	static LogRing& GetLogRing()
+	{
+		static LogRing ring;
+		return ring;
+	}
+
+	/**
+	* @brief
+	* Sink that writes formatted messages into the message ring. Only the
+	* logging thread calls it, so it needs no mutex.
+	*/
+	class RingSink final : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+	{
+	protected:
+		/**
+		* @brief Format the message and publish it in the next slot.
+		* @param msg The message to write.
+		*/
+		void sink_it_(const spdlog::details::log_msg& msg) override
+		{
+			spdlog::memory_buf_t buffer;
+			formatter_->format(msg, buffer);
+
+			size_t length = buffer.size();
+			while (length > 0 &&
+				(buffer.data()[length - 1] == '\n' || buffer.data()[length - 1] == '\r'))
+				length--;
+			length = std::min(length, LogRing::TEXT_SIZE - 1);
+
+			LogRing& ring = GetLogRing();
+			const uint64_t index = ring.write_index.load(std::memory_order_relaxed);
+			LogRing::Slot& slot = ring.slots[index % LogRing::CAPACITY];
+
+			slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.level = int(msg.level);
+			std::memcpy(slot.text, buffer.data(), length);
+			slot.text[length] = '\0';
+			slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+			ring.write_index.store(index + 1, std::memory_order_release);
+		}
+
+		/// @brief Nothing to flush.
+		void flush_() override {}
+	};
+
+	/**
+	* @brief
+	* Distribution sink that lets each distinct message through at most once per
+	* REPEAT_WINDOW. When a suppressed message shows up again after the window,
+	* it is written once with the number of repeats that were dropped. This keeps
+	* per-frame errors from flooding the output even when several of them
+	* alternate.
+	*/
+	class RepeatFilterSink final : public spdlog::sinks::dist_sink<spdlog::details::null_mutex>
+	{
+	protected:
+		/**
+		* @brief Forward the message unless it repeated within the window.
+		* @param msg The message to filter.
+		*/
+		void sink_it_(const spdlog::details::log_msg& msg) override
+		{
+			std::string key(msg.payload.data(), msg.payload.size());
+
+			auto it = seen.find(key);
+			if (it != seen.end() && msg.time - it->second.last < REPEAT_WINDOW)
+			{
+				it->second.suppressed++;
+				return;
+			}
+
+			if (it != seen.end() && it->second.suppressed > 0)
+			{
+				spdlog::memory_buf_t buffer;
+				fmt::format_to(
+					buffer,
+					"{} (repeated {} times)",
+					key,
+					it->second.suppressed);
+				spdlog::details::log_msg repeated = msg;
+				repeated.payload = spdlog::string_view_t(buffer.data(), buffer.size());
+				dist_sink::sink_it_(repeated);
+			}
+			else dist_sink::sink_it_(msg);
+
+			//Forget messages that have gone quiet once too many are tracked
+			if (seen.size() >= MAX_TRACKED_MESSAGES)
+			{
+				for (auto entry = seen.begin(); entry != seen.end();)
+				{
+					if (msg.time - entry->second.last >= REPEAT_WINDOW)
+						entry = seen.erase(entry);
+					else ++entry;
+				}
+			}
+
+			Entry& entry = seen[key];
+			entry.last = msg.time;
+			entry.suppressed = 0;
+		}
+
+	private:
+		/// @brief Structure to hold the state of a tracked message.
+		struct Entry
+		{
+			spdlog::log_clock::time_point last;
+			size_t suppressed = 0;
+		};
+
+		/// @brief Tracked messages keyed by payload.
+		std::unordered_map<std::string, Entry> seen;
+	};
+
+	/**
+	* @details
+	* Create the logging thread and the asynchronous default logger using the
+	* following sink chain:
+	* async logger -> repeat filter -> stdout color sink
+	*                               -> ring sink
+	* The queue uses the overrun_oldest policy, so a full queue drops the oldest
+	* message instead of blocking the frame or simulation loop.
+	*/
+	void InitLogging()
+	{
+		spdlog::init_thread_pool(QUEUE_SIZE, 1);
+
+		auto filter = std::make_shared<RepeatFilterSink>();
+		filter->add_sink(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+
+		auto ring = std::make_shared<RingSink>();
+		ring->set_pattern("%H:%M:%S.%e %v");
+		filter->add_sink(ring);
+
+		auto logger = std::make_shared<spdlog::async_logger>(
+			"PhysicsSim",
+			filter,
+			spdlog::thread_pool(),
+			spdlog::async_overflow_policy::overrun_oldest);
+
+		spdlog::set_default_logger(logger);
+	}
+
+	/**
+	* @details
+	* Switch the default logger back to a synchronous console logger so anything
+	* logged during static destruction still works. Then release the thread
+	* pool, which drains the queue and joins the logging thread.
+	*/
+	void ShutdownLogging()
+	{
+		spdlog::set_default_logger(std::make_shared<spdlog::logger>(
+			"PhysicsSim",
+			std::make_shared<spdlog::sinks::stdout_color_sink_mt>()));
+
+		spdlog::details::registry::instance().set_tp(nullptr);
+	}
+
+	/**
+	* @details
+	* Copy the messages from the cursor to the write index. A slot is only
+	* accepted if its sequence number matches the message index before and after
+	* the copy. If the reader fell more than a full ring behind, it skips ahead.
+	*/
+	void ReadLogMessages(uint64_t& cursor, std::vector<LogMessage>& out)
+	{
+		LogRing& ring = GetLogRing();
+		const uint64_t write = ring.write_index.load(std::memory_order_acquire);
+		if (write - cursor > LogRing::CAPACITY) cursor = write - LogRing::CAPACITY;
+
+		for (; cursor < write; cursor++)
+		{
+			const LogRing::Slot& slot = ring.slots[cursor % LogRing::CAPACITY];
+			const uint64_t expected = 2 * cursor + 2;
+
+			if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+
+			LogMessage message;
+			message.level = slot.level;
+			message.text.assign(slot.text, strnlen(slot.text, LogRing::TEXT_SIZE));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != expected) continue;
+
+			out.push_back(std::move(message));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**
+* @file Logging.hpp
+* @brief
+* Function declarations to set up the application's logging pipeline. Log calls
+* are formatted on the calling thread and handed to a single background thread
+* through a bounded queue that drops the oldest messages instead of blocking.
+* The background thread suppresses repeated messages and writes to stdout and to
+* a lock-free ring buffer that the debug window reads from.
+*/
+
+#pragma once
+
+#ifndef _LOGGING_
+#define _LOGGING_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//External forward declarations
+
+//Internal declarations
+
+/// @brief Utils namespace
+namespace Utils
+{
+	//External forward declarations
+
+	//Internal declarations
+
+	/**
+	* @brief Structure to hold a single log message read from the ring buffer.
+	* @param level The spdlog level of the message.
+	* @param text The formatted message with its time stamp.
+	*/
+	struct LogMessage
+	{
+		int level = 0;
+		std::string text;
+	};
+
+	/**
+	* @brief
+	* Replace the default logger with the asynchronous logger. Must be called
+	* before any other thread logs.
+	*/
+	void InitLogging();
+
+	/// @brief Flush the queue and stop the background logging thread.
+	void ShutdownLogging();
+
+	/**
+	* @brief
+	* Read the messages written to the ring buffer since the last call. Messages
+	* that were overwritten before being read are skipped.
+	* @param cursor The reader's position, advanced past the returned messages.
+	* @param out The vector to append the messages to.
+	*/
+	void ReadLogMessages(uint64_t& cursor, std::vector<LogMessage>& out);
+}
+
+#endif
\ No newline at end of file
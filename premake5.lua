@@ -24,7 +24,8 @@ project "Core"
 		"%{prj.location}/vendor/glfw_build/glad/include",
 		"%{prj.location}/vendor/glfw_build/glfw/include",
 		"%{prj.location}/vendor/imgui_build/build_src",
-		"%{prj.location}/vendor/imgui_build/build_src/backends"
+		"%{prj.location}/vendor/imgui_build/build_src/backends",
+		"%{prj.location}/vendor/spdlog_build/include"
 	}
 
 	links {
@@ -32,6 +33,9 @@ project "Core"
 		"imgui_build",
 		"glfw_build",
 		"spdlog_build",
+		"Profiling",
+		"Utils",
+		"IO",
 		"Graphics",
 		"Simulation"
 	}
@@ -79,7 +83,9 @@ project "Graphics"
 	links {
 		"opengl32.lib",
 		"glfw_build",
-		"spdlog_build"
+		"spdlog_build",
+		"Profiling",
+		"Utils"
 	}
 
 	filter "configurations:Debug"
@@ -117,6 +123,7 @@ project "GraphicsTest"
 		"opengl32.lib",
 		"glfw_build",
 		"spdlog_build",
+		"Profiling",
 		"Graphics"
 	}
 
@@ -146,11 +153,13 @@ project "Simulation"
 
 	includedirs {
 		"%{prj.location}/src",
-		"%{prj.location}/vendor/glfw_build/glm"
+		"%{prj.location}/vendor/glfw_build/glm",
+		"%{prj.location}/vendor/spdlog_build/include"
 	}
 
 	links {
 		"spdlog_build",
+		"Profiling",
 		"Graphics"
 	}
 
@@ -164,6 +173,151 @@ project "Simulation"
 		runtime "Release"
 		optimize "On"
 
+project "Profiling"
+	location "PhysicsSim"
+	kind "StaticLib"
+	language "C++"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files { 
+		"%{prj.location}/src/profiling/**.hpp", 
+		"%{prj.location}/src/profiling/**.cpp"
+	}
+
+	includedirs {
+		"%{prj.location}/src",
+		"%{prj.location}/vendor/glfw_build/glad/include",
+		"%{prj.location}/vendor/glfw_build/glfw/include",
+		"%{prj.location}/vendor/spdlog_build/include"
+	}
+
+	links {
+		"opengl32.lib",
+		"glfw_build",
+		"spdlog_build"
+	}
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		runtime "Release"
+		optimize "On"
+
+project "Utils"
+	location "PhysicsSim"
+	kind "StaticLib"
+	language "C++"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files { 
+		"%{prj.location}/src/utils/**.hpp", 
+		"%{prj.location}/src/utils/**.cpp"
+	}
+
+	includedirs {
+		"%{prj.location}/src",
+		"%{prj.location}/vendor/glfw_build/glad/include",
+		"%{prj.location}/vendor/glfw_build/glfw/include",
+		"%{prj.location}/vendor/glfw_build/glfw/deps",
+		"%{prj.location}/vendor/spdlog_build/include"
+	}
+
+	links {
+		"spdlog_build"
+	}
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		runtime "Release"
+		optimize "On"
+
+project "IO"
+	location "PhysicsSim"
+	kind "StaticLib"
+	language "C++"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files { 
+		"%{prj.location}/src/io/**.hpp", 
+		"%{prj.location}/src/io/**.cpp"
+	}
+
+	excludes {
+		"%{prj.location}/src/io/main.cpp"
+	}
+
+	includedirs {
+		"%{prj.location}/src",
+		"%{prj.location}/vendor/spdlog_build/include"
+	}
+
+	links {
+		"spdlog_build",
+		"Profiling"
+	}
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		runtime "Release"
+		optimize "On"
+
+project "IOTest"
+	location "PhysicsSim"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files { 
+		"%{prj.location}/src/io/main.cpp",
+	}
+
+	includedirs {
+		"%{prj.location}/src",
+		"%{prj.location}/vendor/spdlog_build/include"
+	}
+
+	links {
+		"spdlog_build",
+		"Profiling",
+		"IO"
+	}
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		runtime "Release"
+		optimize "On"
+
 project "imgui_build"
 	location "PhysicsSim"
 	kind "StaticLib"